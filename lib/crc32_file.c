@@ -61,6 +61,8 @@ crc32_file (int fd, uint32_t *resp)
 	}
       if (mapped != MAP_FAILED)
 	{
+	  /* The file is read once from start to end.  */
+	  posix_madvise (mapped, mapsize, POSIX_MADV_SEQUENTIAL);
 	  do
 	    {
 	      if (st.st_size <= (off_t) mapsize)
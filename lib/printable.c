@@ -0,0 +1,199 @@
+/* Finding runs of printable characters.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <ctype.h>
+#include <stdint.h>
+#include "printable.h"
+
+#if defined __x86_64__ || (defined __i386__ && defined __SSE2__)
+# include <immintrin.h>
+# define USE_SSE2 1
+/* The AVX2 variant is compiled with a target attribute and only used
+   when the CPU supports it.  */
+# if __GNUC__ >= 5
+#  define USE_AVX2 1
+# endif
+#endif
+
+
+/* Classify the 64 bytes at P.  Bit I of the result is set if P[I] is
+   printable.  */
+typedef uint64_t classify_fn (const struct printable_class *cls,
+			      const unsigned char *p);
+
+
+static uint64_t
+classify_scalar (const struct printable_class *cls, const unsigned char *p)
+{
+  uint64_t pm = 0;
+  for (unsigned int i = 0; i < 64; ++i)
+    pm |= (uint64_t) cls->byte[p[i]] << i;
+  return pm;
+}
+
+
+/* Add the printable bytes from 128 on to the mask M of the bytes at P
+   with the high bit set in H.  */
+static inline uint64_t
+add_high (const struct printable_class *cls, const unsigned char *p,
+	  uint64_t m, uint64_t h)
+{
+  while (h != 0)
+    {
+      unsigned int i = __builtin_ctzll (h);
+      m |= (uint64_t) cls->byte[p[i]] << i;
+      h &= h - 1;
+    }
+  return m;
+}
+
+
+#ifdef USE_SSE2
+static uint64_t
+classify_sse2 (const struct printable_class *cls, const unsigned char *p)
+{
+  const __m128i space = _mm_set1_epi8 (0x1f);
+  const __m128i del = _mm_set1_epi8 (0x7f);
+  const __m128i tab = _mm_set1_epi8 ('\t');
+  uint64_t pm = 0;
+  uint64_t hm = 0;
+
+  for (unsigned int i = 0; i < 64; i += 16)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *) (p + i));
+      /* The signed compares leave out the bytes from 128 on.  */
+      __m128i ascii = _mm_or_si128 (_mm_and_si128 (_mm_cmpgt_epi8 (v, space),
+						   _mm_cmpgt_epi8 (del, v)),
+				    _mm_cmpeq_epi8 (v, tab));
+      pm |= (uint64_t) (uint16_t) _mm_movemask_epi8 (ascii) << i;
+      hm |= (uint64_t) (uint16_t) _mm_movemask_epi8 (v) << i;
+    }
+
+  return cls->high ? add_high (cls, p, pm, hm) : pm;
+}
+#endif
+
+
+#ifdef USE_AVX2
+static uint64_t __attribute__ ((target ("avx2")))
+classify_avx2 (const struct printable_class *cls, const unsigned char *p)
+{
+  const __m256i space = _mm256_set1_epi8 (0x1f);
+  const __m256i del = _mm256_set1_epi8 (0x7f);
+  const __m256i tab = _mm256_set1_epi8 ('\t');
+  uint64_t pm = 0;
+  uint64_t hm = 0;
+
+  for (unsigned int i = 0; i < 64; i += 32)
+    {
+      __m256i v = _mm256_loadu_si256 ((const __m256i *) (p + i));
+      __m256i ascii
+	= _mm256_or_si256 (_mm256_and_si256 (_mm256_cmpgt_epi8 (v, space),
+					     _mm256_cmpgt_epi8 (del, v)),
+			   _mm256_cmpeq_epi8 (v, tab));
+      pm |= (uint64_t) (uint32_t) _mm256_movemask_epi8 (ascii) << i;
+      hm |= (uint64_t) (uint32_t) _mm256_movemask_epi8 (v) << i;
+    }
+
+  return cls->high ? add_high (cls, p, pm, hm) : pm;
+}
+#endif
+
+
+/* The best variant for this CPU, for classes with ASCII set.  */
+static classify_fn *classify_vector = classify_scalar;
+
+
+void
+printable_class_init (struct printable_class *cls, bool seven_bit)
+{
+  cls->ascii = true;
+  cls->high = false;
+  for (unsigned int c = 0; c < 256; ++c)
+    {
+      cls->byte[c] = ((isprint (c) || c == '\t')
+		      && (! seven_bit || c <= 127));
+      if (c < 128)
+	cls->ascii &= cls->byte[c] == ((c >= 0x20 && c < 0x7f) || c == '\t');
+      else
+	cls->high |= cls->byte[c];
+    }
+
+#ifdef USE_SSE2
+  classify_vector = classify_sse2;
+#endif
+#ifdef USE_AVX2
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    classify_vector = classify_avx2;
+#endif
+}
+
+
+/* Return the number of bytes at the start of BUF which are printable,
+   or not printable if PRINTABLE is false.  */
+static inline size_t
+run (const struct printable_class *cls, const unsigned char *buf,
+     size_t len, bool printable)
+{
+  classify_fn *classify = cls->ascii ? classify_vector : classify_scalar;
+  const uint64_t flip = printable ? 0 : ~(uint64_t) 0;
+  size_t n = 0;
+
+  while (len - n >= 64)
+    {
+      uint64_t p = classify (cls, buf + n) ^ flip;
+      if (p != ~(uint64_t) 0)
+	return n + __builtin_ctzll (~p);
+      n += 64;
+    }
+
+  while (n < len && cls->byte[buf[n]] == printable)
+    ++n;
+  return n;
+}
+
+
+size_t
+printable_run_long (const struct printable_class *cls,
+		    const unsigned char *buf, size_t len)
+{
+  return run (cls, buf, len, true);
+}
+
+
+size_t
+nonprintable_run_long (const struct printable_class *cls,
+		       const unsigned char *buf, size_t len)
+{
+  return run (cls, buf, len, false);
+}
+
@@ -0,0 +1,92 @@
+/* Finding runs of printable characters.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _PRINTABLE_H
+#define _PRINTABLE_H 1
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/* The bytes which can be part of a string: those for which isprint is
+   true in the current locale, and tab.  */
+struct printable_class
+{
+  bool byte[256];
+  /* True if the bytes below 128 are printable as in the C locale, so
+     those can be checked with vector instructions.  */
+  bool ascii;
+  /* True if any byte from 128 on is printable.  */
+  bool high;
+};
+
+/* Set up CLS for the current locale.  With SEVEN_BIT only the bytes
+   below 128 can be printable.  */
+extern void printable_class_init (struct printable_class *cls,
+				  bool seven_bit);
+
+/* Number of bytes printable_run looks at one by one, most runs in
+   binary data are shorter.  */
+#define PRINTABLE_SHORT_RUN 16
+
+/* Like printable_run and nonprintable_run, for the bytes after the
+   first PRINTABLE_SHORT_RUN.  */
+extern size_t printable_run_long (const struct printable_class *cls,
+				  const unsigned char *buf, size_t len);
+extern size_t nonprintable_run_long (const struct printable_class *cls,
+				     const unsigned char *buf, size_t len);
+
+/* Return the number of printable bytes at the start of BUF, at most
+   LEN.  */
+static inline size_t
+printable_run (const struct printable_class *cls, const unsigned char *buf,
+	       size_t len)
+{
+  size_t limit = len < PRINTABLE_SHORT_RUN ? len : PRINTABLE_SHORT_RUN;
+  size_t n = 0;
+  while (n < limit && cls->byte[buf[n]])
+    ++n;
+  if (n < PRINTABLE_SHORT_RUN)
+    return n;
+  return n + printable_run_long (cls, buf + n, len - n);
+}
+
+/* Likewise for the bytes which are not printable.  */
+static inline size_t
+nonprintable_run (const struct printable_class *cls,
+		  const unsigned char *buf, size_t len)
+{
+  size_t limit = len < PRINTABLE_SHORT_RUN ? len : PRINTABLE_SHORT_RUN;
+  size_t n = 0;
+  while (n < limit && ! cls->byte[buf[n]])
+    ++n;
+  if (n < PRINTABLE_SHORT_RUN)
+    return n;
+  return n + nonprintable_run_long (cls, buf + n, len - n);
+}
+
+#endif	/* printable.h */
@@ -30,8 +30,10 @@
 #define LIB_SYSTEM_H	1
 
 #include <argp.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <endian.h>
 #include <byteswap.h>
 #include <unistd.h>
@@ -175,6 +177,45 @@ extern char *color_weak;
 
 extern const char color_off[];
 
+
+/* Running work in parallel processes.  */
+
+/* Command line parser for --jobs.  */
+extern const struct argp jobs_argp;
+
+/* Number of processes given with --jobs.  */
+extern unsigned int workpool_jobs;
+
+struct workpool;
+
+/* Does the work for ARG.  Runs in a child process with standard output
+   and error going to temporary files, DATA is another one to pass more
+   back to the parent.  If the work has to be done in the parent DATA
+   is NULL.  The result is passed to the corresponding done function.  */
+typedef int workpool_work_fn (void *arg, FILE *data);
+
+/* Called in the parent in the order the work was added, after the
+   output of the child was copied.  Returns false if the output of all
+   following work is to be dropped.  Then RESULT is -1 and DATA NULL for
+   those.  */
+typedef bool workpool_done_fn (void *arg, int result, FILE *data);
+
+/* Create a pool running at most JOBS processes at the same time.  A
+   pool created by work running in a child does everything there.  */
+extern struct workpool *workpool_begin (unsigned int jobs);
+
+/* Add work for ARG, waiting for older work first if JOBS processes are
+   running already.  WORK can be NULL, then only DONE is called in
+   order, with RESULT zero.  */
+extern void workpool_add (struct workpool *pool, workpool_work_fn *work,
+			  workpool_done_fn *done, void *arg);
+
+/* Wait for all work added so far, before printing directly.  */
+extern void workpool_sync (struct workpool *pool);
+
+/* Wait for all work and free the pool.  */
+extern void workpool_end (struct workpool *pool);
+
 /* A static assertion.  This will cause a compile-time error if EXPR,
    which must be a compile-time constant, is false.  */
 
@@ -0,0 +1,393 @@
+/* Running work in parallel processes with ordered output.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <argp.h>
+#include <errno.h>
+#include <error.h>
+#include <libintl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "system.h"
+
+
+/* Prototype for option handler.  */
+static error_t parse_opt (int key, char *arg, struct argp_state *state);
+
+/* Option values.  */
+#define OPT_JOBS 0x100101
+
+/* Definitions of arguments for argp functions.  */
+static const struct argp_option options[] =
+{
+  { "jobs", OPT_JOBS, "N", 0,
+    N_("Run N jobs in parallel; the output is the same as with one"), 0 },
+
+  { NULL, 0, NULL, 0, NULL, 0 }
+};
+
+/* Parser data structure.  */
+const struct argp jobs_argp =
+  {
+    options, parse_opt, NULL, NULL, NULL, NULL, NULL
+  };
+
+/* Number of processes to use.  */
+unsigned int workpool_jobs = 1;
+
+/* Set in a child process.  Pools created there do all their work in
+   the child, so nested pools don't multiply the number of processes.  */
+static bool in_child;
+
+
+/* Handle program arguments.  */
+static error_t
+parse_opt (int key, char *arg, struct argp_state *state)
+{
+  switch (key)
+    {
+    case OPT_JOBS:
+      {
+	char *endp;
+	errno = 0;
+	unsigned long int n = strtoul (arg, &endp, 0);
+	if (*arg == '\0' || *endp != '\0' || errno != 0 || n == 0
+	    || n > 1024)
+	  argp_error (state, dgettext ("elfutils",
+				       "invalid number of jobs '%s'"), arg);
+	workpool_jobs = n;
+      }
+      break;
+
+    default:
+      return ARGP_ERR_UNKNOWN;
+    }
+  return 0;
+}
+
+
+/* What a child passes back besides its output.  This is in memory
+   shared with the children.  */
+struct workpool_status
+{
+  int result;
+  unsigned int errors;
+};
+
+/* An item which was added and whose output was not yet used.  Each
+   slot keeps its temporary files, they are reused for the next item.
+   The parent and the child only use them through new streams or the
+   file descriptors, stdio buffers of the other side must not matter.
+   ERR is NULL if standard output and error go to the same file, then
+   both go to OUT in the order they are written.  */
+struct workpool_slot
+{
+  pid_t pid;
+  FILE *out;
+  FILE *err;
+  FILE *data;
+  workpool_done_fn *done;
+  void *arg;
+};
+
+struct workpool
+{
+  unsigned int nalloc;		/* Number of elements in SLOTS.  */
+  unsigned int nslots;		/* Number of them which can be used.  */
+  unsigned int first;		/* Oldest item still running.  */
+  unsigned int nrunning;	/* Number of items still running.  */
+  bool dropping;		/* Output of following items is dropped.  */
+  struct workpool_status *status;
+  struct workpool_slot slots[0];
+};
+
+
+static void
+copy_file (FILE *from, FILE *to)
+{
+  char buf[BUFSIZ];
+  ssize_t n;
+
+  if (lseek (fileno (from), 0, SEEK_SET) != 0)
+    error (EXIT_FAILURE, errno, dgettext ("elfutils",
+					  "cannot read temporary file"));
+  while ((n = TEMP_FAILURE_RETRY (read (fileno (from), buf, sizeof buf))) > 0)
+    fwrite (buf, 1, n, to);
+}
+
+
+/* A new stream for FP, positioned at the start.  */
+static FILE *
+open_file (FILE *fp, const char *mode)
+{
+  int fd = dup (fileno (fp));
+  FILE *result = fd < 0 ? NULL : fdopen (fd, mode);
+  if (result == NULL || lseek (fd, 0, SEEK_SET) != 0)
+    error (EXIT_FAILURE, errno, dgettext ("elfutils",
+					  "cannot open temporary file"));
+  return result;
+}
+
+
+static void
+reset_file (FILE *fp)
+{
+  if (ftruncate (fileno (fp), 0) != 0
+      || lseek (fileno (fp), 0, SEEK_SET) != 0)
+    error (EXIT_FAILURE, errno, dgettext ("elfutils",
+					  "cannot reset temporary file"));
+}
+
+
+/* Kill the items still running after the oldest one, their output is
+   not wanted anymore.  */
+static void
+abandon (struct workpool *pool)
+{
+  for (unsigned int i = 1; i < pool->nrunning; ++i)
+    {
+      struct workpool_slot *slot
+	= &pool->slots[(pool->first + i) % pool->nslots];
+      if (slot->pid > 0)
+	{
+	  kill (slot->pid, SIGKILL);
+	  while (waitpid (slot->pid, NULL, 0) < 0 && errno == EINTR)
+	    continue;
+	}
+    }
+}
+
+
+/* Wait for the oldest item and use its output.  */
+static void
+finish_first (struct workpool *pool)
+{
+  struct workpool_slot *slot = &pool->slots[pool->first];
+  struct workpool_status *status = &pool->status[pool->first];
+
+  /* Items without work have no process.  */
+  int wstatus = 0;
+  while (slot->pid != 0 && waitpid (slot->pid, &wstatus, 0) < 0)
+    if (errno != EINTR)
+      error (EXIT_FAILURE, errno, dgettext ("elfutils",
+					    "cannot wait for child process"));
+
+  if (pool->dropping)
+    (void) slot->done (slot->arg, -1, NULL);
+  else
+    {
+      copy_file (slot->out, stdout);
+      fflush (stdout);
+      if (slot->err != NULL)
+	copy_file (slot->err, stderr);
+
+      /* A child which failed printed why, like error does, and that
+	 was copied.  Stop the same as if the work had been done here.  */
+      if (! WIFEXITED (wstatus) || WEXITSTATUS (wstatus) != 0)
+	{
+	  abandon (pool);
+	  if (WIFEXITED (wstatus))
+	    exit (WEXITSTATUS (wstatus));
+	  error (EXIT_FAILURE, 0, dgettext ("elfutils",
+					    "child process failed"));
+	}
+
+      error_message_count += status->errors;
+
+      FILE *data = open_file (slot->data, "r");
+      if (! slot->done (slot->arg, status->result, data))
+	pool->dropping = true;
+      fclose (data);
+    }
+
+  reset_file (slot->out);
+  if (slot->err != NULL)
+    reset_file (slot->err);
+  reset_file (slot->data);
+
+  pool->first = (pool->first + 1) % pool->nslots;
+  --pool->nrunning;
+}
+
+
+/* Wait for all running items and use their output.  */
+static void
+finish_all (struct workpool *pool)
+{
+  while (pool->nrunning > 0)
+    finish_first (pool);
+}
+
+
+static void __attribute__ ((noreturn))
+run_child (struct workpool_slot *slot, struct workpool_status *status,
+	   workpool_work_fn *work)
+{
+  in_child = true;
+
+  if (dup2 (fileno (slot->out), STDOUT_FILENO) < 0
+      || dup2 (fileno (slot->err ?: slot->out), STDERR_FILENO) < 0)
+    _exit (1);
+
+  FILE *data = open_file (slot->data, "w");
+  unsigned int errors = error_message_count;
+  status->result = work (slot->arg, data);
+  status->errors = error_message_count - errors;
+
+  if (fflush (stdout) != 0 || fflush (stderr) != 0 || fclose (data) != 0)
+    _exit (1);
+  _exit (0);
+}
+
+
+struct workpool *
+workpool_begin (unsigned int jobs)
+{
+  struct workpool *pool = xcalloc (1, (sizeof (struct workpool)
+				       + jobs * sizeof (struct workpool_slot)));
+  pool->nalloc = jobs;
+
+  /* With just one process everything is done here.  The same if
+     anything we need for more is not available, or in a child.  */
+  if (jobs > 1 && ! in_child)
+    {
+      /* Keep the order of what is written to standard output and
+	 error if they go to the same place.  */
+      struct stat out_st;
+      struct stat err_st;
+      bool merged = (fstat (STDOUT_FILENO, &out_st) == 0
+		     && fstat (STDERR_FILENO, &err_st) == 0
+		     && out_st.st_dev == err_st.st_dev
+		     && out_st.st_ino == err_st.st_ino);
+
+      pool->status = mmap (NULL, jobs * sizeof (struct workpool_status),
+			   PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+			   -1, 0);
+      if (pool->status == MAP_FAILED)
+	pool->status = NULL;
+
+      for (unsigned int i = 0; pool->status != NULL && i < jobs; ++i)
+	{
+	  struct workpool_slot *slot = &pool->slots[i];
+	  slot->out = tmpfile ();
+	  slot->err = merged ? NULL : tmpfile ();
+	  slot->data = tmpfile ();
+	  if (slot->out == NULL || (! merged && slot->err == NULL)
+	      || slot->data == NULL)
+	    break;
+	  pool->nslots = i + 1;
+	}
+      if (pool->nslots < 2)
+	pool->nslots = 0;
+    }
+
+  return pool;
+}
+
+
+void
+workpool_add (struct workpool *pool, workpool_work_fn *work,
+	      workpool_done_fn *done, void *arg)
+{
+  if (pool->nslots > 0)
+    {
+      if (pool->nrunning == pool->nslots)
+	finish_first (pool);
+
+      unsigned int idx = (pool->first + pool->nrunning) % pool->nslots;
+      struct workpool_slot *slot = &pool->slots[idx];
+      slot->done = done;
+      slot->arg = arg;
+
+      if (work == NULL && ! pool->dropping)
+	{
+	  pool->status[idx].result = 0;
+	  pool->status[idx].errors = 0;
+	  slot->pid = 0;
+	  ++pool->nrunning;
+	  return;
+	}
+
+      /* Nothing buffered must be written twice.  */
+      fflush (stdout);
+      fflush (stderr);
+
+      slot->pid = pool->dropping ? -1 : fork ();
+      if (slot->pid == 0)
+	run_child (slot, &pool->status[idx], work);
+      if (slot->pid > 0)
+	{
+	  ++pool->nrunning;
+	  return;
+	}
+    }
+
+  /* Run it here, after everything added before.  */
+  finish_all (pool);
+  if (pool->dropping)
+    (void) done (arg, -1, NULL);
+  else if (! done (arg, work != NULL ? work (arg, NULL) : 0, NULL))
+    pool->dropping = true;
+}
+
+
+void
+workpool_sync (struct workpool *pool)
+{
+  finish_all (pool);
+}
+
+
+void
+workpool_end (struct workpool *pool)
+{
+  finish_all (pool);
+
+  for (unsigned int i = 0; i < pool->nalloc; ++i)
+    {
+      struct workpool_slot *slot = &pool->slots[i];
+      if (slot->out != NULL)
+	fclose (slot->out);
+      if (slot->err != NULL)
+	fclose (slot->err);
+      if (slot->data != NULL)
+	fclose (slot->data);
+    }
+  if (pool->status != NULL)
+    munmap (pool->status, pool->nalloc * sizeof (struct workpool_status));
+  free (pool);
+}
@@ -43,6 +43,7 @@
 #include <fcntl.h>
 
 #include "libdwP.h"
+#include "libelfP.h"
 
 
 /* Section names.  */
@@ -129,6 +130,17 @@ check_section (Dwarf *result, GElf_Ehdr *ehdr, Elf_Scn *scn, bool inscngrp)
     /* A section appears twice.  That's bad.  We ignore the section.  */
     return result;
 
+  /* These sections are mostly read front to back, let the system know
+     so it can read ahead.  .debug_info and .debug_abbrev are followed
+     by DIE references and abbrev offsets all over the place, dropping
+     pages behind the reader would hurt, only ask for them to be read
+     in.  This is only a hint, ignore errors.  */
+  if (cnt == IDX_debug_line || cnt == IDX_debug_aranges
+      || cnt == IDX_debug_pubnames)
+    (void) elf_scnadvise (scn, ELF_ADV_SEQUENTIAL);
+  else if (cnt == IDX_debug_info || cnt == IDX_debug_abbrev)
+    (void) elf_scnadvise (scn, ELF_ADV_WILLNEED);
+
   /* We cannot know whether or not a GNU compressed section has already
      been uncompressed or not, so ignore any errors.  */
   if (gnu_compressed)
@@ -216,10 +228,46 @@ valid_p (Dwarf *result)
 static Dwarf *
 global_read (Dwarf *result, Elf *elf, GElf_Ehdr *ehdr)
 {
-  Elf_Scn *scn = NULL;
+  /* Without a table of the sections by name each lookup would look at
+     all sections, then a single pass over them is cheaper.  */
+  if (! __libelf_scnname_indexed (elf))
+    {
+      Elf_Scn *scn = NULL;
+
+      while (result != NULL && (scn = elf_nextscn (elf, scn)) != NULL)
+	result = check_section (result, ehdr, scn, false);
+
+      return valid_p (result);
+    }
 
-  while (result != NULL && (scn = elf_nextscn (elf, scn)) != NULL)
-    result = check_section (result, ehdr, scn, false);
+  /* Look up the sections we know by name instead of looking at every
+     section, files with many sections are common.  Sections with a
+     name appearing more than once, either plain or GNU compressed,
+     are tried in the order they appear in the file.  */
+  for (size_t cnt = 0; result != NULL && cnt < ndwarf_scnnames; ++cnt)
+    {
+      /* The name with ".z" instead of ".".  */
+      char zname[sizeof dwarf_scnnames[0] + 1];
+      zname[0] = '.';
+      zname[1] = 'z';
+      strcpy (&zname[2], &dwarf_scnnames[cnt][1]);
+
+      Elf_Scn *scn = elf_getscnbyname (elf, dwarf_scnnames[cnt]);
+      Elf_Scn *zscn = elf_getscnbyname (elf, zname);
+      while (result != NULL && result->sectiondata[cnt] == NULL
+	     && (scn != NULL || zscn != NULL))
+	if (zscn == NULL
+	    || (scn != NULL && elf_ndxscn (scn) < elf_ndxscn (zscn)))
+	  {
+	    result = check_section (result, ehdr, scn, false);
+	    scn = elf_nextscnbyname (elf, scn, dwarf_scnnames[cnt]);
+	  }
+	else
+	  {
+	    result = check_section (result, ehdr, zscn, false);
+	    zscn = elf_nextscnbyname (elf, zscn, zname);
+	  }
+    }
 
   return valid_p (result);
 }
@@ -360,3 +408,36 @@ dwarf_begin_elf (Elf *elf, Dwarf_Cmd cmd, Elf_Scn *scngrp)
   return NULL;
 }
 INTDEF(dwarf_begin_elf)
+
+
+Elf_Data *
+internal_function
+__libdw_prepare_section (Dwarf *dbg, int sec_index)
+{
+  unsigned int bit = 1u << sec_index;
+  if ((dbg->pending_sections & bit) != 0)
+    {
+      /* Clear the bit first, the hook reads the data it prepares.  */
+      dbg->pending_sections &= ~bit;
+
+      /* Data that cannot be prepared is not to be used at all.  */
+      if (! dbg->prepare_section (dbg, sec_index, dbg->prepare_arg))
+	{
+	  dbg->sectiondata[sec_index] = NULL;
+	  dbg->failed_sections |= bit;
+	}
+    }
+
+  if ((dbg->failed_sections & bit) != 0)
+    __libdw_seterrno (DWARF_E_RELOC_ERROR);
+  return dbg->sectiondata[sec_index];
+}
+
+void
+internal_function
+__libdw_prepare_sections (Dwarf *dbg)
+{
+  for (int cnt = 0; dbg->pending_sections != 0 && cnt < IDX_last; ++cnt)
+    if ((dbg->pending_sections & (1u << cnt)) != 0)
+      (void) __libdw_prepare_section (dbg, cnt);
+}
@@ -91,8 +91,9 @@ dwarf_formref_die (Dwarf_Attribute *attr, Dwarf_Die *result)
 	  }
 	while (cu->type_sig8 != sig);
 
-      datap = cu->dbg->sectiondata[IDX_debug_types]->d_buf;
-      size = cu->dbg->sectiondata[IDX_debug_types]->d_size;
+      Elf_Data *data = __libdw_section_data (cu->dbg, IDX_debug_types);
+      datap = data->d_buf;
+      size = data->d_size;
       offset = cu->start + cu->type_offset;
     }
   else
@@ -42,10 +42,10 @@ __libdw_formptr (Dwarf_Attribute *attr, int sec_index,
   if (attr == NULL)
     return NULL;
 
-  const Elf_Data *d = attr->cu->dbg->sectiondata[sec_index];
+  const Elf_Data *d = __libdw_section_data (attr->cu->dbg, sec_index);
   if (unlikely (d == NULL))
     {
-      __libdw_seterrno (err_nodata);
+      __libdw_seterrno_section (attr->cu->dbg, sec_index, err_nodata);
       return NULL;
     }
 
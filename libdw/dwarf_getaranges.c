@@ -67,7 +67,10 @@ dwarf_getaranges (Dwarf *dbg, Dwarf_Aranges **aranges, size_t *naranges)
       return 0;
     }
 
-  if (dbg->sectiondata[IDX_debug_aranges] == NULL)
+  Elf_Data *data = __libdw_section_data (dbg, IDX_debug_aranges);
+  if (data == NULL && __libdw_section_failed (dbg, IDX_debug_aranges))
+    return -1;
+  if (data == NULL)
     {
       /* No such section.  */
       *aranges = NULL;
@@ -76,15 +79,16 @@ dwarf_getaranges (Dwarf *dbg, Dwarf_Aranges **aranges, size_t *naranges)
       return 0;
     }
 
-  if (dbg->sectiondata[IDX_debug_aranges]->d_buf == NULL)
+  /* The CU offsets are checked against .debug_info.  */
+  Elf_Data *infodata = __libdw_section_data (dbg, IDX_debug_info);
+  if (data->d_buf == NULL || infodata == NULL)
     return -1;
 
   struct arangelist *arangelist = NULL;
   unsigned int narangelist = 0;
 
-  const unsigned char *readp = dbg->sectiondata[IDX_debug_aranges]->d_buf;
-  const unsigned char *readendp
-    = readp + dbg->sectiondata[IDX_debug_aranges]->d_size;
+  const unsigned char *readp = data->d_buf;
+  const unsigned char *readendp = readp + data->d_size;
 
   while (readp < readendp)
     {
@@ -195,8 +199,7 @@ dwarf_getaranges (Dwarf *dbg, Dwarf_Aranges **aranges, size_t *naranges)
 	  new_arange->arange.length = range_length;
 
 	  /* We store the actual CU DIE offset, not the CU header offset.  */
-	  const char *cu_header = (dbg->sectiondata[IDX_debug_info]->d_buf
-				   + offset);
+	  const char *cu_header = (infodata->d_buf + offset);
 	  unsigned int offset_size;
 	  if (read_4ubyte_unaligned_noncvt (cu_header) == DWARF3_LENGTH_64_BIT)
 	    offset_size = 8;
@@ -212,7 +215,7 @@ dwarf_getaranges (Dwarf *dbg, Dwarf_Aranges **aranges, size_t *naranges)
 
 	  /* Sanity-check the data.  */
 	  if (unlikely (new_arange->arange.offset
-			>= dbg->sectiondata[IDX_debug_info]->d_size))
+			>= infodata->d_size))
 	    goto invalid;
 	}
     }
@@ -40,12 +40,14 @@ dwarf_getcfi (Dwarf *dbg)
   if (dbg == NULL)
     return NULL;
 
-  if (dbg->cfi == NULL && dbg->sectiondata[IDX_debug_frame] != NULL)
+  Elf_Data *data;
+  if (dbg->cfi == NULL
+      && (data = __libdw_section_data (dbg, IDX_debug_frame)) != NULL)
     {
       Dwarf_CFI *cfi = libdw_typed_alloc (dbg, Dwarf_CFI);
 
       cfi->dbg = dbg;
-      cfi->data = (Elf_Data_Scn *) dbg->sectiondata[IDX_debug_frame];
+      cfi->data = (Elf_Data_Scn *) data;
 
       cfi->search_table = NULL;
       cfi->search_table_vaddr = 0;
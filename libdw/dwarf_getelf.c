@@ -43,5 +43,8 @@ dwarf_getelf (Dwarf *dwarf)
     /* Some error occurred before.  */
     return NULL;
 
+  /* The caller may read the sections from the ELF file itself.  */
+  __libdw_prepare_sections (dwarf);
+
   return dwarf->elf;
 }
@@ -772,10 +772,11 @@ dwarf_getlocation_addr (Dwarf_Attribute *attr, Dwarf_Addr address,
   if (initial_offset_base (attr, &off, &base) != 0)
     return -1;
 
-  const Elf_Data *d = attr->cu->dbg->sectiondata[IDX_debug_loc];
+  const Elf_Data *d = __libdw_section_data (attr->cu->dbg, IDX_debug_loc);
   if (d == NULL)
     {
-      __libdw_seterrno (DWARF_E_NO_LOCLIST);
+      __libdw_seterrno_section (attr->cu->dbg, IDX_debug_loc,
+				DWARF_E_NO_LOCLIST);
       return -1;
     }
 
@@ -853,10 +854,11 @@ dwarf_getlocations (Dwarf_Attribute *attr, ptrdiff_t offset, Dwarf_Addr *basep,
 	return -1;
     }
 
-  const Elf_Data *d = attr->cu->dbg->sectiondata[IDX_debug_loc];
+  const Elf_Data *d = __libdw_section_data (attr->cu->dbg, IDX_debug_loc);
   if (d == NULL)
     {
-      __libdw_seterrno (DWARF_E_NO_LOCLIST);
+      __libdw_seterrno_section (attr->cu->dbg, IDX_debug_loc,
+				DWARF_E_NO_LOCLIST);
       return -1;
     }
 
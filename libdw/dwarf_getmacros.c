@@ -300,10 +300,10 @@ read_macros (Dwarf *dbg, int sec_index,
 	     void *arg, ptrdiff_t offset, bool accept_0xff,
 	     Dwarf_Die *cudie)
 {
-  Elf_Data *d = dbg->sectiondata[sec_index];
+  Elf_Data *d = __libdw_section_data (dbg, sec_index);
   if (unlikely (d == NULL || d->d_buf == NULL))
     {
-      __libdw_seterrno (DWARF_E_NO_ENTRY);
+      __libdw_seterrno_section (dbg, sec_index, DWARF_E_NO_ENTRY);
       return -1;
     }
 
@@ -468,9 +468,10 @@ gnu_macros_getmacros_off (Dwarf *dbg, Dwarf_Off macoff,
 {
   assert (offset >= 0);
 
-  if (macoff >= dbg->sectiondata[IDX_debug_macro]->d_size)
+  Elf_Data *d = __libdw_section_data (dbg, IDX_debug_macro);
+  if (d == NULL || macoff >= d->d_size)
     {
-      __libdw_seterrno (DWARF_E_INVALID_OFFSET);
+      __libdw_seterrno_section (dbg, IDX_debug_macro, DWARF_E_INVALID_OFFSET);
       return -1;
     }
 
@@ -50,20 +50,21 @@ dwarf_next_unit (Dwarf *dwarf, Dwarf_Off off, Dwarf_Off *next_off,
     return -1;
 
   /* If we reached the end before don't do anything.  */
+  Elf_Data *d;
   if (off == (Dwarf_Off) -1l
-      || unlikely (dwarf->sectiondata[sec_idx] == NULL)
+      || unlikely ((d = __libdw_section_data (dwarf, sec_idx)) == NULL)
       /* Make sure there is enough space in the .debug_info section
 	 for at least the initial word.  We cannot test the rest since
 	 we don't know yet whether this is a 64-bit object or not.  */
-      || unlikely (off + 4 >= dwarf->sectiondata[sec_idx]->d_size))
+      || unlikely (off + 4 >= d->d_size))
     {
       *next_off = (Dwarf_Off) -1l;
-      return 1;
+      return __libdw_section_failed (dwarf, sec_idx) ? -1 : 1;
     }
 
   /* This points into the .debug_info section to the beginning of the
      CU entry.  */
-  const unsigned char *data = dwarf->sectiondata[sec_idx]->d_buf;
+  const unsigned char *data = d->d_buf;
   const unsigned char *bytes = data + off;
 
   /* The format of the CU header is described in dwarf2p1 7.5.1:
@@ -108,7 +109,7 @@ dwarf_next_unit (Dwarf *dwarf, Dwarf_Off off, Dwarf_Off *next_off,
 
   /* Now we know how large the header is.  */
   if (unlikely (DIE_OFFSET_FROM_CU_OFFSET (off, offset_size, debug_types)
-		>= dwarf->sectiondata[sec_idx]->d_size))
+		>= d->d_size))
     {
       *next_off = -1;
       return 1;
@@ -43,11 +43,11 @@ __libdw_offdie (Dwarf *dbg, Dwarf_Off offset, Dwarf_Die *result,
   if (dbg == NULL)
     return NULL;
 
-  Elf_Data *const data = dbg->sectiondata[debug_types ? IDX_debug_types
-					  : IDX_debug_info];
-  if (offset >= data->d_size)
+  const int sec_index = debug_types ? IDX_debug_types : IDX_debug_info;
+  Elf_Data *const data = __libdw_section_data (dbg, sec_index);
+  if (data == NULL || offset >= data->d_size)
     {
-      __libdw_seterrno (DWARF_E_INVALID_DWARF);
+      __libdw_seterrno_section (dbg, sec_index, DWARF_E_INVALID_DWARF);
       return NULL;
     }
 
@@ -102,10 +102,11 @@ dwarf_ranges (Dwarf_Die *die, ptrdiff_t offset, Dwarf_Addr *basep,
 
   /* We have to look for a noncontiguous range.  */
 
-  const Elf_Data *d = die->cu->dbg->sectiondata[IDX_debug_ranges];
+  const Elf_Data *d = __libdw_section_data (die->cu->dbg, IDX_debug_ranges);
   if (d == NULL && offset != 0)
     {
-      __libdw_seterrno (DWARF_E_NO_DEBUG_RANGES);
+      __libdw_seterrno_section (die->cu->dbg, IDX_debug_ranges,
+				DWARF_E_NO_DEBUG_RANGES);
       return -1;
     }
 
@@ -259,7 +259,9 @@ extern Dwarf *dwarf_begin (int fildes, Dwarf_Cmd cmd);
 /* Create a handle for a new debug session for an ELF file.  */
 extern Dwarf *dwarf_begin_elf (Elf *elf, Dwarf_Cmd cmd, Elf_Scn *scngrp);
 
-/* Retrieve ELF descriptor used for DWARF access.  */
+/* Retrieve ELF descriptor used for DWARF access.  Relocations libdwfl
+   defers until libdw reads a section are all applied first, so the
+   debugging sections can be read from the ELF descriptor directly.  */
 extern Elf *dwarf_getelf (Dwarf *dwarf);
 
 /* Retieve DWARF descriptor used for a Dwarf_Die or Dwarf_Attribute.
@@ -130,6 +130,7 @@ enum
   DWARF_E_NO_ALT_DEBUGLINK,
   DWARF_E_INVALID_OPCODE,
   DWARF_E_NOT_CUDIE,
+  DWARF_E_RELOC_ERROR,
 };
 
 
@@ -147,6 +148,16 @@ struct Dwarf
   /* The section data.  */
   Elf_Data *sectiondata[IDX_last];
 
+  /* Sections whose data must still be prepared by PREPARE_SECTION
+     before it is used, one bit for each IDX_* index.  libdwfl uses this
+     to apply ET_REL relocations only to the sections actually read.  */
+  unsigned int pending_sections;
+  /* Sections whose data could not be prepared.  Their SECTIONDATA is
+     NULL and reading them is an error.  */
+  unsigned int failed_sections;
+  bool (*prepare_section) (Dwarf *dbg, int sec_index, void *arg);
+  void *prepare_arg;
+
   /* True if the file has a byte order different from the host.  */
   bool other_byte_order;
 
@@ -208,6 +219,28 @@ struct Dwarf
 };
 
 
+/* Prepare section SEC_INDEX of DBG if it is pending and return its
+   data.  If it could not be prepared, set the error and return NULL.  */
+extern Elf_Data *__libdw_prepare_section (Dwarf *dbg, int sec_index)
+     __nonnull_attribute__ (1) internal_function;
+
+/* Prepare all the pending sections of DBG.  */
+extern void __libdw_prepare_sections (Dwarf *dbg)
+     __nonnull_attribute__ (1) internal_function;
+
+/* Return the data of section SEC_INDEX, or NULL if DBG does not have
+   it.  Data not read right after dwarf_begin must be fetched this way,
+   not from SECTIONDATA, in case it has not been prepared yet.  */
+static inline Elf_Data *
+__libdw_section_data (Dwarf *dbg, int sec_index)
+{
+  if (unlikely (((dbg->pending_sections | dbg->failed_sections)
+		 & (1u << sec_index)) != 0))
+    return __libdw_prepare_section (dbg, sec_index);
+  return dbg->sectiondata[sec_index];
+}
+
+
 /* Abbreviation representation.  */
 struct Dwarf_Abbrev
 {
@@ -604,14 +637,31 @@ __libdw_relocate_offset (Dwarf *dbg __attribute__ ((unused)),
   return 0;
 }
 
+/* Return true if DBG lacks section SEC_INDEX only because it could not
+   be prepared.  The error is set then.  */
+static inline bool
+__libdw_section_failed (Dwarf *dbg, int sec_index)
+{
+  return (dbg->failed_sections & (1u << sec_index)) != 0;
+}
+
+/* Set error VALUE for the missing section SEC_INDEX of DBG, unless it
+   could not be prepared, which set a better one.  */
+static inline void
+__libdw_seterrno_section (Dwarf *dbg, int sec_index, int value)
+{
+  if (! __libdw_section_failed (dbg, sec_index))
+    __libdw_seterrno (value);
+}
+
 static inline Elf_Data *
 __libdw_checked_get_data (Dwarf *dbg, int sec_index)
 {
-  Elf_Data *data = dbg->sectiondata[sec_index];
+  Elf_Data *data = __libdw_section_data (dbg, sec_index);
   if (unlikely (data == NULL)
       || unlikely (data->d_buf == NULL))
     {
-      __libdw_seterrno (DWARF_E_INVALID_DWARF);
+      __libdw_seterrno_section (dbg, sec_index, DWARF_E_INVALID_DWARF);
       return NULL;
     }
   return data;
@@ -93,8 +93,9 @@ __libdw_intern_next_unit (Dwarf *dbg, bool debug_types)
     }
 
   /* Invalid or truncated debug section data?  */
-  Elf_Data *data = dbg->sectiondata[debug_types
-				    ? IDX_debug_types : IDX_debug_info];
+  Elf_Data *data = __libdw_section_data (dbg, (debug_types
+					       ? IDX_debug_types
+					       : IDX_debug_info));
   if (unlikely (*offsetp > data->d_size))
     *offsetp = data->d_size;
 
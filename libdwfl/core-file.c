@@ -32,6 +32,7 @@
 #include "libdwflP.h"
 #include <gelf.h>
 
+#include <sys/mman.h>
 #include <sys/param.h>
 #include <unistd.h>
 #include <endian.h>
@@ -164,6 +165,122 @@ dwfl_report_core_segments (Dwfl *dwfl, Elf *elf, size_t phnum, GElf_Phdr *notes)
 /* Never read more than this much without mmap.  */
 #define MAX_EAGER_COST	8192
 
+/* Read at most this much past what the caller needs when we choose
+   the buffer ourselves, rounded up to a whole page.  */
+#define CORE_READAHEAD	(64 * 1024)
+
+static inline void
+update_end (GElf_Phdr *pphdr, const GElf_Off align,
+            GElf_Off *pend, GElf_Addr *pend_vaddr)
+{
+  *pend = (pphdr->p_offset + pphdr->p_filesz + align - 1) & -align;
+  *pend_vaddr = (pphdr->p_vaddr + pphdr->p_memsz + align - 1) & -align;
+}
+
+/* Use following contiguous segments to get towards SIZE.  */
+static inline bool
+do_more (size_t size, GElf_Phdr *pphdr, const GElf_Off align,
+         Elf *elf, GElf_Off start, int *pndx,
+         GElf_Off *pend, GElf_Addr *pend_vaddr)
+{
+  while (*pend <= start || *pend - start < size)
+    {
+      if (pphdr->p_filesz < pphdr->p_memsz)
+	/* This segment is truncated, so no following one helps us.  */
+	return false;
+
+      if (unlikely (gelf_getphdr (elf, (*pndx)++, pphdr) == NULL))
+	return false;
+
+      if (pphdr->p_type == PT_LOAD)
+	{
+	  if (pphdr->p_offset > *pend
+	      || pphdr->p_vaddr > *pend_vaddr)
+	    /* It's discontiguous!  */
+	    return false;
+
+	  update_end (pphdr, align, pend, pend_vaddr);
+	}
+    }
+  return true;
+}
+
+#define more(size) do_more (size, &phdr, align, elf, start, &ndx, &end, &end_vaddr)
+
+/* Tell whether SIZE bytes at OFFSET in the core file ELF are all
+   contents of contiguous PT_LOAD segments.  */
+static bool
+core_file_contiguous (Dwfl *dwfl, Elf *elf, GElf_Off offset, GElf_Off size)
+{
+  const GElf_Off align = dwfl->segment_align ?: 1;
+  GElf_Phdr phdr;
+  int ndx = 0;
+
+  do
+    if (unlikely (gelf_getphdr (elf, ndx++, &phdr) == NULL))
+      return false;
+  while (phdr.p_type != PT_LOAD || phdr.p_offset + phdr.p_filesz <= offset);
+
+  if (phdr.p_offset > offset)
+    return false;
+
+  GElf_Off start = offset;
+  GElf_Off end;
+  GElf_Addr end_vaddr;
+
+  update_end (&phdr, align, &end, &end_vaddr);
+  return more (size) && offset + size <= elf->maximum_size;
+}
+
+/* Map the pages of the core file ELF holding SIZE bytes at START, which
+   must all be in the file.  Returns the address of START in the mapping,
+   which unmap_core_pages releases, or NULL on failure.  */
+static void *
+map_core_pages (Elf *elf, GElf_Off start, size_t size)
+{
+  const GElf_Off pagesize = sysconf (_SC_PAGESIZE);
+  const GElf_Off offset = elf->start_offset + start;
+  const size_t skip = offset & (pagesize - 1);
+
+  void *pages = mmap (NULL, skip + size, PROT_READ | PROT_WRITE,
+		      MAP_PRIVATE, elf->fildes, offset - skip);
+  if (pages == MAP_FAILED)
+    {
+      /* The file cannot be mapped, so read it into anonymous pages
+	 instead.  Then they are released the same way.  */
+      pages = mmap (NULL, skip + size, PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (unlikely (pages == MAP_FAILED))
+	{
+	  __libdwfl_seterrno (DWFL_E_NOMEM);
+	  return NULL;
+	}
+      if (unlikely (pread_retry (elf->fildes, pages + skip, size, offset)
+		    != (ssize_t) size))
+	{
+	  munmap (pages, skip + size);
+	  __libdwfl_seterrno (DWFL_E_ERRNO);
+	  return NULL;
+	}
+    }
+
+  return pages + skip;
+}
+
+/* Release the pages of a map_core_pages mapping from the one holding
+   CONTENTS + KEEP on, or all of them when KEEP is zero.  SIZE is what
+   the mapping holds from CONTENTS.  */
+static void
+unmap_core_pages (void *contents, size_t keep, size_t size)
+{
+  const uintptr_t pagesize = sysconf (_SC_PAGESIZE);
+  uintptr_t from = (uintptr_t) contents + keep;
+  from = keep == 0 ? from & -pagesize : (from + pagesize - 1) & -pagesize;
+  const uintptr_t to = ((uintptr_t) contents + size + pagesize - 1) & -pagesize;
+  if (to > from)
+    munmap ((void *) from, to - from);
+}
+
 /* Dwfl_Module_Callback passed to and called by dwfl_segment_report_module
    to read in a segment as ELF image directly if possible or indicate an
    attempt must be made to read in the while segment right now.  */
@@ -180,32 +297,57 @@ core_file_read_eagerly (Dwfl_Module *mod,
 {
   Elf *core = arg;
 
-  /* The available buffer is often the whole segment when the core file
-     was mmap'd if used together with the dwfl_elf_phdr_memory_callback.
-     Which means that if it is complete we can just construct the whole
-     ELF image right now without having to read in anything more.  */
-  if (whole <= *buffer_available)
+  /* When the core file was mmap'd, the buffer from the
+     dwfl_elf_phdr_memory_callback points into it.  Then if the whole
+     ELF image is there, we can construct it right now from the core
+     file contents without reading or copying anything.  */
+  if (core->map_address != NULL)
+    {
+      GElf_Off offset = (*buffer - core->map_address) - core->start_offset;
+      if (whole <= *buffer_available
+	  || core_file_contiguous (mod->dwfl, core, offset, whole))
+	{
+	  *elfp = elf_begin_rand (core, offset, whole, NULL);
+	  *buffer = NULL;
+	  *buffer_available = 0;
+	  return *elfp != NULL;
+	}
+    }
+  else if (whole <= *buffer_available)
     {
-      /* All there ever was, we already have on hand.  */
+      /* The buffer holds pages we mapped from the core file, with all
+	 there ever was.  Hand them over to the ELF image as they are
+	 when they start on a page, else copy what we need.  */
 
-      if (core->map_address == NULL)
+      const uintptr_t pagesize = sysconf (_SC_PAGESIZE);
+      if (((uintptr_t) *buffer & (pagesize - 1)) == 0)
 	{
-	  /* We already malloc'd the buffer.  */
+	  unmap_core_pages (*buffer, whole, *buffer_available);
+	  *buffer_available = whole;
 	  *elfp = elf_memory (*buffer, whole);
 	  if (unlikely (*elfp == NULL))
 	    return false;
 
-	  (*elfp)->flags |= ELF_F_MALLOCED;
-	  *buffer = NULL;
-	  *buffer_available = 0;
-	  return true;
+	  (*elfp)->flags |= ELF_F_MMAPPED;
 	}
+      else
+	{
+	  void *image = malloc (whole);
+	  if (unlikely (image == NULL))
+	    return false;
+	  *elfp = elf_memory (memcpy (image, *buffer, whole), whole);
+	  if (unlikely (*elfp == NULL))
+	    {
+	      free (image);
+	      return false;
+	    }
 
-      /* We can use the image inside the core file directly.  */
-      *elfp = elf_begin_rand (core, *buffer - core->map_address, whole, NULL);
+	  (*elfp)->flags |= ELF_F_MALLOCED;
+	  unmap_core_pages (*buffer, 0, *buffer_available);
+	}
       *buffer = NULL;
       *buffer_available = 0;
-      return *elfp != NULL;
+      return true;
     }
 
   /* We don't have the whole file.  Which either means the core file
@@ -241,44 +383,6 @@ core_file_read_eagerly (Dwfl_Module *mod,
   return cost <= MAX_EAGER_COST;
 }
 
-static inline void
-update_end (GElf_Phdr *pphdr, const GElf_Off align,
-            GElf_Off *pend, GElf_Addr *pend_vaddr)
-{
-  *pend = (pphdr->p_offset + pphdr->p_filesz + align - 1) & -align;
-  *pend_vaddr = (pphdr->p_vaddr + pphdr->p_memsz + align - 1) & -align;
-}
-
-/* Use following contiguous segments to get towards SIZE.  */
-static inline bool
-do_more (size_t size, GElf_Phdr *pphdr, const GElf_Off align,
-         Elf *elf, GElf_Off start, int *pndx,
-         GElf_Off *pend, GElf_Addr *pend_vaddr)
-{
-  while (*pend <= start || *pend - start < size)
-    {
-      if (pphdr->p_filesz < pphdr->p_memsz)
-	/* This segment is truncated, so no following one helps us.  */
-	return false;
-
-      if (unlikely (gelf_getphdr (elf, (*pndx)++, pphdr) == NULL))
-	return false;
-
-      if (pphdr->p_type == PT_LOAD)
-	{
-	  if (pphdr->p_offset > *pend
-	      || pphdr->p_vaddr > *pend_vaddr)
-	    /* It's discontiguous!  */
-	    return false;
-
-	  update_end (pphdr, align, pend, pend_vaddr);
-	}
-    }
-  return true;
-}
-
-#define more(size) do_more (size, &phdr, align, elf, start, &ndx, &end, &end_vaddr)
-
 bool
 dwfl_elf_phdr_memory_callback (Dwfl *dwfl, int ndx,
 			       void **buffer, size_t *buffer_available,
@@ -292,7 +396,7 @@ dwfl_elf_phdr_memory_callback (Dwfl *dwfl, int ndx,
     {
       /* Called for cleanup.  */
       if (elf->map_address == NULL)
-	free (*buffer);
+	unmap_core_pages (*buffer, 0, *buffer_available);
       *buffer = NULL;
       *buffer_available = 0;
       return false;
@@ -317,12 +421,20 @@ dwfl_elf_phdr_memory_callback (Dwfl *dwfl, int ndx,
   if (! more (minread))
     return false;
 
-  /* See how much more we can get of what the caller wants.  */
-  (void) more (*buffer_available);
+  /* When the buffer is up to us, read ahead a little past what the caller
+     wants, to the end of a page.  But only so much, however much more is
+     on hand, so only the pages the caller looks at are ever touched.  */
+  size_t size = *buffer_available;
+  if (*buffer == NULL)
+    {
+      const GElf_Off pagesize = sysconf (_SC_PAGESIZE);
+      size = MAX (size, MAX (minread, CORE_READAHEAD));
+      size = ((elf->start_offset + start + size + pagesize - 1) & -pagesize)
+	     - (elf->start_offset + start);
+    }
 
-  /* If it's already on hand anyway, use as much as there is.  */
-  if (elf->map_address != NULL)
-    (void) more (elf->maximum_size - start);
+  /* See how much of it we can get.  */
+  (void) more (size);
 
   /* Make sure we don't look past the end of the actual file,
      even if the headers tell us to.  */
@@ -333,71 +445,67 @@ dwfl_elf_phdr_memory_callback (Dwfl *dwfl, int ndx,
   if (unlikely (start >= end))
     return false;
 
-  if (elf->map_address != NULL)
+  size = MIN (size, end - start);
+
+  if (elf->map_address == NULL && *buffer != NULL)
     {
-      void *contents = elf->map_address + elf->start_offset + start;
-      size_t size = end - start;
+      /* Read it right into the caller's buffer.  */
+      ssize_t nread = pread_retry (elf->fildes, *buffer, size,
+				   elf->start_offset + start);
+      if (nread < (ssize_t) minread)
+	{
+	  if (nread < 0)
+	    __libdwfl_seterrno (DWFL_E_ERRNO);
+	  return false;
+	}
 
       if (minread == 0)		/* String mode.  */
 	{
-	  const void *eos = memchr (contents, '\0', size);
-	  if (unlikely (eos == NULL) || unlikely (eos == contents))
+	  const void *eos = memchr (*buffer, '\0', nread);
+	  if (unlikely (eos == NULL) || unlikely (eos == *buffer))
 	    return false;
-	  size = eos + 1 - contents;
+	  nread = eos + 1 - *buffer;
 	}
 
-      if (*buffer == NULL)
-	{
-	  *buffer = contents;
-	  *buffer_available = size;
-	}
-      else
-	{
-	  *buffer_available = MIN (size, *buffer_available);
-	  memcpy (*buffer, contents, *buffer_available);
-	}
+      *buffer_available = nread;
+      return true;
     }
+
+  /* Otherwise use the pages of the core file right where they are,
+     mapping just those we need when the file was not mmap'd.  */
+  void *contents;
+  if (elf->map_address != NULL)
+    contents = elf->map_address + elf->start_offset + start;
   else
     {
-      void *into = *buffer;
-      if (*buffer == NULL)
-	{
-	  *buffer_available = MIN (minread ?: 512,
-				   MAX (4096, MIN (end - start,
-						   *buffer_available)));
-	  into = malloc (*buffer_available);
-	  if (unlikely (into == NULL))
-	    {
-	      __libdwfl_seterrno (DWFL_E_NOMEM);
-	      return false;
-	    }
-	}
+      contents = map_core_pages (elf, start, size);
+      if (unlikely (contents == NULL))
+	return false;
+    }
 
-      ssize_t nread = pread_retry (elf->fildes, into, *buffer_available, start);
-      if (nread < (ssize_t) minread)
+  if (minread == 0)		/* String mode.  */
+    {
+      const void *eos = memchr (contents, '\0', size);
+      if (unlikely (eos == NULL) || unlikely (eos == contents))
 	{
-	  if (into != *buffer)
-	    free (into);
-	  if (nread < 0)
-	    __libdwfl_seterrno (DWFL_E_ERRNO);
+	  if (elf->map_address == NULL)
+	    unmap_core_pages (contents, 0, size);
 	  return false;
 	}
+      if (elf->map_address == NULL)
+	unmap_core_pages (contents, eos + 1 - contents, size);
+      size = eos + 1 - contents;
+    }
 
-      if (minread == 0)		/* String mode.  */
-	{
-	  const void *eos = memchr (into, '\0', nread);
-	  if (unlikely (eos == NULL) || unlikely (eos == into))
-	    {
-	      if (*buffer == NULL)
-		free (into);
-	      return false;
-	    }
-	  nread = eos + 1 - into;
-	}
-
-      if (*buffer == NULL)
-	*buffer = into;
-      *buffer_available = nread;
+  if (*buffer == NULL)
+    {
+      *buffer = contents;
+      *buffer_available = size;
+    }
+  else
+    {
+      *buffer_available = MIN (size, *buffer_available);
+      memcpy (*buffer, contents, *buffer_available);
     }
 
   return true;
@@ -562,9 +670,18 @@ dwfl_core_file_report (Dwfl *dwfl, Elf *elf, const char *executable)
   /* Now report the modules from dwfl_link_map_report which were not filtered
      out by dwfl_segment_report_module.  */
 
-  Dwfl_Module **lastmodp = &dwfl->modulelist;
-  while (*lastmodp != NULL)
-    lastmodp = &(*lastmodp)->next;
+  size_t nmodules = 0;
+  for (struct r_debug_info_module *module = r_debug_info.module;
+       module != NULL; module = module->next)
+    ++nmodules;
+  Dwfl_Module **reported = malloc (nmodules * sizeof reported[0]);
+  if (unlikely (reported == NULL) && nmodules > 0)
+    {
+      clear_r_debug_info (&r_debug_info);
+      __libdwfl_seterrno (DWFL_E_NOMEM);
+      return -1;
+    }
+  size_t nreported = 0;
   for (struct r_debug_info_module *module = r_debug_info.module;
        module != NULL; module = module->next)
     {
@@ -583,25 +700,15 @@ dwfl_core_file_report (Dwfl *dwfl, Elf *elf, const char *executable)
       ++listed;
       module->elf = NULL;
       module->fd = -1;
-      /* Move this module to the end of the list, so that we end
-	 up with a list in the same order as the link_map chain.  */
-      if (mod->next != NULL)
-	{
-	  if (*lastmodp != mod)
-	    {
-	      lastmodp = &dwfl->modulelist;
-	      while (*lastmodp != mod)
-		lastmodp = &(*lastmodp)->next;
-	    }
-	  *lastmodp = mod->next;
-	  mod->next = NULL;
-	  while (*lastmodp != NULL)
-	    lastmodp = &(*lastmodp)->next;
-	  *lastmodp = mod;
-	}
-      lastmodp = &mod->next;
+      reported[nreported++] = mod;
     }
 
+  /* Move them all to the end of the list at once, so that we end
+     up with a list in the same order as the link_map chain.  */
+  if (nreported > 0)
+    __libdwfl_move_modules_last (dwfl, reported, nreported);
+  free (reported);
+
   clear_r_debug_info (&r_debug_info);
 
   /* We return the number of modules we found if we found any.
@@ -171,7 +171,8 @@ compare_cukey (const void *a, const void *b)
 static Dwfl_Error
 intern_cu (Dwfl_Module *mod, Dwarf_Off cuoff, struct dwfl_cu **result)
 {
-  if (unlikely (cuoff + 4 >= mod->dw->sectiondata[IDX_debug_info]->d_size))
+  Elf_Data *data = __libdw_section_data (mod->dw, IDX_debug_info);
+  if (unlikely (data == NULL || cuoff + 4 >= data->d_size))
     {
       if (likely (mod->lazycu == 1))
 	{
@@ -0,0 +1,556 @@
+/* Process-wide cache of debuginfo file lookups.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#include "libdwflP.h"
+#include <ctype.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <search.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/* What the cache knows about a name.  */
+enum cache_kind
+  {
+    cache_missing,		/* A file which does not exist.  */
+    cache_dir,			/* A directory.  */
+    cache_build_id,		/* A file from a manifest for a .build-id name.  */
+    cache_found,		/* A file which was found, by the name tried.  */
+    cache_crc			/* The CRC of a file, named "DEV:INO".  */
+  };
+
+/* Identity and modification time of a file.  */
+struct stamp
+{
+  dev_t dev;
+  ino_t ino;
+  struct timespec mtime;
+};
+
+struct cache_entry
+{
+  enum cache_kind kind;
+  char *name;
+  union
+  {
+    /* For cache_missing: the closest directory above the file which
+       existed when it was found missing, and its state then.  Adding
+       the file, or any missing directory on the way to it, changes the
+       modification time of that directory.  */
+    struct
+    {
+      struct cache_entry *dir;
+      struct stamp stamp;
+    } missing;
+
+    /* For cache_dir: the state of the directory, read once for each
+       search, and when it was read.  */
+    struct
+    {
+      bool exists;
+      unsigned int serial;
+      struct stamp stamp;
+      struct timespec checked;
+    } dir;
+
+    /* For cache_build_id: the file named in a manifest.  It is trusted
+       without looking at it.  */
+    struct
+    {
+      char *path;
+    } build_id;
+
+    /* For cache_found: the canonical name of the file found, while it
+       is still the same file.  */
+    struct
+    {
+      char *path;
+      struct stamp stamp;
+    } found;
+
+    /* For cache_crc: the CRC of the whole file, while its size and
+       modification and change times stay the same.  */
+    struct
+    {
+      bool valid;
+      uint32_t crc;
+      off_t size;
+      struct timespec mtime;
+      struct timespec ctime;
+    } crc;
+  };
+};
+
+/* The cache is shared by all Dwfl sessions in the process.  The files
+   from manifests are kept apart, only flushing the cache forgets them.  */
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static void *cache_root;
+static void *seed_root;
+static size_t cache_count;
+static unsigned int cache_serial = 1;
+
+/* When CACHE_ROOT holds this many entries, it is started over.  */
+#define CACHE_MAX_ENTRIES	4096
+
+/* A directory changed this recently when it was read may still change
+   without its modification time changing, see note_missing.  */
+#define CACHE_RACY_SECONDS	2
+
+
+static int
+cache_compare (const void *a, const void *b)
+{
+  const struct cache_entry *e1 = a;
+  const struct cache_entry *e2 = b;
+  if (e1->kind != e2->kind)
+    return e1->kind < e2->kind ? -1 : 1;
+  return strcmp (e1->name, e2->name);
+}
+
+static void
+cache_free_entry (void *p)
+{
+  struct cache_entry *entry = p;
+  if (entry->kind == cache_build_id)
+    free (entry->build_id.path);
+  else if (entry->kind == cache_found)
+    free (entry->found.path);
+  free (entry->name);
+  free (entry);
+}
+
+/* Find the entry of KIND for NAME in the tree at *ROOTP.  If there is
+   none and CREATE is true, add a cleared one.  Called with cache_lock
+   held.  */
+static struct cache_entry *
+cache_lookup (void **rootp, enum cache_kind kind, const char *name,
+	      bool create)
+{
+  struct cache_entry key = { .kind = kind, .name = (char *) name };
+  struct cache_entry **found = tfind (&key, rootp, cache_compare);
+  if (found != NULL)
+    return *found;
+  if (! create)
+    return NULL;
+
+  struct cache_entry *entry = calloc (1, sizeof *entry);
+  if (unlikely (entry == NULL))
+    return NULL;
+  entry->kind = kind;
+  entry->name = strdup (name);
+  if (unlikely (entry->name == NULL)
+      || unlikely (tsearch (entry, rootp, cache_compare) == NULL))
+    {
+      free (entry->name);
+      free (entry);
+      return NULL;
+    }
+  if (rootp == &cache_root)
+    ++cache_count;
+  return entry;
+}
+
+/* Forget everything but the files from manifests when the cache is
+   full.  Called with cache_lock held, before adding entries.  */
+static void
+cache_make_room (void)
+{
+  if (cache_count < CACHE_MAX_ENTRIES)
+    return;
+  tdestroy (cache_root, cache_free_entry);
+  cache_root = NULL;
+  cache_count = 0;
+}
+
+static void
+set_stamp (struct stamp *stamp, const struct stat *st)
+{
+  stamp->dev = st->st_dev;
+  stamp->ino = st->st_ino;
+  stamp->mtime = st->st_mtim;
+}
+
+static bool
+same_stamp (const struct stamp *a, const struct stamp *b)
+{
+  return (a->dev == b->dev && a->ino == b->ino
+	  && a->mtime.tv_sec == b->mtime.tv_sec
+	  && a->mtime.tv_nsec == b->mtime.tv_nsec);
+}
+
+/* Bring the state of DIR up to date, unless that was already done
+   during this search.  Called with cache_lock held.  */
+static void
+dir_refresh (struct cache_entry *dir)
+{
+  if (dir->dir.serial == cache_serial)
+    return;
+
+  struct stat st;
+  clock_gettime (CLOCK_REALTIME, &dir->dir.checked);
+  dir->dir.exists = stat (dir->name, &st) == 0 && S_ISDIR (st.st_mode);
+  if (dir->dir.exists)
+    set_stamp (&dir->dir.stamp, &st);
+  dir->dir.serial = cache_serial;
+}
+
+
+void
+internal_function
+__libdwfl_cache_new_search (void)
+{
+  pthread_mutex_lock (&cache_lock);
+  if (++cache_serial == 0)
+    ++cache_serial;
+  pthread_mutex_unlock (&cache_lock);
+}
+
+bool
+internal_function
+__libdwfl_cache_missing (const char *fname)
+{
+  bool missing = false;
+  int save_errno = errno;
+
+  pthread_mutex_lock (&cache_lock);
+  struct cache_entry *entry = cache_lookup (&cache_root, cache_missing,
+					    fname, false);
+  if (entry != NULL && entry->missing.dir != NULL)
+    {
+      struct cache_entry *dir = entry->missing.dir;
+      dir_refresh (dir);
+      missing = (dir->dir.exists
+		 && same_stamp (&dir->dir.stamp, &entry->missing.stamp));
+    }
+  pthread_mutex_unlock (&cache_lock);
+
+  errno = save_errno;
+  return missing;
+}
+
+void
+internal_function
+__libdwfl_cache_note_missing (const char *fname)
+{
+  int save_errno = errno;
+
+  char *path = malloc (strlen (fname) + sizeof ".");
+  if (unlikely (path == NULL))
+    return;
+  strcpy (path, fname);
+
+  pthread_mutex_lock (&cache_lock);
+  cache_make_room ();
+
+  /* Find the closest directory which exists.  */
+  struct cache_entry *dir;
+  do
+    {
+      char *slash = strrchr (path, '/');
+      bool top = slash == NULL || slash == path;
+      if (slash == NULL)
+	strcpy (path, ".");
+      else
+	slash[slash == path] = '\0';
+
+      dir = cache_lookup (&cache_root, cache_dir, path, true);
+      if (dir == NULL)
+	break;
+      dir_refresh (dir);
+      if (! dir->dir.exists && top)
+	dir = NULL;
+    }
+  while (dir != NULL && ! dir->dir.exists);
+
+  /* The modification time has a granularity, a file added within the
+     same tick as the directory changed before leaves it the same.  So
+     only a directory which had not changed for a while when it was read
+     can tell the file is still missing.  */
+  if (dir != NULL
+      && (dir->dir.stamp.mtime.tv_sec + CACHE_RACY_SECONDS
+	  >= dir->dir.checked.tv_sec))
+    dir = NULL;
+
+  if (dir != NULL)
+    {
+      struct cache_entry *entry = cache_lookup (&cache_root, cache_missing,
+						fname, true);
+      if (entry != NULL)
+	{
+	  entry->missing.dir = dir;
+	  entry->missing.stamp = dir->dir.stamp;
+	}
+    }
+
+  pthread_mutex_unlock (&cache_lock);
+
+  free (path);
+  errno = save_errno;
+}
+
+int
+internal_function
+__libdwfl_cache_open_build_id (const char *id_name, char **file_name)
+{
+  int save_errno = errno;
+  int fd = -1;
+
+  pthread_mutex_lock (&cache_lock);
+  struct cache_entry *entry = cache_lookup (&seed_root, cache_build_id,
+					    id_name, false);
+  if (entry != NULL && entry->build_id.path != NULL)
+    {
+      fd = TEMP_FAILURE_RETRY (open (entry->build_id.path, O_RDONLY));
+      char *fname = fd < 0 ? NULL : strdup (entry->build_id.path);
+      if (fd >= 0 && fname == NULL)
+	{
+	  close (fd);
+	  fd = -1;
+	}
+      if (fd < 0)
+	{
+	  free (entry->build_id.path);
+	  entry->build_id.path = NULL;
+	}
+      else
+	{
+	  free (*file_name);
+	  *file_name = fname;
+	}
+    }
+  pthread_mutex_unlock (&cache_lock);
+
+  errno = save_errno;
+  return fd;
+}
+
+void
+internal_function
+__libdwfl_cache_note_build_id (const char *id_name, const char *fname)
+{
+  int save_errno = errno;
+  char *path = strdup (fname);
+
+  pthread_mutex_lock (&cache_lock);
+  struct cache_entry *entry = (path == NULL ? NULL
+			       : cache_lookup (&seed_root, cache_build_id,
+					       id_name, true));
+  if (entry != NULL)
+    {
+      free (entry->build_id.path);
+      entry->build_id.path = path;
+      path = NULL;
+    }
+  pthread_mutex_unlock (&cache_lock);
+
+  free (path);
+  errno = save_errno;
+}
+
+char *
+internal_function
+__libdwfl_cache_canonical_name (const char *fname, int fd)
+{
+  int save_errno = errno;
+  char *path = NULL;
+  struct stat st;
+  bool stamped = fstat (fd, &st) == 0;
+  struct stamp stamp;
+  if (stamped)
+    set_stamp (&stamp, &st);
+
+  pthread_mutex_lock (&cache_lock);
+  struct cache_entry *entry = (! stamped ? NULL
+			       : cache_lookup (&cache_root, cache_found,
+					       fname, false));
+  if (entry != NULL && same_stamp (&entry->found.stamp, &stamp))
+    path = strdup (entry->found.path);
+  pthread_mutex_unlock (&cache_lock);
+  if (path != NULL)
+    {
+      errno = save_errno;
+      return path;
+    }
+
+  path = canonicalize_file_name (fname);
+  if (path == NULL)
+    {
+      errno = save_errno;
+      return NULL;
+    }
+
+  char *copy = stamped ? strdup (path) : NULL;
+  if (copy != NULL)
+    {
+      pthread_mutex_lock (&cache_lock);
+      cache_make_room ();
+      entry = cache_lookup (&cache_root, cache_found, fname, true);
+      if (entry != NULL)
+	{
+	  free (entry->found.path);
+	  entry->found.path = copy;
+	  entry->found.stamp = stamp;
+	  copy = NULL;
+	}
+      pthread_mutex_unlock (&cache_lock);
+      free (copy);
+    }
+
+  errno = save_errno;
+  return path;
+}
+
+static bool
+same_time (const struct timespec *a, const struct timespec *b)
+{
+  return a->tv_sec == b->tv_sec && a->tv_nsec == b->tv_nsec;
+}
+
+int
+internal_function
+__libdwfl_cache_crc32_file (int fd, uint32_t *resp)
+{
+  struct stat st;
+  if (fstat (fd, &st) != 0 || ! S_ISREG (st.st_mode))
+    return __libdwfl_crc32_file (fd, resp);
+
+  char name[2 * sizeof (uintmax_t) * 3 + 2];
+  snprintf (name, sizeof name, "%ju:%ju",
+	    (uintmax_t) st.st_dev, (uintmax_t) st.st_ino);
+
+  bool found = false;
+  pthread_mutex_lock (&cache_lock);
+  struct cache_entry *entry = cache_lookup (&cache_root, cache_crc, name,
+					    false);
+  if (entry != NULL && entry->crc.valid
+      && entry->crc.size == st.st_size
+      && same_time (&entry->crc.mtime, &st.st_mtim)
+      && same_time (&entry->crc.ctime, &st.st_ctim))
+    {
+      *resp = entry->crc.crc;
+      found = true;
+    }
+  pthread_mutex_unlock (&cache_lock);
+  if (found)
+    return 0;
+
+  /* Reading the whole file takes long, don't hold the lock meanwhile.  */
+  uint32_t crc;
+  if (__libdwfl_crc32_file (fd, &crc) != 0)
+    return -1;
+  *resp = crc;
+
+  int save_errno = errno;
+  pthread_mutex_lock (&cache_lock);
+  cache_make_room ();
+  entry = cache_lookup (&cache_root, cache_crc, name, true);
+  if (entry != NULL)
+    {
+      entry->crc.valid = true;
+      entry->crc.crc = crc;
+      entry->crc.size = st.st_size;
+      entry->crc.mtime = st.st_mtim;
+      entry->crc.ctime = st.st_ctim;
+    }
+  pthread_mutex_unlock (&cache_lock);
+  errno = save_errno;
+
+  return 0;
+}
+
+
+void
+dwfl_debuginfo_cache_flush (void)
+{
+  pthread_mutex_lock (&cache_lock);
+  tdestroy (cache_root, cache_free_entry);
+  cache_root = NULL;
+  cache_count = 0;
+  tdestroy (seed_root, cache_free_entry);
+  seed_root = NULL;
+  pthread_mutex_unlock (&cache_lock);
+}
+
+/* Check that NAME looks like a name under .build-id, two hex digits, a
+   slash and at least one more hex digit, optionally with .debug.  */
+static bool
+valid_id_name (const char *name)
+{
+  if (! isxdigit (name[0]) || ! isxdigit (name[1]) || name[2] != '/')
+    return false;
+  size_t n = strspn (&name[3], "0123456789abcdefABCDEF");
+  return n > 0 && (name[3 + n] == '\0'
+		   || strcmp (&name[3 + n], ".debug") == 0);
+}
+
+int
+dwfl_debuginfo_cache_seed (const char *manifest)
+{
+  FILE *fp = fopen (manifest, "r");
+  if (fp == NULL)
+    {
+      __libdwfl_seterrno (DWFL_E_ERRNO);
+      return -1;
+    }
+
+  int count = 0;
+  char *line = NULL;
+  size_t linelen = 0;
+  ssize_t n;
+  while ((n = getline (&line, &linelen, fp)) > 0)
+    {
+      if (line[n - 1] == '\n')
+	line[--n] = '\0';
+      if (n == 0 || line[0] == '#')
+	continue;
+
+      char *space = strchr (line, ' ');
+      if (space == NULL || space[1] == '\0')
+	{
+	  __libdwfl_seterrno (DWFL_E_INVALID_ARGUMENT);
+	  count = -1;
+	  break;
+	}
+      *space = '\0';
+      if (! valid_id_name (line))
+	{
+	  __libdwfl_seterrno (DWFL_E_INVALID_ARGUMENT);
+	  count = -1;
+	  break;
+	}
+
+      __libdwfl_cache_note_build_id (line, space + 1);
+      ++count;
+    }
+
+  free (line);
+  fclose (fp);
+  return count;
+}
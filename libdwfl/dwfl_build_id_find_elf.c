@@ -65,13 +65,19 @@ __libdwfl_open_by_build_id (Dwfl_Module *mod, bool debug, char **file_name,
     strcpy (&id_name[sizeof "/.build-id/" - 1 + 3 + (id_len - 1) * 2],
 	    ".debug");
 
+  /* A file listed in a manifest is tried first.  */
+  const char *cache_name = &id_name[sizeof "/.build-id/" - 1];
+  int fd = __libdwfl_cache_open_build_id (cache_name, file_name);
+  if (fd >= 0)
+    return fd;
+  __libdwfl_cache_new_search ();
+
   const Dwfl_Callbacks *const cb = mod->dwfl->callbacks;
   char *path = strdup ((cb->debuginfo_path ? *cb->debuginfo_path : NULL)
 		       ?: DEFAULT_DEBUGINFO_PATH);
   if (path == NULL)
     return -1;
 
-  int fd = -1;
   char *dir;
   char *paths = path;
   while (fd < 0 && (dir = strsep (&paths, ":")) != NULL)
@@ -89,18 +95,27 @@ __libdwfl_open_by_build_id (Dwfl_Module *mod, bool debug, char **file_name,
 	break;
       memcpy (mempcpy (name, dir, dirlen), id_name, sizeof id_name);
 
+      if (__libdwfl_cache_missing (name))
+	{
+	  free (name);
+	  errno = ENOENT;
+	  continue;
+	}
+
       fd = TEMP_FAILURE_RETRY (open (name, O_RDONLY));
       if (fd >= 0)
 	{
 	  if (*file_name != NULL)
 	    free (*file_name);
-	  *file_name = canonicalize_file_name (name);
+	  *file_name = __libdwfl_cache_canonical_name (name, fd);
 	  if (*file_name == NULL)
 	    {
 	      *file_name = name;
 	      name = NULL;
 	    }
 	}
+      else if (errno == ENOENT || errno == ENOTDIR)
+	__libdwfl_cache_note_missing (name);
       free (name);
     }
 
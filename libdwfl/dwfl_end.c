@@ -41,6 +41,7 @@ dwfl_end (Dwfl *dwfl)
   free (dwfl->lookup_addr);
   free (dwfl->lookup_module);
   free (dwfl->lookup_segndx);
+  free (dwfl->proc_maps);
 
   Dwfl_Module *next = dwfl->modulelist;
   while (next != NULL)
@@ -100,6 +100,7 @@ __libdwfl_module_free (Dwfl_Module *mod)
 	    close (mod->alt_fd);
 	}
     }
+  free (mod->lazy_reloc);
 
   if (mod->ebl != NULL)
     ebl_closebackend (mod->ebl);
@@ -120,10 +121,12 @@ __libdwfl_module_free (Dwfl_Module *mod)
 }
 
 void
-dwfl_report_begin_add (Dwfl *dwfl __attribute__ ((unused)))
+dwfl_report_begin_add (Dwfl *dwfl)
 {
-  /* The lookup table will be cleared on demand, there is nothing we need
-     to do here.  */
+  /* The lookup table will be cleared on demand.  What is reported need
+     no longer be what dwfl_linux_proc_refresh saw.  */
+  free (dwfl->proc_maps);
+  dwfl->proc_maps = NULL;
 }
 INTDEF (dwfl_report_begin_add)
 
@@ -137,6 +140,9 @@ dwfl_report_begin (Dwfl *dwfl)
     m->gc = true;
 
   dwfl->offline_next_address = OFFLINE_REDZONE;
+
+  free (dwfl->proc_maps);
+  dwfl->proc_maps = NULL;
 }
 INTDEF (dwfl_report_begin)
 
@@ -155,6 +161,71 @@ use (Dwfl_Module *mod, Dwfl_Module **tailp, Dwfl *dwfl)
   return mod;
 }
 
+static int
+compare_modules (const void *a, const void *b)
+{
+  Dwfl_Module *const *m1 = a;
+  Dwfl_Module *const *m2 = b;
+  return *m1 < *m2 ? -1 : *m1 > *m2;
+}
+
+void
+internal_function
+__libdwfl_move_modules_last (Dwfl *dwfl, Dwfl_Module **reported, size_t n)
+{
+  Dwfl_Module **sorted = malloc (n * sizeof sorted[0]);
+  bool *placed = calloc (n, sizeof placed[0]);
+  if (unlikely (sorted == NULL) || unlikely (placed == NULL))
+    {
+      /* Without memory to spare, move them one at a time.  */
+      free (sorted);
+      free (placed);
+      for (size_t i = 0; i < n; ++i)
+	{
+	  Dwfl_Module **prevp = &dwfl->modulelist;
+	  while (*prevp != reported[i])
+	    prevp = &(*prevp)->next;
+	  *prevp = reported[i]->next;
+	  while (*prevp != NULL)
+	    prevp = &(*prevp)->next;
+	  *prevp = reported[i];
+	  reported[i]->next = NULL;
+	}
+      return;
+    }
+
+  memcpy (sorted, reported, n * sizeof sorted[0]);
+  qsort (sorted, n, sizeof sorted[0], compare_modules);
+
+  /* Take all the reported modules out of the list.  */
+  Dwfl_Module **lastmodp = &dwfl->modulelist;
+  while (*lastmodp != NULL)
+    if (bsearch (lastmodp, sorted, n, sizeof sorted[0],
+		 compare_modules) != NULL)
+      *lastmodp = (*lastmodp)->next;
+    else
+      lastmodp = &(*lastmodp)->next;
+
+  /* Put them back at the end, each where it was last reported.  */
+  Dwfl_Module **tail = lastmodp;
+  for (size_t i = n; i-- > 0; )
+    {
+      Dwfl_Module **found = bsearch (&reported[i], sorted, n,
+				     sizeof sorted[0], compare_modules);
+      /* Duplicates sort next to each other, any of them marks it.  */
+      while (found > sorted && found[-1] == reported[i])
+	--found;
+      if (placed[found - sorted])
+	continue;
+      placed[found - sorted] = true;
+      reported[i]->next = *tail;
+      *tail = reported[i];
+    }
+
+  free (sorted);
+  free (placed);
+}
+
 /* Report that a module called NAME spans addresses [START, END).
    Returns the module handle, either existing or newly allocated,
    or returns a null pointer for an allocation error.  */
@@ -1324,8 +1324,6 @@ load_dw (Dwfl_Module *mod, struct dwfl_file *debugfile)
 
       find_symtab (mod);
       Dwfl_Error result = mod->symerr;
-      if (result == DWFL_E_NOERROR)
-	result = __libdwfl_relocate (mod, debugfile->elf, true);
       if (result != DWFL_E_NOERROR)
 	return result;
 
@@ -1349,6 +1347,18 @@ load_dw (Dwfl_Module *mod, struct dwfl_file *debugfile)
       return err == DWARF_E_NO_DWARF ? DWFL_E_NO_DWARF : DWFL_E (LIBDW, err);
     }
 
+  /* The relocations are applied as libdw reads each section.  */
+  if (mod->e_type == ET_REL && !debugfile->relocated)
+    {
+      Dwfl_Error result = __libdwfl_relocate_lazy (mod, debugfile->elf);
+      if (result != DWFL_E_NOERROR)
+	{
+	  INTUSE(dwarf_end) (mod->dw);
+	  mod->dw = NULL;
+	  return result;
+	}
+    }
+
   /* Until we have iterated through all CU's, we might do lazy lookups.  */
   mod->lazycu = 1;
 
@@ -1433,6 +1443,7 @@ dwfl_module_getdwarf (Dwfl_Module *mod, Dwarf_Addr *bias)
 	  && mod->main.relocated && ! mod->debug.relocated)
 	{
 	  mod->debug.relocated = true;
+	  __libdwfl_relocate_pending (mod);
 	  if (mod->debug.elf != mod->main.elf)
 	    (void) __libdwfl_relocate (mod, mod->debug.elf, false);
 	}
@@ -45,6 +45,9 @@ dwfl_module_getelf (Dwfl_Module *mod, GElf_Addr *loadbase)
 	  mod->main.relocated = true;
 	  if (likely (__libdwfl_module_getebl (mod) == DWFL_E_NOERROR))
 	    {
+	      /* The pending debugging sections are relocated in full
+		 first, not partially with the rest.  */
+	      __libdwfl_relocate_pending (mod);
 	      (void) __libdwfl_relocate (mod, mod->main.elf, false);
 
 	      if (mod->debug.elf == mod->main.elf)
@@ -54,7 +54,18 @@ try_open (const struct stat *main_stat,
     return -1;
 
   struct stat st;
-  int fd = TEMP_FAILURE_RETRY (open (fname, O_RDONLY));
+  int fd;
+  if (__libdwfl_cache_missing (fname))
+    {
+      errno = ENOENT;
+      fd = -1;
+    }
+  else
+    {
+      fd = TEMP_FAILURE_RETRY (open (fname, O_RDONLY));
+      if (fd < 0 && (errno == ENOENT || errno == ENOTDIR))
+	__libdwfl_cache_note_missing (fname);
+    }
   if (fd < 0)
     free (fname);
   else if (fstat (fd, &st) == 0
@@ -78,7 +89,7 @@ static inline bool
 check_crc (int fd, GElf_Word debuglink_crc)
 {
   uint32_t file_crc;
-  return (__libdwfl_crc32_file (fd, &file_crc) == 0
+  return (__libdwfl_cache_crc32_file (fd, &file_crc) == 0
 	  && file_crc == debuglink_crc);
 }
 
@@ -151,6 +162,8 @@ validate (Dwfl_Module *mod, int fd, bool check, GElf_Word debuglink_crc)
       return mod->debug.valid;
     }
 
+  /* Without a build ID only the CRC tells whether this is the right
+     file.  It costs reading all of it, the first time.  */
   return !check || check_crc (fd, debuglink_crc);
 }
 
@@ -351,6 +364,8 @@ dwfl_standard_find_debuginfo (Dwfl_Module *mod,
 			      GElf_Word debuglink_crc,
 			      char **debuginfo_file_name)
 {
+  __libdwfl_cache_new_search ();
+
   /* First try by build ID if we have one.  If that succeeds or fails
      other than just by finding nothing, that's all we do.  */
   const unsigned char *bits;
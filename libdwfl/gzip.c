@@ -129,6 +129,71 @@ zlib_fail (struct unzip_state *state, int result)
     }
 }
 
+#ifdef LZMA
+/* Return the decompressed size of an .xz file of MAPPED_SIZE bytes at
+   START_OFFSET in FD or at MAPPED, from the index of its blocks at the
+   end of the file.  Returns zero when it has no index, or more than one
+   stream, so that is not all there is.  */
+static size_t
+xz_uncompressed_size (int fd, off_t start_offset,
+		      const void *mapped, size_t mapped_size)
+{
+  unsigned char footer_buf[LZMA_STREAM_HEADER_SIZE];
+  const unsigned char *footer;
+  if (mapped_size < 2 * LZMA_STREAM_HEADER_SIZE)
+    return 0;
+  if (mapped != NULL)
+    footer = mapped + mapped_size - LZMA_STREAM_HEADER_SIZE;
+  else if (pread_retry (fd, footer_buf, sizeof footer_buf,
+			start_offset + mapped_size - sizeof footer_buf)
+	   == sizeof footer_buf)
+    footer = footer_buf;
+  else
+    return 0;
+
+  lzma_stream_flags flags;
+  if (lzma_stream_footer_decode (&flags, footer) != LZMA_OK
+      || flags.backward_size > mapped_size - 2 * LZMA_STREAM_HEADER_SIZE)
+    return 0;
+
+  const size_t index_pos = (mapped_size - LZMA_STREAM_HEADER_SIZE
+			    - flags.backward_size);
+  const unsigned char *index_buf;
+  void *read_buf = NULL;
+  if (mapped != NULL)
+    index_buf = mapped + index_pos;
+  else
+    {
+      read_buf = malloc (flags.backward_size);
+      if (read_buf == NULL
+	  || pread_retry (fd, read_buf, flags.backward_size,
+			  start_offset + index_pos)
+	     != (ssize_t) flags.backward_size)
+	{
+	  free (read_buf);
+	  return 0;
+	}
+      index_buf = read_buf;
+    }
+
+  size_t size = 0;
+  lzma_index *index = NULL;
+  uint64_t memlimit = UINT64_MAX;
+  size_t in_pos = 0;
+  if (lzma_index_buffer_decode (&index, &memlimit, NULL, index_buf,
+				&in_pos, flags.backward_size) == LZMA_OK)
+    {
+      if (lzma_index_file_size (index) == mapped_size
+	  && lzma_index_uncompressed_size (index) < SIZE_MAX)
+	size = lzma_index_uncompressed_size (index);
+      lzma_index_end (index, NULL);
+    }
+
+  free (read_buf);
+  return size;
+}
+#endif
+
 #if !USE_INFLATE
 static Dwfl_Error
 open_stream (int fd, off_t start_offset, struct unzip_state *state)
@@ -182,6 +247,9 @@ unzip (int fd, off_t start_offset,
       .input_buffer = NULL,
       .input_pos = 0
     };
+#ifdef LZMA
+  void *const whole_mapped = mapped;
+#endif
 
   if (mapped == NULL)
     {
@@ -233,6 +301,24 @@ unzip (int fd, off_t start_offset,
       return zlib_fail (&state, result);
     }
 
+#ifdef LZMA
+  /* When the index tells how big it all is, decompress into a buffer of
+     just that size, with a byte to spare to see the end of the stream,
+     instead of growing it as we go.  */
+  size_t whole_size_hint = xz_uncompressed_size (fd, start_offset,
+						 whole_mapped, _mapped_size);
+  if (whole_size_hint != 0)
+    {
+      if (!bigger_buffer (&state, whole_size_hint + 1))
+	{
+	  inflateEnd (&z);
+	  return zlib_fail (&state, Z (MEM_ERROR));
+	}
+      z.next_out = state.buffer;
+      z.avail_out = state.size;
+    }
+#endif
+
   do
     {
       if (z.avail_in == 0 && state.input_buffer != NULL)
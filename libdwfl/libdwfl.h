@@ -168,6 +168,19 @@ extern Dwfl_Module *dwfl_report_elf (Dwfl *dwfl, const char *name,
 extern Dwfl_Module *dwfl_report_offline (Dwfl *dwfl, const char *name,
 					 const char *file_name, int fd);
 
+/* Report COUNT files in order, as dwfl_report_offline (DWFL, NAMES[I],
+   FILE_NAMES[I], -1) would.  The files are first opened and their
+   headers read on up to NTHREADS threads at once, or on as many as
+   there are processors if NTHREADS is zero.  If MODULES is not null,
+   MODULES[I] is set to the module reported for FILE_NAMES[I], or to
+   null if that failed.  Returns the number of files reported, or -1
+   if none could be tried.  */
+extern int dwfl_report_offline_files (Dwfl *dwfl, size_t count,
+				      const char *const *names,
+				      const char *const *file_names,
+				      unsigned int nthreads,
+				      Dwfl_Module **modules);
+
 
 /* Finish reporting the current set of modules to the library.
    If REMOVED is not null, it's called for each module that
@@ -310,6 +323,35 @@ extern int dwfl_standard_find_debuginfo (Dwfl_Module *, void **,
 					 const char *, const char *,
 					 GElf_Word, char **);
 
+/* The standard callbacks above share a cache between all Dwfl sessions
+   in the process.  A file found missing is not looked for again until
+   the directory it would be in changes.  The cache is limited in size
+   and started over when full, except for the files added from
+   manifests.  */
+
+/* Forget everything in the cache.  */
+extern void dwfl_debuginfo_cache_flush (void);
+
+/* Add the files listed in MANIFEST to the cache, so they are found by
+   build ID without searching the debuginfo path.  Each line has a name
+   as under a .build-id directory, like "ab/cdef0123.debug" for a
+   debuginfo file or "ab/cdef0123" for the main file, a space and the
+   file name.  Empty lines and lines starting with # are ignored.
+   Returns the number of files added or -1 for errors.  */
+extern int dwfl_debuginfo_cache_seed (const char *manifest)
+  __nonnull_attribute__ (1);
+
+/* Keep the decompressed contents of gzip, bzip2 and xz compressed files
+   opened by libdwfl as files in the directory DIR, so the next time the
+   same file is opened they are mapped from there instead of decompressed
+   again.  A file in DIR is named for the device, inode number,
+   modification time and size of the compressed file, so a compressed
+   file that changes is decompressed anew.  Whatever is in DIR under
+   such a name is trusted.  The setting is shared by all Dwfl sessions
+   in the process.  With DIR null, the default, nothing is kept.
+   Returns zero, or -1 if DIR is not a directory.  */
+extern int dwfl_decompress_cache_dir (const char *dir);
+
 
 /* This callback must be used when using dwfl_offline_* to report modules,
    if ET_REL is to be supported.  */
@@ -372,6 +414,16 @@ extern int dwfl_core_file_report (Dwfl *dwfl, Elf *elf, const char *executable);
    or an errno code if opening the proc files failed.  */
 extern int dwfl_linux_proc_report (Dwfl *dwfl, pid_t pid);
 
+/* Bring the modules of DWFL up to date with the files now mapped into
+   the address space of PID.  This is dwfl_report_begin, then
+   dwfl_linux_proc_report and dwfl_report_end, except that when no file
+   has been mapped or unmapped since the last call for PID, and nothing
+   else was reported since, it does nothing at all.  The modules for
+   mappings that did not change are kept, with everything already read
+   from their files.  Returns zero on success, -1 if reporting failed,
+   or an errno code if reading the proc files failed.  */
+extern int dwfl_linux_proc_refresh (Dwfl *dwfl, pid_t pid);
+
 /* Similar, but reads an input stream in the format of Linux /proc/PID/maps
    files giving module layout, not the file for a live process.  */
 extern int dwfl_linux_proc_maps_report (Dwfl *dwfl, FILE *);
@@ -140,6 +140,13 @@ struct Dwfl
   GElf_Off lookup_tail_offset;
   int lookup_tail_ndx;
 
+  /* The file mappings in /proc/PID/maps dwfl_linux_proc_refresh
+     reported last, while nothing else has been reported since, or
+     null.  */
+  char *proc_maps;
+  size_t proc_maps_size;
+  pid_t proc_maps_pid;
+
   struct Dwfl_User_Core *user_core;
 };
 
@@ -201,6 +208,8 @@ struct Dwfl_Module
   Dwfl_Error symerr;		/* Previous failure to load symbols.  */
   Dwfl_Error dwerr;		/* Previous failure to load DWARF.  */
 
+  struct dwfl_lazy_reloc *lazy_reloc; /* Relocations left for libdw.  */
+
   /* Known CU's in this module.  */
   struct dwfl_cu *first_cu, **cu;
 
@@ -476,6 +485,15 @@ extern void __libdwfl_getelf (Dwfl_Module *mod) internal_function;
 extern Dwfl_Error __libdwfl_relocate (Dwfl_Module *mod, Elf *file, bool debug)
   internal_function;
 
+/* Like __libdwfl_relocate for the debugging sections of FILE, which
+   MOD->dw was just opened on.  The sections libdw reads through
+   __libdw_section_data are only relocated when it first does.  */
+extern Dwfl_Error __libdwfl_relocate_lazy (Dwfl_Module *mod, Elf *file)
+  internal_function;
+
+/* Apply the relocations __libdwfl_relocate_lazy left pending.  */
+extern void __libdwfl_relocate_pending (Dwfl_Module *mod) internal_function;
+
 /* Find the section index in mod->main.elf that contains the given
    *ADDR.  Adjusts *ADDR to be section relative on success, returns
    SHN_UNDEF on failure.  */
@@ -551,6 +569,40 @@ extern uint32_t __libdwfl_crc32 (uint32_t crc, unsigned char *buf, size_t len)
   attribute_hidden;
 extern int __libdwfl_crc32_file (int fd, uint32_t *resp) attribute_hidden;
 
+/* The process-wide cache of files looked for by the standard callbacks,
+   see debuginfo-cache.c.  */
+
+/* Start a new search, the directories are looked at again.  */
+extern void __libdwfl_cache_new_search (void) internal_function;
+
+/* Return true if FNAME is known not to exist.  */
+extern bool __libdwfl_cache_missing (const char *fname) internal_function;
+
+/* Note that opening FNAME failed with ENOENT or ENOTDIR.  */
+extern void __libdwfl_cache_note_missing (const char *fname)
+  internal_function;
+
+/* Open the file from a manifest for the .build-id name ID_NAME, like
+   "ab/cdef.debug".  On success return the fd and replace *FILE_NAME
+   with the malloc'd name.  Otherwise return -1.  */
+extern int __libdwfl_cache_open_build_id (const char *id_name,
+					  char **file_name) internal_function;
+
+/* Note FNAME from a manifest as the file for ID_NAME.  */
+extern void __libdwfl_cache_note_build_id (const char *id_name,
+					   const char *fname)
+  internal_function;
+
+/* Return the malloc'd canonical name of FNAME, opened as FD, or NULL.
+   It is remembered while FNAME stays the same file.  */
+extern char *__libdwfl_cache_canonical_name (const char *fname, int fd)
+  internal_function;
+
+/* Like __libdwfl_crc32_file, but remember the CRC of each file, by
+   device and inode, until its size or times change.  */
+extern int __libdwfl_cache_crc32_file (int fd, uint32_t *resp)
+  internal_function;
+
 
 /* Given ELF and some parameters return TRUE if the *P return value parameters
    have been successfully filled in.  Any of the *P parameters can be NULL.  */
@@ -578,6 +630,15 @@ extern Dwfl_Module *__libdwfl_report_offline (Dwfl *dwfl, const char *name,
 								const char *))
   internal_function;
 
+/* Meat of dwfl_report_offline_files.  With STOP, no files are reported
+   after the first one that fails.  */
+extern int __libdwfl_report_offline_files (Dwfl *dwfl, size_t count,
+					   const char *const *names,
+					   const char *const *file_names,
+					   unsigned int nthreads, bool stop,
+					   Dwfl_Module **modules)
+  internal_function;
+
 /* Free PROCESS.  Unlink and free also any structures it references.  */
 extern void __libdwfl_process_free (Dwfl_Process *process)
   internal_function;
@@ -597,6 +658,13 @@ extern GElf_Addr __libdwfl_segment_start (Dwfl *dwfl, GElf_Addr start)
 extern GElf_Addr __libdwfl_segment_end (Dwfl *dwfl, GElf_Addr end)
   internal_function;
 
+/* Move the N modules in REPORTED to the end of the module list of DWFL,
+   in that order, like the link_map chain they were reported from.  A
+   module that is in REPORTED more than once goes where it is last.  */
+extern void __libdwfl_move_modules_last (Dwfl *dwfl, Dwfl_Module **reported,
+					 size_t n)
+  internal_function;
+
 /* Decompression wrappers: decompress whole file into memory.  */
 extern Dwfl_Error __libdw_gunzip  (int fd, off_t start_offset,
 				   void *mapped, size_t mapped_size,
@@ -34,6 +34,7 @@
 #include <byteswap.h>
 #include <endian.h>
 #include <fcntl.h>
+#include <sys/param.h>
 
 /* This element is always provided and always has a constant value.
    This makes it an easy thing to scan for to discern the format.  */
@@ -229,6 +230,85 @@ addrsize (uint_fast8_t elfclass)
   return elfclass * 4;
 }
 
+/* The link_map entries and the names they point to are mostly close
+   together in the dynamic linker's heap.  So rather than fetching each
+   word or string with the memory callback, report_r_debug keeps copies
+   of a few blocks of memory around what it read last.  Each block starts
+   at an address aligned for MEMORY_CACHE_ALIGN, so the address words
+   read from it are as aligned in the copy as they are in memory.  */
+#define MEMORY_CACHE_BLOCKS	8
+#define MEMORY_CACHE_BLOCK_SIZE	4096
+#define MEMORY_CACHE_ALIGN	8
+
+struct memory_cache
+{
+  Dwfl *dwfl;
+  Dwfl_Memory_Callback *memory_callback;
+  void *memory_callback_arg;
+  unsigned int next_victim;
+  struct
+  {
+    GElf_Addr vaddr;
+    size_t size;
+    unsigned char data[MEMORY_CACHE_BLOCK_SIZE]
+      __attribute__ ((aligned (MEMORY_CACHE_ALIGN)));
+  } blocks[MEMORY_CACHE_BLOCKS];
+};
+
+/* Return a pointer to at least SIZE bytes of memory at VADDR, or to the
+   string there if SIZE is zero.  It is valid until the next call.  */
+static const void *
+memory_cache_read (struct memory_cache *cache, GElf_Addr vaddr, size_t size)
+{
+  for (unsigned int i = 0; i < MEMORY_CACHE_BLOCKS; ++i)
+    {
+      const GElf_Addr offset = vaddr - cache->blocks[i].vaddr;
+      if (vaddr >= cache->blocks[i].vaddr
+	  && offset < cache->blocks[i].size
+	  && (size == 0
+	      ? memchr (&cache->blocks[i].data[offset], '\0',
+			cache->blocks[i].size - offset) != NULL
+	      : size <= cache->blocks[i].size - offset))
+	return &cache->blocks[i].data[offset];
+    }
+
+  /* Fetch a new block from VADDR aligned down on, to the end of the page
+     or as much as the callback has at hand up to the size of the block.  */
+  const GElf_Addr start = vaddr & -(GElf_Addr) MEMORY_CACHE_ALIGN;
+  const size_t lead = vaddr - start;
+  if (unlikely (size > MEMORY_CACHE_BLOCK_SIZE - lead))
+    return NULL;
+
+  Dwfl *dwfl = cache->dwfl;
+  int segndx = INTUSE(dwfl_addrsegment) (dwfl, start, NULL);
+  if (unlikely (segndx < 0))
+    return NULL;
+
+  void *buffer = NULL;
+  size_t buffer_available = (MEMORY_CACHE_BLOCK_SIZE
+			     - (start & (MEMORY_CACHE_BLOCK_SIZE - 1)));
+  buffer_available = MAX (buffer_available, lead + size);
+  if (! (*cache->memory_callback) (dwfl, segndx, &buffer, &buffer_available,
+				   start, lead + (size ?: 1),
+				   cache->memory_callback_arg))
+    return NULL;
+
+  unsigned int i = cache->next_victim++ % MEMORY_CACHE_BLOCKS;
+  cache->blocks[i].vaddr = start;
+  cache->blocks[i].size = MIN (buffer_available, MEMORY_CACHE_BLOCK_SIZE);
+  memcpy (cache->blocks[i].data, buffer, cache->blocks[i].size);
+  (void) (*cache->memory_callback) (dwfl, -1, &buffer, &buffer_available,
+				    0, 0, cache->memory_callback_arg);
+
+  if (unlikely (cache->blocks[i].size <= lead)
+      || (size == 0
+	  && memchr (&cache->blocks[i].data[lead], '\0',
+		     cache->blocks[i].size - lead) == NULL))
+    return NULL;
+
+  return &cache->blocks[i].data[lead];
+}
+
 /* Report a module for each struct link_map in the linked list at r_map
    in the struct r_debug at R_DEBUG_VADDR.  For r_debug_info description
    see dwfl_link_map_report in libdwflP.h.  If R_DEBUG_INFO is not NULL then no
@@ -248,16 +328,30 @@ report_r_debug (uint_fast8_t elfclass, uint_fast8_t elfdata,
 		void *memory_callback_arg,
 		struct r_debug_info *r_debug_info)
 {
-  /* Skip r_version, to aligned r_map field.  */
-  GElf_Addr read_vaddr = r_debug_vaddr + addrsize (elfclass);
-
-  void *buffer = NULL;
-  size_t buffer_available = 0;
-  inline int release_buffer (int result)
+  struct memory_cache *cache = malloc (sizeof *cache);
+  if (unlikely (cache == NULL))
+    {
+      __libdwfl_seterrno (DWFL_E_NOMEM);
+      return -1;
+    }
+  cache->dwfl = dwfl;
+  cache->memory_callback = memory_callback;
+  cache->memory_callback_arg = memory_callback_arg;
+  cache->next_victim = 0;
+  for (unsigned int i = 0; i < MEMORY_CACHE_BLOCKS; ++i)
+    cache->blocks[i].size = 0;
+
+  /* The modules reported, to move them into link_map order at the end.  */
+  Dwfl_Module **reported = NULL;
+  size_t nreported = 0;
+  size_t reported_alloc = 0;
+
+  inline int finish (int result)
   {
-    if (buffer != NULL)
-      (void) (*memory_callback) (dwfl, -1, &buffer, &buffer_available, 0, 0,
-				 memory_callback_arg);
+    if (nreported > 0)
+      __libdwfl_move_modules_last (dwfl, reported, nreported);
+    free (reported);
+    free (cache);
     return result;
   }
 
@@ -266,53 +360,39 @@ report_r_debug (uint_fast8_t elfclass, uint_fast8_t elfdata,
   {
     size_t nb = n * addrsize (elfclass); /* Address words -> bytes to read.  */
 
-    /* Read a new buffer if the old one doesn't cover these words.  */
-    if (buffer == NULL
-	|| vaddr < read_vaddr
-	|| vaddr - read_vaddr + nb > buffer_available)
-      {
-	release_buffer (0);
-
-	read_vaddr = vaddr;
-	int segndx = INTUSE(dwfl_addrsegment) (dwfl, vaddr, NULL);
-	if (unlikely (segndx < 0)
-	    || unlikely (! (*memory_callback) (dwfl, segndx,
-					       &buffer, &buffer_available,
-					       vaddr, nb, memory_callback_arg)))
-	  return true;
-      }
-
-    Elf32_Addr (*a32)[n] = vaddr - read_vaddr + buffer;
-    Elf64_Addr (*a64)[n] = (void *) a32;
+    /* A clobbered pointer need not be aligned, so go by bytes.  */
+    const unsigned char *words = memory_cache_read (cache, vaddr, nb);
+    if (unlikely (words == NULL))
+      return true;
 
     if (elfclass == ELFCLASS32)
       {
 	if (elfdata == ELFDATA2MSB)
 	  for (size_t i = 0; i < n; ++i)
-	    addrs[i] = BE32 (read_4ubyte_unaligned_noncvt (&(*a32)[i]));
+	    addrs[i] = BE32 (read_4ubyte_unaligned_noncvt (words + i * 4));
 	else
 	  for (size_t i = 0; i < n; ++i)
-	    addrs[i] = LE32 (read_4ubyte_unaligned_noncvt (&(*a32)[i]));
+	    addrs[i] = LE32 (read_4ubyte_unaligned_noncvt (words + i * 4));
       }
     else
       {
 	if (elfdata == ELFDATA2MSB)
 	  for (size_t i = 0; i < n; ++i)
-	    addrs[i] = BE64 (read_8ubyte_unaligned_noncvt (&(*a64)[i]));
+	    addrs[i] = BE64 (read_8ubyte_unaligned_noncvt (words + i * 8));
 	else
 	  for (size_t i = 0; i < n; ++i)
-	    addrs[i] = LE64 (read_8ubyte_unaligned_noncvt (&(*a64)[i]));
+	    addrs[i] = LE64 (read_8ubyte_unaligned_noncvt (words + i * 8));
       }
 
     return false;
   }
 
-  if (unlikely (read_addrs (read_vaddr, 1)))
-    return release_buffer (-1);
+  /* Skip r_version, to aligned r_map field.  */
+  if (unlikely (read_addrs (r_debug_vaddr + addrsize (elfclass), 1)))
+    return finish (-1);
 
   GElf_Addr next = addrs[0];
 
-  Dwfl_Module **lastmodp = &dwfl->modulelist;
   int result = 0;
 
   /* There can't be more elements in the link_map list than there are
@@ -323,7 +403,7 @@ report_r_debug (uint_fast8_t elfclass, uint_fast8_t elfdata,
   while (next != 0 && ++iterations < dwfl->lookup_elts)
     {
       if (read_addrs (next, 4))
-	return release_buffer (-1);
+	return finish (-1);
 
       /* Unused: l_addr is the difference between the address in memory
          and the ELF file when the core was created. We need to
@@ -339,28 +419,17 @@ report_r_debug (uint_fast8_t elfclass, uint_fast8_t elfdata,
       if (l_ld == 0)
 	continue;
 
-      /* Fetch the string at the l_name address.  */
-      const char *name = NULL;
-      if (buffer != NULL
-	  && read_vaddr <= l_name
-	  && l_name + 1 - read_vaddr < buffer_available
-	  && memchr (l_name - read_vaddr + buffer, '\0',
-		     buffer_available - (l_name - read_vaddr)) != NULL)
-	name = l_name - read_vaddr + buffer;
-      else
+      /* Fetch the string at the l_name address.  It is copied, since
+	 reading the build ID below can drop it from the cache.  */
+      char *name_copy = NULL;
+      const char *name = memory_cache_read (cache, l_name, 0);
+      if (name != NULL && name[0] != '\0')
 	{
-	  release_buffer (0);
-	  read_vaddr = l_name;
-	  int segndx = INTUSE(dwfl_addrsegment) (dwfl, l_name, NULL);
-	  if (likely (segndx >= 0)
-	      && (*memory_callback) (dwfl, segndx,
-				     &buffer, &buffer_available,
-				     l_name, 0, memory_callback_arg))
-	    name = buffer;
+	  name_copy = strdup (name);
+	  if (unlikely (name_copy == NULL))
+	    return finish (result);
 	}
-
-      if (name != NULL && name[0] == '\0')
-	name = NULL;
+      name = name_copy;
 
       if (iterations == 1
 	  && dwfl->user_core != NULL
@@ -376,7 +445,10 @@ report_r_debug (uint_fast8_t elfclass, uint_fast8_t elfdata,
 	  r_debug_info_module = malloc (sizeof (*r_debug_info_module)
 					+ strlen (name1) + 1);
 	  if (unlikely (r_debug_info_module == NULL))
-	    return release_buffer (result);
+	    {
+	      free (name_copy);
+	      return finish (result);
+	    }
 	  r_debug_info_module->fd = -1;
 	  r_debug_info_module->elf = NULL;
 	  r_debug_info_module->l_ld = l_ld;
@@ -417,27 +489,20 @@ report_r_debug (uint_fast8_t elfclass, uint_fast8_t elfdata,
 		      GElf_Addr build_id_vaddr = (build_id_elfaddr
 						  - elf_dynamic_vaddr + l_ld);
 
-		      release_buffer (0);
-		      int segndx = INTUSE(dwfl_addrsegment) (dwfl,
-							     build_id_vaddr,
-							     NULL);
-		      if (! (*memory_callback) (dwfl, segndx,
-						&buffer, &buffer_available,
-						build_id_vaddr, build_id_len,
-						memory_callback_arg))
+		      const void *build_id = memory_cache_read (cache,
+								build_id_vaddr,
+								build_id_len);
+		      if (build_id == NULL)
 			{
 			  /* File has valid build-id which cannot be read from
 			     memory.  This happens for core files without bit 4
 			     (0x10) set in Linux /proc/PID/coredump_filter.  */
 			}
-		      else
-			{
-			  if (memcmp (build_id_bits, buffer, build_id_len) != 0)
-			    /* File has valid build-id which does not match
-			       the one in memory.  */
-			    valid = false;
-			  release_buffer (0);
-			}
+		      else if (memcmp (build_id_bits, build_id,
+				       build_id_len) != 0)
+			/* File has valid build-id which does not match
+			   the one in memory.  */
+			valid = false;
 		    }
 
 		  if (valid)
@@ -476,35 +541,29 @@ report_r_debug (uint_fast8_t elfclass, uint_fast8_t elfdata,
 		}
 	    }
 	}
+      free (name_copy);
 
       if (mod != NULL)
 	{
 	  ++result;
 
-	  /* Move this module to the end of the list, so that we end
-	     up with a list in the same order as the link_map chain.  */
-	  if (mod->next != NULL)
+	  if (nreported == reported_alloc)
 	    {
-	      if (*lastmodp != mod)
-		{
-		  lastmodp = &dwfl->modulelist;
-		  while (*lastmodp != mod)
-		    lastmodp = &(*lastmodp)->next;
-		}
-	      *lastmodp = mod->next;
-	      mod->next = NULL;
-	      while (*lastmodp != NULL)
-		lastmodp = &(*lastmodp)->next;
-	      *lastmodp = mod;
+	      size_t alloc = reported_alloc * 2 ?: 64;
+	      Dwfl_Module **bigger = realloc (reported,
+					      alloc * sizeof reported[0]);
+	      if (unlikely (bigger == NULL))
+		return finish (result);
+	      reported = bigger;
+	      reported_alloc = alloc;
 	    }
-
-	  lastmodp = &mod->next;
+	  reported[nreported++] = mod;
 	}
     }
 
-  return release_buffer (result);
+  return finish (result);
 }
-
+
 static GElf_Addr
 consider_executable (Dwfl_Module *mod, GElf_Addr at_phdr, GElf_Addr at_entry,
 		     uint_fast8_t *elfclass, uint_fast8_t *elfdata,
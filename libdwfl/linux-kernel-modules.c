@@ -36,11 +36,14 @@
 #include "libdwflP.h"
 #include <inttypes.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdio_ext.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 #include <sys/utsname.h>
+#include <time.h>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -55,6 +58,7 @@
 #define KERNEL_MODNAME	"kernel"
 
 #define MODULEDIRFMT	"/lib/modules/%s"
+#define MODULESDEP	"modules.dep"
 
 #define KNOTESFILE	"/sys/kernel/notes"
 #define	MODNOTESFMT	"/sys/module/%s/notes"
@@ -290,14 +294,14 @@ report_kernel_archive (Dwfl *dwfl, const char **release,
   return result;
 }
 
+/* Return the length of the module file suffix of NAME, which is LEN
+   bytes long, or zero if it has none.  */
 static size_t
-check_suffix (const FTSENT *f, size_t namelen)
+check_suffix (const char *name, size_t len)
 {
 #define TRY(sfx)							\
-  if ((namelen ? f->fts_namelen == namelen + sizeof sfx - 1		\
-       : f->fts_namelen >= sizeof sfx)					\
-      && !memcmp (f->fts_name + f->fts_namelen - (sizeof sfx - 1),	\
-		  sfx, sizeof sfx))					\
+  if (len >= sizeof sfx							\
+      && !memcmp (name + len - (sizeof sfx - 1), sfx, sizeof sfx))	\
     return sizeof sfx - 1
 
   TRY (".ko");
@@ -314,6 +318,459 @@ check_suffix (const FTSENT *f, size_t namelen)
 #undef	TRY
 }
 
+/* Replace all ',' or '-' in NAME with '_'.  Following the algorithm by
+   which the kernel makefiles set KBUILD_MODNAME, that makes the module
+   name of a file name.  Modules could well be built using different
+   embedded names than their file names.  To handle that, we would have
+   to look at the __this_module.name contents in the module's text.  */
+static void
+module_name_from_file (char *name)
+{
+  for (; *name != '\0'; ++name)
+    if (*name == '-' || *name == ',')
+      *name = '_';
+}
+
+
+/* A module file found under a module directory.  */
+struct module_file
+{
+  char *name;			/* Module name made from the file name.  */
+  char *path;
+  const char *base;		/* File name part of PATH.  */
+  size_t baselen;		/* Length of BASE without the suffix.  */
+};
+
+/* A directory walked to find module files, and its state then.  */
+struct module_dir
+{
+  char *path;
+  dev_t dev;
+  ino_t ino;
+  struct timespec mtime;
+};
+
+/* All the module files under a module directory, listed by modules.dep
+   or, without it, found by walking the directory tree.  The index is
+   shared by all Dwfl sessions and used until modules.dep changes, or
+   for a walk until any of the directories walked changes.  */
+struct module_index
+{
+  struct module_index *next;
+  char *dir;
+  unsigned int refs;
+  bool from_dep;
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  struct timespec mtime;
+  size_t nfiles;
+  struct module_file *files;	/* In the order found.  */
+  struct module_file **byname;	/* Sorted by name, then order found.  */
+  size_t ndirs;
+  struct module_dir *dirs;	/* Walked, none for modules.dep.  */
+  struct timespec checked;	/* When it was read.  */
+  bool racy;			/* Changed just before, check again.  */
+};
+
+/* A file or directory changed this recently when it was read may still
+   change without its modification time changing.  */
+#define MODULE_INDEX_RACY_SECONDS	2
+
+static pthread_mutex_t module_index_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct module_index *module_indices;
+
+static void
+module_index_free (struct module_index *index)
+{
+  for (size_t i = 0; i < index->nfiles; ++i)
+    {
+      free (index->files[i].name);
+      free (index->files[i].path);
+    }
+  free (index->files);
+  free (index->byname);
+  for (size_t i = 0; i < index->ndirs; ++i)
+    free (index->dirs[i].path);
+  free (index->dirs);
+  free (index->dir);
+  free (index);
+}
+
+/* Drop a reference to INDEX.  Called with module_index_lock held.  */
+static void
+module_index_unref (struct module_index *index)
+{
+  if (--index->refs == 0)
+    module_index_free (index);
+}
+
+static void
+module_index_release (struct module_index *index)
+{
+  pthread_mutex_lock (&module_index_lock);
+  module_index_unref (index);
+  pthread_mutex_unlock (&module_index_lock);
+}
+
+/* Add the file at PATH, which is malloc'd, to INDEX if it is a module.
+   Return false if out of memory.  */
+static bool
+module_index_add (struct module_index *index, size_t *alloc, char *path)
+{
+  if (path == NULL)
+    return false;
+
+  const char *base = strrchr (path, '/');
+  base = base == NULL ? path : base + 1;
+  size_t len = strlen (base);
+  size_t suffix = check_suffix (base, len);
+  if (suffix == 0)
+    {
+      free (path);
+      return true;
+    }
+
+  if (index->nfiles == *alloc)
+    {
+      size_t newalloc = *alloc == 0 ? 64 : *alloc * 2;
+      struct module_file *files = realloc (index->files,
+					   newalloc * sizeof *files);
+      if (unlikely (files == NULL))
+	{
+	  free (path);
+	  return false;
+	}
+      index->files = files;
+      *alloc = newalloc;
+    }
+
+  char *name = strndup (base, len - suffix);
+  if (unlikely (name == NULL))
+    {
+      free (path);
+      return false;
+    }
+  module_name_from_file (name);
+
+  struct module_file *m = &index->files[index->nfiles++];
+  m->name = name;
+  m->path = path;
+  m->base = base;
+  m->baselen = len - suffix;
+  return true;
+}
+
+/* Add the modules listed in modules.dep, the file names before the
+   colons, relative to the directory unless absolute.  */
+static int
+module_index_read_dep (struct module_index *index, FILE *f)
+{
+  int result = 0;
+  size_t alloc = 0;
+  char *line = NULL;
+  size_t linesz = 0;
+  while (result == 0 && getline (&line, &linesz, f) > 0)
+    {
+      char *colon = strchr (line, ':');
+      if (colon == NULL || colon == line)
+	continue;
+      *colon = '\0';
+
+      char *path;
+      if (line[0] == '/')
+	path = strdup (line);
+      else if (asprintf (&path, "%s/%s", index->dir, line) < 0)
+	path = NULL;
+      if (! module_index_add (index, &alloc, path))
+	result = ENOMEM;
+    }
+  free (line);
+
+  if (result == 0 && ferror_unlocked (f))
+    result = errno;
+  return result;
+}
+
+static int
+compare_module_paths (const void *a, const void *b)
+{
+  const struct module_file *m1 = a;
+  const struct module_file *m2 = b;
+  return strcmp (m1->path, m2->path);
+}
+
+/* Note in INDEX if MTIME is too close to when it was read to tell about
+   later changes.  */
+static void
+module_index_check_racy (struct module_index *index,
+			 const struct timespec *mtime)
+{
+  if (mtime->tv_sec + MODULE_INDEX_RACY_SECONDS >= index->checked.tv_sec)
+    index->racy = true;
+}
+
+/* Add the directory at F to INDEX.  Return false if out of memory.  */
+static bool
+module_index_add_dir (struct module_index *index, size_t *alloc,
+		      const FTSENT *f)
+{
+  if (index->ndirs == *alloc)
+    {
+      size_t newalloc = *alloc == 0 ? 16 : *alloc * 2;
+      struct module_dir *dirs = realloc (index->dirs,
+					 newalloc * sizeof *dirs);
+      if (unlikely (dirs == NULL))
+	return false;
+      index->dirs = dirs;
+      *alloc = newalloc;
+    }
+
+  /* With FTS_NOSTAT, FTS_STATP need not be filled in.  */
+  struct stat st;
+  if (stat (f->fts_path, &st) != 0)
+    {
+      /* Check again next time.  */
+      index->racy = true;
+      return true;
+    }
+
+  struct module_dir *d = &index->dirs[index->ndirs];
+  d->path = strdup (f->fts_path);
+  if (unlikely (d->path == NULL))
+    return false;
+  d->dev = st.st_dev;
+  d->ino = st.st_ino;
+  d->mtime = st.st_mtim;
+  module_index_check_racy (index, &d->mtime);
+  ++index->ndirs;
+  return true;
+}
+
+/* Do "find DIR -name *.ko".  The files are sorted by path, so the
+   order does not depend on the order of the directory entries.  The
+   directories are kept to tell when a module is added or removed
+   anywhere in the tree.  */
+static int
+module_index_walk (struct module_index *index)
+{
+  char *modulesdir[] = { index->dir, NULL };
+  FTS *fts = fts_open (modulesdir, FTS_NOSTAT | FTS_LOGICAL, NULL);
+  if (fts == NULL)
+    return errno;
+
+  int result = 0;
+  size_t alloc = 0;
+  size_t dirs_alloc = 0;
+  FTSENT *f;
+  while (result == 0 && (f = fts_read (fts)) != NULL)
+    {
+      /* Skip a "source" subtree, which tends to be large.
+	 This insane hard-coding of names is what depmod does too.  */
+      if (f->fts_namelen == sizeof "source" - 1
+	  && !strcmp (f->fts_name, "source"))
+	{
+	  fts_set (fts, f, FTS_SKIP);
+	  continue;
+	}
+
+      switch (f->fts_info)
+	{
+	case FTS_F:
+	case FTS_SL:
+	case FTS_NSOK:
+	  if (check_suffix (f->fts_name, f->fts_namelen) != 0
+	      && ! module_index_add (index, &alloc, strdup (f->fts_path)))
+	    result = ENOMEM;
+	  break;
+
+	case FTS_D:
+	  if (! module_index_add_dir (index, &dirs_alloc, f))
+	    result = ENOMEM;
+	  break;
+
+	case FTS_ERR:
+	case FTS_DNR:
+	case FTS_NS:
+	  result = f->fts_errno;
+	  break;
+
+	case FTS_SLNONE:
+	default:
+	  break;
+	}
+    }
+  fts_close (fts);
+
+  if (result == 0)
+    qsort (index->files, index->nfiles, sizeof index->files[0],
+	   compare_module_paths);
+  return result;
+}
+
+static int
+compare_module_names (const void *a, const void *b)
+{
+  const struct module_file *m1 = *(const struct module_file **) a;
+  const struct module_file *m2 = *(const struct module_file **) b;
+  int cmp = strcmp (m1->name, m2->name);
+  return cmp != 0 ? cmp : m1 < m2 ? -1 : m1 > m2;
+}
+
+/* Return true if INDEX is still up to date, ST being the state of its
+   modules.dep or, for a walk, of its directory now.  Called with
+   module_index_lock held.  */
+static bool
+module_index_current (const struct module_index *index,
+		      const struct stat *st)
+{
+  if (index->racy
+      || index->dev != st->st_dev || index->ino != st->st_ino
+      || index->size != st->st_size
+      || index->mtime.tv_sec != st->st_mtim.tv_sec
+      || index->mtime.tv_nsec != st->st_mtim.tv_nsec)
+    return false;
+
+  /* Adding or removing a module changes the directory it is in, which
+     need not be the top one.  */
+  for (size_t i = 0; i < index->ndirs; ++i)
+    {
+      const struct module_dir *d = &index->dirs[i];
+      struct stat dst;
+      if (stat (d->path, &dst) != 0
+	  || d->dev != dst.st_dev || d->ino != dst.st_ino
+	  || d->mtime.tv_sec != dst.st_mtim.tv_sec
+	  || d->mtime.tv_nsec != dst.st_mtim.tv_nsec)
+	return false;
+    }
+  return true;
+}
+
+/* Get the index of DIR, with a reference the caller must release with
+   module_index_release.  It is read from modules.dep if there is one,
+   unless WALK is true.  Return zero or an errno code.  */
+static int
+module_index_get (const char *dir, bool walk, struct module_index **indexp)
+{
+  FILE *dep = NULL;
+  if (! walk)
+    {
+      char *depname;
+      if (asprintf (&depname, "%s/" MODULESDEP, dir) < 0)
+	return ENOMEM;
+      dep = fopen (depname, "r");
+      free (depname);
+    }
+
+  struct stat st;
+  bool from_dep = dep != NULL && fstat (fileno (dep), &st) == 0;
+  if (! from_dep && stat (dir, &st) != 0)
+    {
+      int result = errno;
+      if (dep != NULL)
+	fclose (dep);
+      return result;
+    }
+
+  int result = 0;
+  pthread_mutex_lock (&module_index_lock);
+
+  struct module_index **prevp = &module_indices;
+  struct module_index *index;
+  while ((index = *prevp) != NULL
+	 && (index->from_dep != from_dep || strcmp (index->dir, dir) != 0))
+    prevp = &index->next;
+  if (index != NULL)
+    {
+      if (module_index_current (index, &st))
+	++index->refs;
+      else
+	{
+	  /* Out of date.  Sessions still using it keep it until done.  */
+	  *prevp = index->next;
+	  module_index_unref (index);
+	  index = NULL;
+	}
+    }
+
+  if (index == NULL)
+    {
+      index = calloc (1, sizeof *index);
+      if (unlikely (index == NULL) || (index->dir = strdup (dir)) == NULL)
+	result = ENOMEM;
+      else
+	{
+	  index->from_dep = from_dep;
+	  index->dev = st.st_dev;
+	  index->ino = st.st_ino;
+	  index->size = st.st_size;
+	  index->mtime = st.st_mtim;
+	  clock_gettime (CLOCK_REALTIME, &index->checked);
+	  module_index_check_racy (index, &index->mtime);
+	  if (from_dep)
+	    {
+	      (void) __fsetlocking (dep, FSETLOCKING_BYCALLER);
+	      result = module_index_read_dep (index, dep);
+	    }
+	  else
+	    result = module_index_walk (index);
+	}
+
+      if (result == 0 && index->nfiles > 0)
+	{
+	  index->byname = malloc (index->nfiles * sizeof index->byname[0]);
+	  if (unlikely (index->byname == NULL))
+	    result = ENOMEM;
+	  else
+	    {
+	      for (size_t i = 0; i < index->nfiles; ++i)
+		index->byname[i] = &index->files[i];
+	      qsort (index->byname, index->nfiles, sizeof index->byname[0],
+		     compare_module_names);
+	    }
+	}
+
+      if (result == 0)
+	{
+	  /* One reference for the list, one for the caller.  */
+	  index->refs = 2;
+	  index->next = module_indices;
+	  module_indices = index;
+	}
+      else if (index != NULL)
+	{
+	  module_index_free (index);
+	  index = NULL;
+	}
+    }
+
+  pthread_mutex_unlock (&module_index_lock);
+
+  if (dep != NULL)
+    fclose (dep);
+  *indexp = index;
+  return result;
+}
+
+/* Return the first of the files in INDEX for module NAME, or NULL.
+   The others follow it in INDEX->byname.  */
+static struct module_file **
+module_index_find (struct module_index *index, const char *name)
+{
+  size_t lo = 0;
+  size_t hi = index->nfiles;
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+      if (strcmp (index->byname[mid]->name, name) < 0)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return (lo < index->nfiles && !strcmp (index->byname[lo]->name, name)
+	  ? &index->byname[lo] : NULL);
+}
+
 /* Report a kernel and all its modules found on disk, for offline use.
    If RELEASE starts with '/', it names a directory to look in;
    if not, it names a directory to find under /lib/modules/;
@@ -333,109 +790,54 @@ dwfl_linux_kernel_report_offline (Dwfl *dwfl, const char *release,
   result = report_kernel (dwfl, &release, predicate);
   if (result == 0)
     {
-      /* Do "find /lib/modules/RELEASE -name *.ko".  */
+      /* Do "find /lib/modules/RELEASE -name *.ko", or rather look in
+	 the index of that.  */
 
-      char *modulesdir[] = { NULL, NULL };
-      if (release[0] == '/')
-	modulesdir[0] = (char *) release;
-      else
-	{
-	  if (asprintf (&modulesdir[0], MODULEDIRFMT, release) < 0)
-	    return errno;
-	}
+      char *modulesdir = NULL;
+      if (release[0] != '/'
+	  && asprintf (&modulesdir, MODULEDIRFMT, release) < 0)
+	return errno;
 
-      FTS *fts = fts_open (modulesdir, FTS_NOSTAT | FTS_LOGICAL, NULL);
-      if (modulesdir[0] == (char *) release)
-	modulesdir[0] = NULL;
-      if (fts == NULL)
+      struct module_index *index;
+      result = module_index_get (modulesdir ?: release, false, &index);
+      free (modulesdir);
+      if (result != 0)
+	return result;
+
+      /* Collect the modules to report, then open them all in parallel.  */
+      const char **names = malloc (index->nfiles * sizeof names[0]);
+      const char **paths = malloc (index->nfiles * sizeof paths[0]);
+      if (names == NULL || paths == NULL)
+	result = ENOMEM;
+      size_t n = 0;
+      for (size_t i = 0; result == 0 && i < index->nfiles; ++i)
 	{
-	  free (modulesdir[0]);
-	  return errno;
-	}
+	  const struct module_file *m = &index->files[i];
 
-      FTSENT *f;
-      while ((f = fts_read (fts)) != NULL)
-	{
-	  /* Skip a "source" subtree, which tends to be large.
-	     This insane hard-coding of names is what depmod does too.  */
-	  if (f->fts_namelen == sizeof "source" - 1
-	      && !strcmp (f->fts_name, "source"))
+	  if (predicate != NULL)
 	    {
-	      fts_set (fts, f, FTS_SKIP);
-	      continue;
+	      /* Let the predicate decide whether to use this one.  */
+	      int want = (*predicate) (m->name, m->path);
+	      if (want < 0)
+		result = -1;
+	      if (want <= 0)
+		continue;
 	    }
 
-	  switch (f->fts_info)
-	    {
-	    case FTS_F:
-	    case FTS_SL:
-	    case FTS_NSOK:;
-	      /* See if this file name matches "*.ko".  */
-	      const size_t suffix = check_suffix (f, 0);
-	      if (suffix)
-		{
-		  /* We have a .ko file to report.  Following the algorithm
-		     by which the kernel makefiles set KBUILD_MODNAME, we
-		     replace all ',' or '-' with '_' in the file name and
-		     call that the module name.  Modules could well be
-		     built using different embedded names than their file
-		     names.  To handle that, we would have to look at the
-		     __this_module.name contents in the module's text.  */
-
-		  char *name = strndup (f->fts_name, f->fts_namelen - suffix);
-		  if (unlikely (name == NULL))
-		    {
-		      __libdwfl_seterrno (DWFL_E_NOMEM);
-		      result = -1;
-		      break;
-		    }
-		  for (size_t i = 0; i < f->fts_namelen - suffix; ++i)
-		    if (name[i] == '-' || name[i] == ',')
-		      name[i] = '_';
-
-		  if (predicate != NULL)
-		    {
-		      /* Let the predicate decide whether to use this one.  */
-		      int want = (*predicate) (name, f->fts_path);
-		      if (want < 0)
-			{
-			  result = -1;
-			  free (name);
-			  break;
-			}
-		      if (!want)
-			{
-			  free (name);
-			  continue;
-			}
-		    }
-
-		  if (dwfl_report_offline (dwfl, name, f->fts_path, -1) == NULL)
-		    {
-		      free (name);
-		      result = -1;
-		      break;
-		    }
-		  free (name);
-		}
-	      continue;
-
-	    case FTS_ERR:
-	    case FTS_DNR:
-	    case FTS_NS:
-	      result = f->fts_errno;
-	      break;
+	  names[n] = m->name;
+	  paths[n] = m->path;
+	  ++n;
+	}
 
-	    case FTS_SLNONE:
-	    default:
-	      continue;
-	    }
+      if (result != ENOMEM
+	  && ((size_t) __libdwfl_report_offline_files (dwfl, n, names, paths,
+						       0, true, NULL)
+	      != n))
+	result = -1;
 
-	  /* We only get here in error cases.  */
-	  break;
-	}
-      fts_close (fts);
-      free (modulesdir[0]);
+      free (names);
+      free (paths);
+      module_index_release (index);
     }
 
   return result;
@@ -715,16 +1117,19 @@ dwfl_linux_kernel_find_elf (Dwfl_Module *mod,
   if (!strcmp (module_name, KERNEL_MODNAME))
     return find_kernel_elf (mod->dwfl, release, file_name);
 
-  /* Do "find /lib/modules/`uname -r` -name MODULE_NAME.ko".  */
+  /* Do "find /lib/modules/`uname -r` -name MODULE_NAME.ko", or rather
+     look in the index of that.  */
 
-  char *modulesdir[] = { NULL, NULL };
-  if (asprintf (&modulesdir[0], MODULEDIRFMT, release) < 0)
+  char *modulesdir;
+  if (asprintf (&modulesdir, MODULEDIRFMT, release) < 0)
     return -1;
 
-  FTS *fts = fts_open (modulesdir, FTS_NOSTAT | FTS_LOGICAL, NULL);
-  if (fts == NULL)
+  struct module_index *index;
+  int error = module_index_get (modulesdir, false, &index);
+  if (error != 0)
     {
-      free (modulesdir[0]);
+      free (modulesdir);
+      errno = error;
       return -1;
     }
 
@@ -739,75 +1144,69 @@ dwfl_linux_kernel_find_elf (Dwfl_Module *mod,
      In practice, these module names match the .ko file names except for
      some using '_' and some using '-'.  So our cheap kludge is to look for
      two files when either a '_' or '-' appears in a module name, one using
-     only '_' and one only using '-'.  */
+     only '_' and one only using '-'.  Both have the same name in the
+     index.  */
 
   char *alternate_name = malloc (namelen + 1);
-  if (unlikely (alternate_name == NULL))
+  char *index_name = strdup (module_name);
+  if (unlikely (alternate_name == NULL) || unlikely (index_name == NULL))
     {
-      free (modulesdir[0]);
-      return ENOMEM;
+      free (alternate_name);
+      free (index_name);
+      module_index_release (index);
+      free (modulesdir);
+      errno = ENOMEM;
+      return -1;
     }
   if (!subst_name ('-', '_', module_name, alternate_name, namelen) &&
       !subst_name ('_', '-', module_name, alternate_name, namelen))
     alternate_name[0] = '\0';
+  module_name_from_file (index_name);
 
-  FTSENT *f;
-  int error = ENOENT;
-  while ((f = fts_read (fts)) != NULL)
+  int fd = -1;
+  error = ENOENT;
+  bool found = false;
+  while (! found)
     {
-      /* Skip a "source" subtree, which tends to be large.
-	 This insane hard-coding of names is what depmod does too.  */
-      if (f->fts_namelen == sizeof "source" - 1
-	  && !strcmp (f->fts_name, "source"))
-	{
-	  fts_set (fts, f, FTS_SKIP);
-	  continue;
-	}
+      struct module_file **m = module_index_find (index, index_name);
+      for (; m != NULL && m < &index->byname[index->nfiles]
+	     && !strcmp ((*m)->name, index_name); ++m)
+	if ((*m)->baselen == namelen
+	    && (!memcmp ((*m)->base, module_name, namelen)
+		|| !memcmp ((*m)->base, alternate_name, namelen)))
+	  {
+	    found = true;
+	    fd = open ((*m)->path, O_RDONLY);
+	    error = errno;
+	    if (fd >= 0 && (*file_name = strdup ((*m)->path)) == NULL)
+	      {
+		close (fd);
+		fd = -1;
+		error = ENOMEM;
+	      }
+	    break;
+	  }
 
-      error = ENOENT;
-      switch (f->fts_info)
+      /* A module installed without running depmod again is not in
+	 modules.dep, look for it in the tree too.  */
+      if (found || ! index->from_dep)
+	break;
+      module_index_release (index);
+      if (module_index_get (modulesdir, true, &index) != 0)
 	{
-	case FTS_F:
-	case FTS_SL:
-	case FTS_NSOK:
-	  /* See if this file name is "MODULE_NAME.ko".  */
-	  if (check_suffix (f, namelen)
-	      && (!memcmp (f->fts_name, module_name, namelen)
-		  || !memcmp (f->fts_name, alternate_name, namelen)))
-	    {
-	      int fd = open (f->fts_accpath, O_RDONLY);
-	      *file_name = strdup (f->fts_path);
-	      fts_close (fts);
-	      free (modulesdir[0]);
-	      free (alternate_name);
-	      if (fd < 0)
-		free (*file_name);
-	      else if (*file_name == NULL)
-		{
-		  close (fd);
-		  fd = -1;
-		}
-	      return fd;
-	    }
-	  break;
-
-	case FTS_ERR:
-	case FTS_DNR:
-	case FTS_NS:
-	  error = f->fts_errno;
-	  break;
-
-	case FTS_SLNONE:
-	default:
+	  index = NULL;
 	  break;
 	}
     }
 
-  fts_close (fts);
-  free (modulesdir[0]);
+  if (index != NULL)
+    module_index_release (index);
+  free (modulesdir);
   free (alternate_name);
-  errno = error;
-  return -1;
+  free (index_name);
+  if (fd < 0)
+    errno = error;
+  return fd;
 }
 INTDEF (dwfl_linux_kernel_find_elf)
 
@@ -28,6 +28,7 @@
 
 #include "libdwflP.h"
 #include <inttypes.h>
+#include <limits.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <errno.h>
@@ -175,6 +176,63 @@ grovel_auxv (pid_t pid, Dwfl *dwfl, GElf_Addr *sysinfo_ehdr)
   return ENOEXEC;
 }
 
+/* Parse a line of a /proc/PID/maps file, "START-END PERMS OFFSET
+   MAJOR:MINOR INODE FILE", without the newline.  Returns a pointer to
+   FILE, which may be empty, or null if the line is not well-formed.  */
+static char *
+parse_maps_line (char *line, Dwarf_Addr *start, Dwarf_Addr *end,
+		 unsigned int *dmajor, unsigned int *dminor, uint64_t *ino)
+{
+  /* Fields are separated by SEP, or by any blanks for ' ', as
+     sscanf would have it.  */
+  inline bool field (char **p, int base, char sep, uint64_t *value)
+  {
+    char *endp;
+    errno = 0;
+    *value = strtoull (*p, &endp, base);
+    if (endp == *p || errno != 0)
+      return false;
+    if (sep == ' ')
+      {
+	size_t n = strspn (endp, " \t");
+	if (n == 0 && *endp != '\0')
+	  return false;
+	*p = endp + n;
+      }
+    else if (*endp != sep)
+      return false;
+    else
+      *p = endp + 1;
+    return true;
+  }
+
+  char *p = line;
+  uint64_t major, minor;
+  if (! field (&p, 16, '-', start) || ! field (&p, 16, ' ', end))
+    return NULL;
+
+  /* Skip the permissions and the offset.  */
+  for (int i = 0; i < 2; ++i)
+    {
+      p += strcspn (p, " \t");
+      if (*p == '\0')
+	return NULL;
+      p += strspn (p, " \t");
+    }
+
+  if (! field (&p, 16, ':', &major) || ! field (&p, 16, ' ', &minor)
+      || major > UINT_MAX || minor > UINT_MAX)
+    return NULL;
+  *dmajor = major;
+  *dminor = minor;
+
+  /* The inode is the last field, but for the file name.  */
+  if (! field (&p, 10, ' ', ino))
+    return NULL;
+
+  return p;
+}
+
 static inline bool
 do_report (Dwfl *dwfl, char **plast_file, Dwarf_Addr low, Dwarf_Addr high)
 {
@@ -208,14 +266,12 @@ proc_maps_report (Dwfl *dwfl, FILE *f, GElf_Addr sysinfo_ehdr, pid_t pid)
       if (line[len - 1] == '\n')
 	line[len - 1] = '\0';
 
-      Dwarf_Addr start, end, offset;
+      Dwarf_Addr start, end;
       unsigned int dmajor, dminor;
       uint64_t ino;
-      int nread = -1;
-      if (sscanf (line, "%" PRIx64 "-%" PRIx64 " %*s %" PRIx64
-		  " %x:%x %" PRIi64 " %n",
-		  &start, &end, &offset, &dmajor, &dminor, &ino, &nread) < 6
-	  || nread <= 0)
+      char *file = parse_maps_line (line, &start, &end, &dmajor, &dminor,
+				    &ino);
+      if (file == NULL)
 	{
 	  free (line);
 	  free (last_file);
@@ -240,7 +296,6 @@ proc_maps_report (Dwfl *dwfl, FILE *f, GElf_Addr sysinfo_ehdr, pid_t pid)
 	    goto bad_report;
 	}
 
-      char *file = line + nread + strspn (line + nread, " \t");
       if (file[0] != '/' || (ino == 0 && dmajor == 0 && dminor == 0))
 	/* This line doesn't indicate a file mapping.  */
 	continue;
@@ -317,6 +372,181 @@ dwfl_linux_proc_report (Dwfl *dwfl, pid_t pid)
 }
 INTDEF (dwfl_linux_proc_report)
 
+/* Read all of the /proc/PID/maps file into a malloc'd buffer, followed
+   by a NUL.  Returns zero or an errno code.  */
+static int
+read_proc_maps (pid_t pid, char **bufp, size_t *sizep)
+{
+  char *fname;
+  if (asprintf (&fname, PROCMAPSFMT, pid) < 0)
+    return ENOMEM;
+
+  int fd = open (fname, O_RDONLY);
+  free (fname);
+  if (fd < 0)
+    return errno;
+
+  char *buf = NULL;
+  size_t size = 0;
+  size_t alloc = 0;
+  ssize_t nread;
+  do
+    {
+      if (alloc - size < 4096)
+	{
+	  alloc = alloc * 2 ?: 16384;
+	  char *bigger = realloc (buf, alloc);
+	  if (unlikely (bigger == NULL))
+	    {
+	      free (buf);
+	      close (fd);
+	      return ENOMEM;
+	    }
+	  buf = bigger;
+	}
+      nread = TEMP_FAILURE_RETRY (read (fd, buf + size, alloc - size));
+      if (nread > 0)
+	size += nread;
+    }
+  while (nread > 0);
+
+  int result = nread < 0 ? errno : 0;
+  close (fd);
+  if (result != 0)
+    {
+      free (buf);
+      return result;
+    }
+
+  /* The last read left at least 4096 bytes spare.  */
+  buf[size] = '\0';
+  *bufp = buf;
+  *sizep = size;
+  return 0;
+}
+
+/* Copy the lines for file mappings, and for the AT_SYSINFO_EHDR one,
+   from the SIZE bytes of /proc/PID/maps at MAPS to a malloc'd buffer.
+   Only their addresses, device, inode and file name are kept, which is
+   all proc_maps_report goes by.  The heap, the stack and anonymous
+   mappings come and go without changing the modules.  Returns zero or
+   an errno code.  */
+static int
+proc_maps_files (char *maps, size_t size, GElf_Addr sysinfo_ehdr,
+		 char **filesp, size_t *files_sizep)
+{
+  /* No line gets longer, it loses at least its permissions and
+     offset.  */
+  char *files = malloc (size + 1);
+  if (unlikely (files == NULL))
+    return ENOMEM;
+  size_t files_size = 0;
+
+  char *line = maps;
+  while (line < maps + size)
+    {
+      char *eol = memchr (line, '\n', maps + size - line);
+      if (eol != NULL)
+	*eol = '\0';
+
+      Dwarf_Addr start, end;
+      unsigned int dmajor, dminor;
+      uint64_t ino;
+      char *file = parse_maps_line (line, &start, &end, &dmajor, &dminor,
+				    &ino);
+      if (file == NULL)
+	{
+	  if (eol != NULL)
+	    *eol = '\n';
+	  free (files);
+	  return ENOEXEC;
+	}
+
+      if ((start == sysinfo_ehdr && start != 0)
+	  || (file[0] == '/' && (ino != 0 || dmajor != 0 || dminor != 0)))
+	files_size += sprintf (&files[files_size],
+			       "%" PRIx64 "-%" PRIx64 " %x:%x %" PRIu64 " %s\n",
+			       start, end, dmajor, dminor, ino, file);
+
+      if (eol == NULL)
+	break;
+      *eol = '\n';
+      line = eol + 1;
+    }
+
+  *filesp = files;
+  *files_sizep = files_size;
+  return 0;
+}
+
+int
+dwfl_linux_proc_refresh (Dwfl *dwfl, pid_t pid)
+{
+  if (dwfl == NULL)
+    return -1;
+
+  GElf_Addr sysinfo_ehdr = 0;
+  int result = grovel_auxv (pid, dwfl, &sysinfo_ehdr);
+  if (result != 0)
+    return result;
+
+  char *maps = NULL;
+  size_t size = 0;
+  result = read_proc_maps (pid, &maps, &size);
+  if (result != 0)
+    return result;
+
+  char *files;
+  size_t files_size;
+  result = proc_maps_files (maps, size, sysinfo_ehdr, &files, &files_size);
+  if (result != 0)
+    {
+      free (maps);
+      return result;
+    }
+
+  /* If no file was mapped or unmapped since the last time, the modules
+     are all still right.  */
+  if (dwfl->proc_maps != NULL && dwfl->proc_maps_pid == pid
+      && dwfl->proc_maps_size == files_size
+      && memcmp (dwfl->proc_maps, files, files_size) == 0)
+    {
+      free (maps);
+      free (files);
+      return 0;
+    }
+
+  /* Report them all again.  Modules of unchanged mappings are found in
+     the list and kept, with all that was read from their files.  */
+  INTUSE(dwfl_report_begin) (dwfl);
+  if (size > 0)
+    {
+      FILE *f = fmemopen (maps, size, "r");
+      if (f == NULL)
+	result = errno;
+      else
+	{
+	  (void) __fsetlocking (f, FSETLOCKING_BYCALLER);
+	  result = proc_maps_report (dwfl, f, sysinfo_ehdr, pid);
+	  fclose (f);
+	}
+    }
+  if (INTUSE(dwfl_report_end) (dwfl, NULL, NULL) != 0 && result == 0)
+    result = -1;
+  free (maps);
+
+  if (result != 0)
+    {
+      free (files);
+      return result;
+    }
+
+  dwfl->proc_maps = files;
+  dwfl->proc_maps_size = files_size;
+  dwfl->proc_maps_pid = pid;
+  return 0;
+}
+
 static ssize_t
 read_proc_memory (void *arg, void *data, GElf_Addr address,
 		  size_t minread, size_t maxread)
@@ -28,6 +28,7 @@
 
 #include "libdwflP.h"
 #include <fcntl.h>
+#include <pthread.h>
 #include <unistd.h>
 
 /* Since dwfl_report_elf lays out the sections already, this will only be
@@ -309,3 +310,182 @@ dwfl_report_offline (Dwfl *dwfl, const char *name,
   return __libdwfl_report_offline (dwfl, name, file_name, fd, closefd, NULL);
 }
 INTDEF (dwfl_report_offline)
+
+
+/* A file for __libdwfl_report_offline_files, opened ahead of reporting
+   it.  */
+struct offline_file
+{
+  int fd;
+  Elf *elf;
+  Dwfl_Error error;
+  int errnum;			/* errno for DWFL_E_ERRNO.  */
+};
+
+struct offline_files
+{
+  const char *const *file_names;
+  struct offline_file *files;
+  size_t count;
+  size_t next;			/* Next file to open, updated atomically.  */
+};
+
+/* Open FILE_NAME and read what reporting it looks at, the ELF header,
+   the section and program headers and the build ID note.  */
+static void
+open_offline_file (struct offline_file *f, const char *file_name)
+{
+  f->elf = NULL;
+  f->errnum = 0;
+  f->fd = open (file_name, O_RDONLY);
+  if (f->fd < 0)
+    {
+      f->error = DWFL_E_ERRNO;
+      f->errnum = errno;
+      return;
+    }
+
+  f->error = __libdw_open_file (&f->fd, &f->elf, true, true);
+  if (f->error != DWFL_E_NOERROR || elf_kind (f->elf) != ELF_K_ELF)
+    return;
+
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (f->elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      if (gelf_getshdr (scn, &shdr_mem) == NULL)
+	break;
+    }
+  size_t phnum;
+  if (elf_getphdrnum (f->elf, &phnum) == 0)
+    for (size_t i = 0; i < phnum; ++i)
+      {
+	GElf_Phdr phdr_mem;
+	if (gelf_getphdr (f->elf, i, &phdr_mem) == NULL)
+	  break;
+      }
+  const void *build_id;
+  (void) INTUSE(dwelf_elf_gnu_build_id) (f->elf, &build_id);
+
+  /* Don't keep the file descriptor around, there may be many files
+     waiting to be reported.  Archive members are read from it later.  */
+  if (f->fd != -1 && elf_cntl (f->elf, ELF_C_FDREAD) == 0)
+    {
+      close (f->fd);
+      f->fd = -1;
+    }
+}
+
+static void *
+open_offline_files (void *arg)
+{
+  struct offline_files *batch = arg;
+  size_t i;
+  while ((i = __atomic_fetch_add (&batch->next, 1, __ATOMIC_RELAXED))
+	 < batch->count)
+    open_offline_file (&batch->files[i], batch->file_names[i]);
+  return NULL;
+}
+
+int
+internal_function
+__libdwfl_report_offline_files (Dwfl *dwfl, size_t count,
+				const char *const *names,
+				const char *const *file_names,
+				unsigned int nthreads, bool stop,
+				Dwfl_Module **modules)
+{
+  struct offline_files batch =
+    {
+      .file_names = file_names,
+      .files = malloc (count * sizeof batch.files[0]),
+      .count = count,
+      .next = 0
+    };
+  if (unlikely (batch.files == NULL) && count != 0)
+    {
+      __libdwfl_seterrno (DWFL_E_NOMEM);
+      return -1;
+    }
+
+  if (nthreads == 0)
+    {
+      long int ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+      nthreads = ncpus > 0 ? ncpus : 1;
+    }
+  if (nthreads > count)
+    nthreads = count;
+
+  /* This thread opens files too, next to NTHREADS - 1 others.  If
+     threads cannot be started, fewer do all the work.  */
+  pthread_t *threads = NULL;
+  unsigned int started = 0;
+  if (nthreads > 1)
+    threads = malloc ((nthreads - 1) * sizeof threads[0]);
+  if (threads != NULL)
+    while (started + 1 < nthreads
+	   && pthread_create (&threads[started], NULL,
+			      open_offline_files, &batch) == 0)
+      ++started;
+  open_offline_files (&batch);
+  for (unsigned int i = 0; i < started; ++i)
+    pthread_join (threads[i], NULL);
+  free (threads);
+
+  /* Now report the modules in order.  */
+  int reported = 0;
+  size_t i;
+  for (i = 0; i < count; ++i)
+    {
+      struct offline_file *f = &batch.files[i];
+      Dwfl_Module *mod = NULL;
+      if (f->error != DWFL_E_NOERROR)
+	{
+	  errno = f->errnum;
+	  __libdwfl_seterrno (f->error);
+	}
+      else
+	{
+	  mod = process_file (dwfl, names[i], file_names[i], f->fd, f->elf,
+			      NULL);
+	  if (mod == NULL)
+	    {
+	      elf_end (f->elf);
+	      if (f->fd != -1)
+		close (f->fd);
+	    }
+	  else
+	    ++reported;
+	}
+
+      if (modules != NULL)
+	modules[i] = mod;
+      if (mod == NULL && stop)
+	break;
+    }
+
+  /* Drop the files not reported after a failure.  */
+  for (++i; i < count; ++i)
+    if (batch.files[i].error == DWFL_E_NOERROR)
+      {
+	elf_end (batch.files[i].elf);
+	if (batch.files[i].fd != -1)
+	  close (batch.files[i].fd);
+      }
+
+  free (batch.files);
+  return reported;
+}
+
+int
+dwfl_report_offline_files (Dwfl *dwfl, size_t count,
+			   const char *const *names,
+			   const char *const *file_names,
+			   unsigned int nthreads, Dwfl_Module **modules)
+{
+  if (dwfl == NULL)
+    return -1;
+
+  return __libdwfl_report_offline_files (dwfl, count, names, file_names,
+					 nthreads, false, modules);
+}
@@ -30,7 +30,13 @@
 #undef	_
 #include "libdwflP.h"
 
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/stat.h>
 #include <unistd.h>
+#include "system.h"
 
 #if !USE_BZLIB
 # define __libdw_bunzip2(...)	DWFL_E_BADELF
@@ -40,9 +46,108 @@
 # define __libdw_unlzma(...)	DWFL_E_BADELF
 #endif
 
+/* Where to keep decompressed files, shared by all Dwfl sessions in the
+   process.  Null when they are not kept.  */
+static pthread_mutex_t decompress_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static char *decompress_cache;
+
+int
+dwfl_decompress_cache_dir (const char *dir)
+{
+  char *copy = NULL;
+  if (dir != NULL)
+    {
+      struct stat st;
+      if (stat (dir, &st) != 0)
+	{
+	  __libdwfl_seterrno (DWFL_E_ERRNO);
+	  return -1;
+	}
+      if (! S_ISDIR (st.st_mode))
+	{
+	  errno = ENOTDIR;
+	  __libdwfl_seterrno (DWFL_E_ERRNO);
+	  return -1;
+	}
+      copy = strdup (dir);
+      if (unlikely (copy == NULL))
+	{
+	  __libdwfl_seterrno (DWFL_E_NOMEM);
+	  return -1;
+	}
+    }
+
+  pthread_mutex_lock (&decompress_cache_lock);
+  free (decompress_cache);
+  decompress_cache = copy;
+  pthread_mutex_unlock (&decompress_cache_lock);
+  return 0;
+}
+
+/* Return the malloc'd name in the cache of the decompressed contents of
+   the file FD from OFFSET on, or null when they are not kept.  */
+static char *
+decompress_cache_name (int fd, off_t offset)
+{
+  struct stat st;
+  if (fd < 0 || fstat (fd, &st) != 0 || ! S_ISREG (st.st_mode))
+    return NULL;
+
+  char *name = NULL;
+  pthread_mutex_lock (&decompress_cache_lock);
+  if (decompress_cache != NULL
+      && asprintf (&name, "%s/%" PRIx64 "-%" PRIx64 "-%" PRId64 ".%09ld"
+		   "-%" PRId64 "-%" PRId64, decompress_cache,
+		   (uint64_t) st.st_dev, (uint64_t) st.st_ino,
+		   (int64_t) st.st_mtim.tv_sec, (long) st.st_mtim.tv_nsec,
+		   (int64_t) st.st_size, (int64_t) offset) < 0)
+    name = NULL;
+  pthread_mutex_unlock (&decompress_cache_lock);
+  return name;
+}
+
+/* Open the decompressed file NAME from the cache, or return null.  */
+static Elf *
+decompress_cache_open (const char *name)
+{
+  int fd = open (name, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  Elf *elf = elf_begin (fd, ELF_C_READ_MMAP_PRIVATE, NULL);
+  if (elf != NULL
+      && (elf_kind (elf) == ELF_K_NONE || elf_cntl (elf, ELF_C_FDREAD) != 0))
+    {
+      elf_end (elf);
+      elf = NULL;
+    }
+  close (fd);
+  return elf;
+}
+
+/* Put the SIZE bytes decompressed at BUFFER in the cache as NAME.  A
+   file is written under a temporary name and then renamed, so no one
+   ever opens half of it.  Failing to do so is not an error.  */
+static void
+decompress_cache_add (const char *name, const void *buffer, size_t size)
+{
+  char *tmp;
+  if (asprintf (&tmp, "%s.XXXXXX", name) < 0)
+    return;
+
+  int fd = mkstemp (tmp);
+  if (fd >= 0)
+    {
+      bool ok = write_retry (fd, buffer, size) == (ssize_t) size;
+      if (close (fd) != 0 || ! ok || rename (tmp, name) != 0)
+	unlink (tmp);
+    }
+  free (tmp);
+}
+
 /* Consumes and replaces *ELF only on success.  */
 static Dwfl_Error
-decompress (int fd __attribute__ ((unused)), Elf **elf)
+decompress (int fd, Elf **elf)
 {
   Dwfl_Error error = DWFL_E_BADELF;
   void *buffer = NULL;
@@ -55,6 +160,20 @@ decompress (int fd __attribute__ ((unused)), Elf **elf)
   if (mapped_size == 0)
     return error;
 
+  /* Use the contents decompressed once before when they are kept.  */
+  char *cache_name = decompress_cache_name (fd, offset);
+  if (cache_name != NULL)
+    {
+      Elf *cached = decompress_cache_open (cache_name);
+      if (cached != NULL)
+	{
+	  free (cache_name);
+	  elf_end (*elf);
+	  *elf = cached;
+	  return DWFL_E_NOERROR;
+	}
+    }
+
   error = __libdw_gunzip (fd, offset, mapped, mapped_size, &buffer, &size);
   if (error == DWFL_E_BADELF)
     error = __libdw_bunzip2 (fd, offset, mapped, mapped_size, &buffer, &size);
@@ -78,6 +197,8 @@ decompress (int fd __attribute__ ((unused)), Elf **elf)
 	    }
 	  else
 	    {
+	      if (cache_name != NULL && elf_kind (memelf) != ELF_K_NONE)
+		decompress_cache_add (cache_name, buffer, size);
 	      memelf->flags |= ELF_F_MALLOCED;
 	      elf_end (*elf);
 	      *elf = memelf;
@@ -87,6 +208,7 @@ decompress (int fd __attribute__ ((unused)), Elf **elf)
   else
     free (buffer);
 
+  free (cache_name);
   return error;
 }
 
@@ -27,6 +27,7 @@
    not, see <http://www.gnu.org/licenses/>.  */
 
 #include "libdwflP.h"
+#include "../libelf/libelfP.h"
 
 typedef uint8_t GElf_Byte;
 
@@ -783,3 +784,144 @@ __libdwfl_relocate_section (Dwfl_Module *mod, Elf *relocated,
   return relocate_section (mod, relocated, ehdr, shstrndx, &reloc_symtab,
 			   relocscn, shdr, tscn, false, partial);
 }
+
+/* The relocations for the debugging sections of an ET_REL file that are
+   only applied when libdw first reads the section.  */
+struct dwfl_lazy_reloc
+{
+  Dwfl_Module *mod;
+  Elf *debugfile;
+  GElf_Ehdr ehdr;
+  size_t shstrndx;
+
+  /* The symbols are looked up the same way for all the sections.  */
+  struct reloc_symtab_cache reloc_symtab;
+
+  /* The relocation section for each IDX_* section, or NULL.  */
+  Elf_Scn *relocscn[IDX_last];
+};
+
+/* Called by libdw before it reads section SEC_INDEX.  */
+static bool
+relocate_pending (Dwarf *dbg, int sec_index, void *arg)
+{
+  struct dwfl_lazy_reloc *lazy = arg;
+  Elf_Scn *scn = lazy->relocscn[sec_index];
+
+  Dwfl_Error result = DWFL_E_LIBELF;
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+  if (likely (shdr != NULL))
+    {
+      Elf_Scn *tscn = elf_getscn (lazy->debugfile, shdr->sh_info);
+      if (likely (tscn != NULL))
+	result = relocate_section (lazy->mod, lazy->debugfile, &lazy->ehdr,
+				   lazy->shstrndx, &lazy->reloc_symtab,
+				   scn, shdr, tscn, true, false);
+
+      /* The raw data was relocated.  For a file of the other byte order
+	 libelf gave libdw a copy of it.  */
+      Elf_Data *data = dbg->sectiondata[sec_index];
+      Elf_Data *rawdata;
+      if (result == DWFL_E_NOERROR
+	  && (rawdata = elf_rawdata (tscn, NULL)) != NULL
+	  && rawdata->d_buf != data->d_buf)
+	memcpy (data->d_buf, rawdata->d_buf, data->d_size);
+    }
+
+  if (result != DWFL_E_NOERROR)
+    {
+      __libdwfl_seterrno (result);
+      return false;
+    }
+  return true;
+}
+
+Dwfl_Error
+internal_function
+__libdwfl_relocate_lazy (Dwfl_Module *mod, Elf *debugfile)
+{
+  assert (mod->e_type == ET_REL);
+  assert (mod->lazy_reloc == NULL);
+
+  Dwarf *dbg = mod->dw;
+  struct dwfl_lazy_reloc *lazy = calloc (1, sizeof *lazy);
+  if (unlikely (lazy == NULL))
+    return DWFL_E_NOMEM;
+  lazy->mod = mod;
+  lazy->debugfile = debugfile;
+  lazy->reloc_symtab.symshstrndx = SHN_UNDEF;
+  lazy->reloc_symtab.strtabndx = SHN_UNDEF;
+
+  Dwfl_Error result = DWFL_E_NOERROR;
+  if (gelf_getehdr (debugfile, &lazy->ehdr) == NULL
+      || elf_getshdrstrndx (debugfile, &lazy->shstrndx) < 0)
+    result = DWFL_E_LIBELF;
+
+  unsigned int pending = 0;
+  Elf_Scn *scn = NULL;
+  while (result == DWFL_E_NOERROR
+	 && (scn = elf_nextscn (debugfile, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (unlikely (shdr == NULL))
+	{
+	  result = DWFL_E_LIBELF;
+	  break;
+	}
+
+      if ((shdr->sh_type != SHT_REL && shdr->sh_type != SHT_RELA)
+	  || shdr->sh_size == 0)
+	continue;
+
+      Elf_Scn *tscn = elf_getscn (debugfile, shdr->sh_info);
+      if (unlikely (tscn == NULL))
+	{
+	  result = DWFL_E_LIBELF;
+	  break;
+	}
+
+      /* Find the libdw section the relocations apply to.  libdw reads
+	 .debug_abbrev and .debug_str directly, those and the debugging
+	 sections libdw does not know are relocated right away.  */
+      int idx;
+      for (idx = 0; idx < IDX_last; ++idx)
+	if (dbg->sectiondata[idx] != NULL
+	    && ((Elf_Data_Scn *) dbg->sectiondata[idx])->s == tscn)
+	  break;
+
+      if (idx < IDX_last && idx != IDX_debug_abbrev && idx != IDX_debug_str
+	  && lazy->relocscn[idx] == NULL)
+	{
+	  lazy->relocscn[idx] = scn;
+	  pending |= 1u << idx;
+	}
+      else
+	result = relocate_section (mod, debugfile, &lazy->ehdr,
+				   lazy->shstrndx, &lazy->reloc_symtab,
+				   scn, shdr, tscn, true, false);
+    }
+
+  if (result != DWFL_E_NOERROR || pending == 0)
+    {
+      free (lazy);
+      return result;
+    }
+
+  dbg->pending_sections = pending;
+  dbg->prepare_section = relocate_pending;
+  dbg->prepare_arg = lazy;
+  mod->lazy_reloc = lazy;
+  return DWFL_E_NOERROR;
+}
+
+void
+internal_function
+__libdwfl_relocate_pending (Dwfl_Module *mod)
+{
+  if (mod->lazy_reloc == NULL)
+    return;
+
+  __libdw_prepare_sections (mod->dw);
+}
@@ -65,13 +65,24 @@ determine_kind (void *buf, size_t len)
 }
 
 
-/* Allocate an Elf descriptor and fill in the generic information.  */
+/* Allocate an Elf descriptor and fill in the generic information.
+   The EXTRA bytes following the descriptor are cleared unless
+   NOCLEAR.  */
 static inline Elf *
 __attribute__ ((unused))
-allocate_elf (int fildes, void *map_address, off_t offset, size_t maxsize,
-              Elf_Cmd cmd, Elf *parent, Elf_Kind kind, size_t extra)
+allocate_elf_noclear (int fildes, void *map_address, off_t offset,
+		      size_t maxsize, Elf_Cmd cmd, Elf *parent, Elf_Kind kind,
+		      size_t extra, bool noclear)
 {
-  Elf *result = (Elf *) calloc (1, sizeof (Elf) + extra);
+  Elf *result;
+  if (noclear)
+    {
+      result = (Elf *) malloc (sizeof (Elf) + extra);
+      if (result != NULL)
+	memset (result, '\0', sizeof (Elf));
+    }
+  else
+    result = (Elf *) calloc (1, sizeof (Elf) + extra);
   if (result == NULL)
     __libelf_seterrno (ELF_E_NOMEM);
   else
@@ -92,6 +103,17 @@ allocate_elf (int fildes, void *map_address, off_t offset, size_t maxsize,
 }
 
 
+/* Allocate an Elf descriptor and fill in the generic information.  */
+static inline Elf *
+__attribute__ ((unused))
+allocate_elf (int fildes, void *map_address, off_t offset, size_t maxsize,
+              Elf_Cmd cmd, Elf *parent, Elf_Kind kind, size_t extra)
+{
+  return allocate_elf_noclear (fildes, map_address, offset, maxsize, cmd,
+			       parent, kind, extra, false);
+}
+
+
 /* Acquire lock for the descriptor and all children.  */
 static void
 __attribute__ ((unused))
@@ -81,10 +81,19 @@ elfw2(LIBELFBITS,checksum) (Elf *elf)
   /* If we don't have native byte order, we will likely need to
      convert the data with xlate functions.  We do it upfront instead
      of relocking mid-iteration. */
-  if (!likely (same_byte_order))
-    rwlock_wrlock (elf->lock);
-  else
-    rwlock_rdlock (elf->lock);
+  rwlock_wrlock (elf->lock);
+
+  /* All sections are looked at below.  Set them up now, elf_nextscn
+     cannot take the write lock to do so while we hold the lock.  */
+  Elf_ScnList *scns = &elf->state.ELFW(elf,LIBELFBITS).scns;
+  for (size_t cnt = 0; cnt < scns->cnt; ++cnt)
+    (void) __libelf_scn_setup (elf, scns, cnt);
+
+  if (likely (same_byte_order))
+    {
+      rwlock_unlock (elf->lock);
+      rwlock_rdlock (elf->lock);
+    }
 
   /* Iterate over all sections to find those which are not strippable.  */
   scn = NULL;
@@ -76,6 +76,11 @@ load_shdr_wrlock (Elf_Scn *scn)
     }
   elf->state.ELFW(elf,LIBELFBITS).shdr_malloced = 1;
 
+  /* All sections are touched below, set them up if not done yet.  */
+  Elf_ScnList *scns = &elf->state.ELFW(elf,LIBELFBITS).scns;
+  for (size_t cnt = 0; cnt < scns->cnt; ++cnt)
+    (void) __libelf_scn_setup (elf, scns, cnt);
+
   if (elf->map_address != NULL)
     {
       /* First see whether the information in the ELF header is
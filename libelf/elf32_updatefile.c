@@ -356,7 +356,24 @@ __elfw2(LIBELFBITS,updatemmap) (Elf *elf, int change_bo, size_t shnum)
 
 		    last_position = scn_start + dl->data.d.d_off;
 
-		    if (unlikely (change_bo))
+		    if (dl->flags & ELF_F_FILECOPY)
+		      {
+			/* Read the data straight from the source file
+			   into the mapping.  */
+			if (unlikely ((size_t) pread_retry (dl->copy_fd,
+							    last_position,
+							    dl->data.d.d_size,
+							    dl->copy_offset)
+				      != dl->data.d.d_size))
+			  {
+			    free (scns);
+			    __libelf_seterrno (ELF_E_READ_ERROR);
+			    return -1;
+			  }
+
+			last_position += dl->data.d.d_size;
+		      }
+		    else if (unlikely (change_bo))
 		      {
 #if EV_NUM != 2
 			xfct_t fctp;
@@ -508,6 +525,54 @@ fill (int fd, off_t pos, size_t len, char *fillbuf, size_t *filledp)
 }
 
 
+/* Helper function to copy LEN bytes at SRCPOS in SRCFD to POS in FD.
+   If possible the kernel does the copying (or shares the blocks on
+   file systems with reflink support).  Otherwise the data is copied
+   in chunks through BUF, which must have room for MAX_TMPBUF bytes.  */
+static int
+copy_file_data (int fd, off_t pos, int srcfd, off_t srcpos, size_t len,
+		char *buf)
+{
+#ifdef HAVE_COPY_FILE_RANGE
+  while (len > 0)
+    {
+      ssize_t n = copy_file_range (srcfd, &srcpos, fd, &pos, len, 0);
+      if (n > 0)
+	len -= n;
+      else if (n < 0 && errno == EINTR)
+	continue;
+      else
+	/* Not supported for these files (e.g. EXDEV or EINVAL).  If
+	   something is really wrong the fallback below reports it.  */
+	break;
+    }
+#endif
+
+  while (len > 0)
+    {
+      size_t n = MIN (len, MAX_TMPBUF);
+
+      if (unlikely ((size_t) pread_retry (srcfd, buf, n, srcpos) != n))
+	{
+	  __libelf_seterrno (ELF_E_READ_ERROR);
+	  return 1;
+	}
+
+      if (unlikely ((size_t) pwrite_retry (fd, buf, n, pos) != n))
+	{
+	  __libelf_seterrno (ELF_E_WRITE_ERROR);
+	  return 1;
+	}
+
+      srcpos += n;
+      pos += n;
+      len -= n;
+    }
+
+  return 0;
+}
+
+
 int
 internal_function
 __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
@@ -741,6 +806,20 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 
 		    last_offset = scn_start + dl->data.d.d_off;
 
+		    if (dl->flags & ELF_F_FILECOPY)
+		      {
+			/* The data is still only in the source file.  */
+			if (unlikely (copy_file_data (elf->fildes, last_offset,
+						      dl->copy_fd,
+						      dl->copy_offset,
+						      dl->data.d.d_size,
+						      tmpbuf) != 0))
+			  goto fail_free;
+
+			scn_changed = true;
+			goto data_written;
+		      }
+
 		    if (unlikely (change_bo))
 		      {
 #if EV_NUM != 2
@@ -784,6 +863,7 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 		    scn_changed = true;
 		  }
 
+	      data_written:
 		last_offset += dl->data.d.d_size;
 
 		dl->flags &= ~ELF_F_DIRTY;
@@ -279,8 +279,19 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
      we allocate space for a zeroth section in case we need it later.  */
   const size_t scnmax = (scncnt ?: (cmd == ELF_C_RDWR || cmd == ELF_C_RDWR_MMAP)
 			 ? 1 : 0);
-  Elf *elf = allocate_elf (fildes, map_address, offset, maxsize, cmd, parent,
-			   ELF_K_ELF, scnmax * sizeof (Elf_Scn));
+
+  /* The sections of files which are only read are set up when they
+     are first used, see __libelf_scn_setup.  Opening and closing a
+     file with many sections then doesn't have to touch them all.  The
+     bitmap recording which are set up follows the section array.  */
+  bool lazy_scns = (scncnt > 0
+		    && (cmd == ELF_C_READ_MMAP
+			|| (cmd == ELF_C_READ && map_address == NULL)));
+  size_t lazy_size = lazy_scns ? (scnmax + CHAR_BIT - 1) / CHAR_BIT : 0;
+  Elf *elf = allocate_elf_noclear (fildes, map_address, offset, maxsize, cmd,
+				   parent, ELF_K_ELF,
+				   scnmax * sizeof (Elf_Scn) + lazy_size,
+				   lazy_scns);
   if (elf == NULL)
     /* Not enough memory.  */
     return NULL;
@@ -294,6 +305,16 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
   /* Some more or less arbitrary value.  */
   elf->state.elf.scnincr = 10;
 
+  if (lazy_scns)
+    {
+      elf->state.elf.scns_lazy
+	= (unsigned char *) &elf->state.elf32.scns.data[scnmax];
+      memset (elf->state.elf.scns_lazy, '\0', lazy_size);
+
+      /* The zeroth section is often looked at directly.  */
+      (void) __libelf_scn_setup (elf, &elf->state.elf32.scns, 0);
+    }
+
   /* Make the class easily available.  */
   elf->class = e_ident[EI_CLASS];
 
@@ -386,7 +407,7 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
 		elf->state.elf32.scns.data[cnt].shndx_index = -1;
 	    }
 	}
-      else
+      else if (! lazy_scns)
 	{
 	  for (size_t cnt = 0; cnt < scncnt; ++cnt)
 	    {
@@ -483,7 +504,7 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
 		elf->state.elf64.scns.data[cnt].shndx_index = -1;
 	    }
 	}
-      else
+      else if (! lazy_scns)
 	{
 	  for (size_t cnt = 0; cnt < scncnt; ++cnt)
 	    {
@@ -774,39 +795,40 @@ read_long_names (Elf *elf)
 }
 
 
-/* Read the next archive header.  */
-int
-internal_function
-__libelf_next_arhdr_wrlock (Elf *elf)
+/* Read the archive header at OFFSET and convert it into ELF_AR_HDR.
+   AR_HDR_MEM is used as buffer if the file is not mapped, AR_NAME and
+   RAW_NAME receive the NUL terminated names.  Returns the header as
+   found in the file or NULL on error.  */
+static struct ar_hdr *
+read_arhdr (Elf *elf, off_t offset, struct ar_hdr *ar_hdr_mem,
+	    Elf_Arhdr *elf_ar_hdr, char ar_name[16], char raw_name[17])
 {
   struct ar_hdr *ar_hdr;
-  Elf_Arhdr *elf_ar_hdr;
 
   if (elf->map_address != NULL)
     {
       /* See whether this entry is in the file.  */
-      if (unlikely ((size_t) elf->state.ar.offset
-		    > elf->start_offset + elf->maximum_size
+      if (unlikely ((size_t) offset > elf->start_offset + elf->maximum_size
 		    || (elf->start_offset + elf->maximum_size
-			- elf->state.ar.offset) < sizeof (struct ar_hdr)))
+			- offset) < sizeof (struct ar_hdr)))
 	{
 	  /* This record is not anymore in the file.  */
 	  __libelf_seterrno (ELF_E_RANGE);
-	  return -1;
+	  return NULL;
 	}
-      ar_hdr = (struct ar_hdr *) (elf->map_address + elf->state.ar.offset);
+      ar_hdr = (struct ar_hdr *) (elf->map_address + offset);
     }
   else
     {
-      ar_hdr = &elf->state.ar.ar_hdr;
+      ar_hdr = ar_hdr_mem;
 
       if (unlikely (pread_retry (elf->fildes, ar_hdr, sizeof (struct ar_hdr),
-				 elf->state.ar.offset)
+				 offset)
 		    != sizeof (struct ar_hdr)))
 	{
 	  /* Something went wrong while reading the file.  */
 	  __libelf_seterrno (ELF_E_RANGE);
-	  return -1;
+	  return NULL;
 	}
     }
 
@@ -815,13 +837,12 @@ __libelf_next_arhdr_wrlock (Elf *elf)
     {
       /* This is no valid archive.  */
       __libelf_seterrno (ELF_E_ARCHIVE_FMAG);
-      return -1;
+      return NULL;
     }
 
   /* Copy the raw name over to a NUL terminated buffer.  */
-  *((char *) mempcpy (elf->state.ar.raw_name, ar_hdr->ar_name, 16)) = '\0';
-
-  elf_ar_hdr = &elf->state.ar.elf_ar_hdr;
+  *((char *) mempcpy (raw_name, ar_hdr->ar_name, 16)) = '\0';
+  elf_ar_hdr->ar_rawname = raw_name;
 
   /* Now convert the `struct ar_hdr' into `Elf_Arhdr'.
      Determine whether this is a special entry.  */
@@ -830,18 +851,18 @@ __libelf_next_arhdr_wrlock (Elf *elf)
       if (ar_hdr->ar_name[1] == ' '
 	  && memcmp (ar_hdr->ar_name, "/               ", 16) == 0)
 	/* This is the index.  */
-	elf_ar_hdr->ar_name = memcpy (elf->state.ar.ar_name, "/", 2);
+	elf_ar_hdr->ar_name = memcpy (ar_name, "/", 2);
       else if (ar_hdr->ar_name[1] == 'S'
 	       && memcmp (ar_hdr->ar_name, "/SYM64/         ", 16) == 0)
 	/* 64-bit index.  */
-	elf_ar_hdr->ar_name = memcpy (elf->state.ar.ar_name, "/SYM64/", 8);
+	elf_ar_hdr->ar_name = memcpy (ar_name, "/SYM64/", 8);
       else if (ar_hdr->ar_name[1] == '/'
 	       && memcmp (ar_hdr->ar_name, "//              ", 16) == 0)
 	/* This is the array with the long names.  */
-	elf_ar_hdr->ar_name = memcpy (elf->state.ar.ar_name, "//", 3);
+	elf_ar_hdr->ar_name = memcpy (ar_name, "//", 3);
       else if (likely  (isdigit (ar_hdr->ar_name[1])))
 	{
-	  size_t offset;
+	  size_t name_offset;
 
 	  /* This is a long name.  First we have to read the long name
 	     table, if this hasn't happened already.  */
@@ -851,23 +872,23 @@ __libelf_next_arhdr_wrlock (Elf *elf)
 	      /* No long name table although it is reference.  The archive is
 		 broken.  */
 	      __libelf_seterrno (ELF_E_INVALID_ARCHIVE);
-	      return -1;
+	      return NULL;
 	    }
 
-	  offset = atol (ar_hdr->ar_name + 1);
-	  if (unlikely (offset >= elf->state.ar.long_names_len))
+	  name_offset = atol (ar_hdr->ar_name + 1);
+	  if (unlikely (name_offset >= elf->state.ar.long_names_len))
 	    {
 	      /* The index in the long name table is larger than the table.  */
 	      __libelf_seterrno (ELF_E_INVALID_ARCHIVE);
-	      return -1;
+	      return NULL;
 	    }
-	  elf_ar_hdr->ar_name = elf->state.ar.long_names + offset;
+	  elf_ar_hdr->ar_name = elf->state.ar.long_names + name_offset;
 	}
       else
 	{
 	  /* This is none of the known special entries.  */
 	  __libelf_seterrno (ELF_E_INVALID_ARCHIVE);
-	  return -1;
+	  return NULL;
 	}
     }
   else
@@ -875,7 +896,7 @@ __libelf_next_arhdr_wrlock (Elf *elf)
       char *endp;
 
       /* It is a normal entry.  Copy over the name.  */
-      endp = (char *) memccpy (elf->state.ar.ar_name, ar_hdr->ar_name,
+      endp = (char *) memccpy (ar_name, ar_hdr->ar_name,
 			       '/', 16);
       if (endp != NULL)
 	endp[-1] = '\0';
@@ -885,11 +906,11 @@ __libelf_next_arhdr_wrlock (Elf *elf)
 	     Instead, there is space padding at the end of the name.  */
 	  size_t i = 15;
 	  do
-	    elf->state.ar.ar_name[i] = '\0';
-	  while (i > 0 && elf->state.ar.ar_name[--i] == ' ');
+	    ar_name[i] = '\0';
+	  while (i > 0 && ar_name[--i] == ' ');
 	}
 
-      elf_ar_hdr->ar_name = elf->state.ar.ar_name;
+      elf_ar_hdr->ar_name = ar_name;
     }
 
   if (unlikely (ar_hdr->ar_size[0] == ' '))
@@ -898,7 +919,7 @@ __libelf_next_arhdr_wrlock (Elf *elf)
        archive member.  */
     {
       __libelf_seterrno (ELF_E_INVALID_ARCHIVE);
-      return -1;
+      return NULL;
     }
 
   /* Since there are no specialized functions to convert ASCII to
@@ -935,16 +956,111 @@ __libelf_next_arhdr_wrlock (Elf *elf)
   if (elf_ar_hdr->ar_size < 0)
     {
       __libelf_seterrno (ELF_E_INVALID_ARCHIVE);
-      return -1;
+      return NULL;
     }
 
   /* Truncated file?  */
   size_t maxsize;
   maxsize = (elf->start_offset + elf->maximum_size
-	     - elf->state.ar.offset - sizeof (struct ar_hdr));
+	     - offset - sizeof (struct ar_hdr));
   if ((size_t) elf_ar_hdr->ar_size > maxsize)
     elf_ar_hdr->ar_size = maxsize;
 
+  return ar_hdr;
+}
+
+
+/* Read the next archive header.  */
+int
+internal_function
+__libelf_next_arhdr_wrlock (Elf *elf)
+{
+  return (read_arhdr (elf, elf->state.ar.offset, &elf->state.ar.ar_hdr,
+		      &elf->state.ar.elf_ar_hdr, elf->state.ar.ar_name,
+		      elf->state.ar.raw_name) != NULL ? 0 : -1);
+}
+
+
+/* Build the table of all members of the archive ELF.  Special entries
+   (symbol index and long name table) are not part of the table.  Like
+   elf_next the walk stops at the first header which cannot be read.  */
+int
+internal_function
+__libelf_armem_index_wrlock (Elf *elf)
+{
+  if (elf->state.ar.members != NULL)
+    return 0;
+
+  size_t num = 0;
+  size_t max = 0;
+  Elf_ArMem *members = NULL;
+  off_t offset = elf->start_offset + SARMAG;
+
+  while (1)
+    {
+      struct ar_hdr ar_hdr_mem;
+      Elf_Arhdr arhdr;
+      char ar_name[16];
+      char raw_name[17];
+
+      if (read_arhdr (elf, offset, &ar_hdr_mem, &arhdr, ar_name,
+		      raw_name) == NULL)
+	break;
+
+      /* Skip the special entries, the symbol index and the long name
+	 table.  Their names are the only short names starting with a
+	 slash.  */
+      if (arhdr.ar_name != ar_name || ar_name[0] != '/')
+	{
+	  if (num == max)
+	    {
+	      max = max == 0 ? 64 : 2 * max;
+	      Elf_ArMem *newp = realloc (members, max * sizeof (Elf_ArMem));
+	      if (unlikely (newp == NULL))
+		{
+		  free (members);
+		  __libelf_seterrno (ELF_E_NOMEM);
+		  return -1;
+		}
+	      members = newp;
+	    }
+
+	  Elf_ArMem *mem = &members[num++];
+	  mem->offset = offset;
+	  mem->arhdr = arhdr;
+	  memcpy (mem->ar_name, ar_name, sizeof (ar_name));
+	  memcpy (mem->raw_name, raw_name, sizeof (raw_name));
+	  /* Long names point into the long name table which stays
+	     around.  Short names are redirected below once the array
+	     does not move anymore.  */
+	  if (arhdr.ar_name == ar_name)
+	    mem->arhdr.ar_name = NULL;
+	}
+
+      offset += sizeof (struct ar_hdr) + ((arhdr.ar_size + 1) & ~1l);
+    }
+
+  if (members == NULL)
+    {
+      /* Make sure the table is recognized as being read.  */
+      members = malloc (sizeof (Elf_ArMem));
+      if (unlikely (members == NULL))
+	{
+	  __libelf_seterrno (ELF_E_NOMEM);
+	  return -1;
+	}
+    }
+
+  for (size_t cnt = 0; cnt < num; ++cnt)
+    {
+      if (members[cnt].arhdr.ar_name == NULL)
+	members[cnt].arhdr.ar_name = members[cnt].ar_name;
+      members[cnt].arhdr.ar_rawname = members[cnt].raw_name;
+    }
+
+  elf->state.ar.members = members;
+  elf->state.ar.members_num = num;
+
   return 0;
 }
 
@@ -1145,3 +1261,72 @@ elf_begin (int fildes, Elf_Cmd cmd, Elf *ref)
   return retval;
 }
 INTDEF(elf_begin)
+
+
+/* Return a descriptor for member NDX of the archive ELF.  Unlike
+   elf_begin this does not use or change the current archive position,
+   so members can be opened in any order and from several threads.  */
+Elf *
+elf_begin_armem (Elf *elf, size_t ndx, Elf_Cmd cmd)
+{
+  if (elf == NULL)
+    return NULL;
+
+  if (unlikely (elf->kind != ELF_K_AR))
+    {
+      __libelf_seterrno (ELF_E_NO_ARCHIVE);
+      return NULL;
+    }
+
+  /* Only reading is possible.  If the archive was opened with
+     ELF_C_READ_MMAP_PRIVATE the member can be too.  */
+  if (unlikely ((cmd != ELF_C_READ && cmd != ELF_C_READ_MMAP
+		 && cmd != ELF_C_READ_MMAP_PRIVATE)
+		|| (cmd == ELF_C_READ_MMAP_PRIVATE
+		    && elf->cmd != ELF_C_READ_MMAP_PRIVATE)))
+    {
+      __libelf_seterrno (ELF_E_INVALID_CMD);
+      return NULL;
+    }
+
+  rwlock_rdlock (elf->lock);
+
+  if (elf->state.ar.members == NULL)
+    {
+      /* We need the write lock to build the member table.  */
+      rwlock_unlock (elf->lock);
+      rwlock_wrlock (elf->lock);
+      int res = __libelf_armem_index_wrlock (elf);
+      rwlock_unlock (elf->lock);
+      if (res != 0)
+	return NULL;
+      rwlock_rdlock (elf->lock);
+    }
+
+  if (unlikely (ndx >= elf->state.ar.members_num))
+    {
+      rwlock_unlock (elf->lock);
+      __libelf_seterrno (ELF_E_RANGE);
+      return NULL;
+    }
+
+  /* Reading the member only needs the (immutable) member table and
+     the file, so the read lock is enough and other threads can open
+     other members at the same time.  */
+  Elf_ArMem *mem = &elf->state.ar.members[ndx];
+  Elf *result = read_file (elf->fildes, mem->offset + sizeof (struct ar_hdr),
+			   mem->arhdr.ar_size, cmd, elf);
+
+  rwlock_unlock (elf->lock);
+
+  /* Enlist this new descriptor in the list of children.  */
+  if (result != NULL)
+    {
+      rwlock_wrlock (elf->lock);
+      result->next = elf->state.ar.children;
+      elf->state.ar.children = result;
+      rwlock_unlock (elf->lock);
+    }
+
+  return result;
+}
@@ -109,10 +109,13 @@ elf_end (Elf *elf)
     case ELF_K_AR:
       if (elf->state.ar.long_names != NULL)
 	free (elf->state.ar.long_names);
+      free (elf->state.ar.members);
       break;
 
     case ELF_K_ELF:
       {
+	__libelf_scnname_free (elf);
+
 	Elf_Data_Chunk *rawchunks
 	  = (elf->class == ELFCLASS32
 	     || (offsetof (struct Elf, state.elf32.rawchunks)
@@ -146,6 +149,15 @@ elf_end (Elf *elf)
 		Elf_Scn *scn = &list->data[cnt];
 		Elf_Data_List *runp;
 
+		/* Sections never set up hold nothing to free.  Skip
+		   over whole bytes of the bitmap at once.  */
+		if (__libelf_scn_pending (elf, list, cnt))
+		  {
+		    if (elf->state.elf.scns_lazy[cnt / CHAR_BIT] == 0)
+		      cnt -= cnt % CHAR_BIT;
+		    continue;
+		  }
+
 		if ((scn->shdr_flags & ELF_F_MALLOCED) != 0)
 		  /* It doesn't matter which pointer.  */
 		  free (scn->shdr.e32);
@@ -52,7 +52,13 @@ elf_flagshdr (Elf_Scn *scn, Elf_Cmd cmd, unsigned int flags)
     }
 
   if (likely (cmd == ELF_C_SET))
-    result = (scn->shdr_flags |= (flags & ELF_F_DIRTY));
+    {
+      /* The header was changed, maybe the name as well.  */
+      rwlock_wrlock (scn->elf->lock);
+      __libelf_scnname_free (scn->elf);
+      rwlock_unlock (scn->elf->lock);
+      result = (scn->shdr_flags |= (flags & ELF_F_DIRTY));
+    }
   else if (likely (cmd == ELF_C_CLR))
     result = (scn->shdr_flags &= ~(flags & ELF_F_DIRTY));
   else
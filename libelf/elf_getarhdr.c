@@ -53,6 +53,28 @@ elf_getarhdr (Elf *elf)
       return NULL;
     }
 
+  /* If the member table was built look up the header of this member
+     there.  Members opened with elf_begin_armem don't correspond to
+     the current archive position.  */
+  if (parent->state.ar.members != NULL)
+    {
+      off_t offset = elf->start_offset - sizeof (struct ar_hdr);
+      Elf_ArMem *members = parent->state.ar.members;
+      size_t lo = 0;
+      size_t hi = parent->state.ar.members_num;
+
+      while (lo < hi)
+	{
+	  size_t mid = (lo + hi) / 2;
+	  if (members[mid].offset < offset)
+	    lo = mid + 1;
+	  else if (members[mid].offset > offset)
+	    hi = mid;
+	  else
+	    return &members[mid].arhdr;
+	}
+    }
+
   /* Make sure we have read the archive header.  */
   if (parent->state.ar.elf_ar_hdr.ar_name == NULL
       && __libelf_next_arhdr_wrlock (parent) != 0)
@@ -0,0 +1,62 @@
+/* Return number of members of an archive.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libelf.h>
+#include <stddef.h>
+
+#include "libelfP.h"
+
+
+int
+elf_getarmemnum (Elf *elf, size_t *dst)
+{
+  if (elf == NULL)
+    return -1;
+
+  if (unlikely (elf->kind != ELF_K_AR))
+    {
+      __libelf_seterrno (ELF_E_NO_ARCHIVE);
+      return -1;
+    }
+
+  int result = 0;
+
+  rwlock_wrlock (elf->lock);
+
+  if (__libelf_armem_index_wrlock (elf) != 0)
+    result = -1;
+  else
+    *dst = elf->state.ar.members_num;
+
+  rwlock_unlock (elf->lock);
+
+  return result;
+}
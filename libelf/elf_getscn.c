@@ -64,7 +64,7 @@ elf_getscn (Elf *elf, size_t idx)
       if (idx < runp->max)
 	{
 	  if (idx < runp->cnt)
-	    result = &runp->data[idx];
+	    result = __libelf_scn_setup_rdlock (elf, runp, idx);
 	  else
 	    __libelf_seterrno (ELF_E_INVALID_INDEX);
 	  break;
@@ -0,0 +1,234 @@
+/* Look up sections by name.
+   This file is part of elfutils.
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <gelf.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libelfP.h"
+#include "elf_scnname_hash.h"
+
+
+/* Zero marks an empty slot in the hash table, so never use it.  */
+#define NAME_HASH(name) (INTUSE(elf_hash) (name) + 1)
+
+
+static const char *
+scn_name (Elf *elf, Elf_Scn *scn, size_t shstrndx)
+{
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = INTUSE(gelf_getshdr) (scn, &shdr_mem);
+  if (shdr == NULL)
+    return NULL;
+  return INTUSE(elf_strptr) (elf, shstrndx, shdr->sh_name);
+}
+
+
+static struct Elf_ScnNameTab *
+build_table (Elf *elf, size_t shstrndx)
+{
+  size_t shnum;
+  rwlock_rdlock (elf->lock);
+  int res = __elf_getshdrnum_rdlock (elf, &shnum);
+  rwlock_unlock (elf->lock);
+  if (res != 0)
+    return NULL;
+
+  struct Elf_ScnNameTab *tab = calloc (1, (sizeof (struct Elf_ScnNameTab)
+					   + shnum * sizeof (Elf_ScnName)));
+  if (tab == NULL
+      || Elf_ScnName_Hash_init (&tab->hash, shnum + shnum / 8 + 1) != 0)
+    {
+      free (tab);
+      __libelf_seterrno (ELF_E_NOMEM);
+      return NULL;
+    }
+  tab->shstrndx = shstrndx;
+  tab->nentries = shnum;
+
+  /* Walk the sections in index order, so the first section of each
+     name is the one which ends up in the hash table.  */
+  Elf_Scn *scn = NULL;
+  while ((scn = INTUSE(elf_nextscn) (elf, scn)) != NULL)
+    {
+      size_t ndx = scn->index;
+      const char *name = scn_name (elf, scn, shstrndx);
+      if (unlikely (ndx >= shnum) || name == NULL)
+	continue;
+
+      Elf_ScnName *ent = &tab->entries[ndx];
+      ent->name = name;
+      ent->scn = scn;
+      ent->last = ent;
+
+      unsigned long int hval = NAME_HASH (name);
+      if (Elf_ScnName_Hash_insert (&tab->hash, hval, ent) != 0)
+	{
+	  Elf_ScnName *first = Elf_ScnName_Hash_find (&tab->hash, hval, ent);
+	  if (unlikely (first == NULL))
+	    {
+	      Elf_ScnName_Hash_free (&tab->hash);
+	      free (tab);
+	      __libelf_seterrno (ELF_E_NOMEM);
+	      return NULL;
+	    }
+	  first->last->next = ent;
+	  first->last = ent;
+	}
+    }
+
+  return tab;
+}
+
+
+void
+internal_function
+__libelf_scnname_free (Elf *elf)
+{
+  struct Elf_ScnNameTab *tab = elf->state.elf.scns_byname;
+  if (tab != NULL)
+    {
+      elf->state.elf.scns_byname = NULL;
+      Elf_ScnName_Hash_free (&tab->hash);
+      free (tab);
+    }
+}
+
+
+/* Look up NAME after SCN in TAB.  The caller must hold the lock.  */
+static Elf_Scn *
+lookup (struct Elf_ScnNameTab *tab, Elf_Scn *scn, const char *name)
+{
+  Elf_ScnName *ent;
+  if (scn == NULL)
+    {
+      Elf_ScnName key = { .name = name };
+      ent = Elf_ScnName_Hash_find (&tab->hash, NAME_HASH (name), &key);
+    }
+  else
+    {
+      size_t ndx = scn->index;
+      if (ndx < tab->nentries && tab->entries[ndx].scn == scn
+	  && strcmp (tab->entries[ndx].name, name) == 0)
+	ent = tab->entries[ndx].next;
+      else
+	{
+	  /* SCN does not have this name.  Find the first one with the
+	     name after it.  */
+	  Elf_ScnName key = { .name = name };
+	  ent = Elf_ScnName_Hash_find (&tab->hash, NAME_HASH (name), &key);
+	  while (ent != NULL && ent->scn->index <= ndx)
+	    ent = ent->next;
+	}
+    }
+
+  return ent != NULL ? ent->scn : NULL;
+}
+
+
+Elf_Scn *
+elf_nextscnbyname (Elf *elf, Elf_Scn *scn, const char *name)
+{
+  if (elf == NULL)
+    return NULL;
+
+  if (unlikely (elf->kind != ELF_K_ELF))
+    {
+      __libelf_seterrno (ELF_E_INVALID_HANDLE);
+      return NULL;
+    }
+
+  if (unlikely (name == NULL) || unlikely (scn != NULL && scn->elf != elf))
+    {
+      __libelf_seterrno (ELF_E_INVALID_OPERAND);
+      return NULL;
+    }
+
+  size_t shstrndx;
+  if (INTUSE(elf_getshdrstrndx) (elf, &shstrndx) != 0)
+    return NULL;
+
+  if (! __libelf_scnname_indexed (elf))
+    {
+      /* Nothing to do but look at all the sections.  */
+      while ((scn = INTUSE(elf_nextscn) (elf, scn)) != NULL)
+	{
+	  const char *scnname = scn_name (elf, scn, shstrndx);
+	  if (scnname != NULL && strcmp (scnname, name) == 0)
+	    break;
+	}
+      return scn;
+    }
+
+  /* The table is only freed under the write lock, hold the read lock
+     while looking at it.  */
+  rwlock_rdlock (elf->lock);
+  struct Elf_ScnNameTab *tab = elf->state.elf.scns_byname;
+  if (tab != NULL && tab->shstrndx == shstrndx)
+    {
+      Elf_Scn *result = lookup (tab, scn, name);
+      rwlock_unlock (elf->lock);
+      return result;
+    }
+  rwlock_unlock (elf->lock);
+
+  /* The table is built without holding the lock since the functions
+     used take it themselves.  */
+  struct Elf_ScnNameTab *newtab = build_table (elf, shstrndx);
+  if (newtab == NULL)
+    return NULL;
+
+  /* Another thread might have installed a table meanwhile.  Keep that
+     one if it is good, other lookups might be using it.  */
+  rwlock_wrlock (elf->lock);
+  tab = elf->state.elf.scns_byname;
+  if (tab != NULL && tab->shstrndx == shstrndx)
+    {
+      Elf_ScnName_Hash_free (&newtab->hash);
+      free (newtab);
+    }
+  else
+    {
+      __libelf_scnname_free (elf);
+      elf->state.elf.scns_byname = tab = newtab;
+    }
+  Elf_Scn *result = lookup (tab, scn, name);
+  rwlock_unlock (elf->lock);
+
+  return result;
+}
+INTDEF(elf_nextscnbyname)
+
+
+Elf_Scn *
+elf_getscnbyname (Elf *elf, const char *name)
+{
+  return INTUSE(elf_nextscnbyname) (elf, NULL, name);
+}
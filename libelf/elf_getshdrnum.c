@@ -61,8 +61,11 @@ __elf_getshdrnum_rdlock (Elf *elf, size_t *dst)
 	      || (offsetof (Elf, state.elf32.scns)
 		  == offsetof (Elf, state.elf64.scns))
 	      ? &elf->state.elf32.scns : &elf->state.elf64.scns)))
-    /* There is at least one section.  */
-    *dst = 1 + elf->state.elf.scns_last->data[idx - 1].index;
+    /* There is at least one section.  One not set up yet has the
+       index of its place in the array, see __libelf_scn_pending.  */
+    *dst = 1 + (__libelf_scn_pending (elf, elf->state.elf.scns_last, idx - 1)
+		? (size_t) idx - 1
+		: elf->state.elf.scns_last->data[idx - 1].index);
   else
     *dst = 0;
 
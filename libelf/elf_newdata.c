@@ -134,3 +134,4 @@ elf_newdata (Elf_Scn *scn)
      for RESULT == NULL since it still return NULL.  */
   return &result->data.d;
 }
+INTDEF(elf_newdata)
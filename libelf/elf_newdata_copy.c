@@ -0,0 +1,135 @@
+/* Create new data block which is a copy of a section's file contents.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stddef.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+
+#include "libelfP.h"
+
+
+/* Returns true if FD1 and FD2 refer to the same file.  */
+static bool
+same_file (int fd1, int fd2)
+{
+  struct stat st1;
+  struct stat st2;
+
+  if (fstat (fd1, &st1) != 0 || fstat (fd2, &st2) != 0)
+    return true;
+
+  return st1.st_dev == st2.st_dev && st1.st_ino == st2.st_ino;
+}
+
+
+Elf_Data *
+elf_newdata_copy (Elf_Scn *scn, Elf_Scn *src)
+{
+  if (scn == NULL || src == NULL)
+    return NULL;
+
+  Elf *elf = scn->elf;
+  Elf *srcelf = src->elf;
+  if (unlikely (srcelf == elf))
+    {
+      __libelf_seterrno (ELF_E_INVALID_OPERAND);
+      return NULL;
+    }
+
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = INTUSE(gelf_getshdr) (src, &shdr_mem);
+  if (shdr == NULL)
+    return NULL;
+
+  rwlock_rdlock (srcelf->lock);
+  int srcfd = srcelf->fildes;
+  char *map_address = srcelf->map_address;
+  off_t offset = srcelf->start_offset + shdr->sh_offset;
+  size_t maxsize = srcelf->maximum_size;
+  rwlock_unlock (srcelf->lock);
+
+  size_t size = shdr->sh_type == SHT_NOBITS ? 0 : shdr->sh_size;
+  if (unlikely (size != 0 && maxsize != ~((size_t) 0)
+		&& (shdr->sh_offset > maxsize
+		    || maxsize - shdr->sh_offset < size)))
+    {
+      __libelf_seterrno (ELF_E_INVALID_SECTION_HEADER);
+      return NULL;
+    }
+
+  /* If the source file cannot be read directly, or if it is the file
+     we are going to write (where the data might be overwritten before
+     it is copied), use the data in memory.  */
+  bool filecopy = (size != 0 && srcfd != -1 && elf->fildes != -1
+		   && ! same_file (srcfd, elf->fildes));
+  void *buf = NULL;
+  if (size != 0 && map_address != NULL)
+    buf = map_address + offset;
+  else if (size != 0 && ! filecopy)
+    {
+      Elf_Data *rawdata = INTUSE(elf_rawdata) (src, NULL);
+      if (rawdata == NULL)
+	return NULL;
+      buf = rawdata->d_buf;
+    }
+
+  Elf_Data *result = INTUSE(elf_newdata) (scn);
+  if (result == NULL)
+    return NULL;
+
+  /* The alignment must be a power of two which fits the file offset,
+     see __libelf_set_rawdata_wrlock.  */
+  size_t align = shdr->sh_addralign ?: 1;
+  if (! powerof2 (align))
+    align = 1;
+  while (size != 0 && align > 1 && (GElf_Off) align > shdr->sh_offset)
+    align >>= 1;
+
+  rwlock_wrlock (elf->lock);
+
+  result->d_buf = buf;
+  result->d_type = ELF_T_BYTE;
+  result->d_size = shdr->sh_size;
+  result->d_off = 0;
+  result->d_align = align;
+
+  if (filecopy)
+    {
+      Elf_Data_List *dl = (Elf_Data_List *) result;
+      dl->flags |= ELF_F_FILECOPY;
+      dl->copy_fd = srcfd;
+      dl->copy_offset = offset;
+    }
+
+  rwlock_unlock (elf->lock);
+
+  return result;
+}
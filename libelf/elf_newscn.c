@@ -113,7 +113,8 @@ elf_newscn (Elf *elf)
 
       /* Remember the index for the first section in this block.  */
       newp->data[0].index
-	= 1 + elf->state.elf.scns_last->data[elf->state.elf.scns_last->max - 1].index;
+	= 1 + __libelf_scn_setup (elf, elf->state.elf.scns_last,
+				  elf->state.elf.scns_last->max - 1)->index;
 
       /* Enqueue the new list element.  */
       elf->state.elf.scns_last = elf->state.elf.scns_last->next = newp;
@@ -155,6 +156,9 @@ elf_newscn (Elf *elf)
 
   result->flags |= ELF_F_DIRTY;
 
+  /* The new section is not known in the table by name.  */
+  __libelf_scnname_free (elf);
+
  out:
   rwlock_unlock (elf->lock);
 
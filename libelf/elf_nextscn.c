@@ -66,7 +66,7 @@ elf_nextscn (Elf *elf, Elf_Scn *scn)
     list = scn->list;
 
   if (scn + 1 < &list->data[list->cnt])
-    result = scn + 1;
+    result = __libelf_scn_setup_rdlock (elf, list, scn + 1 - list->data);
   else if (scn + 1 == &list->data[list->max]
 	   && (list = list->next) != NULL)
     {
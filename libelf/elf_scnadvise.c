@@ -0,0 +1,162 @@
+/* Give advice about the use of section data.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <fcntl.h>
+#include <libelf.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "libelfP.h"
+
+
+/* Apply ADVICE to the LEN bytes of mapped memory at START.  */
+static void
+advise_memory (char *start, size_t len, int advice)
+{
+  /* madvise needs a page aligned start address.  */
+  uintptr_t pagesize = sysconf (_SC_PAGESIZE);
+  char *page = (char *) ((uintptr_t) start & ~(pagesize - 1));
+  len += start - page;
+
+  switch (advice)
+    {
+    case ELF_ADV_NORMAL:
+      (void) madvise (page, len, MADV_NORMAL);
+      break;
+
+    case ELF_ADV_RANDOM:
+      (void) madvise (page, len, MADV_RANDOM);
+      break;
+
+    case ELF_ADV_SEQUENTIAL:
+      (void) madvise (page, len, MADV_SEQUENTIAL);
+      break;
+
+    case ELF_ADV_WILLNEED:
+      (void) madvise (page, len, MADV_WILLNEED);
+      break;
+
+    case ELF_ADV_POPULATE:
+#ifdef MADV_POPULATE_READ
+      if (madvise (page, len, MADV_POPULATE_READ) == 0)
+	break;
+#endif
+      /* The kernel cannot do it for us, touch every page.  */
+      for (size_t off = 0; off < len; off += pagesize)
+	(void) *(volatile char *) (page + off);
+      break;
+
+    case ELF_ADV_HUGEPAGE:
+#ifdef MADV_HUGEPAGE
+      (void) madvise (page, len, MADV_HUGEPAGE);
+#endif
+      break;
+    }
+}
+
+
+/* Apply ADVICE to the LEN bytes at OFFSET of the file FD.  */
+static void
+advise_file (int fd, off_t offset, size_t len, int advice)
+{
+  switch (advice)
+    {
+    case ELF_ADV_NORMAL:
+      (void) posix_fadvise (fd, offset, len, POSIX_FADV_NORMAL);
+      break;
+
+    case ELF_ADV_RANDOM:
+      (void) posix_fadvise (fd, offset, len, POSIX_FADV_RANDOM);
+      break;
+
+    case ELF_ADV_SEQUENTIAL:
+      (void) posix_fadvise (fd, offset, len, POSIX_FADV_SEQUENTIAL);
+      break;
+
+    case ELF_ADV_WILLNEED:
+    case ELF_ADV_POPULATE:
+      /* The data will be read into memory allocated when needed, the
+	 best we can do is to get it into the page cache.  */
+      (void) posix_fadvise (fd, offset, len, POSIX_FADV_WILLNEED);
+      break;
+
+    case ELF_ADV_HUGEPAGE:
+      /* Nothing to do for data which isn't mapped.  */
+      break;
+    }
+}
+
+
+int
+elf_scnadvise (Elf_Scn *scn, int advice)
+{
+  if (scn == NULL)
+    return -1;
+
+  if (unlikely (advice < ELF_ADV_NORMAL || advice > ELF_ADV_HUGEPAGE))
+    {
+      __libelf_seterrno (ELF_E_INVALID_OPERAND);
+      return -1;
+    }
+
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = INTUSE(gelf_getshdr) (scn, &shdr_mem);
+  if (shdr == NULL)
+    return -1;
+
+  /* Nothing in the file to give advice about.  */
+  if (shdr->sh_type == SHT_NOBITS || shdr->sh_size == 0)
+    return 0;
+
+  Elf *elf = scn->elf;
+  int result = 0;
+
+  rwlock_rdlock (elf->lock);
+
+  if (unlikely (elf->maximum_size != ~((size_t) 0)
+		&& (shdr->sh_offset > elf->maximum_size
+		    || elf->maximum_size - shdr->sh_offset < shdr->sh_size)))
+    {
+      __libelf_seterrno (ELF_E_INVALID_SECTION_HEADER);
+      result = -1;
+    }
+  else if (elf->map_address != NULL)
+    advise_memory ((char *) elf->map_address + elf->start_offset
+		   + shdr->sh_offset, shdr->sh_size, advice);
+  else if (elf->fildes != -1 && scn->rawdata_base == NULL)
+    advise_file (elf->fildes, elf->start_offset + shdr->sh_offset,
+		 shdr->sh_size, advice);
+
+  rwlock_unlock (elf->lock);
+
+  return result;
+}
@@ -0,0 +1,59 @@
+/* Hash table for looking up sections by name.
+   This file is part of elfutils.
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _ELF_SCNNAME_HASH_H
+#define _ELF_SCNNAME_HASH_H	1
+
+#include <string.h>
+
+/* One entry per section of the file, indexed by section index.  */
+typedef struct Elf_ScnName
+{
+  const char *name;
+  Elf_Scn *scn;
+  /* Next section with the same name, in index order.  */
+  struct Elf_ScnName *next;
+  /* Last section with this name.  Only valid in the first one.  */
+  struct Elf_ScnName *last;
+} Elf_ScnName;
+
+#define NAME Elf_ScnName_Hash
+#define TYPE Elf_ScnName *
+#define COMPARE(a, b) strcmp ((a)->name, (b)->name)
+
+#include <dynamicsizehash.h>
+
+/* The table built by elf_getscnbyname.  Only the first section of each
+   name is in the hash table, the others are chained to it.  */
+struct Elf_ScnNameTab
+{
+  Elf_ScnName_Hash hash;
+  size_t shstrndx;		/* Index the names were read from.  */
+  size_t nentries;		/* Number of elements in ENTRIES.  */
+  Elf_ScnName entries[0];
+};
+
+#endif	/* elf_scnname_hash.h */
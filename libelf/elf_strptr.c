@@ -79,7 +79,7 @@ elf_strptr (Elf *elf, size_t idx, size_t offset)
       if (idx < runp->max)
 	{
 	  if (idx < runp->cnt)
-	    strscn = &runp->data[idx];
+	    strscn = __libelf_scn_setup_rdlock (elf, runp, idx);
 	  else
 	    {
 	      __libelf_seterrno (ELF_E_INVALID_INDEX);
@@ -33,6 +33,7 @@
 
 #include <libelf.h>
 #include <fcntl.h>
+#include <stddef.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -180,10 +181,20 @@ elf_update (Elf *elf, Elf_Cmd cmd)
       goto out;
     }
 
+  /* The layout code goes over all sections.  Make sure all those of
+     a file opened for reading are set up.  */
+  Elf_ScnList *scns = (elf->class == ELFCLASS32
+		       || (offsetof (struct Elf, state.elf32.scns)
+			   == offsetof (struct Elf, state.elf64.scns))
+		       ? &elf->state.elf32.scns : &elf->state.elf64.scns);
+  for (size_t cnt = 0; cnt < scns->cnt; ++cnt)
+    (void) __libelf_scn_setup (elf, scns, cnt);
+
   /* Determine the number of sections.  */
   shnum = (elf->state.elf.scns_last->cnt == 0
 	   ? 0
-	   : 1 + elf->state.elf.scns_last->data[elf->state.elf.scns_last->cnt - 1].index);
+	   : 1 + __libelf_scn_setup (elf, elf->state.elf.scns_last,
+				     elf->state.elf.scns_last->cnt - 1)->index);
 
   /* Update the ELF descriptor.  First, place the program header.  It
      will come right after the ELF header.  The count the size of all
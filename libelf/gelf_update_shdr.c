@@ -102,6 +102,9 @@ gelf_update_shdr (Elf_Scn *scn, GElf_Shdr *src)
   /* Mark the section header as modified.  */
   scn->shdr_flags |= ELF_F_DIRTY;
 
+  /* The name might have changed.  */
+  __libelf_scnname_free (elf);
+
   result = 1;
 
  out:
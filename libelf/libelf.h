@@ -152,6 +152,23 @@ enum
 #define ELF_CHF_FORCE ELF_CHF_FORCE
 };
 
+/* Advice for elf_scnadvise.  */
+enum
+{
+  ELF_ADV_NORMAL = 0,		/* No special treatment.  */
+#define ELF_ADV_NORMAL ELF_ADV_NORMAL
+  ELF_ADV_RANDOM,		/* Expect access in random order.  */
+#define ELF_ADV_RANDOM ELF_ADV_RANDOM
+  ELF_ADV_SEQUENTIAL,		/* Expect access in sequential order.  */
+#define ELF_ADV_SEQUENTIAL ELF_ADV_SEQUENTIAL
+  ELF_ADV_WILLNEED,		/* Expect access soon, start reading.  */
+#define ELF_ADV_WILLNEED ELF_ADV_WILLNEED
+  ELF_ADV_POPULATE,		/* Read in and map all pages now.  */
+#define ELF_ADV_POPULATE ELF_ADV_POPULATE
+  ELF_ADV_HUGEPAGE		/* Use huge pages if possible.  */
+#define ELF_ADV_HUGEPAGE ELF_ADV_HUGEPAGE
+};
+
 /* Identification values for recognized object files.  */
 typedef enum
 {
@@ -266,6 +283,16 @@ extern size_t elf_ndxscn (Elf_Scn *__scn);
 /* Get section with next section index.  */
 extern Elf_Scn *elf_nextscn (Elf *__elf, Elf_Scn *__scn);
 
+/* Get the first section with name NAME, NULL if there is none.  For
+   files opened for reading the lookup uses a hash table which is built
+   on the first call.  */
+extern Elf_Scn *elf_getscnbyname (Elf *__elf, const char *__name);
+
+/* Get the next section after SCN with name NAME, the first one if SCN
+   is NULL.  Returns NULL if there is no such section.  */
+extern Elf_Scn *elf_nextscnbyname (Elf *__elf, Elf_Scn *__scn,
+				   const char *__name);
+
 /* Create a new section and append it at the end of the table.  */
 extern Elf_Scn *elf_newscn (Elf *__elf);
 
@@ -392,6 +419,15 @@ extern Elf_Data *elf_rawdata (Elf_Scn *__scn, Elf_Data *__data);
 /* Create new data descriptor for section SCN.  */
 extern Elf_Data *elf_newdata (Elf_Scn *__scn);
 
+/* Create new data descriptor for section SCN holding the uninterpreted
+   file contents of section SRC of another ELF descriptor.  When SCN's
+   file is written the data is copied directly from SRC's file, if
+   possible without passing through user space.  Changes made in memory
+   to SRC's data are not copied.  The file of SRC must stay open until
+   the file of SCN is written.  d_buf of the result is NULL if SRC's
+   file isn't mmapped.  */
+extern Elf_Data *elf_newdata_copy (Elf_Scn *__scn, Elf_Scn *__src);
+
 /* Get data translated from a chunk of the file contents as section data
    would be for TYPE.  The resulting Elf_Data pointer is valid until
    elf_end (ELF) is called.  */
@@ -413,6 +449,17 @@ extern int64_t elf_getaroff (Elf *__elf);
 /* Select archive element at OFFSET.  */
 extern size_t elf_rand (Elf *__elf, size_t __offset);
 
+/* Get the number of members of archive ELF, not counting the symbol
+   index and the long name table.  The member table is read in one go
+   on the first call.  Returns zero on success, -1 otherwise.  */
+extern int elf_getarmemnum (Elf *__elf, size_t *__dst);
+
+/* Return a descriptor for member NDX of archive ELF, counted as for
+   elf_getarmemnum.  CMD must be one of the ELF_C_READ* commands.  The
+   current archive position used by elf_begin and elf_next is not
+   changed, so this can be called for different members concurrently.  */
+extern Elf *elf_begin_armem (Elf *__elf, size_t __ndx, Elf_Cmd __cmd);
+
 /* Get symbol table of archive.  */
 extern Elf_Arsym *elf_getarsym (Elf *__elf, size_t *__narsyms);
 
@@ -420,6 +467,13 @@ extern Elf_Arsym *elf_getarsym (Elf *__elf, size_t *__narsyms);
 /* Control ELF descriptor.  */
 extern int elf_cntl (Elf *__elf, Elf_Cmd __cmd);
 
+/* Tell the system how the file contents of section SCN are going to be
+   used, ADVICE is one of the ELF_ADV_* values.  This only has an effect
+   if the file is mmapped or the section data wasn't read yet.  Since it
+   is only a hint, failure of the system to follow it is not reported.
+   Returns -1 if SCN or ADVICE is invalid, zero otherwise.  */
+extern int elf_scnadvise (Elf_Scn *__scn, int __advice);
+
 /* Retrieve uninterpreted file contents.  */
 extern char *elf_rawfile (Elf *__elf, size_t *__nbytes);
 
@@ -38,6 +38,7 @@
 #include <gelf.h>
 
 #include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -85,7 +86,8 @@ enum
 {
   ELF_F_MMAPPED = 0x40,
   ELF_F_MALLOCED = 0x80,
-  ELF_F_FILEDATA = 0x100
+  ELF_F_FILEDATA = 0x100,
+  ELF_F_FILECOPY = 0x200
 };
 
 
@@ -168,6 +170,10 @@ typedef struct Elf_Data_List
   Elf_Data_Scn data;
   struct Elf_Data_List *next;
   int flags;
+  int copy_fd;			/* If ELF_F_FILECOPY is set in flags the
+				   data is written by copying it from
+				   this file...  */
+  off_t copy_offset;		/* ...at this offset.  */
 } Elf_Data_List;
 
 
@@ -275,6 +281,16 @@ typedef struct Elf_Data_Chunk
 } Elf_Data_Chunk;
 
 
+/* Entry in the table of archive members.  */
+typedef struct
+{
+  off_t offset;			/* Offset of the member's header.  */
+  Elf_Arhdr arhdr;		/* Converted header of the member.  */
+  char ar_name[16];		/* NUL terminated short name.  */
+  char raw_name[17];		/* NUL terminated raw name.  */
+} Elf_ArMem;
+
+
 /* The ELF descriptor.  */
 struct Elf
 {
@@ -336,6 +352,11 @@ struct Elf
       int shdr_malloced;	/* Nonzero if shdr array was allocated.  */
       off_t sizestr_offset;	/* Offset of the size string in the parent
 				   if this is an archive member.  */
+      unsigned char *scns_lazy; /* Bitmap of the sections set up in the
+				   first block of the section list, NULL
+				   if they are all set up.  */
+      struct Elf_ScnNameTab *scns_byname; /* Sections by name, see
+				   elf_getscnbyname.  */
     } elf;
 
     struct
@@ -355,6 +376,11 @@ struct Elf
       int shdr_malloced;	/* Nonzero if shdr array was allocated.  */
       off_t sizestr_offset;	/* Offset of the size string in the parent
 				   if this is an archive member.  */
+      unsigned char *scns_lazy; /* Bitmap of the sections set up in the
+				   first block of the section list, NULL
+				   if they are all set up.  */
+      struct Elf_ScnNameTab *scns_byname; /* Sections by name, see
+				   elf_getscnbyname.  */
       Elf32_Ehdr ehdr_mem;	/* Memory used for ELF header when not
 				   mmaped.  */
       char __e32scnspad[sizeof (Elf64_Ehdr) - sizeof (Elf32_Ehdr)];
@@ -380,6 +406,11 @@ struct Elf
       int shdr_malloced;	/* Nonzero if shdr array was allocated.  */
       off_t sizestr_offset;	/* Offset of the size string in the parent
 				   if this is an archive member.  */
+      unsigned char *scns_lazy; /* Bitmap of the sections set up in the
+				   first block of the section list, NULL
+				   if they are all set up.  */
+      struct Elf_ScnNameTab *scns_byname; /* Sections by name, see
+				   elf_getscnbyname.  */
       Elf64_Ehdr ehdr_mem;	/* Memory used for ELF header when not
 				   mmaped.  */
 
@@ -403,12 +434,74 @@ struct Elf
       char ar_name[16];		/* NUL terminated ar_name of elf_ar_hdr.  */
       char raw_name[17];	/* This is a buffer for the NUL terminated
 				   named raw_name used in the elf_ar_hdr.  */
+      Elf_ArMem *members;	/* Table of all members, NULL if not yet
+				   built.  */
+      size_t members_num;	/* Number of entries in `members'.  */
     } ar;
   } state;
 
   /* There absolutely never must be anything following the union.  */
 };
 
+/* For files which are only read, see file_read_elf, the entries of
+   the section array, except the zeroth, are not initialized by
+   elf_begin.  Which of them are set up is recorded in the scns_lazy
+   bitmap.  Only the first block of the section list is handled like
+   this, so the array index is the section index.  */
+static inline bool
+__libelf_scn_pending (Elf *elf, Elf_ScnList *list, size_t idx)
+{
+  unsigned char *lazy = elf->state.elf.scns_lazy;
+  return (lazy != NULL && list == &elf->state.elf32.scns
+	  && (lazy[idx / CHAR_BIT] & (1 << (idx % CHAR_BIT))) == 0);
+}
+
+/* Return section IDX of LIST, setting it up first if necessary.  The
+   caller must hold the write lock.  */
+static inline Elf_Scn *
+__libelf_scn_setup (Elf *elf, Elf_ScnList *list, size_t idx)
+{
+  Elf_Scn *scn = &list->data[idx];
+  if (__libelf_scn_pending (elf, list, idx))
+    {
+      memset (scn, '\0', sizeof (Elf_Scn));
+      scn->index = idx;
+      scn->elf = elf;
+      scn->list = list;
+      elf->state.elf.scns_lazy[idx / CHAR_BIT] |= 1 << (idx % CHAR_BIT);
+    }
+  return scn;
+}
+
+/* Likewise, for callers holding only the read lock.  Another reader
+   might be using the section already, so it is set up under the write
+   lock, which is then traded back for the read lock.  A section once
+   set up stays so, the pointer returned remains valid.  */
+static inline Elf_Scn *
+__libelf_scn_setup_rdlock (Elf *elf, Elf_ScnList *list, size_t idx)
+{
+  if (__libelf_scn_pending (elf, list, idx))
+    {
+      rwlock_unlock (elf->lock);
+      rwlock_wrlock (elf->lock);
+      (void) __libelf_scn_setup (elf, list, idx);
+      rwlock_unlock (elf->lock);
+      rwlock_rdlock (elf->lock);
+    }
+  return &list->data[idx];
+}
+
+/* Files which are only read cannot have their section headers
+   changed behind our back in a way which matters here, so only for
+   them a table of the sections by name is worth building, see
+   elf_getscnbyname.  */
+static inline bool
+__libelf_scnname_indexed (Elf *elf)
+{
+  return (elf->cmd == ELF_C_READ || elf->cmd == ELF_C_READ_MMAP
+	  || elf->cmd == ELF_C_READ_MMAP_PRIVATE);
+}
+
 /* Type of the conversion functions.  These functions will convert the
    byte order.  */
 typedef void (*xfct_t) (void *, const void *, size_t, int);
@@ -484,6 +577,13 @@ extern void __libelf_seterrno (int value) internal_function;
 /* Get the next archive header.  */
 extern int __libelf_next_arhdr_wrlock (Elf *elf) internal_function;
 
+/* Build the table of archive members if not done already.  */
+extern int __libelf_armem_index_wrlock (Elf *elf) internal_function;
+
+/* Free the table of sections by name.  Must be called whenever section
+   names might change, with the write lock held.  */
+extern void __libelf_scnname_free (Elf *elf) internal_function;
+
 /* Read all of the file associated with the descriptor.  */
 extern char *__libelf_readall (Elf *elf) internal_function;
 
@@ -548,6 +648,9 @@ extern Elf_Scn *__elf_getscn_internal (Elf *__elf, size_t __index)
      attribute_hidden;
 extern Elf_Scn *__elf_nextscn_internal (Elf *__elf, Elf_Scn *__scn)
      attribute_hidden;
+extern Elf_Scn *__elf_nextscnbyname_internal (Elf *__elf, Elf_Scn *__scn,
+					     const char *__name)
+     attribute_hidden;
 extern int __elf_scnshndx_internal (Elf_Scn *__scn) attribute_hidden;
 extern Elf_Data *__elf_getdata_internal (Elf_Scn *__scn, Elf_Data *__data)
      attribute_hidden;
@@ -555,6 +658,7 @@ extern Elf_Data *__elf_getdata_rdlock (Elf_Scn *__scn, Elf_Data *__data)
      internal_function;
 extern Elf_Data *__elf_rawdata_internal (Elf_Scn *__scn, Elf_Data *__data)
      attribute_hidden;
+extern Elf_Data *__elf_newdata_internal (Elf_Scn *__scn) attribute_hidden;
 /* Should be called to setup first section data element if
    data_list_rear is NULL and we know data_read is set and there is
    raw data available.  Might upgrade the ELF lock from a read to a
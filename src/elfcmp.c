@@ -22,18 +22,23 @@
 
 #include <argp.h>
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <error.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <locale.h>
 #include <libintl.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/param.h>
 
 #include <system.h>
+#include <sha1.h>
 #include "../libelf/elf-knowledge.h"
 #include "../libebl/libeblP.h"
 
@@ -55,6 +60,8 @@ ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
 #define OPT_GAPS		0x100
 #define OPT_HASH_INEXACT	0x101
 #define OPT_IGNORE_BUILD_ID	0x102
+#define OPT_MANIFEST		0x103
+#define OPT_WRITE_MANIFEST	0x104
 
 /* Definitions of arguments for argp functions.  */
 static const struct argp_option options[] =
@@ -68,6 +75,10 @@ static const struct argp_option options[] =
   { "ignore-build-id", OPT_IGNORE_BUILD_ID, NULL, 0,
     N_("Ignore differences in build ID"), 0 },
   { "quiet", 'q', NULL, 0, N_("Output nothing; yield exit status only"), 0 },
+  { "manifest", OPT_MANIFEST, "MANIFEST", 0,
+    N_("Compare FILE with the section digests in MANIFEST instead of reading a first file"), 0 },
+  { "write-manifest", OPT_WRITE_MANIFEST, "MANIFEST", 0,
+    N_("Write the section digests of FILE1 to MANIFEST; without FILE2 nothing is compared"), 0 },
 
   { NULL, 0, NULL, 0, N_("Miscellaneous:"), 0 },
   { NULL, 0, NULL, 0, NULL, 0 }
@@ -78,15 +89,23 @@ static const char doc[] = N_("\
 Compare relevant parts of two ELF files for equality.");
 
 /* Strings for arguments in help texts.  */
-static const char args_doc[] = N_("FILE1 FILE2");
+static const char args_doc[] = N_("FILE1 FILE2\n--manifest=MANIFEST FILE\n\
+--write-manifest=MANIFEST FILE1 [FILE2]");
 
 /* Prototype for option handler.  */
 static error_t parse_opt (int key, char *arg, struct argp_state *state);
 
+/* Data structure to communicate with argp functions.  */
+static const struct argp_child argp_children[] =
+  {
+    { &jobs_argp, 0, NULL, 0 },
+    { NULL, 0, NULL, 0 }
+  };
+
 /* Data structure to communicate with argp functions.  */
 static struct argp argp =
 {
-  options, parse_opt, args_doc, doc, NULL, NULL, NULL
+  options, parse_opt, args_doc, doc, argp_children, NULL, NULL
 };
 
 
@@ -118,8 +137,54 @@ static bool hash_inexact;
 /* True iff build ID notes should be ignored.  */
 static bool ignore_build_id;
 
+/* Manifest to read instead of the first file, if any.  */
+static const char *manifest_in;
+
+/* Manifest to write for the first file, if any.  */
+static const char *manifest_out;
+
 static bool hash_content_equivalent (size_t entsize, Elf_Data *, Elf_Data *);
 
+/* The parts of a section which are compared, with a digest of the
+   content.  */
+struct scn_digest
+{
+  size_t ndx;
+  char *name;
+  GElf_Shdr shdr;
+  /* False for sections whose content is ignored.  */
+  bool compare;
+  /* True if NOTE_DIGEST is set, for note sections with a build ID.  */
+  bool has_note_digest;
+  unsigned char digest[SHA1_DIGEST_SIZE];
+  /* Digest of the notes without the build ID bits.  */
+  unsigned char note_digest[SHA1_DIGEST_SIZE];
+  /* Content still to be hashed by digest_sections.  */
+  Elf_Data *data;
+};
+
+/* The parts of a file which are compared.  */
+struct elf_digests
+{
+  GElf_Ehdr ehdr;
+  size_t shnum;
+  size_t phnum;
+  GElf_Phdr *phdrs;
+  size_t nscns;
+  struct scn_digest *scns;
+  /* Next section for a digest_sections thread.  */
+  size_t next;
+};
+
+static void describe_file (Elf *elf, Ebl *ebl, const char *fname,
+			   struct elf_digests *d);
+static void compute_digests (Elf *elf, Ebl *ebl, const char *fname,
+			     struct elf_digests *d);
+static void write_manifest (const char *fname, struct elf_digests *d);
+static void read_manifest (const char *fname, struct elf_digests *d);
+static void free_digests (struct elf_digests *d);
+static int compare_manifest (const char *manifest, const char *fname);
+
 
 int
 main (int argc, char *argv[])
@@ -137,8 +202,13 @@ main (int argc, char *argv[])
   int remaining;
   (void) argp_parse (&argp, argc, argv, 0, &remaining, NULL);
 
-  /* We expect exactly two non-option parameters.  */
-  if (unlikely (remaining + 2 != argc))
+  /* We expect exactly two non-option parameters.  With a manifest
+     to read there is only the second file, with one to write the
+     second file is optional.  */
+  if (unlikely (manifest_in != NULL
+		? remaining + 1 != argc
+		: (remaining + 2 != argc
+		   && (manifest_out == NULL || remaining + 1 != argc))))
     {
       fputs (gettext ("Invalid number of parameters.\n"), stderr);
       argp_help (&argp, stderr, ARGP_HELP_SEE, program_invocation_short_name);
@@ -148,6 +218,17 @@ main (int argc, char *argv[])
   if (quiet)
     verbose = false;
 
+  if (manifest_in != NULL)
+    {
+      /* The manifest has no content to compare in detail.  */
+      if (gaps != gaps_ignore || hash_inexact || manifest_out != NULL)
+	error (2, 0, gettext ("\
+--manifest cannot be used with --gaps=match, --hash-inexact or --write-manifest"));
+
+      elf_version (EV_CURRENT);
+      return compare_manifest (manifest_in, argv[remaining]);
+    }
+
   /* Comparing the files is done in two phases:
      1. compare all sections.  Sections which are irrelevant (i.e., if
 	strip would remove them) are ignored.  Some section types are
@@ -163,6 +244,23 @@ main (int argc, char *argv[])
   Ebl *ebl1;
   Elf *elf1 = open_file (fname1, &fd1, &ebl1);
 
+  if (manifest_out != NULL)
+    {
+      struct elf_digests d1;
+      describe_file (elf1, ebl1, fname1, &d1);
+      compute_digests (elf1, ebl1, fname1, &d1);
+      write_manifest (manifest_out, &d1);
+      free_digests (&d1);
+
+      if (remaining + 1 == argc)
+	{
+	  elf_end (elf1);
+	  ebl_closebackend (ebl1);
+	  close (fd1);
+	  return 0;
+	}
+    }
+
   const char *const fname2 = argv[remaining + 1];
   int fd2;
   Ebl *ebl2;
@@ -717,6 +815,14 @@ parse_opt (int key, char *arg,
       ignore_build_id = true;
       break;
 
+    case OPT_MANIFEST:
+      manifest_in = arg;
+      break;
+
+    case OPT_WRITE_MANIFEST:
+      manifest_out = arg;
+      break;
+
     default:
       return ARGP_ERR_UNKNOWN;
     }
@@ -906,4 +1012,742 @@ hash_content_equivalent (size_t entsize, Elf_Data *data1, Elf_Data *data2)
 }
 
 
+/* Compute the digest of LEN bytes at BUF.  */
+static void
+digest_bytes (const void *buf, size_t len, unsigned char *digest)
+{
+  struct sha1_ctx ctx;
+  sha1_init_ctx (&ctx);
+  sha1_process_bytes (buf, len, &ctx);
+  sha1_finish_ctx (&ctx, digest);
+}
+
+
+/* Add VALUE to CTX in a byte order which does not depend on the host.  */
+static void
+digest_value (uint64_t value, struct sha1_ctx *ctx)
+{
+  unsigned char buf[8];
+  for (size_t cnt = 0; cnt < sizeof buf; ++cnt)
+    buf[cnt] = value >> (8 * cnt);
+  sha1_process_bytes (buf, sizeof buf, ctx);
+}
+
+
+/* Return an array telling for each of the NSYMS symbols in the symbol
+   table with index SCNNDX whether a copy relocation uses it.  This is
+   search_for_copy_reloc for all symbols in one pass.  */
+static bool *
+copy_reloc_symbols (Ebl *ebl, size_t scnndx, size_t nsyms)
+{
+  bool *used = xcalloc (nsyms ?: 1, sizeof used[0]);
+
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (ebl->elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	error (2, 0,
+	       gettext ("cannot get section header of section %zu: %s"),
+	       elf_ndxscn (scn), elf_errmsg (-1));
+
+      if ((shdr->sh_type != SHT_REL && shdr->sh_type != SHT_RELA)
+	  || shdr->sh_link != scnndx || shdr->sh_entsize == 0)
+	continue;
+
+      Elf_Data *data = elf_getdata (scn, NULL);
+      if (data == NULL)
+	error (2, 0,
+	       gettext ("cannot get content of section %zu: %s"),
+	       elf_ndxscn (scn), elf_errmsg (-1));
+
+      for (int ndx = 0; ndx < (int) (shdr->sh_size / shdr->sh_entsize);
+	   ++ndx)
+	{
+	  GElf_Rela rela_mem;
+	  GElf_Rela *rela;
+	  if (shdr->sh_type == SHT_REL)
+	    {
+	      GElf_Rel rel_mem;
+	      GElf_Rel *rel = gelf_getrel (data, ndx, &rel_mem);
+	      rela = rel == NULL ? NULL : &rela_mem;
+	      if (rel != NULL)
+		rela->r_info = rel->r_info;
+	    }
+	  else
+	    rela = gelf_getrela (data, ndx, &rela_mem);
+	  if (rela == NULL)
+	    error (2, 0, gettext ("cannot get relocation: %s"),
+		   elf_errmsg (-1));
+
+	  size_t symndx = GELF_R_SYM (rela->r_info);
+	  if (symndx < nsyms
+	      && ebl_copy_reloc_p (ebl, GELF_R_TYPE (rela->r_info)))
+	    used[symndx] = true;
+	}
+    }
+
+  return used;
+}
+
+
+/* Compute the digest of a symbol table the way the main comparison loop
+   looks at it: symbols are compared by name rather than string table
+   offset, and the size of an undefined symbol only matters if a copy
+   relocation uses it.  */
+static void
+symtab_digest (Ebl *ebl, const char *fname, struct scn_digest *sd,
+	       Elf_Data *data)
+{
+  if (sd->shdr.sh_entsize == 0)
+    error (2, 0, gettext ("symbol table [%zu] in '%s' has zero sh_entsize"),
+	   sd->ndx, fname);
+
+  size_t nsyms = sd->shdr.sh_size / sd->shdr.sh_entsize;
+  bool *copied = copy_reloc_symbols (ebl, sd->ndx, nsyms);
+
+  struct sha1_ctx ctx;
+  sha1_init_ctx (&ctx);
+  for (int ndx = 0; ndx < (int) nsyms; ++ndx)
+    {
+      GElf_Sym sym_mem;
+      GElf_Sym *sym = gelf_getsym (data, ndx, &sym_mem);
+      if (sym == NULL)
+	error (2, 0, gettext ("cannot get symbol in '%s': %s"),
+	       fname, elf_errmsg (-1));
+
+      const char *name = elf_strptr (ebl->elf, sd->shdr.sh_link,
+				     sym->st_name);
+      if (name == NULL)
+	name = "";
+      sha1_process_bytes (name, strlen (name) + 1, &ctx);
+      digest_value (sym->st_value, &ctx);
+      digest_value (sym->st_shndx != SHN_UNDEF || copied[ndx]
+		    ? sym->st_size : 0, &ctx);
+      digest_value (sym->st_info | sym->st_other << 8
+		    | (uint64_t) sym->st_shndx << 16, &ctx);
+    }
+  sha1_finish_ctx (&ctx, sd->digest);
+
+  free (copied);
+}
+
+
+/* Compute the digest of a note section.  If it has a GNU build ID note
+   also compute NOTE_DIGEST, which leaves out the build ID bits but not
+   their length, for --ignore-build-id.  */
+static void
+note_digest (struct scn_digest *sd, Elf_Data *data)
+{
+  digest_bytes (data->d_buf, data->d_size, sd->digest);
+
+  struct sha1_ctx ctx;
+  sha1_init_ctx (&ctx);
+  size_t start = 0;
+  size_t off = 0;
+  GElf_Nhdr nhdr;
+  size_t name_offset;
+  size_t desc_offset;
+  while (off < data->d_size
+	 && (off = gelf_getnote (data, off, &nhdr,
+				 &name_offset, &desc_offset)) > 0)
+    if (nhdr.n_type == NT_GNU_BUILD_ID
+	&& nhdr.n_namesz == sizeof "GNU"
+	&& memcmp (data->d_buf + name_offset, "GNU", sizeof "GNU") == 0)
+      {
+	sha1_process_bytes (data->d_buf + start, desc_offset - start, &ctx);
+	start = desc_offset + nhdr.n_descsz;
+	sd->has_note_digest = true;
+      }
+
+  if (sd->has_note_digest)
+    {
+      if (start < data->d_size)
+	sha1_process_bytes (data->d_buf + start, data->d_size - start, &ctx);
+      sha1_finish_ctx (&ctx, sd->note_digest);
+    }
+}
+
+
+/* Fill in D with the headers of ELF and the sections the main
+   comparison loop looks at.  The digests are computed separately by
+   compute_digests, which is not needed if the headers differ.  */
+static void
+describe_file (Elf *elf, Ebl *ebl, const char *fname, struct elf_digests *d)
+{
+  memset (d, '\0', sizeof *d);
+
+  if (gelf_getehdr (elf, &d->ehdr) == NULL)
+    error (2, 0, gettext ("cannot get ELF header of '%s': %s"),
+	   fname, elf_errmsg (-1));
+  if (unlikely (elf_getshdrnum (elf, &d->shnum) != 0))
+    error (2, 0, gettext ("cannot get section count of '%s': %s"),
+	   fname, elf_errmsg (-1));
+  if (unlikely (elf_getphdrnum (elf, &d->phnum) != 0))
+    error (2, 0, gettext ("cannot get program header count of '%s': %s"),
+	   fname, elf_errmsg (-1));
+
+  d->phdrs = xmalloc ((d->phnum ?: 1) * sizeof d->phdrs[0]);
+  for (size_t ndx = 0; ndx < d->phnum; ++ndx)
+    if (gelf_getphdr (elf, ndx, &d->phdrs[ndx]) == NULL)
+      error (2, 0,
+	     gettext ("cannot get program header entry %d of '%s': %s"),
+	     (int) ndx, fname, elf_errmsg (-1));
+
+  d->scns = xmalloc ((d->shnum ?: 1) * sizeof d->scns[0]);
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	error (2, 0,
+	       gettext ("cannot get section header of section %zu: %s"),
+	       elf_ndxscn (scn), elf_errmsg (-1));
+      const char *sname = elf_strptr (elf, d->ehdr.e_shstrndx,
+				      shdr->sh_name);
+      if (ebl_section_strip_p (ebl, &d->ehdr, shdr, sname, true, false))
+	continue;
+
+      struct scn_digest *sd = &d->scns[d->nscns++];
+      sd->ndx = elf_ndxscn (scn);
+      sd->name = sname == NULL ? NULL : xstrdup (sname);
+      sd->shdr = *shdr;
+      sd->compare = (sname == NULL
+		     || (strcmp (sname, ".gnu_debuglink") != 0
+			 && strcmp (sname, ".gnu.prelink_undo") != 0));
+      sd->has_note_digest = false;
+      sd->data = NULL;
+    }
+}
+
+
+/* Thread function hashing the plain content of sections.  Each thread
+   takes the next section which is not done yet.  */
+static void *
+digest_sections (void *arg)
+{
+  struct elf_digests *d = arg;
+  size_t cnt;
+  while ((cnt = __atomic_fetch_add (&d->next, 1, __ATOMIC_RELAXED))
+	 < d->nscns)
+    {
+      struct scn_digest *sd = &d->scns[cnt];
+      if (sd->data != NULL)
+	digest_bytes (sd->data->d_buf, sd->data->d_size, sd->digest);
+    }
+  return NULL;
+}
+
+
+/* Compute the digests of the sections in D.  Symbol tables and notes
+   are hashed first, the content of the other sections then in several
+   threads with --jobs.  */
+static void
+compute_digests (Elf *elf, Ebl *ebl, const char *fname,
+		 struct elf_digests *d)
+{
+  size_t nplain = 0;
+  for (size_t cnt = 0; cnt < d->nscns; ++cnt)
+    {
+      struct scn_digest *sd = &d->scns[cnt];
+      sd->data = NULL;
+      if (! sd->compare)
+	continue;
+
+      /* Symbol tables and notes are looked at entry by entry.  The
+	 content of other sections is hashed as it is in the file, so
+	 the digest does not depend on the byte order of the machine.  */
+      Elf_Scn *scn = elf_getscn (elf, sd->ndx);
+      Elf_Data *data;
+      switch (sd->shdr.sh_type)
+	{
+	case SHT_DYNSYM:
+	case SHT_SYMTAB:
+	case SHT_NOTE:
+	case SHT_NOBITS:
+	  data = elf_getdata (scn, NULL);
+	  break;
+
+	default:
+	  data = elf_rawdata (scn, NULL);
+	  break;
+	}
+      if (data == NULL)
+	error (2, 0,
+	       gettext ("cannot get content of section %zu in '%s': %s"),
+	       sd->ndx, fname, elf_errmsg (-1));
+
+      switch (sd->shdr.sh_type)
+	{
+	case SHT_DYNSYM:
+	case SHT_SYMTAB:
+	  symtab_digest (ebl, fname, sd, data);
+	  break;
+
+	case SHT_NOTE:
+	  note_digest (sd, data);
+	  break;
+
+	case SHT_NOBITS:
+	  /* Only the size is compared.  */
+	  {
+	    struct sha1_ctx ctx;
+	    sha1_init_ctx (&ctx);
+	    digest_value (data->d_size, &ctx);
+	    sha1_finish_ctx (&ctx, sd->digest);
+	  }
+	  break;
+
+	default:
+	  sd->data = data;
+	  ++nplain;
+	  break;
+	}
+    }
+
+  size_t nthreads = MAX (1, MIN ((size_t) workpool_jobs, nplain));
+  pthread_t threads[nthreads];
+  bool started[nthreads];
+  d->next = 0;
+  for (size_t t = 1; t < nthreads; ++t)
+    started[t] = pthread_create (&threads[t], NULL,
+				 digest_sections, d) == 0;
+  digest_sections (d);
+  for (size_t t = 1; t < nthreads; ++t)
+    if (started[t])
+      pthread_join (threads[t], NULL);
+
+  for (size_t cnt = 0; cnt < d->nscns; ++cnt)
+    d->scns[cnt].data = NULL;
+}
+
+
+static void
+free_digests (struct elf_digests *d)
+{
+  for (size_t cnt = 0; cnt < d->nscns; ++cnt)
+    free (d->scns[cnt].name);
+  free (d->scns);
+  free (d->phdrs);
+}
+
+
+/* First line of a manifest.  */
+#define MANIFEST_MAGIC "elfcmp manifest 1"
+
+static void
+print_digest (FILE *fp, bool present, const unsigned char *digest)
+{
+  putc (' ', fp);
+  if (! present)
+    putc ('-', fp);
+  else
+    for (size_t cnt = 0; cnt < SHA1_DIGEST_SIZE; ++cnt)
+      fprintf (fp, "%02x", digest[cnt]);
+}
+
+/* Write the headers and section digests in D to the manifest FNAME.
+   It is a text file with one line for the ELF header, each program
+   header and each section which is compared.  Numbers are in hex, the
+   section name is the rest of its line.  */
+static void
+write_manifest (const char *fname, struct elf_digests *d)
+{
+  FILE *fp = fopen (fname, "w");
+  if (fp == NULL)
+    error (2, errno, gettext ("cannot create '%s'"), fname);
+
+  fputs (MANIFEST_MAGIC "\nehdr ", fp);
+  for (size_t cnt = 0; cnt < EI_NIDENT; ++cnt)
+    fprintf (fp, "%02x", d->ehdr.e_ident[cnt]);
+  fprintf (fp, " %x %x %x %" PRIx64 " %" PRIx64 " %x %x %x %x %zx %zx\n",
+	   d->ehdr.e_type, d->ehdr.e_machine, d->ehdr.e_version,
+	   d->ehdr.e_entry, d->ehdr.e_phoff, d->ehdr.e_flags,
+	   d->ehdr.e_ehsize, d->ehdr.e_phentsize, d->ehdr.e_shentsize,
+	   d->shnum, d->phnum);
+
+  for (size_t ndx = 0; ndx < d->phnum; ++ndx)
+    {
+      GElf_Phdr *phdr = &d->phdrs[ndx];
+      fprintf (fp, "phdr %x %x %" PRIx64 " %" PRIx64 " %" PRIx64
+	       " %" PRIx64 " %" PRIx64 " %" PRIx64 "\n",
+	       phdr->p_type, phdr->p_flags, phdr->p_offset, phdr->p_vaddr,
+	       phdr->p_paddr, phdr->p_filesz, phdr->p_memsz, phdr->p_align);
+    }
+
+  for (size_t cnt = 0; cnt < d->nscns; ++cnt)
+    {
+      struct scn_digest *sd = &d->scns[cnt];
+      GElf_Shdr *shdr = &sd->shdr;
+      fprintf (fp, "scn %zx %x %" PRIx64 " %" PRIx64 " %" PRIx64
+	       " %" PRIx64 " %x %x %" PRIx64 " %" PRIx64,
+	       sd->ndx, shdr->sh_type, shdr->sh_flags, shdr->sh_addr,
+	       shdr->sh_offset, shdr->sh_size, shdr->sh_link, shdr->sh_info,
+	       shdr->sh_addralign, shdr->sh_entsize);
+      print_digest (fp, sd->compare, sd->digest);
+      print_digest (fp, sd->has_note_digest, sd->note_digest);
+      fprintf (fp, " %s\n", sd->name ?: "");
+    }
+
+  if (ferror (fp) | (fclose (fp) != 0))
+    error (2, errno, gettext ("while writing '%s'"), fname);
+}
+
+
+/* Parse N hex numbers from *P into VALS.  Each is followed by a space
+   or the end of the line.  */
+static bool
+parse_numbers (char **p, uint64_t *vals, size_t n)
+{
+  for (size_t cnt = 0; cnt < n; ++cnt)
+    {
+      char *endp;
+      errno = 0;
+      vals[cnt] = strtoull (*p, &endp, 16);
+      if (endp == *p || ! isxdigit (**p)
+	  || (*endp != ' ' && *endp != '\0') || errno != 0)
+	return false;
+      *p = *endp == ' ' ? endp + 1 : endp;
+    }
+  return true;
+}
+
+/* Parse the LEN bytes in hex at *P into BUF.  A '-' means there are
+   none, which sets *PRESENT to false.  */
+static bool
+parse_hex (char **p, unsigned char *buf, size_t len, bool *present)
+{
+  *present = **p != '-';
+  if (! *present)
+    {
+      memset (buf, '\0', len);
+      *p += 1;
+    }
+  else
+    for (size_t cnt = 0; cnt < len; ++cnt)
+      {
+	unsigned int byte;
+	if (! isxdigit ((*p)[0]) || ! isxdigit ((*p)[1])
+	    || sscanf (*p, "%2x", &byte) != 1)
+	  return false;
+	buf[cnt] = byte;
+	*p += 2;
+      }
+  if (**p != ' ')
+    return false;
+  *p += 1;
+  return true;
+}
+
+/* Read the manifest FNAME written by write_manifest into D.  */
+static void
+read_manifest (const char *fname, struct elf_digests *d)
+{
+  FILE *fp = fopen (fname, "r");
+  if (fp == NULL)
+    error (2, errno, gettext ("cannot open '%s'"), fname);
+
+  memset (d, '\0', sizeof *d);
+
+  char *line = NULL;
+  size_t linelen = 0;
+  size_t lineno = 0;
+  size_t nphdrs = 0;
+  ssize_t n;
+  while ((n = getline (&line, &linelen, fp)) > 0)
+    {
+      ++lineno;
+      if (line[n - 1] != '\n')
+	goto invalid;
+      line[n - 1] = '\0';
+
+      char *p = line;
+      uint64_t vals[11];
+      bool present;
+      if (lineno == 1)
+	{
+	  if (strcmp (line, MANIFEST_MAGIC) != 0)
+	    goto invalid;
+	}
+      else if (lineno == 2)
+	{
+	  if (strncmp (p, "ehdr ", 5) != 0)
+	    goto invalid;
+	  p += 5;
+	  if (! parse_hex (&p, d->ehdr.e_ident, EI_NIDENT, &present)
+	      || ! present || ! parse_numbers (&p, vals, 11) || *p != '\0')
+	    goto invalid;
+	  d->ehdr.e_type = vals[0];
+	  d->ehdr.e_machine = vals[1];
+	  d->ehdr.e_version = vals[2];
+	  d->ehdr.e_entry = vals[3];
+	  d->ehdr.e_phoff = vals[4];
+	  d->ehdr.e_flags = vals[5];
+	  d->ehdr.e_ehsize = vals[6];
+	  d->ehdr.e_phentsize = vals[7];
+	  d->ehdr.e_shentsize = vals[8];
+	  d->shnum = vals[9];
+	  d->phnum = vals[10];
+	  if (d->shnum > SIZE_MAX / sizeof d->scns[0]
+	      || d->phnum > SIZE_MAX / sizeof d->phdrs[0])
+	    goto invalid;
+	  d->phdrs = xmalloc ((d->phnum ?: 1) * sizeof d->phdrs[0]);
+	  d->scns = xmalloc ((d->shnum ?: 1) * sizeof d->scns[0]);
+	}
+      else if (strncmp (p, "phdr ", 5) == 0)
+	{
+	  p += 5;
+	  if (nphdrs == d->phnum || d->nscns != 0
+	      || ! parse_numbers (&p, vals, 8) || *p != '\0')
+	    goto invalid;
+	  GElf_Phdr *phdr = &d->phdrs[nphdrs++];
+	  phdr->p_type = vals[0];
+	  phdr->p_flags = vals[1];
+	  phdr->p_offset = vals[2];
+	  phdr->p_vaddr = vals[3];
+	  phdr->p_paddr = vals[4];
+	  phdr->p_filesz = vals[5];
+	  phdr->p_memsz = vals[6];
+	  phdr->p_align = vals[7];
+	}
+      else if (strncmp (p, "scn ", 4) == 0)
+	{
+	  p += 4;
+	  if (d->nscns == d->shnum || ! parse_numbers (&p, vals, 10))
+	    goto invalid;
+	  struct scn_digest *sd = &d->scns[d->nscns++];
+	  sd->name = NULL;
+	  sd->data = NULL;
+	  sd->ndx = vals[0];
+	  memset (&sd->shdr, '\0', sizeof sd->shdr);
+	  sd->shdr.sh_type = vals[1];
+	  sd->shdr.sh_flags = vals[2];
+	  sd->shdr.sh_addr = vals[3];
+	  sd->shdr.sh_offset = vals[4];
+	  sd->shdr.sh_size = vals[5];
+	  sd->shdr.sh_link = vals[6];
+	  sd->shdr.sh_info = vals[7];
+	  sd->shdr.sh_addralign = vals[8];
+	  sd->shdr.sh_entsize = vals[9];
+	  if (! parse_hex (&p, sd->digest, SHA1_DIGEST_SIZE, &sd->compare)
+	      || ! parse_hex (&p, sd->note_digest, SHA1_DIGEST_SIZE,
+			      &sd->has_note_digest))
+	    goto invalid;
+	  sd->name = xstrdup (p);
+	}
+      else
+	goto invalid;
+    }
+
+  if (lineno < 2 || nphdrs != d->phnum || ferror (fp))
+    {
+    invalid:
+      error (2, 0, gettext ("invalid manifest '%s' at line %zu"),
+	     fname, lineno);
+    }
+
+  free (line);
+  fclose (fp);
+}
+
+
+/* Compare the headers in D1 and D2 in the same order and with the same
+   rules as main does.  */
+static int
+compare_headers (struct elf_digests *d1, struct elf_digests *d2,
+		 const char *fname1, const char *fname2)
+{
+  int result = 0;
+#define DIGEST_DIFFERENCE						      \
+  do									      \
+    {									      \
+      result = 1;							      \
+      if (! verbose)							      \
+	return result;							      \
+    }									      \
+  while (0)
+
+  GElf_Ehdr *ehdr1 = &d1->ehdr;
+  GElf_Ehdr *ehdr2 = &d2->ehdr;
+  if (unlikely (memcmp (ehdr1->e_ident, ehdr2->e_ident, EI_NIDENT) != 0
+		|| ehdr1->e_type != ehdr2->e_type
+		|| ehdr1->e_machine != ehdr2->e_machine
+		|| ehdr1->e_version != ehdr2->e_version
+		|| ehdr1->e_entry != ehdr2->e_entry
+		|| ehdr1->e_phoff != ehdr2->e_phoff
+		|| ehdr1->e_flags != ehdr2->e_flags
+		|| ehdr1->e_ehsize != ehdr2->e_ehsize
+		|| ehdr1->e_phentsize != ehdr2->e_phentsize
+		|| ehdr1->e_shentsize != ehdr2->e_shentsize
+		|| d1->phnum != d2->phnum))
+    {
+      if (! quiet)
+	error (0, 0, gettext ("%s %s diff: ELF header"), fname1, fname2);
+      DIGEST_DIFFERENCE;
+    }
+
+  if (unlikely (d1->shnum != d2->shnum))
+    {
+      if (! quiet)
+	error (0, 0, gettext ("%s %s diff: section count"), fname1, fname2);
+      DIGEST_DIFFERENCE;
+    }
+
+  if (unlikely (d1->phnum != d2->phnum))
+    {
+      if (! quiet)
+	error (0, 0, gettext ("%s %s diff: program header count"),
+	       fname1, fname2);
+      DIGEST_DIFFERENCE;
+    }
+
+  for (size_t cnt = 0; cnt < MIN (d1->nscns, d2->nscns); ++cnt)
+    {
+      struct scn_digest *sd1 = &d1->scns[cnt];
+      struct scn_digest *sd2 = &d2->scns[cnt];
+      GElf_Shdr *shdr1 = &sd1->shdr;
+      GElf_Shdr *shdr2 = &sd2->shdr;
+
+      if (unlikely (sd1->name == NULL || sd2->name == NULL
+		    || strcmp (sd1->name, sd2->name) != 0))
+	{
+	  if (! quiet)
+	    error (0, 0, gettext ("%s %s differ: section [%zu], [%zu] name"),
+		   fname1, fname2, sd1->ndx, sd2->ndx);
+	  DIGEST_DIFFERENCE;
+	}
+
+      if (! sd1->compare)
+	continue;
+
+      if (shdr1->sh_type != shdr2->sh_type
+	  || shdr1->sh_flags != shdr2->sh_flags
+	  || shdr1->sh_addr != shdr2->sh_addr
+	  || (shdr1->sh_offset != shdr2->sh_offset
+	      && (shdr1->sh_flags & SHF_ALLOC)
+	      && ehdr1->e_type != ET_REL)
+	  || shdr1->sh_size != shdr2->sh_size
+	  || shdr1->sh_link != shdr2->sh_link
+	  || shdr1->sh_info != shdr2->sh_info
+	  || shdr1->sh_addralign != shdr2->sh_addralign
+	  || shdr1->sh_entsize != shdr2->sh_entsize)
+	{
+	  if (! quiet)
+	    error (0, 0, gettext ("%s %s differ: section [%zu] '%s' header"),
+		   fname1, fname2, sd1->ndx, sd1->name);
+	  DIGEST_DIFFERENCE;
+	}
+    }
+
+  if (unlikely (d1->nscns != d2->nscns))
+    {
+      if (! quiet)
+	error (0, 0,
+	       gettext ("%s %s differ: unequal amount of important sections"),
+	       fname1, fname2);
+      DIGEST_DIFFERENCE;
+    }
+
+  for (size_t ndx = 0; ndx < MIN (d1->phnum, d2->phnum); ++ndx)
+    if (unlikely (memcmp (&d1->phdrs[ndx], &d2->phdrs[ndx],
+			  sizeof (GElf_Phdr)) != 0))
+      {
+	if (! quiet)
+	  error (0, 0, gettext ("%s %s differ: program header %d"),
+		 fname1, fname2, (int) ndx);
+	DIGEST_DIFFERENCE;
+      }
+
+  return result;
+}
+
+
+/* Compare the section digests in D1 and D2.  */
+static int
+compare_contents (struct elf_digests *d1, struct elf_digests *d2,
+		  const char *fname1, const char *fname2)
+{
+  int result = 0;
+
+  for (size_t cnt = 0; cnt < MIN (d1->nscns, d2->nscns); ++cnt)
+    {
+      struct scn_digest *sd1 = &d1->scns[cnt];
+      struct scn_digest *sd2 = &d2->scns[cnt];
+      if (! sd1->compare || ! sd2->compare
+	  || memcmp (sd1->digest, sd2->digest, SHA1_DIGEST_SIZE) == 0)
+	continue;
+
+      /* Build IDs may be the only difference.  */
+      bool build_id = (sd1->has_note_digest && sd2->has_note_digest
+		       && memcmp (sd1->note_digest, sd2->note_digest,
+				  SHA1_DIGEST_SIZE) == 0);
+      if (build_id && ignore_build_id)
+	continue;
+
+      if (! quiet)
+	{
+	  if (build_id)
+	    error (0, 0, gettext ("%s %s differ: build ID content"),
+		   fname1, fname2);
+	  else if (sd1->shdr.sh_type == SHT_SYMTAB
+	      || sd1->shdr.sh_type == SHT_DYNSYM)
+	    {
+	      if (sd1->ndx == sd2->ndx)
+		error (0, 0, gettext ("%s %s differ: symbol table [%zu]"),
+		       fname1, fname2, sd1->ndx);
+	      else
+		error (0, 0, gettext ("\
+%s %s differ: symbol table [%zu,%zu]"),
+		       fname1, fname2, sd1->ndx, sd2->ndx);
+	    }
+	  else if (sd1->ndx == sd2->ndx)
+	    error (0, 0, gettext ("%s %s differ: section [%zu] '%s' content"),
+		   fname1, fname2, sd1->ndx, sd1->name);
+	  else
+	    error (0, 0, gettext ("\
+%s %s differ: section [%zu,%zu] '%s' content"),
+		   fname1, fname2, sd1->ndx, sd2->ndx, sd1->name);
+	}
+      DIGEST_DIFFERENCE;
+    }
+
+  return result;
+#undef DIGEST_DIFFERENCE
+}
+
+
+/* Compare FNAME with the file described by MANIFEST.  The headers are
+   compared first, the section content is only hashed if they match or
+   all differences are wanted.  */
+static int
+compare_manifest (const char *manifest, const char *fname)
+{
+  struct elf_digests d1;
+  read_manifest (manifest, &d1);
+
+  int fd;
+  Ebl *ebl;
+  Elf *elf = open_file (fname, &fd, &ebl);
+  struct elf_digests d2;
+  describe_file (elf, ebl, fname, &d2);
+
+  int result = compare_headers (&d1, &d2, manifest, fname);
+  if (result == 0 || verbose)
+    {
+      compute_digests (elf, ebl, fname, &d2);
+      result |= compare_contents (&d1, &d2, manifest, fname);
+    }
+
+  free_digests (&d1);
+  free_digests (&d2);
+  elf_end (elf);
+  ebl_closebackend (ebl);
+  close (fd);
+
+  return result;
+}
+
+
 #include "debugpred.h"
@@ -834,7 +834,18 @@ process_file (const char *fname)
 	 copied as is.  The section header string table will be
 	 created later and the symbol table might be fixed up if
 	 necessary.  */
-      if (! adjust_names || ndx != shdrstrndx)
+      if (! get_section (ndx) && ndx != symtabndx
+	  && (! adjust_names || ndx != shdrstrndx))
+	{
+	  /* Nothing will change, let libelf copy the file contents
+	     directly when writing the new file.  */
+	  if (elf_newdata_copy (newscn, scn) == NULL)
+	    {
+	      error (0, 0, "Couldn't copy data for section %zd", ndx);
+	      return cleanup (-1);
+	    }
+	}
+      else if (! adjust_names || ndx != shdrstrndx)
 	{
 	  Elf_Data *data = elf_getdata (scn, NULL);
 	  if (data == NULL)
@@ -80,10 +80,17 @@ static const char args_doc[] = N_("FILE...");
 /* Prototype for option handler.  */
 static error_t parse_opt (int key, char *arg, struct argp_state *state);
 
+/* Parser children.  */
+static struct argp_child argp_children[] =
+  {
+    { &jobs_argp, 0, N_("Miscellaneous:"), 0 },
+    { NULL, 0, NULL, 0}
+  };
+
 /* Data structure to communicate with argp functions.  */
 static struct argp argp =
 {
-  options, parse_opt, args_doc, doc, NULL, NULL, NULL
+  options, parse_opt, args_doc, doc, argp_children, NULL, NULL
 };
 
 
@@ -95,6 +102,7 @@ static void process_elf_file (Elf *elf, const char *prefix, const char *suffix,
 			      const char *fname, size_t size, bool only_one);
 static void check_note_section (Ebl *ebl, GElf_Ehdr *ehdr,
 				GElf_Shdr *shdr, int idx);
+static bool file_done (void *arg, int result, FILE *data);
 
 
 /* Report an error.  */
@@ -123,10 +131,33 @@ static uint32_t shstrndx;
 /* Array to count references in section groups.  */
 static int *scnref;
 
+/* For each section the first section group following it which it is
+   a member of, built when first needed.  */
+static unsigned int *group_after;
+
 /* Numbers of sections and program headers.  */
 static unsigned int shnum;
 static unsigned int phnum;
 
+/* The ELF files and archive members are checked by a workpool, with
+   --jobs in parallel.  The checks of one file share too much state to
+   be split up further.  */
+static struct workpool *pool;
+
+/* Value of ERROR_COUNT after the last file was done.  */
+static unsigned int file_error_count;
+
+/* One ELF file to check.  */
+struct elf_job
+{
+  Elf *elf;
+  const char *prefix;
+  const char *suffix;
+  const char *fname;
+  size_t size;
+  bool only_one;
+};
+
 
 int
 main (int argc, char *argv[])
@@ -144,6 +175,8 @@ main (int argc, char *argv[])
   /* Before we start tell the ELF library which version we are using.  */
   elf_version (EV_CURRENT);
 
+  pool = workpool_begin (workpool_jobs);
+
   /* Now process all the files given at the command line.  */
   bool only_one = remaining + 1 == argc;
   do
@@ -152,6 +185,7 @@ main (int argc, char *argv[])
       int fd = open (argv[remaining], O_RDONLY);
       if (fd == -1)
 	{
+	  workpool_sync (pool);
 	  error (0, errno, gettext ("cannot open input file"));
 	  continue;
 	}
@@ -159,15 +193,19 @@ main (int argc, char *argv[])
       /* Create an `Elf' descriptor.  */
       Elf *elf = elf_begin (fd, ELF_C_READ_MMAP, NULL);
       if (elf == NULL)
-	ERROR (gettext ("cannot generate Elf descriptor: %s\n"),
-	       elf_errmsg (-1));
+	{
+	  workpool_sync (pool);
+	  ERROR (gettext ("cannot generate Elf descriptor: %s\n"),
+		 elf_errmsg (-1));
+	  file_error_count = error_count;
+	}
       else
 	{
-	  unsigned int prev_error_count = error_count;
 	  struct stat st;
 
 	  if (fstat (fd, &st) != 0)
 	    {
+	      workpool_sync (pool);
 	      printf ("cannot stat '%s': %m\n", argv[remaining]);
 	      close (fd);
 	      continue;
@@ -178,17 +216,23 @@ main (int argc, char *argv[])
 
 	  /* Now we can close the descriptor.  */
 	  if (elf_end (elf) != 0)
-	    ERROR (gettext ("error while closing Elf descriptor: %s\n"),
-		   elf_errmsg (-1));
+	    {
+	      workpool_sync (pool);
+	      ERROR (gettext ("error while closing Elf descriptor: %s\n"),
+		     elf_errmsg (-1));
+	    }
 
-	  if (prev_error_count == error_count && !be_quiet)
-	    puts (gettext ("No errors"));
+	  /* Whether there were errors is known once all the checks of
+	     the file are done.  */
+	  workpool_add (pool, NULL, file_done, NULL);
 	}
 
       close (fd);
     }
   while (++remaining < argc);
 
+  workpool_end (pool);
+
   return error_count != 0;
 }
 
@@ -241,6 +285,43 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\
 }
 
 
+static int
+elf_job_work (void *arg, FILE *data __attribute__ ((unused)))
+{
+  struct elf_job *job = arg;
+  unsigned int prev_error_count = error_count;
+
+  process_elf_file (job->elf, job->prefix, job->suffix, job->fname,
+		    job->size, job->only_one);
+
+  return error_count - prev_error_count;
+}
+
+
+static bool
+elf_job_done (void *arg, int result, FILE *data)
+{
+  /* Errors found in the parent are counted already.  */
+  if (data != NULL)
+    error_count += result;
+
+  free (arg);
+  return true;
+}
+
+
+static bool
+file_done (void *arg __attribute__ ((unused)),
+	   int result __attribute__ ((unused)),
+	   FILE *data __attribute__ ((unused)))
+{
+  if (file_error_count == error_count && !be_quiet)
+    puts (gettext ("No errors"));
+  file_error_count = error_count;
+  return true;
+}
+
+
 /* Process one file.  */
 static void
 process_file (int fd, Elf *elf, const char *prefix, const char *suffix,
@@ -252,8 +333,19 @@ process_file (int fd, Elf *elf, const char *prefix, const char *suffix,
   switch (kind)
     {
     case ELF_K_ELF:
-      /* Yes!  It's an ELF file.  */
-      process_elf_file (elf, prefix, suffix, fname, size, only_one);
+      {
+	/* Yes!  It's an ELF file.  The work is done before
+	   workpool_add returns, in this or a child process, so
+	   nothing has to be copied.  */
+	struct elf_job *job = xmalloc (sizeof *job);
+	job->elf = elf;
+	job->prefix = prefix;
+	job->suffix = suffix;
+	job->fname = fname;
+	job->size = size;
+	job->only_one = only_one;
+	workpool_add (pool, elf_job_work, elf_job_done, job);
+      }
       break;
 
     case ELF_K_AR:
@@ -295,14 +387,18 @@ process_file (int fd, Elf *elf, const char *prefix, const char *suffix,
 	    /* Get next archive element.  */
 	    cmd = elf_next (subelf);
 	    if (elf_end (subelf) != 0)
-	      ERROR (gettext (" error while freeing sub-ELF descriptor: %s\n"),
-		     elf_errmsg (-1));
+	      {
+		workpool_sync (pool);
+		ERROR (gettext (" error while freeing sub-ELF descriptor: %s\n"),
+		       elf_errmsg (-1));
+	      }
 	  }
       }
       break;
 
     default:
       /* We cannot do anything.  */
+      workpool_sync (pool);
       ERROR (gettext ("\
 Not an ELF file - it has the wrong magic bytes at the start\n"));
       break;
@@ -532,6 +628,40 @@ invalid number of program header table entries\n"));
 
 /* Check that there is a section group section with index < IDX which
    contains section IDX and that there is exactly one.  */
+static void
+find_group_after (Ebl *ebl)
+{
+  group_after = xcalloc (shnum, sizeof (unsigned int));
+
+  for (size_t cnt = 1; cnt < shnum; ++cnt)
+    {
+      Elf_Scn *scn = elf_getscn (ebl->elf, cnt);
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	/* We cannot get the section header so we cannot check it.
+	   The error to get the section header will be shown
+	   somewhere else.  */
+	continue;
+
+      if (shdr->sh_type != SHT_GROUP)
+	continue;
+
+      Elf_Data *data = elf_getdata (scn, NULL);
+      if (data == NULL || data->d_buf == NULL
+	  || data->d_size < sizeof (Elf32_Word))
+	/* Cannot check the section.  */
+	continue;
+
+      Elf32_Word *grpdata = (Elf32_Word *) data->d_buf;
+      for (size_t inner = 1; inner < data->d_size / sizeof (Elf32_Word);
+	   ++inner)
+	if (grpdata[inner] < cnt && group_after[grpdata[inner]] == 0)
+	  group_after[grpdata[inner]] = cnt;
+    }
+}
+
+
 static void
 check_scn_group (Ebl *ebl, int idx)
 {
@@ -539,36 +669,10 @@ check_scn_group (Ebl *ebl, int idx)
     {
       /* No reference so far.  Search following sections, maybe the
 	 order is wrong.  */
-      size_t cnt;
-
-      for (cnt = idx + 1; cnt < shnum; ++cnt)
-	{
-	  Elf_Scn *scn = elf_getscn (ebl->elf, cnt);
-	  GElf_Shdr shdr_mem;
-	  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
-	  if (shdr == NULL)
-	    /* We cannot get the section header so we cannot check it.
-	       The error to get the section header will be shown
-	       somewhere else.  */
-	    continue;
-
-	  if (shdr->sh_type != SHT_GROUP)
-	    continue;
-
-	  Elf_Data *data = elf_getdata (scn, NULL);
-	  if (data == NULL || data->d_buf == NULL
-	      || data->d_size < sizeof (Elf32_Word))
-	    /* Cannot check the section.  */
-	    continue;
-
-	  Elf32_Word *grpdata = (Elf32_Word *) data->d_buf;
-	  for (size_t inner = 1; inner < data->d_size / sizeof (Elf32_Word);
-	       ++inner)
-	    if (grpdata[inner] == (Elf32_Word) idx)
-	      goto out;
-	}
+      if (group_after == NULL)
+	find_group_after (ebl);
+      size_t cnt = group_after[idx] ?: shnum;
 
-    out:
       if (cnt == shnum)
 	ERROR (gettext ("\
 section [%2d] '%s': section with SHF_GROUP flag set not part of a section group\n"),
@@ -931,30 +1035,18 @@ section [%2d] '%s': symbol %zu: non-local section symbol\n"),
 
 	      if (destshdr == NULL && xndx == SHN_ABS)
 		{
-		  /* In a DSO, we have to find the GOT section by name.  */
-		  Elf_Scn *gotscn = NULL;
-		  Elf_Scn *gscn = NULL;
-		  while ((gscn = elf_nextscn (ebl->elf, gscn)) != NULL)
+		  /* In a DSO, we have to find the GOT section by name.
+		     There might be a .got.plt section, use it if so.  */
+		  Elf_Scn *gotscn = elf_getscnbyname (ebl->elf, ".got.plt");
+		  if (gotscn == NULL)
 		    {
-		      destshdr = gelf_getshdr (gscn, &destshdr_mem);
-		      assert (destshdr != NULL);
-		      const char *sname = elf_strptr (ebl->elf,
-						      ehdr->e_shstrndx,
-						      destshdr->sh_name);
-		      if (sname != NULL)
-			{
-			  if (strcmp (sname, ".got.plt") == 0)
-			    break;
-			  if (strcmp (sname, ".got") == 0)
-			    /* Do not stop looking.
-			       There might be a .got.plt section.  */
-			    gotscn = gscn;
-			}
-
-		      destshdr = NULL;
+		      Elf_Scn *gscn = NULL;
+		      while ((gscn = elf_nextscnbyname (ebl->elf, gscn,
+							 ".got")) != NULL)
+			gotscn = gscn;
 		    }
 
-		  if (destshdr == NULL && gotscn != NULL)
+		  if (gotscn != NULL)
 		    destshdr = gelf_getshdr (gotscn, &destshdr_mem);
 		}
 
@@ -2785,9 +2877,13 @@ section_flags_string (GElf_Word flags, char *buf, size_t len)
 }
 
 
-static int
-has_copy_reloc (Ebl *ebl, unsigned int symscnndx, unsigned int symndx)
+/* Return an array telling for each of the NSYMS symbols in section
+   SYMSCNNDX whether it has a copy relocation.  */
+static bool *
+find_copy_relocs (Ebl *ebl, unsigned int symscnndx, size_t nsyms)
 {
+  bool *result = xcalloc (nsyms, sizeof (bool));
+
   /* First find the relocation section for the symbol table.  */
   Elf_Scn *scn = NULL;
   GElf_Shdr shdr_mem;
@@ -2803,11 +2899,11 @@ has_copy_reloc (Ebl *ebl, unsigned int symscnndx, unsigned int symndx)
     }
 
   if (scn == NULL)
-    return 0;
+    return result;
 
   Elf_Data *data = elf_getdata (scn, NULL);
   if (data == NULL || shdr->sh_entsize == 0)
-    return 0;
+    return result;
 
   if (shdr->sh_type == SHT_REL)
     for (int i = 0; (size_t) i < shdr->sh_size / shdr->sh_entsize; ++i)
@@ -2817,9 +2913,9 @@ has_copy_reloc (Ebl *ebl, unsigned int symscnndx, unsigned int symndx)
 	if (rel == NULL)
 	  continue;
 
-	if (GELF_R_SYM (rel->r_info) == symndx
+	if (GELF_R_SYM (rel->r_info) < nsyms
 	    && ebl_copy_reloc_p (ebl, GELF_R_TYPE (rel->r_info)))
-	  return 1;
+	  result[GELF_R_SYM (rel->r_info)] = true;
       }
   else
     for (int i = 0; (size_t) i < shdr->sh_size / shdr->sh_entsize; ++i)
@@ -2829,12 +2925,12 @@ has_copy_reloc (Ebl *ebl, unsigned int symscnndx, unsigned int symndx)
 	if (rela == NULL)
 	  continue;
 
-	if (GELF_R_SYM (rela->r_info) == symndx
+	if (GELF_R_SYM (rela->r_info) < nsyms
 	    && ebl_copy_reloc_p (ebl, GELF_R_TYPE (rela->r_info)))
-	  return 1;
+	  result[GELF_R_SYM (rela->r_info)] = true;
       }
 
-  return 0;
+  return result;
 }
 
 
@@ -2857,26 +2953,59 @@ static struct version_namelist
 } *version_namelist;
 
 
+static int
+version_compare (const struct version_namelist *a,
+		 const struct version_namelist *b)
+{
+  if (a->objname == NULL || b->objname == NULL)
+    return a->objname != b->objname || strcmp (a->name, b->name) != 0;
+  return strcmp (a->objname, b->objname) != 0 || strcmp (a->name, b->name) != 0;
+}
+
+/* The versions in VERSION_NAMELIST by name, to find duplicates.  */
+#define NAME Version_Hash
+#define TYPE struct version_namelist *
+#define COMPARE(a, b) version_compare (a, b)
+#define NO_UNDEF
+#include <dynamicsizehash.h>
+#include <dynamicsizehash.c>
+#undef NO_UNDEF
+
+static Version_Hash version_hash;
+
+
+/* The versions by index, once all are known.  The first and last
+   one in VERSION_NAMELIST with the index, NULL if there is none.  */
+static struct version_ndx
+{
+  struct version_namelist *first;
+  struct version_namelist *last;
+} *version_ndx;
+static size_t nversion_ndx;
+
+
 static int
 add_version (const char *objname, const char *name, GElf_Versym ndx, int type)
 {
-  /* Check that there are no duplications.  */
-  struct version_namelist *nlp = version_namelist;
-  while (nlp != NULL)
-    {
-      if (((nlp->objname == NULL && objname == NULL)
-	   || (nlp->objname != NULL && objname != NULL
-	       && strcmp (nlp->objname, objname) == 0))
-	  && strcmp (nlp->name, name) == 0)
-	return nlp->type == ver_def ? 1 : -1;
-      nlp = nlp->next;
-    }
+  if (version_namelist == NULL)
+    Version_Hash_init (&version_hash, 31);
 
-  nlp = xmalloc (sizeof (*nlp));
+  struct version_namelist *nlp = xmalloc (sizeof (*nlp));
   nlp->objname = objname;
   nlp->name = name;
   nlp->ndx = ndx;
   nlp->type = type;
+
+  /* Check that there are no duplications.  */
+  unsigned long int hval = elf_hash (name);
+  struct version_namelist *old = Version_Hash_find (&version_hash, hval, nlp);
+  if (old != NULL)
+    {
+      free (nlp);
+      return old->type == ver_def ? 1 : -1;
+    }
+
+  Version_Hash_insert (&version_hash, hval, nlp);
   nlp->next = version_namelist;
   version_namelist = nlp;
 
@@ -2884,6 +3013,26 @@ add_version (const char *objname, const char *name, GElf_Versym ndx, int type)
 }
 
 
+static void
+index_versions (void)
+{
+  GElf_Versym max_ndx = 0;
+  for (struct version_namelist *nlp = version_namelist; nlp != NULL;
+       nlp = nlp->next)
+    max_ndx = MAX (max_ndx, nlp->ndx);
+
+  nversion_ndx = max_ndx + 1;
+  version_ndx = xcalloc (nversion_ndx, sizeof (struct version_ndx));
+  for (struct version_namelist *nlp = version_namelist; nlp != NULL;
+       nlp = nlp->next)
+    {
+      if (version_ndx[nlp->ndx].first == NULL)
+	version_ndx[nlp->ndx].first = nlp;
+      version_ndx[nlp->ndx].last = nlp;
+    }
+}
+
+
 static void
 check_versym (Ebl *ebl, int idx)
 {
@@ -2933,6 +3082,10 @@ section [%2d] '%s' has different number of entries than symbol table [%2d] '%s'\
     /* The error has already been reported.  */
     return;
 
+  /* The copy relocations are looked at when first needed.  */
+  bool *copy_relocs = NULL;
+  size_t nsyms = shdr->sh_size / shdr->sh_entsize;
+
   for (int cnt = 1; (size_t) cnt < shdr->sh_size / shdr->sh_entsize; ++cnt)
     {
       GElf_Versym versym_mem;
@@ -2967,14 +3120,11 @@ section [%2d] '%s': symbol %d: local symbol with global scope\n"),
 section [%2d] '%s': symbol %d: local symbol with version\n"),
 		   idx, section_name (ebl, idx), cnt);
 
-	  /* Look through the list of defined versions and locate the
-	     index we need for this symbol.  */
-	  struct version_namelist *runp = version_namelist;
-	  while (runp != NULL)
-	    if (runp->ndx == (*versym & (GElf_Versym) 0x7fff))
-	      break;
-	    else
-	      runp = runp->next;
+	  /* Locate the version with the index we need for this
+	     symbol.  */
+	  size_t ndx = *versym & (GElf_Versym) 0x7fff;
+	  struct version_namelist *runp = (ndx < nversion_ndx
+					   ? version_ndx[ndx].first : NULL);
 
 	  if (runp == NULL)
 	    ERROR (gettext ("\
@@ -2990,14 +3140,17 @@ section [%2d] '%s': symbol %d: version index %d is for defined version\n"),
 	    {
 	      /* Unless this symbol has a copy relocation associated
 		 this must not happen.  */
-	      if (!has_copy_reloc (ebl, shdr->sh_link, cnt)
-		  && !in_nobits_scn (ebl, sym->st_shndx))
+	      if (copy_relocs == NULL)
+		copy_relocs = find_copy_relocs (ebl, shdr->sh_link, nsyms);
+	      if (!copy_relocs[cnt] && !in_nobits_scn (ebl, sym->st_shndx))
 		ERROR (gettext ("\
 section [%2d] '%s': symbol %d: version index %d is for requested version\n"),
 		       idx, section_name (ebl, idx), cnt, (int) *versym);
 	    }
 	}
     }
+
+  free (copy_relocs);
 }
 
 
@@ -3367,16 +3520,13 @@ section [%2d] '%s': entry %d has zero offset to next entry, but sh_info says the
   /* Check whether the referenced names are available.  */
   while (namelist != NULL)
     {
-      struct version_namelist *runp = version_namelist;
-      while (runp != NULL)
-	{
-	  if (runp->type == ver_def
-	      && strcmp (runp->name, namelist->name) == 0)
-	    break;
-	  runp = runp->next;
-	}
+      /* Definitions have no object name.  */
+      struct version_namelist key = { .name = namelist->name };
+      struct version_namelist *runp
+	= (version_namelist == NULL ? NULL
+	   : Version_Hash_find (&version_hash, elf_hash (key.name), &key));
 
-      if (runp == NULL)
+      if (runp == NULL || runp->type != ver_def)
 	ERROR (gettext ("\
 section [%2d] '%s': unknown parent version '%s'\n"),
 	       idx, section_name (ebl, idx), namelist->name);
@@ -4204,6 +4354,8 @@ loadable segment [%u] is writable but contains no writable sections\n"),
 
   if (version_namelist != NULL)
     {
+      index_versions ();
+
       if (versym_scnndx == 0)
     ERROR (gettext ("\
 no .gnu.versym section present but .gnu.versym_d or .gnu.versym_r section exist\n"));
@@ -4213,23 +4365,19 @@ no .gnu.versym section present but .gnu.versym_d or .gnu.versym_r section exist\
       /* Check for duplicate index numbers.  */
       do
 	{
-	  struct version_namelist *runp = version_namelist->next;
-	  while (runp != NULL)
-	    {
-	      if (version_namelist->ndx == runp->ndx)
-		{
-		  ERROR (gettext ("duplicate version index %d\n"),
-			 (int) version_namelist->ndx);
-		  break;
-		}
-	      runp = runp->next;
-	    }
+	  if (version_ndx[version_namelist->ndx].last != version_namelist)
+	    ERROR (gettext ("duplicate version index %d\n"),
+		   (int) version_namelist->ndx);
 
 	  struct version_namelist *old = version_namelist;
 	  version_namelist = version_namelist->next;
 	  free (old);
 	}
       while (version_namelist != NULL);
+
+      free (version_ndx);
+      version_ndx = NULL;
+      Version_Hash_free (&version_hash);
     }
   else if (versym_scnndx != 0)
     ERROR (gettext ("\
@@ -4239,6 +4387,8 @@ no .gnu.versym section present but .gnu.versym_d or .gnu.versym_r section exist\
     compare_hash_gnu_hash (ebl, ehdr, hash_idx, gnu_hash_idx);
 
   free (scnref);
+  free (group_after);
+  group_after = NULL;
 }
 
 
@@ -4665,7 +4815,9 @@ static void
 process_elf_file (Elf *elf, const char *prefix, const char *suffix,
 		  const char *fname, size_t size, bool only_one)
 {
-  /* Reset variables.  */
+  /* Reset variables.  Messages must not show libelf errors left from
+     other files, which are not seen with --jobs.  */
+  (void) elf_errno ();
   ndynamic = 0;
   nverneed = 0;
   nverdef = 0;
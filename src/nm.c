@@ -34,6 +34,7 @@
 #include <libintl.h>
 #include <locale.h>
 #include <obstack.h>
+#include <pthread.h>
 #include <search.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -114,6 +115,7 @@ static error_t parse_opt (int key, char *arg, struct argp_state *state);
 static struct argp_child argp_children[] =
   {
     { &color_argp, 0, N_("Output formatting"), 2 },
+    { &jobs_argp, 0, N_("Miscellaneous:"), 3 },
     { NULL, 0, NULL, 0}
   };
 
@@ -128,7 +130,8 @@ static struct argp argp =
 static int process_file (const char *fname, bool more_than_one);
 
 /* Handle content of archive.  */
-static int handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
+struct open_elf;
+static int handle_ar (struct open_elf *file, const char *prefix,
 		      const char *suffix);
 
 /* Handle ELF file.  */
@@ -141,12 +144,41 @@ static int handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
 	 fname, __LINE__, PACKAGE_VERSION, elf_errmsg (-1))
 
 
+/* The files and archive members are handled by a workpool, with
+   --jobs in parallel.  An ELF descriptor stays open until everything
+   using it is done.  */
+struct open_elf
+{
+  Elf *elf;
+  int fd;
+  bool close_fd;		/* True for the files opened here.  */
+  char *fname;
+  struct open_elf *parent;	/* The archive ELF is a member of.  */
+  unsigned int refs;
+};
+
+/* Symbols of one ELF file to print.  */
+struct elf_job
+{
+  struct open_elf *file;
+  char *prefix;
+  char *suffix;
+  const char *fname;
+};
+
+static struct workpool *pool;
+
+/* Results of the jobs which are done.  */
+static int jobs_result;
+
+
 /* Internal representation of symbols.  */
 typedef struct GElf_SymX
 {
   GElf_Sym sym;
   Elf32_Word xndx;
   char *where;
+  const char *name;		/* Demangled if requested.  */
 } GElf_SymX;
 
 
@@ -237,6 +269,8 @@ main (int argc, char *argv[])
   /* Tell the library which version we are expecting.  */
   (void) elf_version (EV_CURRENT);
 
+  pool = workpool_begin (workpool_jobs);
+
   if (remaining == argc)
     /* The user didn't specify a name so we use a.out.  */
     result = process_file ("a.out", false);
@@ -250,7 +284,9 @@ main (int argc, char *argv[])
       while (++remaining < argc);
     }
 
-  return result;
+  workpool_end (pool);
+
+  return result | jobs_result;
 }
 
 
@@ -367,6 +403,78 @@ parse_opt (int key, char *arg,
 }
 
 
+static struct open_elf *
+open_elf_new (Elf *elf, int fd, const char *fname, struct open_elf *parent)
+{
+  struct open_elf *file = xmalloc (sizeof *file);
+  file->elf = elf;
+  file->fd = fd;
+  file->close_fd = parent == NULL;
+  file->fname = xstrdup (fname);
+  file->parent = parent;
+  file->refs = 1;
+  if (parent != NULL)
+    ++parent->refs;
+  return file;
+}
+
+
+static void
+open_elf_release (struct open_elf *file)
+{
+  if (--file->refs != 0)
+    return;
+
+  if (elf_end (file->elf) != 0)
+    INTERNAL_ERROR (file->fname);
+
+  if (file->close_fd && close (file->fd) != 0)
+    error (EXIT_FAILURE, errno, gettext ("while closing '%s'"), file->fname);
+
+  if (file->parent != NULL)
+    open_elf_release (file->parent);
+  free (file->fname);
+  free (file);
+}
+
+
+static int
+elf_job_work (void *arg, FILE *data __attribute__ ((unused)))
+{
+  struct elf_job *job = arg;
+  return handle_elf (job->file->fd, job->file->elf, job->prefix, job->fname,
+		     job->suffix);
+}
+
+
+static bool
+elf_job_done (void *arg, int result, FILE *data __attribute__ ((unused)))
+{
+  struct elf_job *job = arg;
+  if (result > 0)
+    jobs_result |= result;
+  open_elf_release (job->file);
+  free (job->prefix);
+  free (job->suffix);
+  free (job);
+  return true;
+}
+
+
+/* Print the symbols of FILE in the workpool, taking over our reference
+   to it.  */
+static void
+add_elf_job (struct open_elf *file, const char *prefix, const char *suffix)
+{
+  struct elf_job *job = xmalloc (sizeof *job);
+  job->file = file;
+  job->prefix = prefix != NULL ? xstrdup (prefix) : NULL;
+  job->suffix = suffix != NULL ? xstrdup (suffix) : NULL;
+  job->fname = file->fname;
+  workpool_add (pool, elf_job_work, elf_job_done, job);
+}
+
+
 /* Open the file and determine the type.  */
 static int
 process_file (const char *fname, bool more_than_one)
@@ -375,6 +483,7 @@ process_file (const char *fname, bool more_than_one)
   int fd = open (fname, O_RDONLY);
   if (fd == -1)
     {
+      workpool_sync (pool);
       error (0, errno, gettext ("cannot open '%s'"), fname);
       return 1;
     }
@@ -385,27 +494,15 @@ process_file (const char *fname, bool more_than_one)
     {
       if (elf_kind (elf) == ELF_K_ELF)
 	{
-	  int result = handle_elf (fd, elf, more_than_one ? "" : NULL,
-				   fname, NULL);
-
-	  if (elf_end (elf) != 0)
-	    INTERNAL_ERROR (fname);
-
-	  if (close (fd) != 0)
-	    error (EXIT_FAILURE, errno, gettext ("while closing '%s'"), fname);
-
-	  return result;
+	  add_elf_job (open_elf_new (elf, fd, fname, NULL),
+		       more_than_one ? "" : NULL, NULL);
+	  return 0;
 	}
       else if (elf_kind (elf) == ELF_K_AR)
 	{
-	  int result = handle_ar (fd, elf, NULL, fname, NULL);
-
-	  if (elf_end (elf) != 0)
-	    INTERNAL_ERROR (fname);
-
-	  if (close (fd) != 0)
-	    error (EXIT_FAILURE, errno, gettext ("while closing '%s'"), fname);
-
+	  struct open_elf *file = open_elf_new (elf, fd, fname, NULL);
+	  int result = handle_ar (file, NULL, NULL);
+	  open_elf_release (file);
 	  return result;
 	}
 
@@ -414,6 +511,7 @@ process_file (const char *fname, bool more_than_one)
 	INTERNAL_ERROR (fname);
     }
 
+  workpool_sync (pool);
   error (0, 0, gettext ("%s: File format not recognized"), fname);
 
   return 1;
@@ -421,9 +519,11 @@ process_file (const char *fname, bool more_than_one)
 
 
 static int
-handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
-	   const char *suffix)
+handle_ar (struct open_elf *file, const char *prefix, const char *suffix)
 {
+  int fd = file->fd;
+  Elf *elf = file->elf;
+  const char *fname = file->fname;
   size_t fname_len = strlen (fname) + 1;
   size_t prefix_len = prefix != NULL ? strlen (prefix) : 0;
   char new_prefix[prefix_len + fname_len + 2];
@@ -454,6 +554,7 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 	  Elf_Arhdr *arhdr = NULL;
 	  size_t arhdr_off = 0;	/* Note: 0 is no valid offset.  */
 
+	  workpool_sync (pool);
 	  fputs_unlocked (gettext("\nArchive index:\n"), stdout);
 
 	  while (arsym->as_off != 0)
@@ -494,13 +595,26 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 	  && strcmp (arhdr->ar_name, "/SYM64/") != 0)
 	{
 	  if (elf_kind (subelf) == ELF_K_ELF)
-	    result |= handle_elf (fd, subelf, new_prefix, arhdr->ar_name,
-				  new_suffix);
+	    {
+	      /* The header changes with elf_next.  */
+	      struct open_elf *member = open_elf_new (subelf, fd,
+						      arhdr->ar_name, file);
+	      cmd = elf_next (subelf);
+	      add_elf_job (member, new_prefix, new_suffix);
+	      continue;
+	    }
 	  else if (elf_kind (subelf) == ELF_K_AR)
-	    result |= handle_ar (fd, subelf, new_prefix, arhdr->ar_name,
-				 new_suffix);
+	    {
+	      struct open_elf *member = open_elf_new (subelf, fd,
+						      arhdr->ar_name, file);
+	      result |= handle_ar (member, new_prefix, new_suffix);
+	      cmd = elf_next (subelf);
+	      open_elf_release (member);
+	      continue;
+	    }
 	  else
 	    {
+	      workpool_sync (pool);
 	      error (0, 0, gettext ("%s%s%s: file format not recognized"),
 		     new_prefix, arhdr->ar_name, new_suffix);
 	      result = 1;
@@ -631,6 +745,116 @@ get_var_range (Dwarf_Die *die, Dwarf_Word *lowpc, Dwarf_Word *highpc)
 static void *local_root;
 
 
+/* The CUs whose names are in local_root, by offset.  */
+static void *local_cus;
+
+/* True if the names of all CUs are in local_root.  */
+static bool local_cus_all;
+
+
+static int
+cu_offset_compare (const void *p1, const void *p2)
+{
+  const Dwarf_Off *o1 = p1;
+  const Dwarf_Off *o2 = p2;
+
+  return *o1 < *o2 ? -1 : *o1 > *o2;
+}
+
+
+/* Add the names of the top-level functions and variables of the CU
+   at CUDIE to local_root, unless that was done already.  */
+static void
+get_local_names_cu (Dwarf_Die *cudie)
+{
+  /* This better be a CU DIE.  */
+  if (dwarf_tag (cudie) != DW_TAG_compile_unit)
+    return;
+
+  Dwarf_Off *offp = xmalloc (sizeof *offp);
+  *offp = dwarf_dieoffset (cudie);
+  Dwarf_Off **cures = tsearch (offp, &local_cus, cu_offset_compare);
+  if (cures == NULL)
+    error (EXIT_FAILURE, errno, gettext ("cannot create search tree"));
+  if (*cures != offp)
+    {
+      free (offp);
+      return;
+    }
+
+  /* Get the line information.  */
+  Dwarf_Files *files;
+  size_t nfiles;
+  if (dwarf_getsrcfiles (cudie, &files, &nfiles) != 0)
+    return;
+
+  Dwarf_Die die_mem;
+  Dwarf_Die *die = &die_mem;
+  if (dwarf_child (cudie, die) == 0)
+    /* Iterate over all immediate children of the CU DIE.  */
+    do
+      {
+	int tag = dwarf_tag (die);
+	if (tag != DW_TAG_subprogram && tag != DW_TAG_variable)
+	  continue;
+
+	/* We are interested in five attributes: name, decl_file,
+	   decl_line, low_pc, and high_pc.  */
+	Dwarf_Attribute attr_mem;
+	Dwarf_Attribute *attr = dwarf_attr (die, DW_AT_name, &attr_mem);
+	const char *name = dwarf_formstring (attr);
+	if (name == NULL)
+	  continue;
+
+	Dwarf_Word fileidx;
+	attr = dwarf_attr (die, DW_AT_decl_file, &attr_mem);
+	if (dwarf_formudata (attr, &fileidx) != 0 || fileidx >= nfiles)
+	  continue;
+
+	Dwarf_Word lineno;
+	attr = dwarf_attr (die, DW_AT_decl_line, &attr_mem);
+	if (dwarf_formudata (attr, &lineno) != 0 || lineno == 0)
+	  continue;
+
+	Dwarf_Addr lowpc;
+	Dwarf_Addr highpc;
+	if (tag == DW_TAG_subprogram)
+	  {
+	    if (dwarf_lowpc (die, &lowpc) != 0
+		|| dwarf_highpc (die, &highpc) != 0)
+	      continue;
+	  }
+	else
+	  {
+	    if (get_var_range (die, &lowpc, &highpc) != 0)
+	      continue;
+	  }
+
+	/* We have all the information.  Create a record.  */
+	struct local_name *newp
+	  = (struct local_name *) xmalloc (sizeof (*newp));
+	newp->name = name;
+	newp->file = dwarf_filesrc (files, fileidx, NULL, NULL);
+	newp->lineno = lineno;
+	newp->lowpc = lowpc;
+	newp->highpc = highpc;
+
+       /* Check whether a similar local_name is already in the
+	  cache.  That should not happen.  But if it does, we
+	  don't want to leak memory.  */
+	struct local_name **tres = tsearch (newp, &local_root,
+					    local_compare);
+	if (tres == NULL)
+	  error (EXIT_FAILURE, errno,
+		 gettext ("cannot create search tree"));
+	else if (*tres != newp)
+	  free (newp);
+      }
+    while (dwarf_siblingof (die, die) == 0);
+}
+
+
+/* Add the names of all CUs to local_root.  */
 static void
 get_local_names (Dwarf *dbg)
 {
@@ -646,82 +870,44 @@ get_local_names (Dwarf *dbg)
 
       /* If we cannot get the CU DIE there is no need to go on with
 	 this CU.  */
-      if (cudie == NULL)
-	continue;
-      /* This better be a CU DIE.  */
-      if (dwarf_tag (cudie) != DW_TAG_compile_unit)
-	continue;
-
-      /* Get the line information.  */
-      Dwarf_Files *files;
-      size_t nfiles;
-      if (dwarf_getsrcfiles (cudie, &files, &nfiles) != 0)
-	continue;
+      if (cudie != NULL)
+	get_local_names_cu (cudie);
+    }
 
-      Dwarf_Die die_mem;
-      Dwarf_Die *die = &die_mem;
-      if (dwarf_child (cudie, die) == 0)
-	/* Iterate over all immediate children of the CU DIE.  */
-	do
-	  {
-	    int tag = dwarf_tag (die);
-	    if (tag != DW_TAG_subprogram && tag != DW_TAG_variable)
-	      continue;
+  local_cus_all = true;
+}
 
-	    /* We are interested in five attributes: name, decl_file,
-	       decl_line, low_pc, and high_pc.  */
-	    Dwarf_Attribute attr_mem;
-	    Dwarf_Attribute *attr = dwarf_attr (die, DW_AT_name, &attr_mem);
-	    const char *name = dwarf_formstring (attr);
-	    if (name == NULL)
-	      continue;
 
-	    Dwarf_Word fileidx;
-	    attr = dwarf_attr (die, DW_AT_decl_file, &attr_mem);
-	    if (dwarf_formudata (attr, &fileidx) != 0 || fileidx >= nfiles)
-	      continue;
+/* Find a local name like FAKE.  A function can only be in the CU whose
+   address ranges cover it, so with .debug_aranges the names of that CU
+   are read first.  Not every CU need be covered by .debug_aranges, so
+   if the function is not found there, and for everything else, the
+   names of all CUs are needed.  */
+static struct local_name **
+find_local_name (Dwarf *dbg, struct local_name *fake, bool func)
+{
+  if (dbg == NULL)
+    return NULL;
 
-	    Dwarf_Word lineno;
-	    attr = dwarf_attr (die, DW_AT_decl_line, &attr_mem);
-	    if (dwarf_formudata (attr, &lineno) != 0 || lineno == 0)
-	      continue;
+  if (! local_cus_all)
+    {
+      Dwarf_Aranges *aranges;
+      Dwarf_Die cudie_mem;
+      if (func && dwarf_getaranges (dbg, &aranges, NULL) == 0
+	  && aranges != NULL
+	  && dwarf_addrdie (dbg, fake->lowpc, &cudie_mem) != NULL)
+	{
+	  get_local_names_cu (&cudie_mem);
+	  struct local_name **found = tfind (fake, &local_root,
+					     local_compare);
+	  if (found != NULL)
+	    return found;
+	}
 
-	    Dwarf_Addr lowpc;
-	    Dwarf_Addr highpc;
-	    if (tag == DW_TAG_subprogram)
-	      {
-		if (dwarf_lowpc (die, &lowpc) != 0
-		    || dwarf_highpc (die, &highpc) != 0)
-		  continue;
-	      }
-	    else
-	      {
-		if (get_var_range (die, &lowpc, &highpc) != 0)
-		  continue;
-	      }
-
-	    /* We have all the information.  Create a record.  */
-	    struct local_name *newp
-	      = (struct local_name *) xmalloc (sizeof (*newp));
-	    newp->name = name;
-	    newp->file = dwarf_filesrc (files, fileidx, NULL, NULL);
-	    newp->lineno = lineno;
-	    newp->lowpc = lowpc;
-	    newp->highpc = highpc;
-
-	   /* Check whether a similar local_name is already in the
-	      cache.  That should not happen.  But if it does, we
-	      don't want to leak memory.  */
-	    struct local_name **tres = tsearch (newp, &local_root,
-						local_compare);
-	    if (tres == NULL)
-              error (EXIT_FAILURE, errno,
-                     gettext ("cannot create search tree"));
-	    else if (*tres != newp)
-	      free (newp);
-	  }
-	while (dwarf_siblingof (die, die) == 0);
+      get_local_names (dbg);
     }
+
+  return tfind (fake, &local_root, local_compare);
 }
 
 /* Do elf_strptr, but return a backup string and never NULL.  */
@@ -739,7 +925,7 @@ sym_name (Elf *elf, GElf_Word strndx, GElf_Word st_name, char buf[], size_t n)
 
 /* Show symbols in SysV format.  */
 static void
-show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
+show_symbols_sysv (Ebl *ebl, const char *fullname,
 		   GElf_SymX *syms, size_t nsyms, int longest_name,
 		   int longest_where)
 {
@@ -797,11 +983,6 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
 	  /* TRANS: the "sysv|" parts makes the string unique.  */
 	  longest_where, sgettext ("sysv|Line"));
 
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
-
   /* Iterate over all symbols.  */
   for (cnt = 1; cnt < nsyms; ++cnt)
     {
@@ -809,22 +990,7 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
       if (GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_SECTION)
 	continue;
 
-      char symstrbuf[50];
-      const char *symstr = sym_name (ebl->elf, strndx, syms[cnt].sym.st_name,
-				     symstrbuf, sizeof symstrbuf);
-
-#ifdef USE_DEMANGLE
-      /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-      if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					   &demangle_buffer_len, &status);
-
-	  if (status == 0)
-	    symstr = dmsymstr;
-	}
-#endif
+      const char *symstr = syms[cnt].name;
 
       char symbindbuf[50];
       char symtypebuf[50];
@@ -870,10 +1036,6 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
 				shnum));
     }
 
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
-
   if (scnnames_malloced)
     free (scnnames);
 }
@@ -920,26 +1082,15 @@ class_type_char (Elf *elf, const GElf_Ehdr *ehdr, GElf_Sym *sym)
 
 
 static void
-show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
-		  const char *prefix, const char *fname, const char *fullname,
+show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, const char *fullname,
 		  GElf_SymX *syms, size_t nsyms)
 {
   int digits = length_map[gelf_getclass (elf) - 1][radix];
 
-  if (prefix != NULL && ! print_file_name)
-    printf ("\n%s:\n", fname);
-
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
-
   /* Iterate over all symbols.  */
   for (size_t cnt = 0; cnt < nsyms; ++cnt)
     {
-      char symstrbuf[50];
-      const char *symstr = sym_name (elf, strndx, syms[cnt].sym.st_name,
-				     symstrbuf, sizeof symstrbuf);
+      const char *symstr = syms[cnt].name;
 
       /* Printing entries with a zero-length name makes the output
 	 not very well parseable.  Since these entries don't carry
@@ -951,19 +1102,6 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
       if (GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_FILE)
 	continue;
 
-#ifdef USE_DEMANGLE
-      /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-      if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					   &demangle_buffer_len, &status);
-
-	  if (status == 0)
-	    symstr = dmsymstr;
-	}
-#endif
-
       /* If we have to precede the line with the file name.  */
       if (print_file_name)
 	{
@@ -1044,34 +1182,19 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 	fputs_unlocked (color_off, stdout);
       putchar_unlocked ('\n');
     }
-
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
 }
 
 
 static void
-show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
-		    const char *prefix, const char *fullname, GElf_SymX *syms,
-		    size_t nsyms)
+show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, const char *fullname,
+		    GElf_SymX *syms, size_t nsyms)
 {
-  if (prefix != NULL && ! print_file_name)
-    printf ("%s:\n", fullname);
-
   int digits = length_map[gelf_getclass (elf) - 1][radix];
 
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
-
   /* Iterate over all symbols.  */
   for (size_t cnt = 0; cnt < nsyms; ++cnt)
     {
-      char symstrbuf[50];
-      const char *symstr = sym_name (elf, strndx, syms[cnt].sym.st_name,
-				     symstrbuf, sizeof symstrbuf);
+      const char *symstr = syms[cnt].name;
 
       /* Printing entries with a zero-length name makes the output
 	 not very well parseable.  Since these entries don't carry
@@ -1079,19 +1202,6 @@ show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
       if (symstr[0] == '\0')
 	continue;
 
-#ifdef USE_DEMANGLE
-      /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-      if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					   &demangle_buffer_len, &status);
-
-	  if (status == 0)
-	    symstr = dmsymstr;
-	}
-#endif
-
       /* If we have to precede the line with the file name.  */
       if (print_file_name)
 	{
@@ -1116,16 +1226,19 @@ show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 	      digits, syms[cnt].sym.st_value,
 	      digits, syms[cnt].sym.st_size);
     }
-
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
 }
 
 
 /* Maximum size of memory we allocate on the stack.  */
 #define MAX_STACK_ALLOC	65536
 
+/* Number of symbols printed at a time without sorting.  */
+#define SYMX_BATCH	1024
+
+/* With fewer names to demangle than this per thread no more threads
+   are used.  */
+#define DEMANGLE_THREAD_MIN	1024
+
 static int
 sort_by_address (const void *p1, const void *p2)
 {
@@ -1208,6 +1321,258 @@ getdbg_dwflmod (Dwfl_Module *dwflmod,
   return DWARF_CB_OK;
 }
 
+/* Find where SYM named NAME is defined for the SysV format, or ""
+   if that is not known.  */
+static char *
+symbol_where (Dwarf *dbg, const GElf_Sym *sym, const char *name,
+	      struct obstack *whereob)
+{
+  if (sym->st_shndx != SHN_UNDEF
+      && GELF_ST_BIND (sym->st_info) != STB_LOCAL
+      && global_root != NULL)
+    {
+      Dwarf_Global fake = { .name = name };
+      Dwarf_Global **found = tfind (&fake, &global_root, global_compare);
+      if (found != NULL)
+	{
+	  Dwarf_Die die_mem;
+	  Dwarf_Die *die = dwarf_offdie (dbg, (*found)->die_offset, &die_mem);
+
+	  Dwarf_Die cudie_mem;
+	  Dwarf_Die *cudie = NULL;
+
+	  Dwarf_Addr lowpc;
+	  Dwarf_Addr highpc;
+	  if (die != NULL
+	      && dwarf_lowpc (die, &lowpc) == 0
+	      && lowpc <= sym->st_value
+	      && dwarf_highpc (die, &highpc) == 0
+	      && highpc > sym->st_value)
+	    cudie = dwarf_offdie (dbg, (*found)->cu_offset, &cudie_mem);
+	  if (cudie != NULL)
+	    {
+	      Dwarf_Line *line = dwarf_getsrc_die (cudie, sym->st_value);
+	      if (line != NULL)
+		{
+		  /* We found the line.  */
+		  int lineno;
+		  (void) dwarf_lineno (line, &lineno);
+		  const char *file = dwarf_linesrc (line, NULL, NULL);
+		  file = (file != NULL) ? basename (file) : "???";
+		  obstack_printf (whereob, "%s:%d%c", file, lineno, '\0');
+		  return obstack_finish (whereob);
+		}
+	    }
+	}
+    }
+
+  /* Try to find the symbol among the local symbols.  */
+  struct local_name fake =
+    {
+      .name = name,
+      .lowpc = sym->st_value,
+      .highpc = sym->st_value,
+    };
+  struct local_name **found
+    = find_local_name (dbg, &fake, GELF_ST_TYPE (sym->st_info) == STT_FUNC);
+  if (found != NULL)
+    {
+      /* We found the line.  */
+      obstack_printf (whereob, "%s:%" PRIu64 "%c",
+		      basename ((*found)->file), (*found)->lineno, '\0');
+      return obstack_finish (whereob);
+    }
+
+  return "";
+}
+
+#ifdef USE_DEMANGLE
+/* A mangled symbol name and what it demangles to.  */
+struct demangle_name
+{
+  const char *mangled;
+  char *demangled;
+};
+
+#define NAME Demangle_Hash
+#define TYPE struct demangle_name *
+#define COMPARE(a, b) strcmp ((a)->mangled, (b)->mangled)
+#define NO_UNDEF
+#include <dynamicsizehash.h>
+#include <dynamicsizehash.c>
+#undef NO_UNDEF
+
+/* The names one thread demangles.  */
+struct demangle_job
+{
+  struct demangle_name *names;
+  size_t nnames;
+  pthread_t thread;
+  bool started;
+};
+
+static void *
+demangle_names (void *arg)
+{
+  struct demangle_job *job = arg;
+  for (size_t cnt = 0; cnt < job->nnames; ++cnt)
+    {
+      int status = -1;
+      job->names[cnt].demangled = __cxa_demangle (job->names[cnt].mangled,
+						  NULL, NULL, &status);
+    }
+  return NULL;
+}
+
+/* Demangle the names of the NSYMS symbols in SYMS if requested.  Each
+   distinct name is demangled once, with --jobs in several threads.
+   Returns the names to be freed with free_demangled, and their number
+   in *NNAMES.  */
+static struct demangle_name *
+demangle_symbols (GElf_SymX *syms, size_t nsyms, size_t *nnames)
+{
+  /* Require GNU v3 ABI by the "_Z" prefix.  */
+  inline bool mangled (const char *name)
+  {
+    return name[0] == '_' && name[1] == 'Z';
+  }
+
+  *nnames = 0;
+  if (! demangle)
+    return NULL;
+
+  size_t nmangled = 0;
+  for (size_t cnt = 0; cnt < nsyms; ++cnt)
+    nmangled += mangled (syms[cnt].name);
+  if (nmangled == 0)
+    return NULL;
+
+  /* Collect the distinct names.  */
+  struct demangle_name *names = xmalloc (nmangled * sizeof names[0]);
+  size_t n = 0;
+  Demangle_Hash hash;
+  if (Demangle_Hash_init (&hash, nmangled) != 0)
+    error (EXIT_FAILURE, errno, gettext ("cannot create hash table"));
+  for (size_t cnt = 0; cnt < nsyms; ++cnt)
+    if (mangled (syms[cnt].name))
+      {
+	struct demangle_name key = { .mangled = syms[cnt].name };
+	unsigned long int hval = elf_hash (key.mangled) ?: 1;
+	if (Demangle_Hash_find (&hash, hval, &key) == NULL)
+	  {
+	    names[n] = key;
+	    if (Demangle_Hash_insert (&hash, hval, &names[n]) != 0)
+	      error (EXIT_FAILURE, 0,
+		     gettext ("cannot insert into hash table"));
+	    ++n;
+	  }
+      }
+
+  /* Split them between the threads.  */
+  size_t nthreads = MAX (1, MIN ((size_t) workpool_jobs,
+				 n / DEMANGLE_THREAD_MIN));
+  struct demangle_job *jobs = xmalloc (nthreads * sizeof jobs[0]);
+  for (size_t t = 0; t < nthreads; ++t)
+    {
+      jobs[t].names = &names[n * t / nthreads];
+      jobs[t].nnames = n * (t + 1) / nthreads - n * t / nthreads;
+      jobs[t].started = t > 0 && pthread_create (&jobs[t].thread, NULL,
+						 demangle_names,
+						 &jobs[t]) == 0;
+    }
+  for (size_t t = 0; t < nthreads; ++t)
+    if (! jobs[t].started)
+      demangle_names (&jobs[t]);
+  for (size_t t = 1; t < nthreads; ++t)
+    if (jobs[t].started)
+      pthread_join (jobs[t].thread, NULL);
+  free (jobs);
+
+  /* Use the demangled names.  */
+  for (size_t cnt = 0; cnt < nsyms; ++cnt)
+    if (mangled (syms[cnt].name))
+      {
+	struct demangle_name key = { .mangled = syms[cnt].name };
+	struct demangle_name *found
+	  = Demangle_Hash_find (&hash, elf_hash (key.mangled) ?: 1, &key);
+	if (found != NULL && found->demangled != NULL)
+	  syms[cnt].name = found->demangled;
+      }
+  Demangle_Hash_free (&hash);
+
+  *nnames = n;
+  return names;
+}
+
+static void
+free_demangled (struct demangle_name *names, size_t nnames)
+{
+  for (size_t cnt = 0; cnt < nnames; ++cnt)
+    free (names[cnt].demangled);
+  free (names);
+}
+#endif
+
+/* Show the NSYMS symbols in SYMS, with names from section STRNDX.  */
+static void
+show_symbol_batch (Ebl *ebl, GElf_Ehdr *ehdr, GElf_Word strndx,
+		   const char *fullname, Dwarf *dbg, struct obstack *whereob,
+		   GElf_SymX *syms, size_t nsyms)
+{
+#ifdef USE_DEMANGLE
+  size_t ndemangled;
+  struct demangle_name *demangled = demangle_symbols (syms, nsyms,
+						      &ndemangled);
+#endif
+
+  /* The SysV format also shows where the symbols are defined.  */
+  int longest_name = 4;
+  int longest_where = 4;
+  if (format == format_sysv)
+    for (size_t cnt = 0; cnt < nsyms; ++cnt)
+      {
+	longest_name = MAX ((size_t) longest_name, strlen (syms[cnt].name));
+
+	syms[cnt].where = symbol_where (dbg, &syms[cnt].sym, syms[cnt].name,
+					whereob);
+	longest_where = MAX ((size_t) longest_where,
+			     strlen (syms[cnt].where));
+      }
+
+  /* Sort the entries according to the users wishes.  */
+  if (sort == sort_name)
+    {
+      sort_by_name_strtab = elf_getdata (elf_getscn (ebl->elf, strndx),
+					 NULL);
+      qsort (syms, nsyms, sizeof (GElf_SymX), sort_by_name);
+    }
+  else if (sort == sort_numeric)
+    qsort (syms, nsyms, sizeof (GElf_SymX), sort_by_address);
+
+  /* Finally print according to the users selection.  */
+  switch (format)
+    {
+    case format_sysv:
+      show_symbols_sysv (ebl, fullname, syms, nsyms,
+			 longest_name, longest_where);
+      break;
+
+    case format_bsd:
+      show_symbols_bsd (ebl->elf, ehdr, fullname, syms, nsyms);
+      break;
+
+    case format_posix:
+    default:
+      assert (format == format_posix);
+      show_symbols_posix (ebl->elf, ehdr, fullname, syms, nsyms);
+      break;
+    }
+
+#ifdef USE_DEMANGLE
+  free_demangled (demangled, ndemangled);
+#endif
+}
+
 static void
 show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
 	      Elf_Scn *scn, Elf_Scn *xndxscn,
@@ -1295,8 +1660,6 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
       if (dbg != NULL)
 	{
 	  (void) dwarf_getpubnames (dbg, get_global, NULL, 0);
-
-	  get_local_names (dbg);
 	}
     }
 
@@ -1316,25 +1679,34 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
           gettext ("%s: entries (%zd) in section %zd `%s' is too large"),
           fullname, nentries, elf_ndxscn (scn),
           elf_strptr (ebl->elf, shstrndx, shdr->sh_name));
+
+  /* Unsorted symbols are printed as they are read, a batch at a time,
+     except in the SysV format which needs the longest name first.  */
+  const bool streaming = sort == sort_nosort && format != format_sysv;
+  const size_t nmem = streaming ? MIN (nentries, SYMX_BATCH) : nentries;
   GElf_SymX *sym_mem;
-  if (nentries * sizeof (GElf_SymX) < MAX_STACK_ALLOC)
-    sym_mem = (GElf_SymX *) alloca (nentries * sizeof (GElf_SymX));
+  const bool sym_mem_malloced = nmem * sizeof (GElf_SymX) >= MAX_STACK_ALLOC;
+  if (! sym_mem_malloced)
+    sym_mem = (GElf_SymX *) alloca (nmem * sizeof (GElf_SymX));
   else
-    sym_mem = (GElf_SymX *) xmalloc (nentries * sizeof (GElf_SymX));
+    sym_mem = (GElf_SymX *) xmalloc (nmem * sizeof (GElf_SymX));
+
+  /* In archives the BSD and POSIX formats start with the member name.  */
+  if (prefix != NULL && ! print_file_name)
+    {
+      if (format == format_bsd)
+	printf ("\n%s:\n", fname);
+      else if (format == format_posix)
+	printf ("%s:\n", fullname);
+    }
 
   /* Iterate over all symbols.  */
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
-  int longest_name = 4;
-  int longest_where = 4;
   size_t nentries_used = 0;
   for (size_t cnt = 0; cnt < nentries; ++cnt)
     {
+      GElf_SymX *symx = &sym_mem[nentries_used];
       GElf_Sym *sym = gelf_getsymshndx (data, xndxdata, cnt,
-					&sym_mem[nentries_used].sym,
-					&sym_mem[nentries_used].xndx);
+					&symx->sym, &symx->xndx);
       if (sym == NULL)
 	INTERNAL_ERROR (fullname);
 
@@ -1345,150 +1717,36 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
 	  || (hide_local && GELF_ST_BIND (sym->st_info) == STB_LOCAL))
 	continue;
 
-      sym_mem[nentries_used].where = "";
+      symx->where = "";
       if (format == format_sysv)
 	{
-	  const char *symstr = elf_strptr (ebl->elf, shdr->sh_link,
-					   sym->st_name);
-	  if (symstr == NULL)
+	  symx->name = elf_strptr (ebl->elf, shdr->sh_link, sym->st_name);
+	  if (symx->name == NULL)
 	    continue;
-
-#ifdef USE_DEMANGLE
-	  /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-	  if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	    {
-	      int status = -1;
-	      char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					       &demangle_buffer_len, &status);
-
-	      if (status == 0)
-		symstr = dmsymstr;
-	    }
-#endif
-
-	  longest_name = MAX ((size_t) longest_name, strlen (symstr));
-
-	  if (sym->st_shndx != SHN_UNDEF
-	      && GELF_ST_BIND (sym->st_info) != STB_LOCAL
-	      && global_root != NULL)
-	    {
-	      Dwarf_Global fake = { .name = symstr };
-	      Dwarf_Global **found = tfind (&fake, &global_root,
-					    global_compare);
-	      if (found != NULL)
-		{
-		  Dwarf_Die die_mem;
-		  Dwarf_Die *die = dwarf_offdie (dbg, (*found)->die_offset,
-						 &die_mem);
-
-		  Dwarf_Die cudie_mem;
-		  Dwarf_Die *cudie = NULL;
-
-		  Dwarf_Addr lowpc;
-		  Dwarf_Addr highpc;
-		  if (die != NULL
-		      && dwarf_lowpc (die, &lowpc) == 0
-		      && lowpc <= sym->st_value
-		      && dwarf_highpc (die, &highpc) == 0
-		      && highpc > sym->st_value)
-		    cudie = dwarf_offdie (dbg, (*found)->cu_offset,
-					  &cudie_mem);
-		  if (cudie != NULL)
-		    {
-		      Dwarf_Line *line = dwarf_getsrc_die (cudie,
-							   sym->st_value);
-		      if (line != NULL)
-			{
-			  /* We found the line.  */
-			  int lineno;
-			  (void) dwarf_lineno (line, &lineno);
-			  const char *file = dwarf_linesrc (line, NULL, NULL);
-			  file = (file != NULL) ? basename (file) : "???";
-			  int n;
-			  n = obstack_printf (&whereob, "%s:%d%c", file,
-					      lineno, '\0');
-			  sym_mem[nentries_used].where
-			    = obstack_finish (&whereob);
-
-			  /* The return value of obstack_print included the
-			     NUL byte, so subtract one.  */
-			  if (--n > (int) longest_where)
-			    longest_where = (size_t) n;
-			}
-		    }
-		}
-	    }
-
-	  /* Try to find the symbol among the local symbols.  */
-	  if (sym_mem[nentries_used].where[0] == '\0')
-	    {
-	      struct local_name fake =
-		{
-		  .name = symstr,
-		  .lowpc = sym->st_value,
-		  .highpc = sym->st_value,
-		};
-	      struct local_name **found = tfind (&fake, &local_root,
-						 local_compare);
-	      if (found != NULL)
-		{
-		  /* We found the line.  */
-		  int n = obstack_printf (&whereob, "%s:%" PRIu64 "%c",
-					  basename ((*found)->file),
-					  (*found)->lineno,
-					  '\0');
-		  sym_mem[nentries_used].where = obstack_finish (&whereob);
-
-		  /* The return value of obstack_print included the
-		     NUL byte, so subtract one.  */
-		  if (--n > (int) longest_where)
-		    longest_where = (size_t) n;
-		}
-	    }
+	}
+      else
+	{
+	  char symstrbuf[50];
+	  symx->name = sym_name (ebl->elf, shdr->sh_link, sym->st_name,
+				 symstrbuf, sizeof symstrbuf);
+	  if (symx->name == symstrbuf)
+	    symx->name = obstack_copy0 (&whereob, symstrbuf,
+					strlen (symstrbuf));
 	}
 
       /* We use this entry.  */
-      ++nentries_used;
-    }
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
-  /* Now we know the exact number.  */
-  nentries = nentries_used;
-
-  /* Sort the entries according to the users wishes.  */
-  if (sort == sort_name)
-    {
-      sort_by_name_strtab = elf_getdata (elf_getscn (ebl->elf, shdr->sh_link),
-					 NULL);
-      qsort (sym_mem, nentries, sizeof (GElf_SymX), sort_by_name);
-    }
-  else if (sort == sort_numeric)
-    qsort (sym_mem, nentries, sizeof (GElf_SymX), sort_by_address);
-
-  /* Finally print according to the users selection.  */
-  switch (format)
-    {
-    case format_sysv:
-      show_symbols_sysv (ebl, shdr->sh_link, fullname, sym_mem, nentries,
-			 longest_name, longest_where);
-      break;
-
-    case format_bsd:
-      show_symbols_bsd (ebl->elf, ehdr, shdr->sh_link, prefix, fname, fullname,
-			sym_mem, nentries);
-      break;
-
-    case format_posix:
-    default:
-      assert (format == format_posix);
-      show_symbols_posix (ebl->elf, ehdr, shdr->sh_link, prefix, fullname,
-			  sym_mem, nentries);
-      break;
+      if (++nentries_used == nmem && streaming)
+	{
+	  show_symbol_batch (ebl, ehdr, shdr->sh_link, fullname, dbg,
+			     &whereob, sym_mem, nentries_used);
+	  nentries_used = 0;
+	}
     }
+  show_symbol_batch (ebl, ehdr, shdr->sh_link, fullname, dbg, &whereob,
+		     sym_mem, nentries_used);
 
   /* Free all memory.  */
-  if (nentries * sizeof (sym_mem[0]) >= MAX_STACK_ALLOC)
+  if (sym_mem_malloced)
     free (sym_mem);
 
   obstack_free (&whereob, NULL);
@@ -1501,6 +1759,10 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
       tdestroy (local_root, free);
       local_root = NULL;
 
+      tdestroy (local_cus, free);
+      local_cus = NULL;
+      local_cus_all = false;
+
       if (dwfl == NULL)
 	(void) dwarf_end (dbg);
     }
@@ -128,10 +128,17 @@ static const char args_doc[] = N_("FILE...");
 /* Prototype for option handler.  */
 static error_t parse_opt (int key, char *arg, struct argp_state *state);
 
+/* Parser children.  */
+static struct argp_child argp_children[] =
+  {
+    { &jobs_argp, 0, N_("Output control:"), 0 },
+    { NULL, 0, NULL, 0}
+  };
+
 /* Data structure to communicate with argp functions.  */
 static struct argp argp =
 {
-  options, parse_opt, args_doc, doc, NULL, NULL, NULL
+  options, parse_opt, args_doc, doc, argp_children, NULL, NULL
 };
 
 /* If non-null, the section from which we should read to (compressed) ELF.  */
@@ -181,6 +188,9 @@ static bool print_archive_index;
 /* True if any of the control options except print_archive_index is set.  */
 static bool any_control_option;
 
+/* Workpool printing the modules.  */
+static struct workpool *pool;
+
 /* True if we should print addresses from DWARF in symbolic form.  */
 static bool print_address_names = true;
 
@@ -287,14 +297,20 @@ main (int argc, char *argv[])
   /* Before we start tell the ELF library which version we are using.  */
   elf_version (EV_CURRENT);
 
-  /* Now process all the files given at the command line.  */
+  /* The modules are printed by a workpool, with --jobs in parallel.
+     A single file is printed here, so the units of its sections can
+     be printed in parallel instead.  */
   bool only_one = remaining + 1 == argc;
+  pool = workpool_begin (only_one ? 1 : workpool_jobs);
+
+  /* Now process all the files given at the command line.  */
   do
     {
       /* Open the file.  */
       int fd = open (argv[remaining], O_RDONLY);
       if (fd == -1)
 	{
+	  workpool_sync (pool);
 	  error (0, errno, gettext ("cannot open input file"));
 	  continue;
 	}
@@ -305,6 +321,8 @@ main (int argc, char *argv[])
     }
   while (++remaining < argc);
 
+  workpool_end (pool);
+
   return error_message_count != 0;
 }
 
@@ -679,25 +697,58 @@ struct process_dwflmod_args
   bool only_one;
 };
 
+/* A module to print in the workpool.  */
+struct dwflmod_job
+{
+  Dwfl_Module *dwflmod;
+  int fd;
+  bool only_one;
+};
+
 static int
-process_dwflmod (Dwfl_Module *dwflmod,
-		 void **userdata __attribute__ ((unused)),
-		 const char *name __attribute__ ((unused)),
-		 Dwarf_Addr base __attribute__ ((unused)),
-		 void *arg)
+dwflmod_job_work (void *arg, FILE *data __attribute__ ((unused)))
 {
-  const struct process_dwflmod_args *a = arg;
+  struct dwflmod_job *job = arg;
 
   /* Print the file name.  */
-  if (!a->only_one)
+  if (!job->only_one)
     {
       const char *fname;
-      dwfl_module_info (dwflmod, NULL, NULL, NULL, NULL, NULL, &fname, NULL);
+      dwfl_module_info (job->dwflmod, NULL, NULL, NULL, NULL, NULL, &fname,
+			NULL);
 
       printf ("\n%s:\n\n", fname);
     }
 
-  process_elf_file (dwflmod, a->fd);
+  process_elf_file (job->dwflmod, job->fd);
+
+  return 0;
+}
+
+static bool
+dwflmod_job_done (void *arg, int result __attribute__ ((unused)),
+		  FILE *data __attribute__ ((unused)))
+{
+  free (arg);
+  return true;
+}
+
+static int
+process_dwflmod (Dwfl_Module *dwflmod,
+		 void **userdata __attribute__ ((unused)),
+		 const char *name __attribute__ ((unused)),
+		 Dwarf_Addr base __attribute__ ((unused)),
+		 void *arg)
+{
+  const struct process_dwflmod_args *a = arg;
+
+  /* A child has its own copy of the module and the file descriptor, so
+     the job does not keep them open here.  */
+  struct dwflmod_job *job = xmalloc (sizeof *job);
+  job->dwflmod = dwflmod;
+  job->fd = a->fd;
+  job->only_one = a->only_one;
+  workpool_add (pool, dwflmod_job_work, dwflmod_job_done, job);
 
   return DWARF_CB_OK;
 }
@@ -734,6 +785,9 @@ find_no_debuginfo (Dwfl_Module *mod,
 static void
 process_file (int fd, const char *fname, bool only_one)
 {
+  /* Everything but the modules is printed directly.  */
+  workpool_sync (pool);
+
   if (print_archive_index)
     check_archive_index (fd, fname, only_one);
 
@@ -4634,6 +4688,142 @@ skip_listptr_hole (struct listptr_table *table, size_t *idxp,
 }
 
 
+/* With --jobs the units of a section are split into parts which are
+   printed by the processes of a workpool.  The list pointers noticed
+   while printing .debug_info are passed back as well.  */
+struct print_part
+{
+  Dwarf_Off start;		/* First unit of the part.  */
+  Dwarf_Off end;		/* Start of the first unit after the part.  */
+  bool (*print) (Dwarf_Off start, Dwarf_Off end, void *arg);
+  void *arg;
+  Dwarf *dbg;
+  bool types;			/* True for .debug_types.  */
+};
+
+/* A list pointer noticed by a child.  */
+struct listptr_record
+{
+  uint64_t offset;
+  uint64_t cudie;		/* Offset of the DIE of the unit.  */
+  bool ranges;			/* Else for .debug_loc.  */
+  bool addr64;
+  bool dwarf64;
+};
+
+static void
+write_listptrs (FILE *data, struct listptr_table *table, size_t from,
+		bool ranges)
+{
+  for (size_t i = from; i < table->n; ++i)
+    {
+      Dwarf_Die cudie = CUDIE (table->table[i].cu);
+      struct listptr_record rec =
+	{
+	  .offset = table->table[i].offset,
+	  .cudie = dwarf_dieoffset (&cudie),
+	  .ranges = ranges,
+	  .addr64 = table->table[i].addr64,
+	  .dwarf64 = table->table[i].dwarf64
+	};
+      fwrite (&rec, sizeof rec, 1, data);
+    }
+}
+
+static void
+read_listptrs (FILE *data, Dwarf *dbg, bool types)
+{
+  struct listptr_record rec;
+  while (fread (&rec, sizeof rec, 1, data) == 1)
+    {
+      Dwarf_Die cudie;
+      if ((types ? dwarf_offdie_types : dwarf_offdie) (dbg, rec.cudie,
+						      &cudie) == NULL)
+	continue;
+
+      if (rec.ranges)
+	notice_listptr (section_ranges, &known_rangelistptr,
+			rec.addr64 ? 8 : 4, rec.dwarf64 ? 8 : 4, cudie.cu,
+			rec.offset);
+      else
+	notice_listptr (section_loc, &known_loclistptr, rec.addr64 ? 8 : 4,
+			rec.dwarf64 ? 8 : 4, cudie.cu, rec.offset);
+    }
+}
+
+/* Returns zero if printing the section has to stop after this part.  */
+static int
+print_part_work (void *arg, FILE *data)
+{
+  struct print_part *part = arg;
+  size_t nloc = known_loclistptr.n;
+  size_t nranges = known_rangelistptr.n;
+
+  bool more = part->print (part->start, part->end, part->arg);
+
+  if (data != NULL)
+    {
+      write_listptrs (data, &known_loclistptr, nloc, false);
+      write_listptrs (data, &known_rangelistptr, nranges, true);
+    }
+
+  return more;
+}
+
+static bool
+print_part_done (void *arg, int result, FILE *data)
+{
+  struct print_part *part = arg;
+
+  if (data != NULL)
+    read_listptrs (data, part->dbg, part->types);
+
+  return result > 0;
+}
+
+/* Print the NPARTS parts in PARTS with PRINT.  TYPES says whether this
+   is .debug_types.  */
+static void
+print_parts (struct print_part *parts, size_t nparts, Dwarf *dbg,
+	     bool types, bool (*print) (Dwarf_Off, Dwarf_Off, void *),
+	     void *arg)
+{
+  struct workpool *parts_pool = workpool_begin (workpool_jobs);
+  for (size_t i = 0; i < nparts; ++i)
+    {
+      parts[i].print = print;
+      parts[i].arg = arg;
+      parts[i].dbg = dbg;
+      parts[i].types = types;
+      workpool_add (parts_pool, print_part_work, print_part_done, &parts[i]);
+    }
+  workpool_end (parts_pool);
+}
+
+/* Split the units which start at the NOFFSETS offsets in OFFSETS into
+   at most workpool_jobs parts of about the same size.  The last part goes to
+   the end of the section.  Returns the number of parts.  */
+static size_t
+split_parts (const Dwarf_Off *offsets, size_t noffsets, Dwarf_Off size,
+	     struct print_part *parts)
+{
+  size_t nparts = MIN (noffsets, workpool_jobs);
+  Dwarf_Off per_part = (size - offsets[0]) / nparts;
+  size_t n = 0;
+
+  parts[n].start = offsets[0];
+  for (size_t i = 1; i < noffsets && n + 1 < nparts; ++i)
+    if (offsets[i] - offsets[0] >= (n + 1) * per_part)
+      {
+	parts[n].end = offsets[i];
+	parts[++n].start = offsets[i];
+      }
+  parts[n].end = (Dwarf_Off) -1;
+
+  return n + 1;
+}
+
+
 static void
 print_debug_abbrev_section (Dwfl_Module *dwflmod __attribute__ ((unused)),
 			    Ebl *ebl, GElf_Ehdr *ehdr,
@@ -6208,28 +6398,32 @@ attr_callback (Dwarf_Attribute *attrp, void *arg)
   return DWARF_CB_OK;
 }
 
-static void
-print_debug_units (Dwfl_Module *dwflmod,
-		   Ebl *ebl, GElf_Ehdr *ehdr,
-		   Elf_Scn *scn, GElf_Shdr *shdr,
-		   Dwarf *dbg, bool debug_types)
+struct units_args
 {
-  const bool silent = !(print_debug_sections & section_info);
-  const char *secname = section_name (ebl, ehdr, shdr);
-
-  if (!silent)
-    printf (gettext ("\
-\nDWARF section [%2zu] '%s' at offset %#" PRIx64 ":\n [Offset]\n"),
-	    elf_ndxscn (scn), secname, (uint64_t) shdr->sh_offset);
+  Dwfl_Module *dwflmod;
+  Dwarf *dbg;
+  const char *secname;
+  bool debug_types;
+  bool silent;
+};
 
-  /* If the section is empty we don't have to do anything.  */
-  if (!silent && shdr->sh_size == 0)
-    return;
+/* Print the units from offset START up to END.  Returns false if an
+   error stopped printing the section.  */
+static bool
+print_units_part (Dwarf_Off start, Dwarf_Off end, void *arg)
+{
+  struct units_args *uargs = arg;
+  Dwfl_Module *dwflmod = uargs->dwflmod;
+  Dwarf *dbg = uargs->dbg;
+  const char *secname = uargs->secname;
+  const bool debug_types = uargs->debug_types;
+  const bool silent = uargs->silent;
+  bool result = false;
 
   int maxdies = 20;
   Dwarf_Die *dies = (Dwarf_Die *) xmalloc (maxdies * sizeof (Dwarf_Die));
 
-  Dwarf_Off offset = 0;
+  Dwarf_Off offset = start;
 
   /* New compilation unit.  */
   size_t cuhl;
@@ -6357,11 +6551,78 @@ print_debug_units (Dwfl_Module *dwflmod,
   while (level >= 0);
 
   offset = nextcu;
-  if (offset != 0)
+  if (offset != 0 && offset < end)
      goto next_cu;
+  result = true;
 
  do_return:
   free (dies);
+  return result;
+}
+
+static void
+print_debug_units (Dwfl_Module *dwflmod,
+		   Ebl *ebl, GElf_Ehdr *ehdr,
+		   Elf_Scn *scn, GElf_Shdr *shdr,
+		   Dwarf *dbg, bool debug_types)
+{
+  const bool silent = !(print_debug_sections & section_info);
+  const char *secname = section_name (ebl, ehdr, shdr);
+
+  if (!silent)
+    printf (gettext ("\
+\nDWARF section [%2zu] '%s' at offset %#" PRIx64 ":\n [Offset]\n"),
+	    elf_ndxscn (scn), secname, (uint64_t) shdr->sh_offset);
+
+  /* If the section is empty we don't have to do anything.  */
+  if (!silent && shdr->sh_size == 0)
+    return;
+
+  struct units_args uargs =
+    {
+      .dwflmod = dwflmod,
+      .dbg = dbg,
+      .secname = secname,
+      .debug_types = debug_types,
+      .silent = silent
+    };
+
+  if (workpool_jobs > 1)
+    {
+      /* Find where the units start, only looking at the headers.  */
+      size_t noffsets = 0;
+      size_t maxoffsets = 64;
+      Dwarf_Off *offsets = xmalloc (maxoffsets * sizeof (Dwarf_Off));
+      Dwarf_Off offset = 0;
+      Dwarf_Off nextcu;
+      uint64_t typesig;
+      while (dwarf_next_unit (dbg, offset, &nextcu, NULL, NULL, NULL, NULL,
+			      NULL, debug_types ? &typesig : NULL, NULL) == 0)
+	{
+	  if (noffsets == maxoffsets)
+	    offsets = xrealloc (offsets,
+				(maxoffsets *= 2) * sizeof (Dwarf_Off));
+	  offsets[noffsets++] = offset;
+	  if ((offset = nextcu) == 0)
+	    break;
+	}
+
+      if (noffsets > 1)
+	{
+	  struct print_part *parts
+	    = xmalloc (MIN (noffsets, workpool_jobs) * sizeof (*parts));
+	  size_t nparts = split_parts (offsets, noffsets, shdr->sh_size,
+				       parts);
+	  free (offsets);
+	  print_parts (parts, nparts, dbg, debug_types, print_units_part,
+		       &uargs);
+	  free (parts);
+	  return;
+	}
+      free (offsets);
+    }
+
+  (void) print_units_part (0, (Dwarf_Off) -1, &uargs);
 }
 
 static void
@@ -6469,39 +6730,39 @@ print_decoded_line_section (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr,
 }
 
 
-static void
-print_debug_line_section (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr,
-			  Elf_Scn *scn, GElf_Shdr *shdr, Dwarf *dbg)
+struct line_args
 {
-  if (decodedline)
-    {
-      print_decoded_line_section (dwflmod, ebl, ehdr, scn, shdr, dbg);
-      return;
-    }
-
-  printf (gettext ("\
-\nDWARF section [%2zu] '%s' at offset %#" PRIx64 ":\n"),
-	  elf_ndxscn (scn), section_name (ebl, ehdr, shdr),
-	  (uint64_t) shdr->sh_offset);
-
-  if (shdr->sh_size == 0)
-    return;
-
-  /* There is no functionality in libdw to read the information in the
-     way it is represented here.  Hardcode the decoder.  */
-  Elf_Data *data = dbg->sectiondata[IDX_debug_line];
-  if (unlikely (data == NULL || data->d_buf == NULL))
-    {
-      error (0, 0, gettext ("cannot get line data section data: %s"),
-	     elf_errmsg (-1));
-      return;
-    }
+  Dwfl_Module *dwflmod;
+  Ebl *ebl;
+  GElf_Ehdr *ehdr;
+  Elf_Scn *scn;
+  GElf_Shdr *shdr;
+  Dwarf *dbg;
+  Elf_Data *data;
+};
 
-  const unsigned char *linep = (const unsigned char *) data->d_buf;
+/* Print the line number programs from offset START up to END.  Returns
+   false if invalid data stopped printing the section.  */
+static bool
+print_line_part (Dwarf_Off start, Dwarf_Off end, void *arg)
+{
+  struct line_args *largs = arg;
+  Dwfl_Module *dwflmod = largs->dwflmod;
+  Ebl *ebl = largs->ebl;
+  GElf_Ehdr *ehdr = largs->ehdr;
+  Elf_Scn *scn = largs->scn;
+  GElf_Shdr *shdr = largs->shdr;
+  Dwarf *dbg = largs->dbg;
+  Elf_Data *data = largs->data;
+
+  const unsigned char *linep = (const unsigned char *) data->d_buf + start;
   const unsigned char *lineendp;
 
-  while (linep
-	 < (lineendp = (const unsigned char *) data->d_buf + data->d_size))
+  if (end > data->d_size)
+    end = data->d_size;
+  while (linep < (const unsigned char *) data->d_buf + end
+	 && linep < (lineendp = ((const unsigned char *) data->d_buf
+				 + data->d_size)))
     {
       size_t start_offset = linep - (const unsigned char *) data->d_buf;
 
@@ -6518,7 +6779,7 @@ print_debug_line_section (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr,
 	    invalid_data:
 	      error (0, 0, gettext ("invalid data in section [%zu] '%s'"),
 		     elf_ndxscn (scn), section_name (ebl, ehdr, shdr));
-	      return;
+	      return false;
 	    }
 	  unit_length = read_8ubyte_unaligned_inc (dbg, linep);
 	  length = 8;
@@ -6992,6 +7253,102 @@ print_debug_line_section (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr,
 	}
     }
 
+  return true;
+}
+
+
+static void
+print_debug_line_section (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr,
+			  Elf_Scn *scn, GElf_Shdr *shdr, Dwarf *dbg)
+{
+  if (decodedline)
+    {
+      print_decoded_line_section (dwflmod, ebl, ehdr, scn, shdr, dbg);
+      return;
+    }
+
+  printf (gettext ("\
+\nDWARF section [%2zu] '%s' at offset %#" PRIx64 ":\n"),
+	  elf_ndxscn (scn), section_name (ebl, ehdr, shdr),
+	  (uint64_t) shdr->sh_offset);
+
+  if (shdr->sh_size == 0)
+    return;
+
+  /* There is no functionality in libdw to read the information in the
+     way it is represented here.  Hardcode the decoder.  */
+  Elf_Data *data = dbg->sectiondata[IDX_debug_line];
+  if (unlikely (data == NULL || data->d_buf == NULL))
+    {
+      error (0, 0, gettext ("cannot get line data section data: %s"),
+	     elf_errmsg (-1));
+      return;
+    }
+
+  struct line_args largs =
+    {
+      .dwflmod = dwflmod,
+      .ebl = ebl,
+      .ehdr = ehdr,
+      .scn = scn,
+      .shdr = shdr,
+      .dbg = dbg,
+      .data = data
+    };
+
+  if (workpool_jobs > 1)
+    {
+      /* Find where the line number programs start, only looking at the
+	 unit lengths.  Whatever comes after invalid data is left to the
+	 last part, which reports it.  */
+      size_t noffsets = 0;
+      size_t maxoffsets = 64;
+      Dwarf_Off *offsets = xmalloc (maxoffsets * sizeof (Dwarf_Off));
+      const unsigned char *linep = (const unsigned char *) data->d_buf;
+      const unsigned char *lineendp = linep + data->d_size;
+      while (linep < lineendp)
+	{
+	  if (noffsets == maxoffsets)
+	    offsets = xrealloc (offsets,
+				(maxoffsets *= 2) * sizeof (Dwarf_Off));
+	  offsets[noffsets++] = linep - (const unsigned char *) data->d_buf;
+
+	  if (unlikely (linep + 4 > lineendp))
+	    break;
+	  Dwarf_Word unit_length = read_4ubyte_unaligned_inc (dbg, linep);
+	  unsigned int length = 4;
+	  if (unlikely (unit_length == 0xffffffff))
+	    {
+	      if (unlikely (linep + 8 > lineendp))
+		break;
+	      unit_length = read_8ubyte_unaligned_inc (dbg, linep);
+	      length = 8;
+	    }
+	  if (unlikely (unit_length > (size_t) (lineendp - linep)
+			|| unit_length < 2 + length + 5 * 1))
+	    break;
+	  linep += unit_length;
+	}
+
+      if (noffsets > 1)
+	{
+	  struct print_part *parts
+	    = xmalloc (MIN (noffsets, workpool_jobs) * sizeof (*parts));
+	  size_t nparts = split_parts (offsets, noffsets, data->d_size,
+				       parts);
+	  free (offsets);
+	  print_parts (parts, nparts, dbg, false, print_line_part, &largs);
+	  free (parts);
+	}
+      else
+	{
+	  free (offsets);
+	  (void) print_line_part (0, (Dwarf_Off) -1, &largs);
+	}
+    }
+  else
+    (void) print_line_part (0, (Dwarf_Off) -1, &largs);
+
   /* There must only be one data block.  */
   assert (elf_getdata (scn, data) == NULL);
 }
@@ -8326,6 +8683,10 @@ print_debug (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr)
 	       dwfl_errmsg (-1));
       dbg = &dummy_dbg;
     }
+  else
+    /* The section data is used directly below, which needs all of it
+       to be relocated already.  */
+    (void) dwarf_getelf (dbg);
 
   /* Get the section header string table index.  */
   size_t shstrndx;
@@ -9640,7 +10001,6 @@ for_each_section_argument (Elf *elf, const struct section_argument *list,
     {
       Elf_Scn *scn;
       GElf_Shdr shdr_mem;
-      const char *name = NULL;
 
       char *endp = NULL;
       unsigned long int shndx = strtoul (a->arg, &endp, 0);
@@ -9656,25 +10016,18 @@ for_each_section_argument (Elf *elf, const struct section_argument *list,
 	  if (gelf_getshdr (scn, &shdr_mem) == NULL)
 	    error (EXIT_FAILURE, 0, gettext ("cannot get section header: %s"),
 		   elf_errmsg (-1));
-	  name = elf_strptr (elf, shstrndx, shdr_mem.sh_name);
 	}
       else
 	{
 	  /* Need to look up the section by name.  */
 	  scn = NULL;
 	  bool found = false;
-	  while ((scn = elf_nextscn (elf, scn)) != NULL)
+	  while ((scn = elf_nextscnbyname (elf, scn, a->arg)) != NULL)
 	    {
 	      if (gelf_getshdr (scn, &shdr_mem) == NULL)
 		continue;
-	      name = elf_strptr (elf, shstrndx, shdr_mem.sh_name);
-	      if (name == NULL)
-		continue;
-	      if (!strcmp (name, a->arg))
-		{
-		  found = true;
-		  (*dump) (scn, &shdr_mem, name);
-		}
+	      found = true;
+	      (*dump) (scn, &shdr_mem, a->arg);
 	    }
 
 	  if (unlikely (!found) && !a->implicit)
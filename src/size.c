@@ -85,10 +85,17 @@ static const char args_doc[] = N_("[FILE...]");
 /* Prototype for option handler.  */
 static error_t parse_opt (int key, char *arg, struct argp_state *state);
 
+/* Parser children.  */
+static struct argp_child argp_children[] =
+  {
+    { &jobs_argp, 0, N_("Miscellaneous:"), 0 },
+    { NULL, 0, NULL, 0}
+  };
+
 /* Data structure to communicate with argp functions.  */
 static struct argp argp =
 {
-  options, parse_opt, args_doc, doc, NULL, NULL, NULL
+  options, parse_opt, args_doc, doc, argp_children, NULL, NULL
 };
 
 
@@ -96,11 +103,15 @@ static struct argp argp =
 static int process_file (const char *fname);
 
 /* Handle content of archive.  */
-static int handle_ar (int fd, Elf *elf, const char *prefix, const char *fname);
+struct open_elf;
+static int handle_ar (struct open_elf *file, const char *prefix);
 
 /* Handle ELF file.  */
 static void handle_elf (Elf *elf, const char *fullname, const char *fname);
 
+/* Print the BSD-style header.  */
+static void print_header (Elf *elf);
+
 /* Show total size.  */
 static void show_bsd_totals (void);
 
@@ -152,6 +163,42 @@ static bool totals;
    "class" of ELF binaries processed.  */
 static int totals_class;
 
+/* Variables to add up the sizes of all files.  */
+static uintmax_t total_textsize;
+static uintmax_t total_datasize;
+static uintmax_t total_bsssize;
+
+/* The files and archive members are handled by a workpool, with
+   --jobs in parallel.  An ELF descriptor stays open until everything
+   using it is done.  */
+struct open_elf
+{
+  Elf *elf;
+  int fd;
+  bool close_fd;		/* True for the files opened here.  */
+  char *fname;
+  struct open_elf *parent;	/* The archive ELF is a member of.  */
+  unsigned int refs;
+};
+
+/* Sizes of one ELF file to print.  */
+struct elf_job
+{
+  struct open_elf *file;
+  char *prefix;
+};
+
+/* What a job adds to the totals.  */
+struct elf_job_totals
+{
+  uintmax_t textsize;
+  uintmax_t datasize;
+  uintmax_t bsssize;
+  int class;
+};
+
+static struct workpool *pool;
+
 
 int
 main (int argc, char *argv[])
@@ -180,6 +227,8 @@ main (int argc, char *argv[])
   /* Tell the library which version we are expecting.  */
   elf_version (EV_CURRENT);
 
+  pool = workpool_begin (workpool_jobs);
+
   if (remaining == argc)
     /* The user didn't specify a name so we use a.out.  */
     result = process_file ("a.out");
@@ -189,6 +238,8 @@ main (int argc, char *argv[])
       result |= process_file (argv[remaining]);
     while (++remaining < argc);
 
+  workpool_end (pool);
+
   /* Print the total sizes but only if the output format is BSD and at
      least one file has been correctly read (i.e., we recognized the
      class).  */
@@ -279,6 +330,105 @@ parse_opt (int key, char *arg,
 }
 
 
+static struct open_elf *
+open_elf_new (Elf *elf, int fd, const char *fname, struct open_elf *parent)
+{
+  struct open_elf *file = xmalloc (sizeof *file);
+  file->elf = elf;
+  file->fd = fd;
+  file->close_fd = parent == NULL;
+  file->fname = xstrdup (fname);
+  file->parent = parent;
+  file->refs = 1;
+  if (parent != NULL)
+    ++parent->refs;
+  return file;
+}
+
+
+static void
+open_elf_release (struct open_elf *file)
+{
+  if (--file->refs != 0)
+    return;
+
+  if (unlikely (elf_end (file->elf) != 0))
+    INTERNAL_ERROR (file->fname);
+
+  if (unlikely (file->close_fd && close (file->fd) != 0))
+    error (EXIT_FAILURE, errno, gettext ("while closing '%s'"), file->fname);
+
+  if (file->parent != NULL)
+    open_elf_release (file->parent);
+  free (file->fname);
+  free (file);
+}
+
+
+static int
+elf_job_work (void *arg, FILE *data)
+{
+  struct elf_job *job = arg;
+  struct elf_job_totals before =
+    {
+      total_textsize, total_datasize, total_bsssize, totals_class
+    };
+
+  handle_elf (job->file->elf, job->prefix, job->file->fname);
+
+  if (data != NULL)
+    {
+      struct elf_job_totals added =
+	{
+	  total_textsize - before.textsize,
+	  total_datasize - before.datasize,
+	  total_bsssize - before.bsssize,
+	  totals_class
+	};
+      fwrite (&added, sizeof added, 1, data);
+    }
+
+  return 0;
+}
+
+
+static bool
+elf_job_done (void *arg, int result __attribute__ ((unused)), FILE *data)
+{
+  struct elf_job *job = arg;
+  struct elf_job_totals added;
+
+  if (data != NULL && fread (&added, sizeof added, 1, data) == 1)
+    {
+      total_textsize += added.textsize;
+      total_datasize += added.datasize;
+      total_bsssize += added.bsssize;
+      totals_class = MAX (totals_class, added.class);
+    }
+
+  open_elf_release (job->file);
+  free (job->prefix);
+  free (job);
+  return true;
+}
+
+
+/* Print the sizes of FILE in the workpool, taking over our reference
+   to it.  */
+static void
+add_elf_job (struct open_elf *file, const char *prefix)
+{
+  /* The header is printed only once, so not by the job.  */
+  if (format == format_bsd)
+    print_header (file->elf);
+
+  struct elf_job *job = xmalloc (sizeof *job);
+  job->file = file;
+  job->prefix = prefix != NULL ? xstrdup (prefix) : NULL;
+  workpool_add (pool, elf_job_work, elf_job_done, job);
+}
+
+
 /* Open the file and determine the type.  */
 static int
 process_file (const char *fname)
@@ -286,6 +436,7 @@ process_file (const char *fname)
   int fd = open (fname, O_RDONLY);
   if (unlikely (fd == -1))
     {
+      workpool_sync (pool);
       error (0, errno, gettext ("cannot open '%s'"), fname);
       return 1;
     }
@@ -296,23 +447,14 @@ process_file (const char *fname)
     {
       if (elf_kind (elf) == ELF_K_ELF)
 	{
-	  handle_elf (elf, NULL, fname);
-
-	  if (unlikely (elf_end (elf) != 0))
-	    INTERNAL_ERROR (fname);
-
-	  if (unlikely (close (fd) != 0))
-	    error (EXIT_FAILURE, errno, gettext ("while closing '%s'"), fname);
-
+	  add_elf_job (open_elf_new (elf, fd, fname, NULL), NULL);
 	  return 0;
 	}
       else if (likely (elf_kind (elf) == ELF_K_AR))
 	{
-	  int result = handle_ar (fd, elf, NULL, fname);
-
-	  if (unlikely  (close (fd) != 0))
-	    error (EXIT_FAILURE, errno, gettext ("while closing '%s'"), fname);
-
+	  struct open_elf *file = open_elf_new (elf, fd, fname, NULL);
+	  int result = handle_ar (file, NULL);
+	  open_elf_release (file);
 	  return result;
 	}
 
@@ -324,6 +466,7 @@ process_file (const char *fname)
   if (unlikely (close (fd) != 0))
     error (EXIT_FAILURE, errno, gettext ("while closing '%s'"), fname);
 
+  workpool_sync (pool);
   error (0, 0, gettext ("%s: file format not recognized"), fname);
 
   return 1;
@@ -338,6 +481,8 @@ print_header (Elf *elf)
 
   if (! done)
     {
+      workpool_sync (pool);
+
       int ddigits = length_map[gelf_getclass (elf) - 1][radix_decimal];
       int xdigits = length_map[gelf_getclass (elf) - 1][radix_hex];
 
@@ -355,8 +500,11 @@ print_header (Elf *elf)
 
 
 static int
-handle_ar (int fd, Elf *elf, const char *prefix, const char *fname)
+handle_ar (struct open_elf *file, const char *prefix)
 {
+  int fd = file->fd;
+  Elf *elf = file->elf;
+  const char *fname = file->fname;
   size_t prefix_len = prefix == NULL ? 0 : strlen (prefix);
   size_t fname_len = strlen (fname) + 1;
   char new_prefix[prefix_len + 1 + fname_len];
@@ -379,10 +527,25 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname)
       /* The the header for this element.  */
       Elf_Arhdr *arhdr = elf_getarhdr (subelf);
 
-      if (elf_kind (subelf) == ELF_K_ELF)
-	handle_elf (subelf, new_prefix, arhdr->ar_name);
-      else if (likely (elf_kind (subelf) == ELF_K_AR))
-	result |= handle_ar (fd, subelf, new_prefix, arhdr->ar_name);
+      if (elf_kind (subelf) == ELF_K_ELF
+	  || likely (elf_kind (subelf) == ELF_K_AR))
+	{
+	  /* The header changes with elf_next.  */
+	  struct open_elf *member = open_elf_new (subelf, fd, arhdr->ar_name,
+						  file);
+	  if (elf_kind (subelf) == ELF_K_ELF)
+	    {
+	      cmd = elf_next (subelf);
+	      add_elf_job (member, new_prefix);
+	    }
+	  else
+	    {
+	      result |= handle_ar (member, new_prefix);
+	      cmd = elf_next (subelf);
+	      open_elf_release (member);
+	    }
+	  continue;
+	}
       /* else signal error??? */
 
       /* Get next archive element.  */
@@ -391,9 +554,6 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname)
 	INTERNAL_ERROR (fname);
     }
 
-  if (unlikely (elf_end (elf) != 0))
-    INTERNAL_ERROR (fname);
-
   return result;
 }
 
@@ -515,11 +675,6 @@ show_sysv_one_line (Elf *elf)
 }
 
 
-/* Variables to add up the sizes of all files.  */
-static uintmax_t total_textsize;
-static uintmax_t total_datasize;
-static uintmax_t total_bsssize;
-
 
 /* Show sizes in BSD format.  */
 static void
@@ -662,11 +817,7 @@ handle_elf (Elf *elf, const char *prefix, const char *fname)
   else if (format == format_segments)
     show_segments (elf, fullname);
   else
-    {
-      print_header (elf);
-
-      show_bsd (elf, prefix, fname, fullname);
-    }
+    show_bsd (elf, prefix, fname, fullname);
 }
 
 
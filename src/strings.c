@@ -31,6 +31,7 @@
 #include <inttypes.h>
 #include <libintl.h>
 #include <locale.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdio_ext.h>
@@ -42,6 +43,7 @@
 #include <sys/stat.h>
 
 #include <system.h>
+#include <printable.h>
 
 #ifndef MAP_POPULATE
 # define MAP_POPULATE 0
@@ -90,10 +92,17 @@ static const char args_doc[] = N_("[FILE...]");
 /* Prototype for option handler.  */
 static error_t parse_opt (int key, char *arg, struct argp_state *state);
 
+/* Parser children.  */
+static struct argp_child argp_children[] =
+  {
+    { &jobs_argp, 0, N_("Miscellaneous:"), 0 },
+    { NULL, 0, NULL, 0}
+  };
+
 /* Data structure to communicate with argp functions.  */
 static struct argp argp =
 {
-  options, parse_opt, args_doc, doc, NULL, NULL, NULL
+  options, parse_opt, args_doc, doc, argp_children, NULL, NULL
 };
 
 
@@ -133,6 +142,9 @@ static enum
 /* Page size in use.  */
 static size_t ps;
 
+/* The bytes which can be part of a string.  */
+static struct printable_class printable_byte;
+
 
 /* Mapped parts of the ELF file.  */
 static unsigned char *elfmap;
@@ -167,6 +179,8 @@ main (int argc, char *argv[])
   /* Determine the page size.  We will likely need it a couple of times.  */
   ps = sysconf (_SC_PAGESIZE);
 
+  printable_class_init (&printable_byte, char_7bit);
+
   struct stat st;
   int result = 0;
   if (remaining == argc)
@@ -325,32 +339,41 @@ parse_opt (int key, char *arg,
 }
 
 
+/* Whether the character at BUF, of BYTES_PER_CHAR bytes, can be part of
+   a string.  */
+static inline bool
+printable_mb (const unsigned char *buf)
+{
+  uint32_t ch;
+
+  if (bytes_per_char == 2)
+    {
+      if (big_endian)
+	ch = buf[0] << 8 | buf[1];
+      else
+	ch = buf[1] << 8 | buf[0];
+    }
+  else
+    {
+      if (big_endian)
+	ch = buf[0] << 24 | buf[1] << 16 | buf[2] << 8 | buf[3];
+      else
+	ch = buf[3] << 24 | buf[2] << 16 | buf[1] << 8 | buf[0];
+    }
+
+  return ch <= 255 && (isprint (ch) || ch == '\t');
+}
+
+
 static void
-process_chunk_mb (const char *fname, const unsigned char *buf, off_t to,
-		  size_t len, char **unprinted)
+process_chunk_mb (const char *fname, FILE *out, const unsigned char *buf,
+		  off_t to, size_t len, char **unprinted)
 {
   size_t curlen = *unprinted == NULL ? 0 : strlen (*unprinted);
   const unsigned char *start = buf;
   while (len >= bytes_per_char)
     {
-      uint32_t ch;
-
-      if (bytes_per_char == 2)
-	{
-	  if (big_endian)
-	    ch = buf[0] << 8 | buf[1];
-	  else
-	    ch = buf[1] << 8 | buf[0];
-	}
-      else
-	{
-	  if (big_endian)
-	    ch = buf[0] << 24 | buf[1] << 16 | buf[2] << 8 | buf[3];
-	  else
-	    ch = buf[3] << 24 | buf[2] << 16 | buf[1] << 8 | buf[0];
-	}
-
-      if (ch <= 255 && (isprint (ch) || ch == '\t'))
+      if (printable_mb (buf))
 	{
 	  ++buf;
 	  ++curlen;
@@ -362,19 +385,19 @@ process_chunk_mb (const char *fname, const unsigned char *buf, off_t to,
 	      /* We found a match.  */
 	      if (unlikely (fname != NULL))
 		{
-		  fputs_unlocked (fname, stdout);
-		  fputs_unlocked (": ", stdout);
+		  fputs_unlocked (fname, out);
+		  fputs_unlocked (": ", out);
 		}
 
 	      if (unlikely (radix != radix_none))
-		printf ((radix == radix_octal ? "%7" PRIo64 " "
-			 : (radix == radix_decimal ? "%7" PRId64 " "
-			    : "%7" PRIx64 " ")),
-			(int64_t) to - len - (buf - start));
+		fprintf (out, (radix == radix_octal ? "%7" PRIo64 " "
+				: (radix == radix_decimal ? "%7" PRId64 " "
+				   : "%7" PRIx64 " ")),
+			 (int64_t) to - len - (buf - start));
 
 	      if (unlikely (*unprinted != NULL))
 		{
-		  fputs_unlocked (*unprinted, stdout);
+		  fputs_unlocked (*unprinted, out);
 		  free (*unprinted);
 		  *unprinted = NULL;
 		}
@@ -383,8 +406,14 @@ process_chunk_mb (const char *fname, const unsigned char *buf, off_t to,
 		 assume the file data is encoded in UCS-2/UTF-16 or
 		 UCS-4/UTF-32 respectively we could covert the string.
 		 But there is no such guarantee.  */
-	      fwrite_unlocked (start, 1, buf - start, stdout);
-	      putc_unlocked ('\n', stdout);
+	      fwrite_unlocked (start, 1, buf - start, out);
+	      putc_unlocked ('\n', out);
+	    }
+	  else if (unlikely (*unprinted != NULL))
+	    {
+	      /* The string is too short after all.  */
+	      free (*unprinted);
+	      *unprinted = NULL;
 	    }
 
 	  start = ++buf;
@@ -403,14 +432,14 @@ process_chunk_mb (const char *fname, const unsigned char *buf, off_t to,
 
 
 static void
-process_chunk (const char *fname, const unsigned char *buf, off_t to,
-	       size_t len, char **unprinted)
+process_chunk (const char *fname, FILE *out, const unsigned char *buf,
+	       off_t to, size_t len, char **unprinted)
 {
   /* We are not going to slow the check down for the 2- and 4-byte
      encodings.  Handle them special.  */
   if (unlikely (bytes_per_char != 1))
     {
-      process_chunk_mb (fname, buf, to, len, unprinted);
+      process_chunk_mb (fname, out, buf, to, len, unprinted);
       return;
     }
 
@@ -418,10 +447,14 @@ process_chunk (const char *fname, const unsigned char *buf, off_t to,
   const unsigned char *start = buf;
   while (len > 0)
     {
-      if ((isprint (*buf) || *buf == '\t') && (! char_7bit || *buf <= 127))
+      if (printable_byte.byte[*buf])
 	{
-	  ++buf;
-	  ++curlen;
+	  /* Skip the whole run at once.  */
+	  size_t n = printable_run (&printable_byte, buf, len);
+	  buf += n;
+	  curlen += n;
+	  len -= n;
+	  continue;
 	}
       else
 	{
@@ -430,34 +463,44 @@ process_chunk (const char *fname, const unsigned char *buf, off_t to,
 	      /* We found a match.  */
 	      if (likely (fname != NULL))
 		{
-		  fputs_unlocked (fname, stdout);
-		  fputs_unlocked (": ", stdout);
+		  fputs_unlocked (fname, out);
+		  fputs_unlocked (": ", out);
 		}
 
 	      if (likely (radix != radix_none))
-		printf ((radix == radix_octal ? "%7" PRIo64 " "
-			 : (radix == radix_decimal ? "%7" PRId64 " "
-			    : "%7" PRIx64 " ")),
-			(int64_t) to - len - (buf - start));
+		fprintf (out, (radix == radix_octal ? "%7" PRIo64 " "
+				: (radix == radix_decimal ? "%7" PRId64 " "
+				   : "%7" PRIx64 " ")),
+			 (int64_t) to - len - (buf - start));
 
 	      if (unlikely (*unprinted != NULL))
 		{
-		  fputs_unlocked (*unprinted, stdout);
+		  fputs_unlocked (*unprinted, out);
 		  free (*unprinted);
 		  *unprinted = NULL;
 		}
-	      fwrite_unlocked (start, 1, buf - start, stdout);
-	      putc_unlocked ('\n', stdout);
+	      fwrite_unlocked (start, 1, buf - start, out);
+	      putc_unlocked ('\n', out);
+	    }
+	  else if (unlikely (*unprinted != NULL))
+	    {
+	      /* The string is too short after all.  */
+	      free (*unprinted);
+	      *unprinted = NULL;
 	    }
 
-	  start = ++buf;
+	  /* Skip all the bytes which cannot start a string.  We are done
+	     if we get within MIN_LEN of the end on the way.  */
+	  size_t n = nonprintable_run (&printable_byte, buf, len);
+	  start = buf + n;
 	  curlen =  0;
 
-	  if (len <= min_len)
+	  if (len - (n - 1) <= min_len)
 	    break;
-	}
 
-      --len;
+	  buf = start;
+	  len -= n;
+	}
     }
 
   if (curlen != 0)
@@ -465,6 +508,126 @@ process_chunk (const char *fname, const unsigned char *buf, off_t to,
 }
 
 
+/* With --jobs mapped data is scanned by several threads, in pieces of
+   about this size at most.  Less data is shared out among the jobs, in
+   pieces of at least PIECE_SIZE_MIN.  */
+#define PIECE_SIZE (4 * 1024 * 1024)
+#define PIECE_SIZE_MIN (64 * 1024)
+
+/* A piece scanned by a thread, the output is collected in memory.  */
+struct piece
+{
+  const char *fname;
+  const unsigned char *buf;
+  off_t to;
+  size_t len;
+  char *unprinted;
+  char *out;
+  size_t outlen;
+  pthread_t thread;
+  bool started;
+};
+
+
+static void *
+scan_piece (void *arg)
+{
+  struct piece *piece = arg;
+
+  FILE *out = open_memstream (&piece->out, &piece->outlen);
+  if (unlikely (out == NULL))
+    error (EXIT_FAILURE, errno, gettext ("cannot allocate output buffer"));
+  __fsetlocking (out, FSETLOCKING_BYCALLER);
+
+  process_chunk (piece->fname, out, piece->buf, piece->to, piece->len,
+		 &piece->unprinted);
+
+  if (unlikely (fclose (out) != 0))
+    error (EXIT_FAILURE, errno, gettext ("cannot allocate output buffer"));
+  return NULL;
+}
+
+
+/* Return the first position from POS on at which scanning BUF from the
+   start has nothing collected, or LEN if there is none.  That is the
+   case where the character starting right before is not printable.  */
+static size_t
+piece_boundary (const unsigned char *buf, size_t pos, size_t len)
+{
+  for (size_t n = pos - 1; n + bytes_per_char <= len; ++n)
+    if (! (bytes_per_char == 1
+	   ? printable_byte.byte[buf[n]] : printable_mb (buf + n)))
+      return n + 1;
+  return len;
+}
+
+
+/* Like process_chunk on stdout, with --jobs in several threads.  The
+   data is split into pieces where a new string starts, so each thread
+   can look for strings on its own.  The output is written in the
+   order of the pieces.  */
+static void
+process_mapped (const char *fname, const unsigned char *buf, off_t to,
+		size_t len, char **unprinted)
+{
+  if (workpool_jobs == 1)
+    {
+      process_chunk (fname, stdout, buf, to, len, unprinted);
+      return;
+    }
+
+  size_t piece_size = MAX (MIN (len / workpool_jobs, PIECE_SIZE),
+			   PIECE_SIZE_MIN);
+  struct piece *pieces = xmalloc (workpool_jobs * sizeof (*pieces));
+  size_t pos = 0;
+  while (pos < len)
+    {
+      /* Start as many pieces as there are jobs.  */
+      size_t npieces = 0;
+      while (npieces < workpool_jobs && pos < len)
+	{
+	  size_t end = (len - pos >= 2 * piece_size
+			? piece_boundary (buf, pos + piece_size, len) : len);
+
+	  struct piece *piece = &pieces[npieces++];
+	  piece->fname = fname;
+	  piece->buf = buf + pos;
+	  /* The characters starting right before the end are looked at
+	     as well, they are not printable.  */
+	  piece->len = end == len ? len - pos : end + bytes_per_char - 1 - pos;
+	  piece->to = to - (len - pos - piece->len);
+	  piece->unprinted = pos == 0 ? *unprinted : NULL;
+	  piece->out = NULL;
+	  piece->outlen = 0;
+	  piece->started = (npieces > 1
+			    && pthread_create (&piece->thread, NULL,
+					       scan_piece, piece) == 0);
+	  pos = end;
+	}
+
+      /* The first piece is scanned here, and those for which no
+	 thread could be started.  */
+      for (size_t i = 0; i < npieces; ++i)
+	{
+	  struct piece *piece = &pieces[i];
+	  if (piece->started)
+	    pthread_join (piece->thread, NULL);
+	  else
+	    scan_piece (piece);
+
+	  fwrite_unlocked (piece->out, 1, piece->outlen, stdout);
+	  free (piece->out);
+	}
+
+      /* Only the last piece ends without a character which is not
+	 printable.  */
+      *unprinted = pieces[npieces - 1].unprinted;
+    }
+
+  free (pieces);
+}
+
+
 /* Map a file in as large chunks as possible.  */
 static void *
 map_file (int fd, off_t start_off, off_t fdlen, size_t *map_sizep)
@@ -552,7 +715,7 @@ read_block_no_mmap (int fd, const char *fname, off_t from, off_t fdlen)
 	  /* We only use complete characters.  */
 	  nb &= ~(bytes_per_char - 1);
 
-	  process_chunk (fname, buf, from + nb, nb, &unprinted);
+	  process_chunk (fname, stdout, buf, from + nb, nb, &unprinted);
 
 	  /* If the last bytes of the buffer (modulo the character
 	     size) have been printed we are not copying them.  */
@@ -626,10 +789,10 @@ read_block (int fd, const char *fname, off_t fdlen, off_t from, off_t to)
       && from < (off_t) (elfmap_off + elfmap_size))
     /* There are at least a few bytes in this mapping which we can
        use.  */
-    process_chunk (fname, elfmap_base + (from - elfmap_off),
-		   MIN (to, (off_t) (elfmap_off + elfmap_size)),
-		   MIN (to, (off_t) (elfmap_off + elfmap_size)) - from,
-		   &unprinted);
+    process_mapped (fname, elfmap_base + (from - elfmap_off),
+		    MIN (to, (off_t) (elfmap_off + elfmap_size)),
+		    MIN (to, (off_t) (elfmap_off + elfmap_size)) - from,
+		    &unprinted);
 
   if (to > (off_t) (elfmap_off + elfmap_size))
     {
@@ -681,10 +844,10 @@ read_block (int fd, const char *fname, off_t fdlen, off_t from, off_t to)
 	    error (EXIT_FAILURE, errno, gettext ("re-mmap failed"));
 	  elfmap_off = handled_to;
 
-	  process_chunk (fname, remap_base - to_keep,
-			 elfmap_off + (read_now & ~(bytes_per_char - 1)),
-			 to_keep + (read_now & ~(bytes_per_char - 1)),
-			 &unprinted);
+	  process_mapped (fname, remap_base - to_keep,
+			  elfmap_off + (read_now & ~(bytes_per_char - 1)),
+			  to_keep + (read_now & ~(bytes_per_char - 1)),
+			  &unprinted);
 	  handled_to += read_now;
 	  if (handled_to >= to)
 	    break;
@@ -30,6 +30,7 @@
 #include <libelf.h>
 #include <libintl.h>
 #include <locale.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdio_ext.h>
@@ -60,6 +61,7 @@ ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
 #define OPT_PERMISSIVE		0x101
 #define OPT_STRIP_SECTIONS	0x102
 #define OPT_RELOC_DEBUG 	0x103
+#define OPT_COMPRESS_DEBUG	0x104
 
 
 /* Definitions of arguments for argp functions.  */
@@ -81,6 +83,9 @@ static const struct argp_option options[] =
     N_("Copy modified/access timestamps to the output"), 0 },
   { "reloc-debug-sections", OPT_RELOC_DEBUG, NULL, 0,
     N_("Resolve all trivial relocations between debug sections if the removed sections are placed in a debug file (only relevant for ET_REL files, operation is not reversable, needs -f)"), 0 },
+  { "compress-debug-sections", OPT_COMPRESS_DEBUG, "TYPE",
+    OPTION_ARG_OPTIONAL,
+    N_("Compress the debug sections placed in the debug file.  TYPE can be 'zlib' (ELF ZLIB compression, the default, 'zlib-gabi' is an alias) or 'none' (needs -f)"), 0 },
   { "remove-comment", OPT_REMOVE_COMMENT, NULL, 0,
     N_("Remove .comment section"), 0 },
   { "remove-section", 'R', "SECTION", OPTION_HIDDEN, NULL, 0 },
@@ -98,10 +103,17 @@ static const char args_doc[] = N_("[FILE...]");
 /* Prototype for option handler.  */
 static error_t parse_opt (int key, char *arg, struct argp_state *state);
 
+/* Parser children.  */
+static struct argp_child argp_children[] =
+  {
+    { &jobs_argp, 0, N_("Miscellaneous:"), 0 },
+    { NULL, 0, NULL, 0}
+  };
+
 /* Data structure to communicate with argp functions.  */
 static struct argp argp =
 {
-  options, parse_opt, args_doc, doc, NULL, NULL, NULL
+  options, parse_opt, args_doc, doc, argp_children, NULL, NULL
 };
 
 
@@ -119,7 +131,12 @@ static int handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 static int debug_fd = -1;
 static char *tmp_debug_fname = NULL;
 
-/* Close debug file descriptor, if opened. And remove temporary debug file.  */
+/* With --jobs the output file is written under a temporary name while
+   the debug file is written.  */
+static char *tmp_output_fname = NULL;
+
+/* Close debug file descriptor, if opened. And remove temporary debug
+   and output files.  */
 static void cleanup_debug (void);
 
 #define INTERNAL_ERROR(fname) \
@@ -129,6 +146,17 @@ static void cleanup_debug (void);
 	   fname, __LINE__, PACKAGE_VERSION, elf_errmsg (-1)); \
   } while (0)
 
+/* Like INTERNAL_ERROR while writing the debug file, which can happen in
+   a thread of its own.  The error is kept in DEBUG, finish_debug_file
+   reports it.  Returns false.  */
+#define DEBUG_INTERNAL_ERROR(debug) \
+  do { \
+    (debug)->error = debug_internal; \
+    (debug)->errline = __LINE__; \
+    (debug)->errmsg = elf_errmsg (-1); \
+    return false; \
+  } while (0)
+
 
 /* Name of the output file.  */
 static const char *output_fname;
@@ -157,6 +185,13 @@ static bool permissive;
 /* If true perform relocations between debug sections.  */
 static bool reloc_debug;
 
+/* If true compress the debug sections in the debug file.  */
+static bool compress_debug;
+
+/* The file mode creation mask, applied to the files which are created
+   with mkstemp.  */
+static mode_t file_umask;
+
 
 int
 main (int argc, char *argv[])
@@ -186,9 +221,16 @@ main (int argc, char *argv[])
     error (EXIT_FAILURE, 0,
 	   gettext ("--reloc-debug-sections used without -f"));
 
+  if (compress_debug && debug_fname == NULL)
+    error (EXIT_FAILURE, 0,
+	   gettext ("--compress-debug-sections used without -f"));
+
   /* Tell the library which version we are expecting.  */
   elf_version (EV_CURRENT);
 
+  file_umask = umask (0);
+  umask (file_umask);
+
   if (remaining == argc)
     /* The user didn't specify a name so we use a.out.  */
     result = process_file ("a.out");
@@ -266,6 +308,20 @@ parse_opt (int key, char *arg, struct argp_state *state)
       reloc_debug = true;
       break;
 
+    case OPT_COMPRESS_DEBUG:
+      if (arg == NULL || strcmp (arg, "zlib") == 0
+	  || strcmp (arg, "zlib-gabi") == 0)
+	compress_debug = true;
+      else if (strcmp (arg, "none") == 0)
+	compress_debug = false;
+      else
+	{
+	  argp_error (state,
+		      gettext ("unknown compression type '%s'"), arg);
+	  return EINVAL;
+	}
+      break;
+
     case OPT_REMOVE_COMMENT:
       remove_comment = true;
       break;
@@ -406,6 +462,473 @@ process_file (const char *fname)
 /* Maximum size of array allocated on stack.  */
 #define MAX_STACK_ALLOC	(400 * 1024)
 
+/* What we know about each section of the input file.  */
+struct shdr_info
+{
+  Elf_Scn *scn;
+  GElf_Shdr shdr;
+  Elf_Data *data;
+  Elf_Data *debug_data;
+  const char *name;
+  Elf32_Word idx;		/* Index in new file.  */
+  Elf32_Word old_sh_link;	/* Original value of shdr.sh_link.  */
+  Elf32_Word symtab_idx;
+  Elf32_Word version_idx;
+  Elf32_Word group_idx;
+  Elf32_Word group_cnt;
+  Elf_Scn *newscn;
+  Dwelf_Strent *se;
+  Elf32_Word *newsymidx;
+};
+
+/* The debug file, once all its sections are set up.  */
+struct debug_file
+{
+  Ebl *ebl;
+  Elf *debugelf;
+  const GElf_Ehdr *ehdr;
+  struct shdr_info *shdr_info;
+  size_t shnum;
+  size_t shstrndx;
+  const char *fname;
+  mode_t mode;
+
+  /* What write_debug_file found.  */
+  enum
+    {
+      debug_ok,
+      debug_illformed,
+      debug_write_failed,
+      debug_create_failed,
+      debug_crc_failed,
+      debug_bad_reloc,
+      debug_internal
+    } error;
+  const char *errmsg;
+  int errnum;
+  int errline;
+  uint32_t crc;
+  Elf_Data crc_data;
+};
+
+
+/* Remove any relocations between debug sections in ET_REL
+   for the debug file.  These relocations are always
+   zero based between the unallocated sections.  Returns false, with
+   the error in DEBUG, if that fails.  */
+static bool
+relocate_debug_sections (struct debug_file *debug)
+{
+  Ebl *ebl = debug->ebl;
+  Elf *debugelf = debug->debugelf;
+  const GElf_Ehdr *ehdr = debug->ehdr;
+  struct shdr_info *shdr_info = debug->shdr_info;
+  size_t shnum = debug->shnum;
+  size_t shstrndx = debug->shstrndx;
+
+  Elf_Scn *scn = NULL;
+  size_t cnt = 0;
+  while ((scn = elf_nextscn (debugelf, scn)) != NULL)
+    {
+      cnt++;
+      /* We need the actual section and header from the debugelf
+	 not just the cached original in shdr_info because we
+	 might want to change the size.  */
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr->sh_type == SHT_REL || shdr->sh_type == SHT_RELA)
+	{
+	  /* Make sure that this relocation section points to a
+	     section to relocate with contents, that isn't
+	     allocated and that is a debug section.  */
+	  Elf_Scn *tscn = elf_getscn (debugelf, shdr->sh_info);
+	  GElf_Shdr tshdr_mem;
+	  GElf_Shdr *tshdr = gelf_getshdr (tscn, &tshdr_mem);
+	  if (tshdr->sh_type == SHT_NOBITS
+	      || tshdr->sh_size == 0
+	      || (tshdr->sh_flags & SHF_ALLOC) != 0)
+	    continue;
+
+	  const char *tname =  elf_strptr (debugelf, shstrndx,
+					   tshdr->sh_name);
+	  if (! tname || ! ebl_debugscn_p (ebl, tname))
+	    continue;
+
+	  /* OK, lets relocate all trivial cross debug section
+	     relocations. */
+	  Elf_Data *reldata = elf_getdata (scn, NULL);
+	  if (reldata == NULL || reldata->d_buf == NULL)
+	    DEBUG_INTERNAL_ERROR (debug);
+
+	  /* Make sure we adjust the uncompressed debug data
+	     (and recompress if necessary at the end).  */
+	  GElf_Chdr tchdr;
+	  int tcompress_type = 0;
+	  if (gelf_getchdr (tscn, &tchdr) != NULL)
+	    {
+	      tcompress_type = tchdr.ch_type;
+	      if (elf_compress (tscn, 0, 0) != 1)
+		DEBUG_INTERNAL_ERROR (debug);
+	    }
+
+	  Elf_Data *tdata = elf_getdata (tscn, NULL);
+	  if (tdata == NULL || tdata->d_buf == NULL
+	      || tdata->d_type != ELF_T_BYTE)
+	    DEBUG_INTERNAL_ERROR (debug);
+
+	  /* Pick up the symbol table and shndx table to
+	     resolve relocation symbol indexes.  */
+	  Elf64_Word symt = shdr->sh_link;
+	  Elf_Data *symdata, *xndxdata;
+	  if (symt >= shnum + 2
+	      || shdr_info[symt].symtab_idx >= shnum + 2)
+	    {
+	      debug->error = debug_illformed;
+	      return false;
+	    }
+	  symdata = (shdr_info[symt].debug_data
+		     ?: shdr_info[symt].data);
+	  xndxdata = (shdr_info[shdr_info[symt].symtab_idx].debug_data
+		      ?: shdr_info[shdr_info[symt].symtab_idx].data);
+
+	  /* Apply one relocation.  Returns true when trivial
+	     relocation actually done.  Returns false with the error in
+	     DEBUG if something is wrong.  */
+	  bool relocate (GElf_Addr offset, const GElf_Sxword addend,
+			 bool is_rela, int rtype, int symndx)
+	  {
+	    /* R_*_NONE relocs can always just be removed.  */
+	    if (rtype == 0)
+	      return true;
+
+	    /* We only do simple absolute relocations.  */
+	    Elf_Type type = ebl_reloc_simple_type (ebl, rtype);
+	    if (type == ELF_T_NUM)
+	      return false;
+
+	    /* These are the types we can relocate.  */
+#define TYPES   DO_TYPE (BYTE, Byte); DO_TYPE (HALF, Half);		\
+	    DO_TYPE (WORD, Word); DO_TYPE (SWORD, Sword);		\
+	    DO_TYPE (XWORD, Xword); DO_TYPE (SXWORD, Sxword)
+
+	    /* And only for relocations against other debug sections.  */
+	    GElf_Sym sym_mem;
+	    Elf32_Word xndx;
+	    GElf_Sym *sym = gelf_getsymshndx (symdata, xndxdata,
+					      symndx, &sym_mem,
+					      &xndx);
+	    Elf32_Word sec = (sym->st_shndx == SHN_XINDEX
+			      ? xndx : sym->st_shndx);
+	    if (sec >= shnum + 2)
+	      DEBUG_INTERNAL_ERROR (debug);
+
+	    if (ebl_debugscn_p (ebl, shdr_info[sec].name))
+	      {
+		size_t size;
+
+#define DO_TYPE(NAME, Name) GElf_##Name Name;
+		union { TYPES; } tmpbuf;
+#undef DO_TYPE
+
+		switch (type)
+		  {
+#define DO_TYPE(NAME, Name)				\
+		    case ELF_T_##NAME:		\
+		      size = sizeof (GElf_##Name);	\
+		      tmpbuf.Name = 0;		\
+		      break;
+		    TYPES;
+#undef DO_TYPE
+		  default:
+		    return false;
+		  }
+
+		if (offset > tdata->d_size
+		    || tdata->d_size - offset < size)
+		  {
+		    debug->error = debug_bad_reloc;
+		    return false;
+		  }
+
+		/* When the symbol value is zero then for SHT_REL
+		   sections this is all that needs to be checked.
+		   The addend is contained in the original data at
+		   the offset already.  So if the (section) symbol
+		   address is zero and the given addend is zero
+		   just remove the relocation, it isn't needed
+		   anymore.  */
+		if (addend == 0 && sym->st_value == 0)
+		  return true;
+
+		Elf_Data tmpdata =
+		  {
+		    .d_type = type,
+		    .d_buf = &tmpbuf,
+		    .d_size = size,
+		    .d_version = EV_CURRENT,
+		  };
+		Elf_Data rdata =
+		  {
+		    .d_type = type,
+		    .d_buf = tdata->d_buf + offset,
+		    .d_size = size,
+		    .d_version = EV_CURRENT,
+		  };
+
+		GElf_Addr value = sym->st_value;
+		if (is_rela)
+		  {
+		    /* For SHT_RELA sections we just take the
+		       given addend and add it to the value.  */
+		    value += addend;
+		  }
+		else
+		  {
+		    /* For SHT_REL sections we have to peek at
+		       what is already in the section at the given
+		       offset to get the addend.  */
+		    Elf_Data *d = gelf_xlatetom (debugelf, &tmpdata,
+						 &rdata,
+						 ehdr->e_ident[EI_DATA]);
+		    if (d == NULL)
+		      DEBUG_INTERNAL_ERROR (debug);
+		    assert (d == &tmpdata);
+		  }
+
+		switch (type)
+		  {
+#define DO_TYPE(NAME, Name)					\
+		    case ELF_T_##NAME:			\
+		      tmpbuf.Name += (GElf_##Name) value;	\
+		      break;
+		    TYPES;
+#undef DO_TYPE
+		  default:
+		    abort ();
+		  }
+
+		/* Now finally put in the new value.  */
+		Elf_Data *s = gelf_xlatetof (debugelf, &rdata,
+					     &tmpdata,
+					     ehdr->e_ident[EI_DATA]);
+		if (s == NULL)
+		  DEBUG_INTERNAL_ERROR (debug);
+		assert (s == &rdata);
+
+		return true;
+	      }
+	    return false;
+	  }
+
+	  if (shdr->sh_entsize == 0)
+	    DEBUG_INTERNAL_ERROR (debug);
+
+	  size_t nrels = shdr->sh_size / shdr->sh_entsize;
+	  size_t next = 0;
+	  if (shdr->sh_type == SHT_REL)
+	    for (size_t relidx = 0; relidx < nrels; ++relidx)
+	      {
+		GElf_Rel rel_mem;
+		GElf_Rel *r = gelf_getrel (reldata, relidx, &rel_mem);
+		if (! relocate (r->r_offset, 0, false,
+				GELF_R_TYPE (r->r_info),
+				GELF_R_SYM (r->r_info)))
+		  {
+		    if (unlikely (debug->error != debug_ok))
+		      return false;
+		    if (relidx != next)
+		      gelf_update_rel (reldata, next, r);
+		    ++next;
+		  }
+	      }
+	  else
+	    for (size_t relidx = 0; relidx < nrels; ++relidx)
+	      {
+		GElf_Rela rela_mem;
+		GElf_Rela *r = gelf_getrela (reldata, relidx, &rela_mem);
+		if (! relocate (r->r_offset, r->r_addend, true,
+				GELF_R_TYPE (r->r_info),
+				GELF_R_SYM (r->r_info)))
+		  {
+		    if (unlikely (debug->error != debug_ok))
+		      return false;
+		    if (relidx != next)
+		      gelf_update_rela (reldata, next, r);
+		    ++next;
+		  }
+	      }
+
+	  nrels = next;
+	  shdr->sh_size = reldata->d_size = nrels * shdr->sh_entsize;
+	  gelf_update_shdr (scn, shdr);
+
+	  if (tcompress_type != 0)
+	    if (elf_compress (tscn, tcompress_type, ELF_CHF_FORCE) != 1)
+	      DEBUG_INTERNAL_ERROR (debug);
+	}
+    }
+
+  return true;
+}
+
+
+/* Compress the debug sections in the debug file.  Returns false, with
+   the error in DEBUG, if that fails.  */
+static bool
+compress_debug_sections (struct debug_file *debug)
+{
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (debug->debugelf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	DEBUG_INTERNAL_ERROR (debug);
+
+      if (shdr->sh_type == SHT_NOBITS || shdr->sh_size == 0
+	  || (shdr->sh_flags & (SHF_ALLOC | SHF_COMPRESSED)) != 0)
+	continue;
+
+      const char *name = elf_strptr (debug->debugelf, debug->shstrndx,
+				     shdr->sh_name);
+      if (name == NULL || strncmp (name, ".debug", strlen (".debug")) != 0)
+	continue;
+
+      /* Sections which would not get smaller are left alone.  */
+      if (elf_compress (scn, ELFCOMPRESS_ZLIB, 0) < 0)
+	DEBUG_INTERNAL_ERROR (debug);
+    }
+
+  return true;
+}
+
+
+/* Finish the debug file and write it, then compute its checksum.  With
+   --jobs this runs in its own thread, so nothing is printed here.  */
+static void *
+write_debug_file (void *arg)
+{
+  struct debug_file *debug = arg;
+
+  if (reloc_debug && debug->ehdr->e_type == ET_REL
+      && ! relocate_debug_sections (debug))
+    return NULL;
+
+  if (compress_debug && ! compress_debug_sections (debug))
+    return NULL;
+
+  /* Finally write the file.  */
+  if (unlikely (elf_update (debug->debugelf, ELF_C_WRITE) == -1))
+    {
+      debug->error = debug_write_failed;
+      debug->errmsg = elf_errmsg (-1);
+      return NULL;
+    }
+
+  /* Create the real output file.  First rename, then change the
+     mode.  */
+  if (rename (tmp_debug_fname, debug_fname) != 0
+      || fchmod (debug_fd, debug->mode & ~file_umask) != 0)
+    {
+      debug->error = debug_create_failed;
+      debug->errnum = errno;
+      return NULL;
+    }
+
+  if (!remove_shdrs)
+    {
+      debug->crc_data = (Elf_Data)
+	{
+	  .d_type = ELF_T_WORD,
+	  .d_buf = &debug->crc,
+	  .d_size = sizeof (debug->crc),
+	  .d_version = EV_CURRENT
+	};
+
+      /* Compute the checksum which we will add to the executable.  */
+      if (crc32_file (debug_fd, &debug->crc) != 0)
+	{
+	  debug->error = debug_crc_failed;
+	  debug->errnum = errno;
+	}
+    }
+
+  return NULL;
+}
+
+
+/* Report what went wrong in write_debug_file.  Returns nonzero if the
+   debug file could not be created.  */
+static int
+finish_debug_file (struct debug_file *debug)
+{
+  switch (debug->error)
+    {
+    case debug_illformed:
+      error (0, 0, gettext ("illformed file '%s'"), debug->fname);
+      return 1;
+
+    case debug_write_failed:
+      error (0, 0, gettext ("while writing '%s': %s"),
+	     tmp_debug_fname, debug->errmsg);
+      return 1;
+
+    case debug_create_failed:
+      error (0, debug->errnum, gettext ("while creating '%s'"), debug_fname);
+      return 1;
+
+    case debug_bad_reloc:
+      cleanup_debug ();
+      error (EXIT_FAILURE, 0, gettext ("bad relocation"));
+      return 1;
+
+    case debug_internal:
+      cleanup_debug ();
+      error (EXIT_FAILURE, 0, gettext ("%s: INTERNAL ERROR %d (%s): %s"),
+	     debug->fname, debug->errline, PACKAGE_VERSION, debug->errmsg);
+      return 1;
+
+    default:
+      break;
+    }
+
+  /* The temporary file does not exist anymore.  */
+  free (tmp_debug_fname);
+  tmp_debug_fname = NULL;
+
+  if (debug->error == debug_crc_failed)
+    {
+      error (0, debug->errnum, gettext ("\
+while computing checksum for debug information"));
+      unlink (debug_fname);
+      return 1;
+    }
+
+  return 0;
+}
+
+/* Returns true if the contents of sections of type SH_TYPE might be
+   changed in the stripped file when the symbol table changes.  All
+   others are copied unchanged.  */
+static bool
+data_changes_p (GElf_Word sh_type)
+{
+  switch (sh_type)
+    {
+    case SHT_SYMTAB:
+    case SHT_DYNSYM:
+    case SHT_SYMTAB_SHNDX:
+    case SHT_REL:
+    case SHT_RELA:
+    case SHT_HASH:
+    case SHT_GNU_versym:
+    case SHT_GROUP:
+      return true;
+    default:
+      return false;
+    }
+}
+
 static int
 handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
 	    mode_t mode, struct timespec tvp[2])
@@ -419,23 +942,7 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
   int result = 0;
   size_t shdridx = 0;
   size_t shstrndx;
-  struct shdr_info
-  {
-    Elf_Scn *scn;
-    GElf_Shdr shdr;
-    Elf_Data *data;
-    Elf_Data *debug_data;
-    const char *name;
-    Elf32_Word idx;		/* Index in new file.  */
-    Elf32_Word old_sh_link;	/* Original value of shdr.sh_link.  */
-    Elf32_Word symtab_idx;
-    Elf32_Word version_idx;
-    Elf32_Word group_idx;
-    Elf32_Word group_cnt;
-    Elf_Scn *newscn;
-    Dwelf_Strent *se;
-    Elf32_Word *newsymidx;
-  } *shdr_info = NULL;
+  struct shdr_info *shdr_info = NULL;
   Elf_Scn *scn;
   size_t cnt;
   size_t idx;
@@ -446,6 +953,7 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
   GElf_Ehdr *debugehdr;
   Dwelf_Strtab *shst = NULL;
   Elf_Data debuglink_crc_data;
+  Elf_Scn *debuglink_scn = NULL;
   bool any_symtab_changes = false;
   Elf_Data *shstrtab_data = NULL;
   void *debuglink_buf = NULL;
@@ -458,8 +966,28 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
     }
   memcpy (cp, fname, fname_len);
 
-  /* If we are not replacing the input file open a new file here.  */
-  if (output_fname != NULL)
+  /* If we are not replacing the input file open a new file here.  With
+     --jobs and a debug file it is only renamed when both are written.
+     So it is left alone, as otherwise, if the debug file cannot be
+     written.  */
+  if (output_fname != NULL && workpool_jobs > 1 && debug_fname != NULL)
+    {
+      size_t output_fname_len = strlen (output_fname);
+      tmp_output_fname = xmalloc (output_fname_len + sizeof (".XXXXXX"));
+      strcpy (mempcpy (tmp_output_fname, output_fname, output_fname_len),
+	      ".XXXXXX");
+
+      fd = mkstemp (tmp_output_fname);
+      if (unlikely (fd == -1) || unlikely (fchmod (fd, mode & ~file_umask) != 0))
+	{
+	  error (0, errno, gettext ("cannot open '%s'"), output_fname);
+	  if (fd != -1)
+	    close (fd);
+	  cleanup_debug ();
+	  return 1;
+	}
+    }
+  else if (output_fname != NULL)
     {
       fd = open (output_fname, O_RDWR | O_CREAT, mode);
       if (unlikely (fd == -1))
@@ -1134,6 +1662,7 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
 
       /* Cache this Elf_Data describing the CRC32 word in the section.
 	 We'll fill this in when we have written the debug file.  */
+      debuglink_scn = shdr_info[cnt].newscn;
       debuglink_crc_data = *shdr_info[cnt].data;
       debuglink_crc_data.d_buf = ((char *) debuglink_crc_data.d_buf
 				  + crc_offset);
@@ -1235,7 +1764,18 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
 
 	/* Get the data from the old file if necessary.  We already
 	   created the data for the section header string table.  */
-	if (cnt < shnum)
+	if (cnt < shnum && ! data_changes_p (shdr_info[cnt].shdr.sh_type))
+	  {
+	    /* The section contents are written unchanged.  Let libelf
+	       copy them from the old file, without reading them.  */
+	    newdata = elf_newdata_copy (scn, shdr_info[cnt].scn);
+	    if (newdata == NULL)
+	      INTERNAL_ERROR (fname);
+
+	    /* We know the size.  */
+	    shdr_info[cnt].shdr.sh_size = newdata->d_size;
+	  }
+	else if (cnt < shnum)
 	  {
 	    if (shdr_info[cnt].data == NULL)
 	      {
@@ -1753,297 +2293,46 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
 	  }
       }
 
-  /* Remove any relocations between debug sections in ET_REL
-     for the debug file when requested.  These relocations are always
-     zero based between the unallocated sections.  */
-  if (debug_fname != NULL && reloc_debug && ehdr->e_type == ET_REL)
-    {
-      scn = NULL;
-      cnt = 0;
-      while ((scn = elf_nextscn (debugelf, scn)) != NULL)
-	{
-	  cnt++;
-	  /* We need the actual section and header from the debugelf
-	     not just the cached original in shdr_info because we
-	     might want to change the size.  */
-	  GElf_Shdr shdr_mem;
-	  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
-	  if (shdr->sh_type == SHT_REL || shdr->sh_type == SHT_RELA)
-	    {
-	      /* Make sure that this relocation section points to a
-		 section to relocate with contents, that isn't
-		 allocated and that is a debug section.  */
-	      Elf_Scn *tscn = elf_getscn (debugelf, shdr->sh_info);
-	      GElf_Shdr tshdr_mem;
-	      GElf_Shdr *tshdr = gelf_getshdr (tscn, &tshdr_mem);
-	      if (tshdr->sh_type == SHT_NOBITS
-		  || tshdr->sh_size == 0
-		  || (tshdr->sh_flags & SHF_ALLOC) != 0)
-		continue;
-
-	      const char *tname =  elf_strptr (debugelf, shstrndx,
-					       tshdr->sh_name);
-	      if (! tname || ! ebl_debugscn_p (ebl, tname))
-		continue;
-
-	      /* OK, lets relocate all trivial cross debug section
-		 relocations. */
-	      Elf_Data *reldata = elf_getdata (scn, NULL);
-	      if (reldata == NULL || reldata->d_buf == NULL)
-		INTERNAL_ERROR (fname);
-
-	      /* Make sure we adjust the uncompressed debug data
-		 (and recompress if necessary at the end).  */
-	      GElf_Chdr tchdr;
-	      int tcompress_type = 0;
-	      if (gelf_getchdr (tscn, &tchdr) != NULL)
-		{
-		  tcompress_type = tchdr.ch_type;
-		  if (elf_compress (tscn, 0, 0) != 1)
-		    INTERNAL_ERROR (fname);
-		}
-
-	      Elf_Data *tdata = elf_getdata (tscn, NULL);
-	      if (tdata == NULL || tdata->d_buf == NULL
-		  || tdata->d_type != ELF_T_BYTE)
-		INTERNAL_ERROR (fname);
-
-	      /* Pick up the symbol table and shndx table to
-		 resolve relocation symbol indexes.  */
-	      Elf64_Word symt = shdr->sh_link;
-	      Elf_Data *symdata, *xndxdata;
-	      elf_assert (symt < shnum + 2);
-	      elf_assert (shdr_info[symt].symtab_idx < shnum + 2);
-	      symdata = (shdr_info[symt].debug_data
-			 ?: shdr_info[symt].data);
-	      xndxdata = (shdr_info[shdr_info[symt].symtab_idx].debug_data
-			  ?: shdr_info[shdr_info[symt].symtab_idx].data);
-
-	      /* Apply one relocation.  Returns true when trivial
-		 relocation actually done.  */
-	      bool relocate (GElf_Addr offset, const GElf_Sxword addend,
-			     bool is_rela, int rtype, int symndx)
-	      {
-		/* R_*_NONE relocs can always just be removed.  */
-		if (rtype == 0)
-		  return true;
-
-		/* We only do simple absolute relocations.  */
-		Elf_Type type = ebl_reloc_simple_type (ebl, rtype);
-		if (type == ELF_T_NUM)
-		  return false;
-
-		/* These are the types we can relocate.  */
-#define TYPES   DO_TYPE (BYTE, Byte); DO_TYPE (HALF, Half);		\
-		DO_TYPE (WORD, Word); DO_TYPE (SWORD, Sword);		\
-		DO_TYPE (XWORD, Xword); DO_TYPE (SXWORD, Sxword)
-
-		/* And only for relocations against other debug sections.  */
-		GElf_Sym sym_mem;
-		Elf32_Word xndx;
-		GElf_Sym *sym = gelf_getsymshndx (symdata, xndxdata,
-						  symndx, &sym_mem,
-						  &xndx);
-		Elf32_Word sec = (sym->st_shndx == SHN_XINDEX
-				  ? xndx : sym->st_shndx);
-		if (sec >= shnum + 2)
-		  INTERNAL_ERROR (fname);
-
-		if (ebl_debugscn_p (ebl, shdr_info[sec].name))
-		  {
-		    size_t size;
-
-#define DO_TYPE(NAME, Name) GElf_##Name Name;
-		    union { TYPES; } tmpbuf;
-#undef DO_TYPE
-
-		    switch (type)
-		      {
-#define DO_TYPE(NAME, Name)				\
-			case ELF_T_##NAME:		\
-			  size = sizeof (GElf_##Name);	\
-			  tmpbuf.Name = 0;		\
-			  break;
-			TYPES;
-#undef DO_TYPE
-		      default:
-			return false;
-		      }
-
-		    if (offset > tdata->d_size
-			|| tdata->d_size - offset < size)
-		      {
-			cleanup_debug ();
-			error (EXIT_FAILURE, 0, gettext ("bad relocation"));
-		      }
-
-		    /* When the symbol value is zero then for SHT_REL
-		       sections this is all that needs to be checked.
-		       The addend is contained in the original data at
-		       the offset already.  So if the (section) symbol
-		       address is zero and the given addend is zero
-		       just remove the relocation, it isn't needed
-		       anymore.  */
-		    if (addend == 0 && sym->st_value == 0)
-		      return true;
-
-		    Elf_Data tmpdata =
-		      {
-			.d_type = type,
-			.d_buf = &tmpbuf,
-			.d_size = size,
-			.d_version = EV_CURRENT,
-		      };
-		    Elf_Data rdata =
-		      {
-			.d_type = type,
-			.d_buf = tdata->d_buf + offset,
-			.d_size = size,
-			.d_version = EV_CURRENT,
-		      };
-
-		    GElf_Addr value = sym->st_value;
-		    if (is_rela)
-		      {
-			/* For SHT_RELA sections we just take the
-			   given addend and add it to the value.  */
-			value += addend;
-		      }
-		    else
-		      {
-			/* For SHT_REL sections we have to peek at
-			   what is already in the section at the given
-			   offset to get the addend.  */
-			Elf_Data *d = gelf_xlatetom (debugelf, &tmpdata,
-						     &rdata,
-						     ehdr->e_ident[EI_DATA]);
-			if (d == NULL)
-			  INTERNAL_ERROR (fname);
-			assert (d == &tmpdata);
-		      }
-
-		    switch (type)
-		      {
-#define DO_TYPE(NAME, Name)					\
-			case ELF_T_##NAME:			\
-			  tmpbuf.Name += (GElf_##Name) value;	\
-			  break;
-			TYPES;
-#undef DO_TYPE
-		      default:
-			abort ();
-		      }
-
-		    /* Now finally put in the new value.  */
-		    Elf_Data *s = gelf_xlatetof (debugelf, &rdata,
-						 &tmpdata,
-						 ehdr->e_ident[EI_DATA]);
-		    if (s == NULL)
-		      INTERNAL_ERROR (fname);
-		    assert (s == &rdata);
-
-		    return true;
-		  }
-		return false;
-	      }
-
-	      if (shdr->sh_entsize == 0)
-		INTERNAL_ERROR (fname);
-
-	      size_t nrels = shdr->sh_size / shdr->sh_entsize;
-	      size_t next = 0;
-	      if (shdr->sh_type == SHT_REL)
-		for (size_t relidx = 0; relidx < nrels; ++relidx)
-		  {
-		    GElf_Rel rel_mem;
-		    GElf_Rel *r = gelf_getrel (reldata, relidx, &rel_mem);
-		    if (! relocate (r->r_offset, 0, false,
-				    GELF_R_TYPE (r->r_info),
-				    GELF_R_SYM (r->r_info)))
-		      {
-			if (relidx != next)
-			  gelf_update_rel (reldata, next, r);
-			++next;
-		      }
-		  }
-	      else
-		for (size_t relidx = 0; relidx < nrels; ++relidx)
-		  {
-		    GElf_Rela rela_mem;
-		    GElf_Rela *r = gelf_getrela (reldata, relidx, &rela_mem);
-		    if (! relocate (r->r_offset, r->r_addend, true,
-				    GELF_R_TYPE (r->r_info),
-				    GELF_R_SYM (r->r_info)))
-		      {
-			if (relidx != next)
-			  gelf_update_rela (reldata, next, r);
-			++next;
-		      }
-		  }
-
-	      nrels = next;
-	      shdr->sh_size = reldata->d_size = nrels * shdr->sh_entsize;
-	      gelf_update_shdr (scn, shdr);
-
-	      if (tcompress_type != 0)
-		if (elf_compress (tscn, tcompress_type, ELF_CHF_FORCE) != 1)
-		  INTERNAL_ERROR (fname);
-	    }
-	}
-    }
-
   /* Now that we have done all adjustments to the data,
-     we can actually write out the debug file.  */
+     we can actually write out the debug file.  With --jobs that is
+     done while the stripped file is written, then the checksum is
+     put in afterwards.  */
+  struct debug_file debug =
+    {
+      .ebl = ebl,
+      .debugelf = debugelf,
+      .ehdr = ehdr,
+      .shdr_info = shdr_info,
+      .shnum = shnum,
+      .shstrndx = shstrndx,
+      .fname = fname,
+      .mode = mode
+    };
+  pthread_t debug_thread;
+  bool debug_threaded = false;
   if (debug_fname != NULL)
     {
-      /* Finally write the file.  */
-      if (unlikely (elf_update (debugelf, ELF_C_WRITE) == -1))
-	{
-	  error (0, 0, gettext ("while writing '%s': %s"),
-		 tmp_debug_fname, elf_errmsg (-1));
-	  result = 1;
-	  goto fail_close;
-	}
-
-      /* Create the real output file.  First rename, then change the
-	 mode.  */
-      if (rename (tmp_debug_fname, debug_fname) != 0
-	  || fchmod (debug_fd, mode) != 0)
-	{
-	  error (0, errno, gettext ("while creating '%s'"), debug_fname);
-	  result = 1;
-	  goto fail_close;
-	}
+      /* The input file must stay intact if the debug file cannot be
+	 written.  */
+      if (workpool_jobs > 1 && output_fname != NULL)
+	debug_threaded = pthread_create (&debug_thread, NULL,
+					 write_debug_file, &debug) == 0;
 
-      /* The temporary file does not exist anymore.  */
-      free (tmp_debug_fname);
-      tmp_debug_fname = NULL;
-
-      if (!remove_shdrs)
+      if (! debug_threaded)
 	{
-	  uint32_t debug_crc;
-	  Elf_Data debug_crc_data =
+	  write_debug_file (&debug);
+	  if (finish_debug_file (&debug) != 0)
 	    {
-	      .d_type = ELF_T_WORD,
-	      .d_buf = &debug_crc,
-	      .d_size = sizeof (debug_crc),
-	      .d_version = EV_CURRENT
-	    };
-
-	  /* Compute the checksum which we will add to the executable.  */
-	  if (crc32_file (debug_fd, &debug_crc) != 0)
-	    {
-	      error (0, errno, gettext ("\
-while computing checksum for debug information"));
-	      unlink (debug_fname);
 	      result = 1;
 	      goto fail_close;
 	    }
 
-	  /* Store it in the debuglink section data.  */
-	  if (unlikely (gelf_xlatetof (newelf, &debuglink_crc_data,
-				       &debug_crc_data, ehdr->e_ident[EI_DATA])
-			!= &debuglink_crc_data))
+	  /* Store the checksum in the debuglink section data.  */
+	  if (!remove_shdrs
+	      && unlikely (gelf_xlatetof (newelf, &debuglink_crc_data,
+					  &debug.crc_data,
+					  ehdr->e_ident[EI_DATA])
+			   != &debuglink_crc_data))
 	    INTERNAL_ERROR (fname);
 	}
     }
@@ -2090,6 +2379,8 @@ while computing checksum for debug information"));
     {
       error (0, 0, gettext ("%s: error while creating ELF header: %s"),
 	     output_fname ?: fname, elf_errmsg (-1));
+      if (debug_threaded)
+	pthread_join (debug_thread, NULL);
       cleanup_debug ();
       return 1;
     }
@@ -2099,6 +2390,8 @@ while computing checksum for debug information"));
     {
       error (0, 0, gettext ("%s: error while reading the file: %s"),
 	     fname, elf_errmsg (-1));
+      if (debug_threaded)
+	pthread_join (debug_thread, NULL);
       cleanup_debug ();
       return 1;
     }
@@ -2117,6 +2410,41 @@ while computing checksum for debug information"));
       result = 1;
     }
 
+  if (debug_threaded)
+    {
+      pthread_join (debug_thread, NULL);
+      if (finish_debug_file (&debug) != 0)
+	{
+	  result = 1;
+	  goto fail_close;
+	}
+
+      /* Put the checksum in the debuglink section of the file just
+	 written.  */
+      if (!remove_shdrs)
+	{
+	  GElf_Shdr shdr_mem;
+	  GElf_Shdr *shdr = gelf_getshdr (debuglink_scn, &shdr_mem);
+	  if (shdr == NULL
+	      || unlikely (gelf_xlatetof (newelf, &debuglink_crc_data,
+					  &debug.crc_data,
+					  ehdr->e_ident[EI_DATA])
+			   != &debuglink_crc_data))
+	    INTERNAL_ERROR (fname);
+
+	  off_t crc_offset = (shdr->sh_offset
+			      + ((char *) debuglink_crc_data.d_buf
+				 - (char *) debuglink_buf));
+	  if (pwrite_retry (fd, debuglink_crc_data.d_buf,
+			    debuglink_crc_data.d_size, crc_offset)
+	      != (ssize_t) debuglink_crc_data.d_size)
+	    {
+	      error (0, errno, gettext ("while writing '%s'"), output_fname);
+	      result = 1;
+	    }
+	}
+    }
+
   if (remove_shdrs)
     {
       /* libelf can't cope without the section headers being properly intact.
@@ -2211,6 +2539,21 @@ while computing checksum for debug information"));
   if (ebl != NULL)
     ebl_closebackend (ebl);
 
+  /* Only now the output file is complete.  */
+  if (tmp_output_fname != NULL && result == 0)
+    {
+      if (rename (tmp_output_fname, output_fname) != 0)
+	{
+	  error (0, errno, gettext ("while creating '%s'"), output_fname);
+	  result = 1;
+	}
+      else
+	{
+	  free (tmp_output_fname);
+	  tmp_output_fname = NULL;
+	}
+    }
+
   cleanup_debug ();
 
   /* If requested, preserve the timestamp.  */
@@ -2246,6 +2589,13 @@ cleanup_debug (void)
       close (debug_fd);
       debug_fd = -1;
     }
+
+  if (tmp_output_fname != NULL)
+    {
+      unlink (tmp_output_fname);
+      free (tmp_output_fname);
+      tmp_output_fname = NULL;
+    }
 }
 
 static int
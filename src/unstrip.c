@@ -245,9 +245,37 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\
 	error (EXIT_FAILURE, 0, msg, elf_errmsg (-1));			      \
     } while (0)
 
-/* Copy INELF to newly-created OUTELF, exit via error for any problems.  */
+/* Returns true if the data of an allocated section from a stripped file
+   of type E_TYPE described by SHDR is written out unchanged, so it can
+   be copied straight from the file.  libdwfl might have relocated an
+   ET_REL file in memory, or decompressed unallocated sections, and the
+   section types we adjust to a new symbol table must be read in.  */
+static bool
+section_copy_p (GElf_Half e_type, const GElf_Shdr *shdr)
+{
+  if (e_type == ET_REL || (shdr->sh_flags & SHF_ALLOC) == 0)
+    return false;
+
+  switch (shdr->sh_type)
+    {
+    case SHT_NOBITS:
+    case SHT_SYMTAB:
+    case SHT_DYNSYM:
+    case SHT_SYMTAB_SHNDX:
+    case SHT_REL:
+    case SHT_RELA:
+    case SHT_HASH:
+    case SHT_GNU_versym:
+    case SHT_GROUP:
+      return false;
+    }
+  return true;
+}
+
+/* Copy INELF to newly-created OUTELF, exit via error for any problems.
+   If VERBATIM, INELF is a stripped file written out as it is.  */
 static void
-copy_elf (Elf *outelf, Elf *inelf)
+copy_elf (Elf *outelf, Elf *inelf, bool verbatim)
 {
   ELF_CHECK (gelf_newehdr (outelf, gelf_getclass (inelf)),
 	     _("cannot create ELF header: %s"));
@@ -279,9 +307,17 @@ copy_elf (Elf *outelf, Elf *inelf)
       Elf_Scn *newscn = elf_newscn (outelf);
 
       GElf_Shdr shdr_mem;
-      ELF_CHECK (gelf_update_shdr (newscn, gelf_getshdr (scn, &shdr_mem)),
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      ELF_CHECK (gelf_update_shdr (newscn, shdr),
 		 _("cannot copy section header: %s"));
 
+      if (verbatim && section_copy_p (ehdr->e_type, shdr))
+	{
+	  ELF_CHECK (elf_newdata_copy (newscn, scn) != NULL,
+		     _("cannot copy section data: %s"));
+	  continue;
+	}
+
       Elf_Data *data = elf_getdata (scn, NULL);
       ELF_CHECK (data != NULL, _("cannot get section data: %s"));
       Elf_Data *newdata = elf_newdata (newscn);
@@ -861,44 +897,73 @@ compare_symbols (const void *a, const void *b)
   return (s1->compare - s2->compare) ?: strcmp (s1->name, s2->name);
 }
 
-/* Compare symbols for output order after slots have been assigned.  */
-static int
-compare_symbols_output (const void *a, const void *b)
+/* Hash a symbol for finding its duplicates, consistent with
+   compare_symbols.  */
+static unsigned long int
+hash_symbol (const struct symbol *s)
 {
-  const struct symbol *s1 = a;
-  const struct symbol *s2 = b;
-  int cmp;
+  unsigned long int hval = elf_hash (s->name);
+  hval ^= (s->value * 31 + s->size) * 31 + s->shndx;
+  hval = hval * 31 + (uint16_t) s->compare;
+  return hval ?: 1;
+}
 
-  /* Sort discarded symbols last.  */
-  cmp = (s1->name == NULL) - (s2->name == NULL);
+#define NAME Symbol_Hash
+#define TYPE struct symbol *
+#define COMPARE(a, b) compare_symbols (a, b)
+#define NO_UNDEF
+#include <dynamicsizehash.h>
+#include <dynamicsizehash.c>
+#undef NO_UNDEF
 
-  if (cmp == 0)
-    /* Local symbols must come first.  */
-    cmp = ((GELF_ST_BIND (s2->info.info) == STB_LOCAL)
-	   - (GELF_ST_BIND (s1->info.info) == STB_LOCAL));
+/* Compare section symbols, binutils puts them in section index order.  */
+static int
+compare_section_symbols (const void *a, const void *b)
+{
+  const struct symbol *s1 = *(const struct symbol **) a;
+  const struct symbol *s2 = *(const struct symbol **) b;
 
-  if (cmp == 0)
-    /* binutils always puts section symbols first.  */
-    cmp = ((GELF_ST_TYPE (s2->info.info) == STT_SECTION)
-	   - (GELF_ST_TYPE (s1->info.info) == STT_SECTION));
+  CMP (shndx);
+  else
+    assert (s1 == s2);
 
-  if (cmp == 0)
-    {
-      if (GELF_ST_TYPE (s1->info.info) == STT_SECTION)
-	{
-	  /* binutils always puts section symbols in section index order.  */
-	  CMP (shndx);
-	  else
-	    assert (s1 == s2);
-	}
+  return 0;
+}
 
-      /* Nothing really matters, so preserve the original order.  */
-      CMP (map);
-      else
-	assert (s1 == s2);
-    }
+/* Return the NSYM symbols left in SYMBOLS after slots have been assigned,
+   in output order.  Local symbols must come first, and binutils always
+   puts section symbols first.  Otherwise nothing really matters, so the
+   original order is preserved.  */
+static struct symbol **
+order_output_symbols (struct symbol *symbols, size_t total_syms, size_t nsym)
+{
+  inline size_t symbol_class (const struct symbol *s)
+  {
+    return (2 * (GELF_ST_BIND (s->info.info) != STB_LOCAL)
+	    + (GELF_ST_TYPE (s->info.info) != STT_SECTION));
+  }
 
-  return cmp;
+  size_t start[5] = { 0, 0, 0, 0, 0 };
+  for (size_t i = 0; i < total_syms; ++i)
+    if (symbols[i].name != NULL)
+      ++start[symbol_class (&symbols[i]) + 1];
+  for (size_t c = 1; c < 5; ++c)
+    start[c] += start[c - 1];
+  assert (start[4] == nsym);
+
+  struct symbol **order = xmalloc (nsym * sizeof order[0]);
+  size_t next[4] = { start[0], start[1], start[2], start[3] };
+  for (size_t i = 0; i < total_syms; ++i)
+    if (symbols[i].name != NULL)
+      order[next[symbol_class (&symbols[i])]++] = &symbols[i];
+
+  /* Only the section symbols need sorting.  */
+  qsort (&order[start[0]], start[1] - start[0], sizeof order[0],
+	 compare_section_symbols);
+  qsort (&order[start[2]], start[3] - start[2], sizeof order[0],
+	 compare_section_symbols);
+
+  return order;
 }
 
 #undef CMP
@@ -1111,6 +1176,15 @@ find_alloc_sections_prelink (Elf *debug, Elf_Data *debug_shstrtab,
 	}
     }
 
+  /* Note which sections already have a match, by index in DEBUG.  */
+  size_t debug_shnum;
+  ELF_CHECK (elf_getshdrnum (debug, &debug_shnum) == 0,
+	     _("cannot get section count: %s"));
+  bool *matched = xcalloc (debug_shnum, sizeof matched[0]);
+  for (size_t i = 0; i < nalloc; ++i)
+    if (sections[i].outscn != NULL)
+      matched[elf_ndxscn (sections[i].outscn)] = true;
+
   Elf_Scn *scn = NULL;
   while ((scn = elf_nextscn (debug, scn)) != NULL)
     {
@@ -1138,12 +1212,11 @@ find_alloc_sections_prelink (Elf *debug, Elf_Data *debug_shstrtab,
 
       /* If there is no prelink info, we are just here to find
 	 the sections to give error messages about.  */
-      for (size_t i = 0; shdr != NULL && i < nalloc; ++i)
-	if (sections[i].outscn == scn)
-	  shdr = NULL;
-      check_match (shdr == NULL, scn, name);
+      check_match (matched[elf_ndxscn (scn)], scn, name);
     }
 
+  free (matched);
+
   if (fail)
     exit (EXIT_FAILURE);
 
@@ -1574,12 +1647,25 @@ more sections in stripped file than debug file -- arguments reversed?"));
 	if (strtab != NULL)
 	  shdr_mem.sh_name = dwelf_strent_off (sec->strent);
 
-	Elf_Data *indata = elf_getdata (sec->scn, NULL);
-	ELF_CHECK (indata != NULL, _("cannot get section data: %s"));
 	Elf_Data *outdata = elf_getdata (sec->outscn, NULL);
 	ELF_CHECK (outdata != NULL, _("cannot copy section data: %s"));
-	*outdata = *indata;
-	elf_flagdata (outdata, ELF_C_SET, ELF_F_DIRTY);
+	if (section_copy_p (stripped_ehdr->e_type, &sec->shdr))
+	  {
+	    /* The placeholder data is left empty, the contents are
+	       copied from the stripped file when it is written.  */
+	    outdata->d_buf = NULL;
+	    outdata->d_size = 0;
+	    elf_flagdata (outdata, ELF_C_SET, ELF_F_DIRTY);
+	    ELF_CHECK (elf_newdata_copy (sec->outscn, sec->scn) != NULL,
+		       _("cannot copy section data: %s"));
+	  }
+	else
+	  {
+	    Elf_Data *indata = elf_getdata (sec->scn, NULL);
+	    ELF_CHECK (indata != NULL, _("cannot get section data: %s"));
+	    *outdata = *indata;
+	    elf_flagdata (outdata, ELF_C_SET, ELF_F_DIRTY);
+	  }
 
 	/* Preserve the file layout of the allocated sections.  */
 	if (stripped_ehdr->e_type != ET_REL && (shdr_mem.sh_flags & SHF_ALLOC))
@@ -1663,8 +1749,8 @@ more sections in stripped file than debug file -- arguments reversed?"));
       /* First collect all the symbols from both tables.  */
 
       const size_t total_syms = stripped_nsym - 1 + unstripped_nsym - 1;
-      struct symbol symbols[total_syms];
-      size_t symndx_map[total_syms];
+      struct symbol *symbols = xmalloc (total_syms * sizeof symbols[0]);
+      size_t *symndx_map = xmalloc (total_syms * sizeof symndx_map[0]);
 
       if (stripped_symtab != NULL)
 	collect_symbols (unstripped, stripped_ehdr->e_type == ET_REL,
@@ -1680,14 +1766,17 @@ more sections in stripped file than debug file -- arguments reversed?"));
 		       &symbols[stripped_nsym - 1],
 		       &symndx_map[stripped_nsym - 1], split_bss);
 
-      /* Next, sort our array of all symbols.  */
-      qsort (symbols, total_syms, sizeof symbols[0], compare_symbols);
-
-      /* Now we can weed out the duplicates.  Assign remaining symbols
-	 new slots, collecting a map from old indices to new.  */
+      /* Now we can weed out the duplicates.  Of equal symbols the last
+	 one collected is kept, so going backwards it is the first one
+	 seen.  Assign remaining symbols slots, collecting a map from old
+	 indices to new.  */
+      Symbol_Hash symbol_hash;
+      Symbol_Hash_init (&symbol_hash, total_syms);
       size_t nsym = 0;
-      for (struct symbol *s = symbols; s < &symbols[total_syms]; ++s)
+      for (size_t i = total_syms; i-- > 0; )
 	{
+	  struct symbol *s = &symbols[i];
+
 	  /* Skip a section symbol for a removed section.  */
 	  if (s->shndx == SHN_UNDEF
 	      && GELF_ST_TYPE (s->info.info) == STT_SECTION)
@@ -1698,53 +1787,54 @@ more sections in stripped file than debug file -- arguments reversed?"));
 	      continue;
 	    }
 
-	  struct symbol *n = s;
-	  while (n + 1 < &symbols[total_syms] && !compare_symbols (s, n + 1))
-	    ++n;
-
-	  while (s < n)
+	  unsigned long int hval = hash_symbol (s);
+	  struct symbol *twin = Symbol_Hash_find (&symbol_hash, hval, s);
+	  if (twin != NULL)
 	    {
-	      /* This is a duplicate.  Its twin will get the next slot.  */
+	      /* This is a duplicate.  Its twin has a slot.  */
 	      s->name = NULL;	/* Mark as discarded. */
-	      s->duplicate = n->map;
-	      ++s;
+	      s->duplicate = twin->map;
+	      continue;
 	    }
 
 	  /* Allocate the next slot.  */
+	  Symbol_Hash_insert (&symbol_hash, hval, s);
 	  *s->map = ++nsym;
 	}
+      Symbol_Hash_free (&symbol_hash);
 
-      /* Now we sort again, to determine the order in the output.  */
-      qsort (symbols, total_syms, sizeof symbols[0], compare_symbols_output);
+      /* Now determine the order in the output.  */
+      struct symbol **output_symbols = order_output_symbols (symbols,
+							     total_syms,
+							     nsym);
 
-      if (nsym < total_syms)
-	/* The discarded symbols are now at the end of the table.  */
-	assert (symbols[nsym].name == NULL);
-
-      /* Now a final pass updates the map with the final order,
-	 and builds up the new string table.  */
-      symstrtab = dwelf_strtab_init (true);
+      /* Now a pass updates the map with the final order.  */
       for (size_t i = 0; i < nsym; ++i)
 	{
-	  assert (symbols[i].name != NULL);
-	  assert (*symbols[i].map != 0);
-	  *symbols[i].map = 1 + i;
-	  symbols[i].strent = dwelf_strtab_add (symstrtab, symbols[i].name);
+	  assert (output_symbols[i]->name != NULL);
+	  assert (*output_symbols[i]->map != 0);
+	  *output_symbols[i]->map = 1 + i;
 	}
 
       /* Scan the discarded symbols too, just to update their slots
 	 in SYMNDX_MAP to refer to their live duplicates.  */
-      for (size_t i = nsym; i < total_syms; ++i)
-	{
-	  assert (symbols[i].name == NULL);
-	  if (symbols[i].duplicate == NULL)
-	    assert (*symbols[i].map == STN_UNDEF);
-	  else
-	    {
-	      assert (*symbols[i].duplicate != STN_UNDEF);
-	      *symbols[i].map = *symbols[i].duplicate;
-	    }
-	}
+      for (size_t i = 0; i < total_syms; ++i)
+	if (symbols[i].name == NULL)
+	  {
+	    if (symbols[i].duplicate == NULL)
+	      assert (*symbols[i].map == STN_UNDEF);
+	    else
+	      {
+		assert (*symbols[i].duplicate != STN_UNDEF);
+		*symbols[i].map = *symbols[i].duplicate;
+	      }
+	  }
+
+      /* A final pass builds up the new string table.  */
+      symstrtab = dwelf_strtab_init (true);
+      for (size_t i = 0; i < nsym; ++i)
+	output_symbols[i]->strent = dwelf_strtab_add (symstrtab,
+						      output_symbols[i]->name);
 
       /* Now we are ready to write the new symbol table.  */
       symdata = elf_getdata (unstripped_symtab, NULL);
@@ -1811,7 +1901,7 @@ more sections in stripped file than debug file -- arguments reversed?"));
       shdr->sh_info = 1;
       for (size_t i = 0; i < nsym; ++i)
 	{
-	  struct symbol *s = &symbols[i];
+	  struct symbol *s = output_symbols[i];
 
 	  /* Fill in the symbol details.  */
 	  sym.st_name = dwelf_strent_off (s->strent);
@@ -1836,6 +1926,9 @@ more sections in stripped file than debug file -- arguments reversed?"));
       elf_flagdata (symdata, ELF_C_SET, ELF_F_DIRTY);
       update_shdr (unstripped_symtab, shdr);
 
+      free (output_symbols);
+      free (symbols);
+
       if (stripped_symtab != NULL)
 	{
 	  /* Adjust any relocations referring to the old symbol table.  */
@@ -1851,6 +1944,8 @@ more sections in stripped file than debug file -- arguments reversed?"));
       /* Also adjust references to the other old symbol table.  */
       adjust_all_relocs (unstripped, unstripped_symtab, shdr,
 			 &symndx_map[stripped_nsym - 1]);
+
+      free (symndx_map);
     }
   else if (stripped_symtab != NULL && stripped_shnum != unstripped_shnum)
     check_symtab_section_symbols (unstripped,
@@ -2037,7 +2132,7 @@ DWARF data in '%s' not adjusted for prelinking bias; consider prelink -u"),
       if (unstripped == NULL)
 	{
 	  /* Actually, we are just copying out the main file as it is.  */
-	  copy_elf (outelf, stripped);
+	  copy_elf (outelf, stripped, true);
 	  if (stripped_ehdr->e_type != ET_REL)
 	    elf_flagelf (outelf, ELF_C_SET, ELF_F_LAYOUT);
 	  ELF_CHECK (elf_update (outelf, ELF_C_WRITE) > 0,
@@ -2045,7 +2140,7 @@ DWARF data in '%s' not adjusted for prelinking bias; consider prelink -u"),
 	}
       else
 	{
-	  copy_elf (outelf, unstripped);
+	  copy_elf (outelf, unstripped, false);
 	  copy_elided_sections (outelf, stripped, stripped_ehdr, bias);
 	}
 
@@ -0,0 +1,169 @@
+/* Test program for elf_getarmemnum and elf_begin_armem.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include ELFUTILS_HEADER(elf)
+
+
+struct member
+{
+  char *name;
+  int64_t off;
+  size_t size;
+  Elf_Kind kind;
+};
+
+
+/* Check the members of the archive in FNAME opened with CMD.  The
+   members are first read sequentially with elf_next, then in reverse
+   order through the member table.  Both must agree.  */
+static int
+check_archive (const char *fname, Elf_Cmd cmd)
+{
+  int fd = open (fname, O_RDONLY);
+  if (fd == -1)
+    {
+      printf ("cannot open '%s': %m\n", fname);
+      return 1;
+    }
+
+  Elf *elf = elf_begin (fd, cmd, NULL);
+  if (elf == NULL || elf_kind (elf) != ELF_K_AR)
+    {
+      printf ("'%s' is no archive: %s\n", fname, elf_errmsg (-1));
+      return 1;
+    }
+
+  size_t nmem = 0;
+  size_t maxmem = 16;
+  struct member *mem = malloc (maxmem * sizeof *mem);
+
+  Elf *subelf;
+  Elf_Cmd subcmd = cmd;
+  while ((subelf = elf_begin (fd, subcmd, elf)) != NULL)
+    {
+      Elf_Arhdr *arhdr = elf_getarhdr (subelf);
+      if (arhdr == NULL)
+	{
+	  printf ("cannot get arhdr: %s\n", elf_errmsg (-1));
+	  return 1;
+	}
+
+      if (arhdr->ar_name[0] != '/')
+	{
+	  if (nmem == maxmem)
+	    mem = realloc (mem, (maxmem *= 2) * sizeof *mem);
+	  mem[nmem].name = strdup (arhdr->ar_name);
+	  mem[nmem].off = elf_getaroff (subelf);
+	  mem[nmem].size = arhdr->ar_size;
+	  mem[nmem].kind = elf_kind (subelf);
+	  ++nmem;
+	}
+
+      subcmd = elf_next (subelf);
+      elf_end (subelf);
+    }
+
+  size_t num;
+  if (elf_getarmemnum (elf, &num) != 0)
+    {
+      printf ("elf_getarmemnum: %s\n", elf_errmsg (-1));
+      return 1;
+    }
+
+  if (num != nmem)
+    {
+      printf ("%s: elf_getarmemnum %zd, but elf_next saw %zd members\n",
+	      fname, num, nmem);
+      return 1;
+    }
+
+  /* Keep all member descriptors open at the same time.  */
+  Elf **subs = malloc (num * sizeof (Elf *));
+  for (size_t n = num; n-- > 0; )
+    {
+      subs[n] = elf_begin_armem (elf, n, cmd);
+      if (subs[n] == NULL)
+	{
+	  printf ("elf_begin_armem %zd: %s\n", n, elf_errmsg (-1));
+	  return 1;
+	}
+
+      Elf_Arhdr *arhdr = elf_getarhdr (subs[n]);
+      if (arhdr == NULL)
+	{
+	  printf ("cannot get arhdr for member %zd: %s\n", n,
+		  elf_errmsg (-1));
+	  return 1;
+	}
+
+      if (strcmp (arhdr->ar_name, mem[n].name) != 0
+	  || (size_t) arhdr->ar_size != mem[n].size
+	  || elf_getaroff (subs[n]) != mem[n].off
+	  || elf_kind (subs[n]) != mem[n].kind)
+	{
+	  printf ("%s: member %zd mismatch: '%s' vs '%s'\n",
+		  fname, n, arhdr->ar_name, mem[n].name);
+	  return 1;
+	}
+    }
+
+  if (elf_begin_armem (elf, num, cmd) != NULL)
+    {
+      printf ("elf_begin_armem beyond the last member succeeded\n");
+      return 1;
+    }
+
+  for (size_t n = 0; n < num; ++n)
+    {
+      elf_end (subs[n]);
+      free (mem[n].name);
+    }
+  free (subs);
+  free (mem);
+
+  elf_end (elf);
+  close (fd);
+
+  printf ("%s: %zd members\n", cmd == ELF_C_READ ? "read" : "mmap", num);
+  return 0;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  int result = 0;
+
+  elf_version (EV_CURRENT);
+
+  for (int i = 1; i < argc; ++i)
+    {
+      result |= check_archive (argv[i], ELF_C_READ);
+      result |= check_archive (argv[i], ELF_C_READ_MMAP);
+    }
+
+  return result;
+}
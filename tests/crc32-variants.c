@@ -0,0 +1,158 @@
+/* Test and benchmark the CRC-32 variants.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <error.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* The variants are static, get them all.  */
+#include "../lib/crc32.c"
+
+
+/* The CRC computed bit by bit from the polynomial.  */
+static uint32_t
+ref_crc32 (uint32_t crc, const unsigned char *buf, size_t len)
+{
+  crc = ~crc;
+  while (len-- > 0)
+    {
+      crc ^= *buf++;
+      for (int k = 0; k < 8; ++k)
+	crc = (crc & 1) != 0 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+    }
+  return ~crc;
+}
+
+
+static const struct
+{
+  const char *name;
+  crc32_fn *fn;
+} variants[] =
+  {
+    { "byte by byte", crc32_bytewise },
+    { "slice-by-8", crc32_slice8 },
+    { "best", NULL },
+  };
+#define NVARIANTS (sizeof variants / sizeof variants[0])
+
+static crc32_fn *
+variant (size_t i)
+{
+  return variants[i].fn ?: crc32_best;
+}
+
+
+static void
+check (const unsigned char *buf, size_t size)
+{
+  for (size_t start = 0; start < 16; ++start)
+    for (size_t len = 0; start + len <= size;
+	 len += len < 300 ? 1 : 4093)
+      {
+	uint32_t expect = ref_crc32 (0, buf + start, len);
+	for (size_t i = 0; i < NVARIANTS; ++i)
+	  {
+	    uint32_t got = ~variant (i) (~0, buf + start, len);
+	    if (got != expect)
+	      error (EXIT_FAILURE, 0,
+		     "%s start %zd len %zd: %#x, expected %#x",
+		     variants[i].name, start, len, got, expect);
+
+	    /* The same in two parts.  */
+	    size_t split = len / 3;
+	    got = ~variant (i) (variant (i) (~0, buf + start, split),
+				buf + start + split, len - split);
+	    if (got != expect)
+	      error (EXIT_FAILURE, 0,
+		     "%s start %zd len %zd split %zd: %#x, expected %#x",
+		     variants[i].name, start, len, split, got, expect);
+	  }
+      }
+}
+
+
+/* Compute the CRC of LEN bytes in BUF ITERATIONS times, returning the
+   throughput in MB per second.  */
+static double
+time_crc (crc32_fn *fn, const unsigned char *buf, size_t len,
+	  unsigned int iterations, uint32_t *crcp)
+{
+  struct timespec start;
+  struct timespec end;
+  uint32_t crc = 0;
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (unsigned int i = 0; i < iterations; ++i)
+    crc = ~fn (~crc, buf, len);
+  clock_gettime (CLOCK_MONOTONIC, &end);
+
+  *crcp = crc;
+  return ((double) len * iterations / 1e6
+	  / ((end.tv_sec - start.tv_sec)
+	     + (end.tv_nsec - start.tv_nsec) / 1e9));
+}
+
+
+/* Without arguments this only checks the variants against computing
+   the CRC bit by bit, for different lengths and alignments.  Given a
+   buffer size in MB and a number of iterations, it also reports the
+   throughput of each.  */
+int
+main (int argc, char *argv[])
+{
+  size_t size = argc > 1 ? strtoul (argv[1], NULL, 0) << 20 : 0;
+  unsigned int iterations = argc > 2 ? strtoul (argv[2], NULL, 0) : 1;
+
+  if (crc32 (0, (unsigned char *) "123456789", 9) != 0xcbf43926)
+    error (EXIT_FAILURE, 0, "crc32 of \"123456789\" is wrong");
+
+  srand (1);
+  unsigned char buf[20000];
+  for (size_t i = 0; i < sizeof buf; ++i)
+    buf[i] = rand ();
+  check (buf, sizeof buf);
+
+  if (size > 0)
+    {
+      unsigned char *big = malloc (size);
+      if (big == NULL)
+	error (EXIT_FAILURE, 0, "cannot allocate %zd bytes", size);
+      for (size_t i = 0; i < size; ++i)
+	big[i] = rand ();
+
+      uint32_t expect = 0;
+      for (size_t i = 0; i < NVARIANTS; ++i)
+	{
+	  uint32_t crc;
+	  double speed = time_crc (variant (i), big, size, iterations, &crc);
+	  if (i == 0)
+	    expect = crc;
+	  else if (crc != expect)
+	    error (EXIT_FAILURE, 0, "%s: %#x, expected %#x",
+		   variants[i].name, crc, expect);
+	  printf ("%s: %.0f MB/s\n", variants[i].name, speed);
+	}
+      free (big);
+    }
+
+  return 0;
+}
@@ -0,0 +1,184 @@
+/* Test program for the debuginfo lookup cache shared by Dwfl sessions.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static char *debuginfo_path;
+
+static const Dwfl_Callbacks callbacks =
+  {
+    .find_elf = dwfl_build_id_find_elf,
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .section_address = dwfl_offline_section_address,
+    .debuginfo_path = &debuginfo_path,
+  };
+
+static const char *stash = "";
+
+/* Look for the debuginfo of FILE in a new Dwfl session and tell where
+   it was found.  */
+static void
+lookup (const char *what, const char *file, char **id_name)
+{
+  Dwfl *dwfl = dwfl_begin (&callbacks);
+  assert (dwfl != NULL);
+  Dwfl_Module *mod = dwfl_report_offline (dwfl, "", file, -1);
+  if (mod == NULL)
+    error (EXIT_FAILURE, 0, "dwfl_report_offline: %s", dwfl_errmsg (-1));
+  dwfl_report_end (dwfl, NULL, NULL);
+
+  if (id_name != NULL)
+    {
+      const unsigned char *bits;
+      GElf_Addr vaddr;
+      int len = dwfl_module_build_id (mod, &bits, &vaddr);
+      assert (len > 1);
+      *id_name = malloc (3 + 2 * len + sizeof ".debug");
+      char *p = *id_name + sprintf (*id_name, "%02x/", bits[0]);
+      for (int i = 1; i < len; ++i)
+	p += sprintf (p, "%02x", bits[i]);
+      strcpy (p, ".debug");
+    }
+
+  Dwarf_Addr bias;
+  const char *debugfile = NULL;
+  if (dwfl_module_getdwarf (mod, &bias) != NULL)
+    dwfl_module_info (mod, NULL, NULL, NULL, NULL, NULL, NULL, &debugfile);
+
+  printf ("%s: %s\n", what,
+	  debugfile == NULL ? "not found"
+	  : strcmp (debugfile, stash) == 0 ? "found in manifest"
+	  : "found in path");
+
+  dwfl_end (dwfl);
+}
+
+/* FILE has no build ID, its DEBUGFILE under DEBUGDIR is checked by
+   the CRC in its .gnu_debuglink.  The CRC of a file is remembered, but
+   not once the file changed.  */
+static int
+check_crc (const char *file, const char *debugfile)
+{
+  lookup ("debuglink", file, NULL);
+  lookup ("debuglink again", file, NULL);
+
+  int fd = open (debugfile, O_WRONLY | O_APPEND);
+  if (fd < 0 || write (fd, "", 1) != 1 || close (fd) != 0)
+    error (EXIT_FAILURE, errno, "cannot change %s", debugfile);
+  lookup ("changed", file, NULL);
+
+  return 0;
+}
+
+/* Usage: debuginfo-cache FILE DEBUGDIR DEBUGFILE STASH MANIFEST
+	  debuginfo-cache --crc FILE DEBUGDIR DEBUGFILE
+
+   DEBUGFILE is where FILE's debuginfo is found under DEBUGDIR, the
+   debuginfo path.  It is moved there and away from STASH in between
+   lookups, which must notice the directory changes.  */
+int
+main (int argc, char **argv)
+{
+  if (argc == 5 && strcmp (argv[1], "--crc") == 0)
+    {
+      debuginfo_path = argv[3];
+      return check_crc (argv[2], argv[4]);
+    }
+
+  if (argc != 6)
+    error (EXIT_FAILURE, 0,
+	   "usage: debuginfo-cache FILE DEBUGDIR DEBUGFILE STASH MANIFEST");
+
+  const char *file = argv[1];
+  debuginfo_path = argv[2];
+  const char *debugfile = argv[3];
+  stash = argv[4];
+  const char *manifest = argv[5];
+
+  char *id_name;
+  lookup ("stashed", file, &id_name);
+  lookup ("stashed again", file, NULL);
+
+  if (rename (stash, debugfile) != 0)
+    error (EXIT_FAILURE, errno, "rename");
+  lookup ("added", file, NULL);
+
+  /* What one session found by build ID is not found by another with a
+     different debuginfo path.  The directory of STASH has no .build-id.  */
+  char *idfile;
+  if (asprintf (&idfile, "%s/.build-id/%s", debuginfo_path, id_name) < 0)
+    error (EXIT_FAILURE, errno, "asprintf");
+  char *subdir = strrchr (idfile, '/');
+  *subdir = '\0';
+  char *builddir = strrchr (idfile, '/');
+  *builddir = '\0';
+  mkdir (idfile, 0777);
+  *builddir = '/';
+  mkdir (idfile, 0777);
+  *subdir = '/';
+  if (link (debugfile, idfile) != 0)
+    error (EXIT_FAILURE, errno, "link");
+  lookup ("build ID", file, NULL);
+
+  char *otherdir = strdup (stash);
+  *strrchr (otherdir, '/') = '\0';
+  debuginfo_path = otherdir;
+  lookup ("other path", file, NULL);
+  debuginfo_path = argv[2];
+  free (otherdir);
+
+  unlink (idfile);
+  *subdir = '\0';
+  rmdir (idfile);
+  *builddir = '\0';
+  rmdir (idfile);
+  free (idfile);
+
+  if (rename (debugfile, stash) != 0)
+    error (EXIT_FAILURE, errno, "rename");
+  lookup ("removed", file, NULL);
+  lookup ("removed again", file, NULL);
+
+  FILE *fp = fopen (manifest, "w");
+  if (fp == NULL)
+    error (EXIT_FAILURE, errno, "fopen");
+  fprintf (fp, "# build ID name, file\n%s %s\n", id_name, stash);
+  fclose (fp);
+  int n = dwfl_debuginfo_cache_seed (manifest);
+  if (n < 0)
+    error (EXIT_FAILURE, 0, "dwfl_debuginfo_cache_seed: %s",
+	   dwfl_errmsg (-1));
+  printf ("seeded %d\n", n);
+  lookup ("seeded", file, NULL);
+
+  dwfl_debuginfo_cache_flush ();
+  lookup ("flushed", file, NULL);
+
+  free (id_name);
+  return 0;
+}
@@ -0,0 +1,114 @@
+/* Test program for reading modules from core files.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static char *debuginfo_path = NULL;
+
+static const Dwfl_Callbacks callbacks =
+  {
+    .find_elf = dwfl_build_id_find_elf,
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .debuginfo_path = &debuginfo_path,
+  };
+
+static int
+print_module (Dwfl_Module *mod, void **userdata __attribute__ ((unused)),
+	      const char *name, Dwarf_Addr low, void *arg)
+{
+  Dwarf_Addr high;
+  dwfl_module_info (mod, NULL, NULL, &high, NULL, NULL, NULL, NULL);
+  fprintf (arg, "%#" PRIx64 "-%#" PRIx64 " %s", low, high, name);
+
+  GElf_Addr bias;
+  if (dwfl_module_getelf (mod, &bias) == NULL)
+    fprintf (arg, " no ELF\n");
+  else
+    fprintf (arg, " symbols %d\n", dwfl_module_getsymtab (mod));
+  return DWARF_CB_OK;
+}
+
+/* Report the modules in the core file FD, opened for CMD, and write
+   them to OUT.  */
+static void
+report (FILE *out, int fd, Elf_Cmd cmd)
+{
+  Elf *core = elf_begin (fd, cmd, NULL);
+  if (core == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin: %s", elf_errmsg (-1));
+
+  Dwfl *dwfl = dwfl_begin (&callbacks);
+  assert (dwfl != NULL);
+  int n = dwfl_core_file_report (dwfl, core, NULL);
+  if (n < 0)
+    error (EXIT_FAILURE, 0, "dwfl_core_file_report: %s", dwfl_errmsg (-1));
+  dwfl_report_end (dwfl, NULL, NULL);
+
+  fprintf (out, "reported %d\n", n);
+  dwfl_getmodules (dwfl, print_module, out, 0);
+
+  dwfl_end (dwfl);
+  elf_end (core);
+}
+
+/* Usage: dwfl-core-read CORE
+
+   Report the modules in CORE, reading the ELF images from the core
+   file itself, and check that it makes no difference whether the
+   core file is mmap'd.  */
+int
+main (int argc, char **argv)
+{
+  if (argc != 2)
+    error (EXIT_FAILURE, 0, "usage: dwfl-core-read CORE");
+
+  elf_version (EV_CURRENT);
+  int fd = open (argv[1], O_RDONLY);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "open %s", argv[1]);
+
+  char *mapped;
+  size_t mappedlen;
+  FILE *out = open_memstream (&mapped, &mappedlen);
+  report (out, fd, ELF_C_READ_MMAP);
+  fclose (out);
+
+  char *read;
+  size_t readlen;
+  out = open_memstream (&read, &readlen);
+  report (out, fd, ELF_C_READ);
+  fclose (out);
+
+  fputs (mapped, stdout);
+  if (strcmp (mapped, read) != 0)
+    error (EXIT_FAILURE, 0, "without mmap:\n%s", read);
+
+  free (mapped);
+  free (read);
+  close (fd);
+  return 0;
+}
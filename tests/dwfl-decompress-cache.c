@@ -0,0 +1,72 @@
+/* Test program for dwfl_decompress_cache_dir.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <error.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static const Dwfl_Callbacks callbacks =
+  {
+    .find_elf = dwfl_build_id_find_elf,
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .section_address = dwfl_offline_section_address,
+  };
+
+/* Usage: dwfl-decompress-cache CACHEDIR FILE...
+
+   Report each FILE, keeping decompressed files in CACHEDIR, and print
+   what was found in it.  */
+int
+main (int argc, char **argv)
+{
+  if (argc < 3)
+    error (EXIT_FAILURE, 0, "usage: dwfl-decompress-cache CACHEDIR FILE...");
+
+  if (dwfl_decompress_cache_dir (argv[1]) != 0)
+    error (EXIT_FAILURE, 0, "dwfl_decompress_cache_dir: %s",
+	   dwfl_errmsg (-1));
+
+  for (int i = 2; i < argc; ++i)
+    {
+      Dwfl *dwfl = dwfl_begin (&callbacks);
+      assert (dwfl != NULL);
+
+      const char *name = strrchr (argv[i], '/');
+      name = name == NULL ? argv[i] : name + 1;
+      Dwfl_Module *mod = dwfl_report_offline (dwfl, name, argv[i], -1);
+      if (mod == NULL)
+	error (EXIT_FAILURE, 0, "dwfl_report_offline: %s", dwfl_errmsg (-1));
+      dwfl_report_end (dwfl, NULL, NULL);
+
+      Dwarf_Addr low, high;
+      dwfl_module_info (mod, NULL, &low, &high, NULL, NULL, NULL, NULL);
+      printf ("%s %#" PRIx64 "-%#" PRIx64 " symbols %d\n",
+	      name, low, high, dwfl_module_getsymtab (mod));
+
+      dwfl_end (dwfl);
+    }
+
+  if (dwfl_decompress_cache_dir (NULL) != 0)
+    error (EXIT_FAILURE, 0, "dwfl_decompress_cache_dir: %s",
+	   dwfl_errmsg (-1));
+  return 0;
+}
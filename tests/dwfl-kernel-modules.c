@@ -0,0 +1,104 @@
+/* Test program for finding the modules of an offline kernel.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static char *debuginfo_path;
+
+static const Dwfl_Callbacks callbacks =
+  {
+    .find_elf = dwfl_build_id_find_elf,
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .section_address = dwfl_offline_section_address,
+    .debuginfo_path = &debuginfo_path,
+  };
+
+static size_t dirlen;
+
+/* Tell which modules are found, but don't report them, they need not
+   be ELF files.  */
+static int
+predicate (const char *module, const char *file)
+{
+  printf ("%s %s\n", module,
+	  file == NULL ? "(none)"
+	  : strncmp (file, debuginfo_path, dirlen) == 0 ? file + dirlen + 1
+	  : file);
+  return 0;
+}
+
+static void
+report (const char *dir)
+{
+  Dwfl *dwfl = dwfl_begin (&callbacks);
+  assert (dwfl != NULL);
+  int result = dwfl_linux_kernel_report_offline (dwfl, dir, predicate);
+  if (result != 0)
+    error (EXIT_FAILURE, result < 0 ? 0 : result,
+	   "dwfl_linux_kernel_report_offline: %s",
+	   result < 0 ? dwfl_errmsg (-1) : dir);
+  dwfl_end (dwfl);
+}
+
+/* Usage: dwfl-kernel-modules DIR [LINE...]
+
+   Report the kernel in DIR.  Then for each LINE, add it to
+   DIR/modules.dep and report again.  A LINE starting with + instead
+   names a file to create under DIR.  */
+int
+main (int argc, char **argv)
+{
+  if (argc < 2)
+    error (EXIT_FAILURE, 0, "usage: dwfl-kernel-modules DIR [LINE...]");
+
+  const char *dir = argv[1];
+  debuginfo_path = argv[1];
+  dirlen = strlen (dir);
+
+  report (dir);
+
+  char *depname;
+  if (asprintf (&depname, "%s/modules.dep", dir) < 0)
+    error (EXIT_FAILURE, errno, "asprintf");
+  for (int i = 2; i < argc; ++i)
+    {
+      char *fname = NULL;
+      if (argv[i][0] == '+'
+	  && asprintf (&fname, "%s/%s", dir, &argv[i][1]) < 0)
+	error (EXIT_FAILURE, errno, "asprintf");
+      FILE *fp = fopen (fname ?: depname, "a");
+      if (fp == NULL)
+	error (EXIT_FAILURE, errno, "fopen");
+      if (fname == NULL)
+	fprintf (fp, "%s\n", argv[i]);
+      fclose (fp);
+      free (fname);
+
+      printf ("--- %s\n", argv[i]);
+      report (dir);
+    }
+  free (depname);
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+/* Test program for relocating ET_REL debug sections as they are read.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(dwfl)
+#include <gelf.h>
+
+
+static const Dwfl_Callbacks callbacks =
+  {
+    .find_elf = dwfl_build_id_find_elf,
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .section_address = dwfl_offline_section_address,
+  };
+
+/* Print the relocation sections of ELF that still have entries.  */
+static void
+print_relocs (const char *what, Elf *elf)
+{
+  size_t shstrndx;
+  if (elf_getshdrstrndx (elf, &shstrndx) < 0)
+    error (EXIT_FAILURE, 0, "elf_getshdrstrndx: %s", elf_errmsg (-1));
+
+  printf ("%s:", what);
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      assert (shdr != NULL);
+      if ((shdr->sh_type == SHT_REL || shdr->sh_type == SHT_RELA)
+	  && shdr->sh_size != 0)
+	printf (" %s", elf_strptr (elf, shstrndx, shdr->sh_name));
+    }
+  printf ("\n");
+}
+
+/* Make the first relocation in section RELNAME of FILE point past the
+   end of the section it applies to.  */
+static void
+break_reloc (const char *relname, const char *file)
+{
+  int fd = open (file, O_RDWR);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "open %s", file);
+  elf_version (EV_CURRENT);
+  Elf *elf = elf_begin (fd, ELF_C_RDWR, NULL);
+  size_t shstrndx;
+  if (elf == NULL || elf_getshdrstrndx (elf, &shstrndx) < 0)
+    error (EXIT_FAILURE, 0, "%s: %s", file, elf_errmsg (-1));
+
+  Elf_Scn *scn = NULL;
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL
+	 && ((shdr = gelf_getshdr (scn, &shdr_mem)) == NULL
+	     || strcmp (elf_strptr (elf, shstrndx, shdr->sh_name),
+			relname) != 0))
+    ;
+  if (scn == NULL || shdr->sh_type != SHT_RELA)
+    error (EXIT_FAILURE, 0, "%s: no %s", file, relname);
+
+  GElf_Shdr tshdr_mem;
+  GElf_Shdr *tshdr = gelf_getshdr (elf_getscn (elf, shdr->sh_info),
+				   &tshdr_mem);
+  Elf_Data *data = elf_getdata (scn, NULL);
+  GElf_Rela rela_mem;
+  GElf_Rela *rela = data == NULL ? NULL : gelf_getrela (data, 0, &rela_mem);
+  if (tshdr == NULL || rela == NULL)
+    error (EXIT_FAILURE, 0, "%s: %s", file, elf_errmsg (-1));
+  rela->r_offset = tshdr->sh_size;
+  elf_flagelf (elf, ELF_C_SET, ELF_F_LAYOUT);
+  if (gelf_update_rela (data, 0, rela) == 0
+      || elf_flagdata (data, ELF_C_SET, ELF_F_DIRTY) == 0
+      || elf_update (elf, ELF_C_WRITE) < 0)
+    error (EXIT_FAILURE, 0, "%s: %s", file, elf_errmsg (-1));
+  elf_end (elf);
+  close (fd);
+}
+
+/* Usage: dwfl-lazy-reloc FILE
+	  dwfl-lazy-reloc --break RELNAME FILE
+
+   FILE is an ET_REL file with DWARF.  Read its DWARF, then tell which
+   relocation sections are left once libdw gives out the ELF file and
+   once all of it is relocated.  With --break, make the relocations in
+   section RELNAME of FILE invalid first.  */
+int
+main (int argc, char **argv)
+{
+  if (argc == 4 && strcmp (argv[1], "--break") == 0)
+    {
+      break_reloc (argv[2], argv[3]);
+      argc -= 2;
+      argv += 2;
+    }
+  if (argc != 2)
+    error (EXIT_FAILURE, 0, "usage: dwfl-lazy-reloc [--break RELNAME] FILE");
+
+  Dwfl *dwfl = dwfl_begin (&callbacks);
+  assert (dwfl != NULL);
+  Dwfl_Module *mod = dwfl_report_offline (dwfl, "", argv[1], -1);
+  if (mod == NULL)
+    error (EXIT_FAILURE, 0, "dwfl_report_offline: %s", dwfl_errmsg (-1));
+  dwfl_report_end (dwfl, NULL, NULL);
+
+  Dwarf_Addr bias;
+  Dwarf *dw = dwfl_module_getdwarf (mod, &bias);
+  if (dw == NULL)
+    error (EXIT_FAILURE, 0, "dwfl_module_getdwarf: %s", dwfl_errmsg (-1));
+
+  Dwarf_Off off = 0;
+  Dwarf_Off next;
+  size_t hsize;
+  Dwarf_Die cudie;
+  if (dwarf_nextcu (dw, off, &next, &hsize, NULL, NULL, NULL) != 0
+      || dwarf_offdie (dw, off + hsize, &cudie) == NULL)
+    error (EXIT_FAILURE, 0, "no CU: %s", dwarf_errmsg (-1));
+  Dwarf_Addr lowpc;
+  if (dwarf_lowpc (&cudie, &lowpc) == 0)
+    printf ("%s lowpc %#" PRIx64 "\n", dwarf_diename (&cudie), lowpc + bias);
+
+  Dwarf_Lines *lines;
+  size_t nlines = 0;
+  if (dwarf_getsrclines (&cudie, &lines, &nlines) != 0)
+    printf ("dwarf_getsrclines: %s\n", dwarf_errmsg (-1));
+  for (size_t i = 0; i < nlines; ++i)
+    {
+      Dwarf_Line *line = dwarf_onesrcline (lines, i);
+      Dwarf_Addr addr;
+      int lineno;
+      if (dwarf_lineaddr (line, &addr) == 0
+	  && dwarf_lineno (line, &lineno) == 0)
+	printf ("line %d %#" PRIx64 "\n", lineno, addr + bias);
+    }
+
+  /* The caller may read all of the DWARF from the ELF file now.  */
+  Elf *elf = dwarf_getelf (dw);
+  print_relocs ("getelf dwarf", elf);
+
+  GElf_Addr loadbase;
+  if (dwfl_module_getelf (mod, &loadbase) == NULL)
+    error (EXIT_FAILURE, 0, "dwfl_module_getelf: %s", dwfl_errmsg (-1));
+  print_relocs ("getelf", elf);
+
+  dwfl_end (dwfl);
+  return 0;
+}
@@ -0,0 +1,308 @@
+/* Test program for following the link_map list in a core file.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <gelf.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static char *debuginfo_path = NULL;
+
+static const Dwfl_Callbacks callbacks =
+  {
+    .find_elf = dwfl_build_id_find_elf,
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .debuginfo_path = &debuginfo_path,
+  };
+
+/* The memory image of the core file, in pages from IMAGE_VADDR on.
+   The first page holds the phdrs, the dynamic section and r_debug.  */
+#define IMAGE_VADDR	0x100000
+#define PAGE		0x1000
+#define PHDR_OFF	0x40
+#define DYN_OFF		0x100
+#define R_DEBUG_OFF	0x200
+/* Each link_map entry has a page of its own, every other page from the
+   second page on, farther apart than what is read at once.  */
+#define ENTRY_OFF	0x800
+/* Each name goes into the page of the next entry, before that entry.
+   So that entry is read from where the name was read.  */
+#define NAME_OFF	0x401
+#define MODULE_SPACING	0x10000000
+
+static unsigned char *image;
+static bool msb;
+
+static void
+put32 (size_t off, uint32_t val)
+{
+  for (int i = 0; i < 4; ++i)
+    image[off + i] = val >> (msb ? 24 - i * 8 : i * 8);
+}
+
+static void
+put64 (size_t off, uint64_t val)
+{
+  for (int i = 0; i < 8; ++i)
+    image[off + i] = val >> (msb ? 56 - i * 8 : i * 8);
+}
+
+static void
+put_phdr (size_t off, uint32_t type, uint64_t vaddr, uint64_t size)
+{
+  put32 (off, type);
+  put64 (off + 16, vaddr);
+  put64 (off + 24, vaddr);
+  put64 (off + 32, size);
+  put64 (off + 40, size);
+  put64 (off + 48, 8);
+}
+
+/* Return the vaddr of the PT_DYNAMIC of the 64-bit ELF FILE, copying
+   its header to EHDR.  */
+static GElf_Addr
+dynamic_vaddr (const char *file, GElf_Ehdr *ehdr)
+{
+  int fd = open (file, O_RDONLY);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "open %s", file);
+  Elf *elf = elf_begin (fd, ELF_C_READ, NULL);
+  if (elf == NULL || gelf_getehdr (elf, ehdr) == NULL)
+    error (EXIT_FAILURE, 0, "%s: %s", file, elf_errmsg (-1));
+  if (ehdr->e_ident[EI_CLASS] != ELFCLASS64)
+    error (EXIT_FAILURE, 0, "%s: not ELFCLASS64", file);
+
+  size_t phnum;
+  if (elf_getphdrnum (elf, &phnum) != 0)
+    error (EXIT_FAILURE, 0, "%s: %s", file, elf_errmsg (-1));
+  GElf_Addr vaddr = 0;
+  for (size_t i = 0; i < phnum && vaddr == 0; ++i)
+    {
+      GElf_Phdr phdr_mem;
+      GElf_Phdr *phdr = gelf_getphdr (elf, i, &phdr_mem);
+      if (phdr != NULL && phdr->p_type == PT_DYNAMIC)
+	vaddr = phdr->p_vaddr;
+    }
+  if (vaddr == 0)
+    error (EXIT_FAILURE, 0, "%s: no PT_DYNAMIC", file);
+
+  elf_end (elf);
+  close (fd);
+  return vaddr;
+}
+
+/* Write a core file to CORE whose link_map list has an entry for each
+   of the N FILES, in that order.  They get descending addresses, the
+   same one each time for a file given more than once.  */
+static void
+write_core (const char *core, int n, char **files)
+{
+  GElf_Ehdr lib_ehdr;
+  const size_t npages = 1 + 2 * n + 1;
+  image = calloc (npages, PAGE);
+  assert (image != NULL);
+
+  /* The phdrs, one PT_PHDR and one PT_DYNAMIC, the dynamic section with
+     its DT_DEBUG and r_debug.  */
+  for (int i = 0; i < n; ++i)
+    {
+      GElf_Addr dyn = dynamic_vaddr (files[i], &lib_ehdr);
+      msb = lib_ehdr.e_ident[EI_DATA] == ELFDATA2MSB;
+
+      int first = 0;
+      while (strcmp (files[first], files[i]) != 0)
+	++first;
+      const GElf_Addr base = (GElf_Addr) (n - first) * MODULE_SPACING;
+
+      /* struct link_map: l_addr, l_name, l_ld, l_next, l_prev.  */
+      const size_t entry = (1 + 2 * i) * PAGE + ENTRY_OFF;
+      const size_t name = (i + 1 < n
+			   ? (3 + 2 * i) * PAGE + NAME_OFF
+			   /* The last name runs over into the last page.  */
+			   : (3 + 2 * i) * PAGE - 3);
+      put64 (entry, base);
+      put64 (entry + 8, IMAGE_VADDR + name);
+      put64 (entry + 16, base + dyn);
+      put64 (entry + 24, i + 1 < n ? IMAGE_VADDR + entry + 2 * PAGE : 0);
+      put64 (entry + 32, i > 0 ? IMAGE_VADDR + entry - 2 * PAGE : 0);
+      strcpy ((char *) &image[name], files[i]);
+    }
+
+  put_phdr (PHDR_OFF, PT_PHDR, IMAGE_VADDR + PHDR_OFF, 2 * 56);
+  put_phdr (PHDR_OFF + 56, PT_DYNAMIC, IMAGE_VADDR + DYN_OFF, 2 * 16);
+  put64 (DYN_OFF, DT_DEBUG);
+  put64 (DYN_OFF + 8, IMAGE_VADDR + R_DEBUG_OFF);
+  put64 (R_DEBUG_OFF, 1);
+  put64 (R_DEBUG_OFF + 8, IMAGE_VADDR + PAGE + ENTRY_OFF);
+
+  /* An NT_AUXV note pointing at the phdrs.  */
+  unsigned char notes[12 + 8 + 5 * 16];
+  unsigned char *saved = image;
+  image = notes;
+  put32 (0, sizeof "CORE");
+  put32 (4, 5 * 16);
+  put32 (8, NT_AUXV);
+  memcpy (&notes[12], "CORE\0\0\0", 8);
+  const uint64_t auxv[5][2] =
+    {
+      { AT_PHDR, IMAGE_VADDR + PHDR_OFF },
+      { AT_PHENT, 56 },
+      { AT_PHNUM, 2 },
+      { AT_PAGESZ, PAGE },
+      { AT_NULL, 0 }
+    };
+  for (int i = 0; i < 5; ++i)
+    {
+      put64 (20 + i * 16, auxv[i][0]);
+      put64 (20 + i * 16 + 8, auxv[i][1]);
+    }
+  image = saved;
+
+  int fd = open (core, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "open %s", core);
+  Elf *elf = elf_begin (fd, ELF_C_WRITE, NULL);
+  if (elf == NULL || gelf_newehdr (elf, ELFCLASS64) == 0
+      || gelf_newphdr (elf, 1 + npages) == 0)
+    error (EXIT_FAILURE, 0, "%s: %s", core, elf_errmsg (-1));
+
+  GElf_Ehdr ehdr_mem, *ehdr = gelf_getehdr (elf, &ehdr_mem);
+  ehdr->e_ident[EI_DATA] = lib_ehdr.e_ident[EI_DATA];
+  ehdr->e_type = ET_CORE;
+  ehdr->e_machine = lib_ehdr.e_machine;
+  ehdr->e_version = EV_CURRENT;
+  gelf_update_ehdr (elf, ehdr);
+
+  /* The note and the memory image go into sections, so libelf lays
+     them out.  */
+  struct
+  {
+    void *buf;
+    size_t size;
+    size_t align;
+    GElf_Word type;
+  } contents[2] =
+    {
+      { notes, sizeof notes, 4, SHT_NOTE },
+      { image, npages * PAGE, PAGE, SHT_PROGBITS }
+    };
+  Elf_Scn *scn[2];
+  for (int i = 0; i < 2; ++i)
+    {
+      scn[i] = elf_newscn (elf);
+      Elf_Data *data = scn[i] == NULL ? NULL : elf_newdata (scn[i]);
+      if (data == NULL)
+	error (EXIT_FAILURE, 0, "%s: %s", core, elf_errmsg (-1));
+      data->d_buf = contents[i].buf;
+      data->d_size = contents[i].size;
+      data->d_align = contents[i].align;
+      GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn[i], &shdr_mem);
+      shdr->sh_type = contents[i].type;
+      shdr->sh_addralign = contents[i].align;
+      gelf_update_shdr (scn[i], shdr);
+    }
+  if (elf_update (elf, ELF_C_NULL) < 0)
+    error (EXIT_FAILURE, 0, "%s: %s", core, elf_errmsg (-1));
+
+  /* The note, then a PT_LOAD for each page.  libdwfl does not follow
+     more link_map entries than there are segments.  */
+  GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn[0], &shdr_mem);
+  GElf_Phdr phdr =
+    {
+      .p_type = PT_NOTE,
+      .p_offset = shdr->sh_offset,
+      .p_filesz = shdr->sh_size,
+      .p_align = 4
+    };
+  gelf_update_phdr (elf, 0, &phdr);
+  shdr = gelf_getshdr (scn[1], &shdr_mem);
+  for (size_t i = 0; i < npages; ++i)
+    {
+      phdr = (GElf_Phdr)
+	{
+	  .p_type = PT_LOAD,
+	  .p_flags = PF_R | PF_W,
+	  .p_offset = shdr->sh_offset + i * PAGE,
+	  .p_vaddr = IMAGE_VADDR + i * PAGE,
+	  .p_filesz = PAGE,
+	  .p_memsz = PAGE,
+	  .p_align = PAGE
+	};
+      gelf_update_phdr (elf, 1 + i, &phdr);
+    }
+  if (elf_update (elf, ELF_C_WRITE) < 0)
+    error (EXIT_FAILURE, 0, "%s: %s", core, elf_errmsg (-1));
+
+  elf_end (elf);
+  close (fd);
+  free (image);
+}
+
+static int
+print_module (Dwfl_Module *mod __attribute__ ((unused)),
+	      void **userdata __attribute__ ((unused)),
+	      const char *name, Dwarf_Addr low, void *arg __attribute__ ((unused)))
+{
+  printf ("%#" PRIx64 " %s\n", low, name);
+  return DWARF_CB_OK;
+}
+
+/* Usage: dwfl-link-map CORE FILE...
+
+   Write a core file to CORE, with a link_map list of the FILEs, and
+   report its modules in order.  The entries and names are spread over
+   more pages than are cached when reading the list, the names are not
+   aligned and the last name crosses a page boundary.  */
+int
+main (int argc, char **argv)
+{
+  if (argc < 3)
+    error (EXIT_FAILURE, 0, "usage: dwfl-link-map CORE FILE...");
+
+  elf_version (EV_CURRENT);
+  write_core (argv[1], argc - 2, &argv[2]);
+
+  int fd = open (argv[1], O_RDONLY);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "open %s", argv[1]);
+  Elf *core = elf_begin (fd, ELF_C_READ_MMAP, NULL);
+  if (core == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin: %s", elf_errmsg (-1));
+
+  Dwfl *dwfl = dwfl_begin (&callbacks);
+  assert (dwfl != NULL);
+  int n = dwfl_core_file_report (dwfl, core, NULL);
+  if (n < 0)
+    error (EXIT_FAILURE, 0, "dwfl_core_file_report: %s", dwfl_errmsg (-1));
+  dwfl_report_end (dwfl, NULL, NULL);
+
+  printf ("reported %d\n", n);
+  dwfl_getmodules (dwfl, print_module, NULL, 0);
+
+  dwfl_end (dwfl);
+  elf_end (core);
+  close (fd);
+  return 0;
+}
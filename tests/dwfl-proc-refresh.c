@@ -0,0 +1,174 @@
+/* Test program for dwfl_linux_proc_refresh.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static char *debuginfo_path = NULL;
+
+static const Dwfl_Callbacks callbacks =
+  {
+    .find_elf = dwfl_linux_proc_find_elf,
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .debuginfo_path = &debuginfo_path,
+  };
+
+/* dwfl_linux_proc_refresh reads the maps file it reports the modules
+   from with fmemopen, only when files were mapped or unmapped.  Count
+   those reports, reading from a temporary file instead.  */
+static int reports;
+
+FILE *
+fmemopen (void *buf, size_t size, const char *mode)
+{
+  assert (strcmp (mode, "r") == 0);
+  ++reports;
+  FILE *f = tmpfile ();
+  if (f != NULL
+      && (fwrite (buf, 1, size, f) != size || fseek (f, 0, SEEK_SET) != 0))
+    {
+      fclose (f);
+      f = NULL;
+    }
+  return f;
+}
+
+static int
+count_module (Dwfl_Module *mod __attribute__ ((unused)),
+	      void **userdata __attribute__ ((unused)),
+	      const char *name __attribute__ ((unused)),
+	      Dwarf_Addr start __attribute__ ((unused)), void *arg)
+{
+  ++*(int *) arg;
+  return DWARF_CB_OK;
+}
+
+static int
+count_modules (Dwfl *dwfl)
+{
+  int n = 0;
+  dwfl_getmodules (dwfl, count_module, &n, 0);
+  return n;
+}
+
+/* Refresh the modules, and tell whether they were reported again.  */
+static const char *
+refresh (Dwfl *dwfl)
+{
+  int before = reports;
+  int result = dwfl_linux_proc_refresh (dwfl, getpid ());
+  if (result < 0)
+    error (EXIT_FAILURE, 0, "dwfl_linux_proc_refresh: %s", dwfl_errmsg (-1));
+  else if (result > 0)
+    error (EXIT_FAILURE, result, "dwfl_linux_proc_refresh");
+  return reports == before ? "unchanged" : "reported";
+}
+
+/* Refresh and tell about it as WHAT, with the module count relative to
+   COUNT and whether SELF is still the module at ADDR.  */
+static void
+print_refresh (Dwfl *dwfl, const char *what, int count, Dwfl_Module *self,
+	       void *addr)
+{
+  const char *how = refresh (dwfl);
+  printf ("%s: %s, %+d modules, self %s\n", what, how,
+	  count_modules (dwfl) - count,
+	  dwfl_addrmodule (dwfl, (uintptr_t) addr) == self ? "kept" : "new");
+}
+
+/* Tell about the module at ADDR.  */
+static void
+print_module (Dwfl *dwfl, const char *what, void *addr)
+{
+  Dwfl_Module *mod = dwfl_addrmodule (dwfl, (uintptr_t) addr);
+  const char *name = mod == NULL ? NULL : dwfl_module_info (mod, NULL, NULL,
+							     NULL, NULL, NULL,
+							     NULL, NULL);
+  const char *base = name == NULL ? NULL : strrchr (name, '/');
+  printf ("%s: %s\n", what, base == NULL ? "none" : base + 1);
+}
+
+/* Usage: dwfl-proc-refresh FILE
+
+   Refresh the modules of this process, before and after mapping
+   anonymous memory, after mapping FILE and after unmapping it again.
+   Check that the module of this program is kept all along, and that
+   the modules are only reported again when a file was mapped or
+   unmapped.  */
+int
+main (int argc, char **argv)
+{
+  if (argc != 2)
+    error (EXIT_FAILURE, 0, "usage: dwfl-proc-refresh FILE");
+
+  Dwfl *dwfl = dwfl_begin (&callbacks);
+  assert (dwfl != NULL);
+
+  refresh (dwfl);
+  Dwfl_Module *self = dwfl_addrmodule (dwfl, (uintptr_t) &main);
+  if (self == NULL)
+    error (EXIT_FAILURE, 0, "no module for main");
+  if (dwfl_module_getsymtab (self) <= 0)
+    error (EXIT_FAILURE, 0, "no symbols for main");
+
+  /* Reading the symbols may have mapped files too.  */
+  refresh (dwfl);
+  int count = count_modules (dwfl);
+  if (dwfl_addrmodule (dwfl, (uintptr_t) &main) != self)
+    error (EXIT_FAILURE, 0, "module for main not kept");
+
+  print_refresh (dwfl, "again", count, self, &main);
+
+  /* Neither anonymous memory nor a bigger heap change the modules.  */
+  void *anon = mmap (NULL, 16 * 4096, PROT_READ | PROT_WRITE,
+		     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (anon == MAP_FAILED)
+    error (EXIT_FAILURE, errno, "mmap anonymous");
+  void *heap = sbrk (16 * 4096);
+  if (heap == (void *) -1)
+    error (EXIT_FAILURE, errno, "sbrk");
+  print_refresh (dwfl, "anonymous", count, self, &main);
+  munmap (anon, 16 * 4096);
+
+  int fd = open (argv[1], O_RDONLY);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "open %s", argv[1]);
+  void *map = mmap (NULL, 4096, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    error (EXIT_FAILURE, errno, "mmap %s", argv[1]);
+  close (fd);
+
+  print_refresh (dwfl, "mapped", count, self, &main);
+  print_module (dwfl, "mapping", map);
+
+  munmap (map, 4096);
+
+  print_refresh (dwfl, "unmapped", count, self, &main);
+  print_module (dwfl, "mapping", map);
+
+  dwfl_end (dwfl);
+  return 0;
+}
@@ -0,0 +1,124 @@
+/* Test program for dwfl_report_offline_files.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <error.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static const Dwfl_Callbacks callbacks =
+  {
+    .find_elf = dwfl_build_id_find_elf,
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .section_address = dwfl_offline_section_address,
+  };
+
+static int
+print_module (Dwfl_Module *mod, void **userdata __attribute__ ((unused)),
+	      const char *name, Dwarf_Addr low, void *arg)
+{
+  Dwarf_Addr high;
+  const char *file;
+  dwfl_module_info (mod, NULL, NULL, &high, NULL, NULL, &file, NULL);
+  const unsigned char *bits;
+  GElf_Addr vaddr;
+  int len = dwfl_module_build_id (mod, &bits, &vaddr);
+  fprintf (arg, "%s %#" PRIx64 "-%#" PRIx64 " %s build-id %d\n",
+	   name, low, high, file, len);
+  return DWARF_CB_OK;
+}
+
+/* Report the files, all at once with NTHREADS threads when it is not
+   negative, and write what was reported to OUT.  */
+static void
+report (FILE *out, int nthreads, size_t count, char **files)
+{
+  Dwfl *dwfl = dwfl_begin (&callbacks);
+  assert (dwfl != NULL);
+
+  const char *names[count];
+  for (size_t i = 0; i < count; ++i)
+    {
+      names[i] = strrchr (files[i], '/');
+      names[i] = names[i] == NULL ? files[i] : names[i] + 1;
+    }
+
+  Dwfl_Module *mods[count];
+  if (nthreads >= 0)
+    {
+      int n = dwfl_report_offline_files (dwfl, count, names,
+					 (const char *const *) files,
+					 nthreads, mods);
+      fprintf (out, "reported %d\n", n);
+    }
+  else
+    {
+      int n = 0;
+      for (size_t i = 0; i < count; ++i)
+	if ((mods[i] = dwfl_report_offline (dwfl, names[i], files[i],
+					    -1)) != NULL)
+	  ++n;
+      fprintf (out, "reported %d\n", n);
+    }
+  dwfl_report_end (dwfl, NULL, NULL);
+
+  for (size_t i = 0; i < count; ++i)
+    if (mods[i] == NULL)
+      fprintf (out, "%s: failed\n", names[i]);
+  dwfl_getmodules (dwfl, print_module, out, 0);
+
+  dwfl_end (dwfl);
+}
+
+/* Usage: dwfl-report-offline-files NTHREADS FILE...
+
+   Report the FILEs at once, and check that this gives the same as
+   reporting each with dwfl_report_offline.  */
+int
+main (int argc, char **argv)
+{
+  if (argc < 2)
+    error (EXIT_FAILURE, 0,
+	   "usage: dwfl-report-offline-files NTHREADS FILE...");
+
+  int nthreads = atoi (argv[1]);
+  size_t count = argc - 2;
+
+  char *batch;
+  size_t batchlen;
+  FILE *out = open_memstream (&batch, &batchlen);
+  report (out, nthreads, count, &argv[2]);
+  fclose (out);
+
+  char *single;
+  size_t singlelen;
+  out = open_memstream (&single, &singlelen);
+  report (out, -1, count, &argv[2]);
+  fclose (out);
+
+  fputs (batch, stdout);
+  if (strcmp (batch, single) != 0)
+    error (EXIT_FAILURE, 0, "dwfl_report_offline gives:\n%s", single);
+
+  free (batch);
+  free (single);
+  return 0;
+}
@@ -23,14 +23,33 @@
 #include <error.h>
 #include <fcntl.h>
 #include <gelf.h>
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 int
 main (int argc, char *argv[])
 {
+  /* With --copy the section data is copied with elf_newdata_copy,
+     with --mmap both files are accessed through mmap.  */
+  bool copy = false;
+  bool use_mmap = false;
+  while (argc > 1 && strncmp (argv[1], "--", 2) == 0)
+    {
+      if (strcmp (argv[1], "--copy") == 0)
+	copy = true;
+      else if (strcmp (argv[1], "--mmap") == 0)
+	use_mmap = true;
+      else
+	error (EXIT_FAILURE, 0, "unknown option '%s'", argv[1]);
+      ++argv;
+      --argc;
+    }
+
   if (argc < 3)
-    error (EXIT_FAILURE, 0, "usage: %s FROMNAME TONAME", argv[0]);
+    error (EXIT_FAILURE, 0, "usage: %s [--copy] [--mmap] FROMNAME TONAME",
+	   argv[0]);
 
   elf_version (EV_CURRENT);
 
@@ -38,16 +57,18 @@ main (int argc, char *argv[])
   if (infd == -1)
     error (EXIT_FAILURE, errno, "cannot open input file '%s'", argv[1]);
 
-  Elf *inelf = elf_begin (infd, ELF_C_READ, NULL);
+  Elf *inelf = elf_begin (infd, use_mmap ? ELF_C_READ_MMAP : ELF_C_READ,
+			  NULL);
   if (inelf == NULL)
     error (EXIT_FAILURE, 0, "problems opening '%s' as ELF file: %s",
 	   argv[1], elf_errmsg (-1));
 
-  int outfd = creat (argv[2], 0666);
+  int outfd = open (argv[2], O_RDWR | O_CREAT | O_TRUNC, 0666);
   if (outfd == -1)
     error (EXIT_FAILURE, errno, "cannot open output file '%s'", argv[2]);
 
-  Elf *outelf = elf_begin (outfd, ELF_C_WRITE, NULL);
+  Elf *outelf = elf_begin (outfd, use_mmap ? ELF_C_WRITE_MMAP : ELF_C_WRITE,
+			   NULL);
   if (outelf == NULL)
     error (EXIT_FAILURE, 0, "problems opening '%s' as ELF file: %s",
 	   argv[2], elf_errmsg (-1));
@@ -82,7 +103,14 @@ main (int argc, char *argv[])
       GElf_Shdr shdr_mem;
       gelf_update_shdr (newscn, gelf_getshdr (scn, &shdr_mem));
 
-      *elf_newdata (newscn) = *elf_getdata (scn, NULL);
+      if (copy)
+	{
+	  if (elf_newdata_copy (newscn, scn) == NULL)
+	    error (EXIT_FAILURE, 0, "cannot copy section data: %s",
+		   elf_errmsg (-1));
+	}
+      else
+	*elf_newdata (newscn) = *elf_getdata (scn, NULL);
     }
 
   elf_flagelf (outelf, ELF_C_SET, ELF_F_LAYOUT);
@@ -0,0 +1,243 @@
+/* Test and benchmark opening files with many sections.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+
+
+static const char shstrtab[] = "\0.shstrtab\0.scn";
+#define SHSTRTAB_NAME 1
+#define SCN_NAME 11
+
+
+/* Create an ELF file in FD with NSCNS sections besides the zeroth
+   section and the section header string table.  */
+static void
+create_file (int fd, size_t nscns)
+{
+  static char contents[4] = "scn";
+
+  Elf *elf = elf_begin (fd, ELF_C_WRITE, NULL);
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin: %s", elf_errmsg (-1));
+
+  GElf_Ehdr ehdr_mem;
+  GElf_Ehdr *ehdr;
+  if (gelf_newehdr (elf, ELFCLASS64) == 0
+      || (ehdr = gelf_getehdr (elf, &ehdr_mem)) == NULL)
+    error (EXIT_FAILURE, 0, "gelf_newehdr: %s", elf_errmsg (-1));
+  ehdr->e_ident[EI_DATA] = ELFDATA2LSB;
+  ehdr->e_type = ET_REL;
+  ehdr->e_machine = EM_X86_64;
+  ehdr->e_version = EV_CURRENT;
+  ehdr->e_shstrndx = 1;
+  if (gelf_update_ehdr (elf, ehdr) == 0)
+    error (EXIT_FAILURE, 0, "gelf_update_ehdr: %s", elf_errmsg (-1));
+
+  for (size_t cnt = 0; cnt <= nscns; ++cnt)
+    {
+      Elf_Scn *scn = elf_newscn (elf);
+      if (scn == NULL)
+	error (EXIT_FAILURE, 0, "elf_newscn: %s", elf_errmsg (-1));
+
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	error (EXIT_FAILURE, 0, "gelf_getshdr: %s", elf_errmsg (-1));
+
+      Elf_Data *data = elf_newdata (scn);
+      if (data == NULL)
+	error (EXIT_FAILURE, 0, "elf_newdata: %s", elf_errmsg (-1));
+      data->d_type = ELF_T_BYTE;
+      data->d_align = 1;
+      if (cnt == 0)
+	{
+	  shdr->sh_type = SHT_STRTAB;
+	  shdr->sh_name = SHSTRTAB_NAME;
+	  data->d_buf = (char *) shstrtab;
+	  data->d_size = sizeof shstrtab;
+	}
+      else
+	{
+	  shdr->sh_type = SHT_PROGBITS;
+	  shdr->sh_name = SCN_NAME;
+	  data->d_buf = contents;
+	  data->d_size = sizeof contents;
+	}
+      shdr->sh_addralign = 1;
+      if (gelf_update_shdr (scn, shdr) == 0)
+	error (EXIT_FAILURE, 0, "gelf_update_shdr: %s", elf_errmsg (-1));
+    }
+
+  if (elf_update (elf, ELF_C_WRITE) < 0)
+    error (EXIT_FAILURE, 0, "elf_update: %s", elf_errmsg (-1));
+
+  elf_end (elf);
+}
+
+
+/* Check that all sections can be found, also when looked up in
+   different orders.  */
+static void
+check_file (int fd, Elf_Cmd cmd, size_t nscns)
+{
+  Elf *elf = elf_begin (fd, cmd, NULL);
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin: %s", elf_errmsg (-1));
+
+  size_t shnum;
+  if (elf_getshdrnum (elf, &shnum) != 0)
+    error (EXIT_FAILURE, 0, "elf_getshdrnum: %s", elf_errmsg (-1));
+  if (shnum != nscns + 2)
+    error (EXIT_FAILURE, 0, "%zd sections, expected %zd", shnum, nscns + 2);
+
+  /* Look at the last section first, before anything else is set up.  */
+  Elf_Scn *scn = elf_getscn (elf, shnum - 1);
+  if (scn == NULL || elf_ndxscn (scn) != shnum - 1)
+    error (EXIT_FAILURE, 0, "elf_getscn last: %s", elf_errmsg (-1));
+  if (elf_nextscn (elf, scn) != NULL)
+    error (EXIT_FAILURE, 0, "section after the last one");
+
+  const char *name = elf_strptr (elf, 1, SCN_NAME);
+  if (name == NULL || strcmp (name, ".scn") != 0)
+    error (EXIT_FAILURE, 0, "elf_strptr: %s", elf_errmsg (-1));
+
+  size_t cnt = 0;
+  scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      if (elf_ndxscn (scn) != ++cnt)
+	error (EXIT_FAILURE, 0, "section %zd has index %zd",
+	       cnt, elf_ndxscn (scn));
+      if (elf_getscn (elf, cnt) != scn)
+	error (EXIT_FAILURE, 0, "elf_getscn %zd differs", cnt);
+
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	error (EXIT_FAILURE, 0, "gelf_getshdr %zd: %s", cnt, elf_errmsg (-1));
+      if (cnt > 1)
+	{
+	  Elf_Data *data = elf_getdata (scn, NULL);
+	  if (data == NULL || data->d_size != 4
+	      || memcmp (data->d_buf, "scn", 4) != 0)
+	    error (EXIT_FAILURE, 0, "elf_getdata %zd: %s",
+		   cnt, elf_errmsg (-1));
+	}
+    }
+  if (cnt != shnum - 1)
+    error (EXIT_FAILURE, 0, "elf_nextscn found %zd sections", cnt);
+
+  /* All sections but the section header string table have the same
+     name.  */
+  cnt = 0;
+  scn = NULL;
+  while ((scn = elf_nextscnbyname (elf, scn, ".scn")) != NULL)
+    if (elf_ndxscn (scn) != ++cnt + 1)
+      error (EXIT_FAILURE, 0, "section %zd named .scn has index %zd",
+	     cnt, elf_ndxscn (scn));
+  if (cnt != nscns)
+    error (EXIT_FAILURE, 0, "elf_nextscnbyname found %zd sections", cnt);
+  if (elf_getscnbyname (elf, ".shstrtab") != elf_getscn (elf, 1))
+    error (EXIT_FAILURE, 0, "elf_getscnbyname .shstrtab");
+
+  elf_end (elf);
+
+  /* Layout computation needs all sections, without looking at any
+     first.  */
+  elf = elf_begin (fd, cmd, NULL);
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin: %s", elf_errmsg (-1));
+  if (elf_update (elf, ELF_C_NULL) < 0)
+    error (EXIT_FAILURE, 0, "elf_update: %s", elf_errmsg (-1));
+  if (elf_newscn (elf) == NULL)
+    error (EXIT_FAILURE, 0, "elf_newscn: %s", elf_errmsg (-1));
+  if (elf_getshdrnum (elf, &shnum) != 0 || shnum != nscns + 3)
+    error (EXIT_FAILURE, 0, "elf_getshdrnum after elf_newscn");
+  elf_end (elf);
+}
+
+
+/* Open and close the file ITERATIONS times, returning the time per
+   iteration in microseconds.  */
+static double
+time_open (int fd, Elf_Cmd cmd, unsigned int iterations)
+{
+  struct timespec start;
+  struct timespec end;
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (unsigned int i = 0; i < iterations; ++i)
+    {
+      Elf *elf = elf_begin (fd, cmd, NULL);
+      if (elf == NULL)
+	error (EXIT_FAILURE, 0, "elf_begin: %s", elf_errmsg (-1));
+      elf_end (elf);
+    }
+  clock_gettime (CLOCK_MONOTONIC, &end);
+
+  return ((end.tv_sec - start.tv_sec) * 1e6
+	  + (end.tv_nsec - start.tv_nsec) / 1e3) / iterations;
+}
+
+
+/* Without arguments this only checks a file with 20000 sections.
+   Given the number of sections and iterations, it also reports how long
+   opening and closing the file takes.  */
+int
+main (int argc, char *argv[])
+{
+  size_t nscns = argc > 1 ? strtoul (argv[1], NULL, 0) : 20000;
+  unsigned int iterations = argc > 2 ? strtoul (argv[2], NULL, 0) : 0;
+
+  elf_version (EV_CURRENT);
+
+  char name[] = "manyscns.XXXXXX";
+  int fd = mkstemp (name);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "mkstemp");
+  unlink (name);
+
+  create_file (fd, nscns);
+
+  check_file (fd, ELF_C_READ_MMAP, nscns);
+  check_file (fd, ELF_C_READ, nscns);
+
+  if (iterations > 0)
+    {
+      printf ("%zd sections, %u iterations\n", nscns + 2, iterations);
+      printf ("ELF_C_READ_MMAP: %.1f us per open/close\n",
+	      time_open (fd, ELF_C_READ_MMAP, iterations));
+      printf ("ELF_C_READ:      %.1f us per open/close\n",
+	      time_open (fd, ELF_C_READ, iterations));
+    }
+
+  close (fd);
+
+  return 0;
+}
@@ -0,0 +1,177 @@
+/* Test and benchmark finding runs of printable characters.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <ctype.h>
+#include <error.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "printable.h"
+
+
+/* The classification eu-strings used before, byte by byte.  */
+static bool
+ref_printable (unsigned char c, bool seven_bit)
+{
+  return (isprint (c) || c == '\t') && (! seven_bit || c <= 127);
+}
+
+
+static size_t
+ref_run (const unsigned char *buf, size_t len, bool printable,
+	 bool seven_bit)
+{
+  size_t n = 0;
+  while (n < len && ref_printable (buf[n], seven_bit) == printable)
+    ++n;
+  return n;
+}
+
+
+/* Fill BUF with text, with a nonprintable byte about every RARITY
+   bytes.  */
+static void
+fill (unsigned char *buf, size_t len, unsigned int rarity)
+{
+  for (size_t i = 0; i < len; ++i)
+    if (rand () % rarity == 0)
+      buf[i] = rand ();
+    else
+      buf[i] = ' ' + rand () % 95;
+}
+
+
+static void
+check (const struct printable_class *cls, bool seven_bit)
+{
+  unsigned char buf[600];
+
+  for (unsigned int rarity = 1; rarity < 500; rarity += 37)
+    {
+      fill (buf, sizeof buf, rarity);
+      for (size_t start = 0; start < 70; ++start)
+	for (size_t len = 0; start + len <= sizeof buf; len += 7)
+	  {
+	    size_t expect = ref_run (buf + start, len, true, seven_bit);
+	    size_t got = printable_run (cls, buf + start, len);
+	    if (got != expect)
+	      error (EXIT_FAILURE, 0, "start %zd len %zd: %zd, expected %zd",
+		     start, len, got, expect);
+
+	    expect = ref_run (buf + start, len, false, seven_bit);
+	    got = nonprintable_run (cls, buf + start, len);
+	    if (got != expect)
+	      error (EXIT_FAILURE, 0,
+		     "not printable start %zd len %zd: %zd, expected %zd",
+		     start, len, got, expect);
+	  }
+    }
+}
+
+
+/* Scan LEN bytes in BUF ITERATIONS times, returning the throughput in
+   MB per second.  With REF byte by byte.  */
+static double
+time_scan (const struct printable_class *cls, const unsigned char *buf,
+	   size_t len, bool ref, unsigned int iterations, size_t *nrunsp)
+{
+  struct timespec start;
+  struct timespec end;
+  size_t nruns = 0;
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (unsigned int i = 0; i < iterations; ++i)
+    for (size_t n = 0; n < len; ++n)
+      {
+	size_t r = (ref ? ref_run (buf + n, len - n, true, false)
+		    : printable_run (cls, buf + n, len - n));
+	nruns += r > 0;
+	n += r;
+      }
+  clock_gettime (CLOCK_MONOTONIC, &end);
+
+  *nrunsp = nruns;
+  return ((double) len * iterations / 1e6
+	  / ((end.tv_sec - start.tv_sec)
+	     + (end.tv_nsec - start.tv_nsec) / 1e9));
+}
+
+
+/* Without arguments this only checks the results against classifying
+   byte by byte.  Given a buffer size in MB and a number of iterations,
+   it also reports the throughput of both.  */
+int
+main (int argc, char *argv[])
+{
+  size_t size = argc > 1 ? strtoul (argv[1], NULL, 0) << 20 : 0;
+  unsigned int iterations = argc > 2 ? strtoul (argv[2], NULL, 0) : 1;
+
+  struct printable_class cls;
+  printable_class_init (&cls, false);
+  check (&cls, false);
+  printable_class_init (&cls, true);
+  check (&cls, true);
+
+  /* Also without the vector instructions, and with printable bytes
+     from 128 on.  */
+  printable_class_init (&cls, false);
+  cls.ascii = false;
+  check (&cls, false);
+
+  printable_class_init (&cls, false);
+  for (unsigned int c = 0xa0; c < 0x100; ++c)
+    cls.byte[c] = true;
+  cls.high = true;
+  struct printable_class latin1 = cls;
+  srand (1);
+  unsigned char buf[300];
+  fill (buf, sizeof buf, 3);
+  for (size_t start = 0; start < 100; ++start)
+    {
+      size_t expect = 0;
+      while (start + expect < sizeof buf
+	     && (isprint (buf[start + expect]) || buf[start + expect] == '\t'
+		 || buf[start + expect] >= 0xa0))
+	++expect;
+      if (printable_run (&latin1, buf + start, sizeof buf - start) != expect)
+	error (EXIT_FAILURE, 0, "high bytes at %zd", start);
+    }
+
+  if (size > 0)
+    {
+      unsigned char *big = malloc (size);
+      if (big == NULL)
+	error (EXIT_FAILURE, 0, "cannot allocate %zd bytes", size);
+      printable_class_init (&cls, false);
+      fill (big, size, 200);
+      size_t nref;
+      size_t nruns;
+      double ref = time_scan (&cls, big, size, true, iterations, &nref);
+      double fast = time_scan (&cls, big, size, false, iterations, &nruns);
+      if (nruns != nref)
+	error (EXIT_FAILURE, 0, "%zd runs, expected %zd", nruns, nref);
+      printf ("%.0f MB/s byte by byte, %.0f MB/s\n", ref, fast);
+      free (big);
+    }
+
+  return 0;
+}
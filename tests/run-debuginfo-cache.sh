@@ -0,0 +1,79 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+# Lookups in several Dwfl sessions share a cache of missing files.  It
+# must notice when the debuginfo file appears or goes away, and files
+# can be added to it by build ID from a manifest.
+testfiles testfile-inlines testfile14
+
+tempfiles debuginfo-cache.manifest debuginfo-cache.out
+
+abs_test_bindir=$(pwd)/bindir
+abs_test_debugdir=$(pwd)/debugdir
+
+mkdir ${abs_test_bindir}
+mkdir ${abs_test_bindir}/bin
+mkdir ${abs_test_debugdir}
+mkdir ${abs_test_debugdir}/bin
+
+testrun ${abs_top_builddir}/src/strip -f $(pwd)/testfile-inlines.debug \
+	-o ${abs_test_bindir}/bin/testfile-inlines testfile-inlines
+
+# Directories changed just now are not trusted to tell a file is
+# missing, make them look older.
+touch -d '2001-01-01 00:00' ${abs_test_debugdir} ${abs_test_debugdir}/bin
+
+testrun_compare ${abs_builddir}/debuginfo-cache \
+	${abs_test_bindir}/bin/testfile-inlines ${abs_test_debugdir} \
+	${abs_test_debugdir}/bin/testfile-inlines.debug \
+	$(pwd)/testfile-inlines.debug debuginfo-cache.manifest <<\EOF
+stashed: not found
+stashed again: not found
+added: found in path
+build ID: found in path
+other path: not found
+removed: not found
+removed again: not found
+seeded 1
+seeded: found in manifest
+flushed: not found
+EOF
+
+# testfile14 has no build ID, its debuginfo file is checked by CRC.
+testrun ${abs_top_builddir}/src/strip \
+	-f ${abs_test_debugdir}/bin/testfile14.debug \
+	-o ${abs_test_bindir}/bin/testfile14 testfile14
+
+testrun_compare ${abs_builddir}/debuginfo-cache --crc \
+	${abs_test_bindir}/bin/testfile14 ${abs_test_debugdir} \
+	${abs_test_debugdir}/bin/testfile14.debug <<\EOF
+debuglink: found in path
+debuglink again: found in path
+changed: not found
+EOF
+
+# Cleanup
+rm testfile-inlines.debug
+rm ${abs_test_bindir}/bin/testfile-inlines
+rm ${abs_test_bindir}/bin/testfile14
+rm ${abs_test_debugdir}/bin/testfile14.debug
+rmdir ${abs_test_bindir}/bin
+rmdir ${abs_test_bindir}
+rmdir ${abs_test_debugdir}/bin
+rmdir ${abs_test_debugdir}
+
+exit 0
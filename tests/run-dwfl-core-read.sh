@@ -0,0 +1,44 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# The modules found in the core files are the same whether the core
+# file is mmap'd or only its pages that are looked at.
+testfiles test-core.core linkmap-cut.core backtrace.x86_64.core
+
+testrun_compare ${abs_builddir}/dwfl-core-read test-core.core <<\EOF
+reported 2
+0x7f67f2caf000-0x7f67f2eb1000 /home/jkratoch/redhat/elfutils-libregr/test-core-lib.so symbols -1
+0x7fff1596c000-0x7fff1596d000 linux-vdso.so.1 symbols 11
+EOF
+
+testrun_compare ${abs_builddir}/dwfl-core-read linkmap-cut.core <<\EOF
+reported 5
+0x400000-0x602000 .////////////////////////////////////linkmap-cut no ELF
+0x3fdf400000-0x3fdf622000 /usr/lib64/ld-2.18.so no ELF
+0x3fdf800000-0x3fdfbbe000 /usr/lib64/libc-2.18.so no ELF
+0x7f08bc24d000-0x7f08bc44f000 .////////////////////////////////////linkmap-cut-lib.so no ELF
+0x7fffa1928000-0x7fffa1929000 linux-vdso.so.1 symbols 11
+EOF
+
+testrun_compare ${abs_builddir}/dwfl-core-read backtrace.x86_64.core <<\EOF
+reported 2
+0x400000-0x6e0000 /home/jkratoch/redhat/elfutils/tests/backtrace.x86_64.exec no ELF
+0x7fff1bdcc000-0x7fff1bdce000 linux-vdso.so.1 symbols 11
+EOF
+
+exit 0
@@ -0,0 +1,63 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+type gzip > /dev/null 2>&1 || exit 77
+type xz > /dev/null 2>&1 || exit 77
+
+testfiles hello_x86_64.ko hello_i386.ko
+
+gzip -c hello_x86_64.ko > hello.ko.gz
+xz -c hello_x86_64.ko > hello.ko.xz
+tempfiles hello.ko.gz hello.ko.xz
+
+cache=${PWD}/decompress-cache
+rm -rf $cache
+mkdir $cache
+
+# Decompressed once, then used from the cache.
+for i in 1 2; do
+testrun_compare ${abs_builddir}/dwfl-decompress-cache $cache \
+	hello.ko.gz hello.ko.xz <<\EOF
+hello.ko.gz 0x10000-0x10388 symbols 30
+hello.ko.xz 0x10000-0x10388 symbols 30
+EOF
+test $(ls $cache | wc -l) -eq 2 || { ls -l $cache; exit 1; }
+done
+
+# What is in the cache is what is used.
+for f in $cache/*; do
+  cp hello_i386.ko $f
+done
+testrun_compare ${abs_builddir}/dwfl-decompress-cache $cache \
+	hello.ko.gz hello.ko.xz <<\EOF
+hello.ko.gz 0x10000-0x1026c symbols 28
+hello.ko.xz 0x10000-0x1026c symbols 28
+EOF
+
+# A file that changes is decompressed again.
+touch -d '2001-01-01 00:00' hello.ko.gz hello.ko.xz
+testrun_compare ${abs_builddir}/dwfl-decompress-cache $cache \
+	hello.ko.gz hello.ko.xz <<\EOF
+hello.ko.gz 0x10000-0x10388 symbols 30
+hello.ko.xz 0x10000-0x10388 symbols 30
+EOF
+test $(ls $cache | wc -l) -eq 4 || { ls -l $cache; exit 1; }
+
+rm -rf $cache
+
+exit 0
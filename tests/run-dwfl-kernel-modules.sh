@@ -0,0 +1,59 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# A module tree, the files need not be ELF files.  Modules under
+# "source" are ignored.
+kdir=${PWD}/kernel-modules
+rm -rf $kdir
+mkdir -p $kdir/kernel/fs $kdir/kernel/net $kdir/extra $kdir/source
+touch $kdir/vmlinux $kdir/kernel/fs/ext-4.ko $kdir/kernel/net/ip,v6.ko.gz \
+      $kdir/extra/zz_top.ko $kdir/extra/README $kdir/source/src.ko
+
+# Directories changed just now are searched again each time, make them
+# look older.
+find $kdir -type d | xargs touch -d '2001-01-01 00:00'
+
+# Without modules.dep the tree is searched, again when a module is added
+# to any directory.  Then only what modules.dep lists counts, also when
+# it changes.
+testrun_compare ${abs_builddir}/dwfl-kernel-modules $kdir \
+	"+kernel/fs/btrfs.ko" \
+	"kernel/net/ip,v6.ko.gz:" \
+	"extra/zz_top.ko: kernel/net/ip,v6.ko.gz" <<\EOF
+kernel vmlinux
+zz_top extra/zz_top.ko
+ext_4 kernel/fs/ext-4.ko
+ip_v6 kernel/net/ip,v6.ko.gz
+--- +kernel/fs/btrfs.ko
+kernel vmlinux
+zz_top extra/zz_top.ko
+btrfs kernel/fs/btrfs.ko
+ext_4 kernel/fs/ext-4.ko
+ip_v6 kernel/net/ip,v6.ko.gz
+--- kernel/net/ip,v6.ko.gz:
+kernel vmlinux
+ip_v6 kernel/net/ip,v6.ko.gz
+--- extra/zz_top.ko: kernel/net/ip,v6.ko.gz
+kernel vmlinux
+ip_v6 kernel/net/ip,v6.ko.gz
+zz_top extra/zz_top.ko
+EOF
+
+rm -rf $kdir
+
+exit 0
@@ -0,0 +1,60 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# The debug sections are only relocated once they are read.  All that
+# are left are relocated when dwarf_getelf gives out the ELF file, the
+# rest when dwfl_module_getelf relocates everything.
+testfiles hello_x86_64.ko testfile23
+
+testrun_compare ${abs_builddir}/dwfl-lazy-reloc hello_x86_64.ko <<\EOF
+/home/mark/src/tests/hmodule/init.c lowpc 0x10024
+line 5 0x10024
+line 5 0x1002d
+line 6 0x1002d
+line 8 0x1003b
+line 8 0x1003f
+getelf dwarf: .rela.text .rela__mcount_loc .rela.gnu.linkonce.this_module
+getelf: .rela.text
+EOF
+
+# Big endian, libdw reads a converted copy of the sections.
+testrun_compare ${abs_builddir}/dwfl-lazy-reloc testfile23 <<\EOF
+line 5 0x10000
+line 6 0x1000c
+line 7 0x10010
+line 7 0x1002c
+line 1 0x1002c
+line 2 0x10038
+line 3 0x1003c
+line 3 0x10058
+getelf dwarf: .rela.opd
+getelf: .rela.opd
+EOF
+
+# A section that cannot be relocated is an error when it is read.
+tempfiles hello-badreloc.ko
+cp hello_x86_64.ko hello-badreloc.ko
+testrun_compare ${abs_builddir}/dwfl-lazy-reloc --break .rela.debug_line \
+	hello-badreloc.ko <<\EOF
+/home/mark/src/tests/hmodule/init.c lowpc 0x10024
+dwarf_getsrclines: cannot relocate DWARF
+getelf dwarf: .rela.text .rela__mcount_loc .rela.gnu.linkonce.this_module .rela.debug_line
+getelf: .rela.text .rela.debug_line
+EOF
+
+exit 0
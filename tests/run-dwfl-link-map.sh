@@ -0,0 +1,46 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# The link_map list has each entry on a page of its own, after the
+# unaligned name of the one before it, so reading it goes through more
+# blocks than are cached.  The last name runs over into the next page.
+# A library listed twice at the same address overlaps itself and is
+# dropped.
+testfiles test-core-lib.so linkmap-cut-lib.so testfile52-64.so
+testfiles testfile54-64.so libtestfile_multi_shared.so testfile69.so
+testfiles testfile-dwfl-report-elf-align-shlib.so testlib_dynseg.so
+testfiles testfile52-64.prelink.so
+tempfiles linkmap.core
+
+testrun_compare ${abs_builddir}/dwfl-link-map linkmap.core \
+  test-core-lib.so linkmap-cut-lib.so testfile52-64.so testfile54-64.so \
+  libtestfile_multi_shared.so testfile69.so testfile54-64.so \
+  testfile-dwfl-report-elf-align-shlib.so testlib_dynseg.so \
+  testfile52-64.prelink.so <<\EOF
+reported 9
+0x3010000000 testfile52-64.prelink.so
+0x20000000 testlib_dynseg.so
+0x30000000 testfile-dwfl-report-elf-align-shlib.so
+0x50000000 testfile69.so
+0x60000000 libtestfile_multi_shared.so
+0x80000000 testfile52-64.so
+0x90000000 linkmap-cut-lib.so
+0xa0000000 test-core-lib.so
+EOF
+
+exit 0
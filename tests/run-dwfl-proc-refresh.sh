@@ -0,0 +1,35 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+test -r /proc/self/maps || exit 77
+
+# Refreshing keeps the modules that are still mapped, adds the new
+# mapping and drops it again once it is unmapped.  The modules are not
+# reported again for anonymous memory.
+testfiles testfile
+
+testrun_compare ${abs_builddir}/dwfl-proc-refresh testfile <<\EOF
+again: unchanged, +0 modules, self kept
+anonymous: unchanged, +0 modules, self kept
+mapped: reported, +1 modules, self kept
+mapping: testfile
+unmapped: reported, +0 modules, self kept
+mapping: none
+EOF
+
+exit 0
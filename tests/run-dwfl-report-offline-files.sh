@@ -0,0 +1,37 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# The files are laid out in the order given, whichever thread opened
+# them, and the same as reported one by one.
+testfiles testfile hello_x86_64.ko hello_i386.ko testfile23 hello_ppc64.ko
+
+for nthreads in 1 3 0; do
+testrun_compare ${abs_builddir}/dwfl-report-offline-files $nthreads \
+	testfile hello_x86_64.ko nonexistent hello_i386.ko testfile23 \
+	hello_ppc64.ko <<\EOF
+reported 5
+nonexistent: failed
+testfile 0x8048000-0x80495e4 testfile build-id 0
+hello_x86_64.ko 0x10000-0x10388 hello_x86_64.ko build-id 20
+hello_i386.ko 0x20400-0x2066c hello_i386.ko build-id 20
+testfile23 0x30700-0x30778 testfile23 build-id 0
+hello_ppc64.ko 0x40800-0x40c38 hello_ppc64.ko build-id 20
+EOF
+done
+
+exit 0
@@ -0,0 +1,32 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Section data copied with elf_newdata_copy must come out the same as
+# data copied through memory, both for write and mmap output.
+testfiles testfile10 testfile2
+tempfiles testfile.tmp testfile.copy.tmp
+
+for file in testfile10 testfile2; do
+  testrun ${abs_builddir}/ecp $file testfile.tmp
+  testrun ${abs_builddir}/ecp --copy $file testfile.copy.tmp
+  cmp testfile.tmp testfile.copy.tmp
+  testrun ${abs_builddir}/ecp --copy --mmap $file testfile.copy.tmp
+  cmp testfile.tmp testfile.copy.tmp
+done
+
+exit 0
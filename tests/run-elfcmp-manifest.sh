@@ -0,0 +1,57 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+# A manifest written for a file describes it like the file itself.
+testfiles testfile testfile3
+tempfiles testfile.manifest testfile.manifest2
+
+testrun ${abs_top_builddir}/src/elfcmp --write-manifest=testfile.manifest \
+	testfile
+testrun ${abs_top_builddir}/src/elfcmp --manifest=testfile.manifest testfile
+testrun ${abs_top_builddir}/src/elfcmp --jobs=3 \
+	--manifest=testfile.manifest testfile
+
+# Writing a manifest while comparing two files gives the same one.
+testrun ${abs_top_builddir}/src/elfcmp --write-manifest=testfile.manifest2 \
+	testfile testfile
+cmp testfile.manifest testfile.manifest2
+
+# testfile3 has other headers and content.
+if testrun ${abs_top_builddir}/src/elfcmp -q --manifest=testfile.manifest \
+	testfile3; then
+  exit 1
+fi
+if testrun ${abs_top_builddir}/src/elfcmp -q -l --manifest=testfile.manifest \
+	testfile3; then
+  exit 1
+fi
+
+# The content of a section is hashed as it is in the file, also in a file
+# in the other byte order.  The .hash section of this big endian file
+# has 64-bit entries.
+testfiles testfile-s390x-hash-both
+tempfiles testfile-s390x-hash-both.manifest
+
+testrun ${abs_top_builddir}/src/elfcmp \
+	--write-manifest=testfile-s390x-hash-both.manifest \
+	testfile-s390x-hash-both
+grep -q '^scn 4 5 2 80000290 290 58 6 0 8 8 4f5e5afff2b045d4d8acb3006dba836e32088383 - \.hash$' \
+	testfile-s390x-hash-both.manifest
+test "$(dd if=testfile-s390x-hash-both bs=1 skip=656 count=88 2> /dev/null \
+	| sha1sum)" = "4f5e5afff2b045d4d8acb3006dba836e32088383  -"
+
+exit 0
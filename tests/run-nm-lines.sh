@@ -0,0 +1,129 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+# The SysV format looks up the line of each symbol in the CU it belongs
+# to.  Functions are found through .debug_aranges, objects in the local
+# names of all CUs.
+testfiles testfilefoobarbaz
+
+testrun_compare ${abs_top_builddir}/src/nm -f sysv --defined-only testfilefoobarbaz <<\EOF
+
+
+Symbols from testfilefoobarbaz:
+
+Name                                   Value    Class  Type     Size         Line Section
+
+                                      |00000000|LOCAL |FILE    |00000000|        |ABS
+_DYNAMIC                              |08049f14|LOCAL |OBJECT  |00000000|        |.dynamic
+_GLOBAL_OFFSET_TABLE_                 |0804a000|LOCAL |OBJECT  |00000000|        |.got.plt
+_IO_stdin_used                        |0804854c|GLOBAL|OBJECT  |00000004|        |.rodata
+__FRAME_END__                         |080486b0|LOCAL |OBJECT  |00000000|        |.eh_frame
+__JCR_END__                           |08049f10|LOCAL |OBJECT  |00000000|        |.jcr
+__JCR_LIST__                          |08049f10|LOCAL |OBJECT  |00000000|        |.jcr
+__TMC_END__                           |0804a018|GLOBAL|OBJECT  |00000000|        |.data
+__bss_start                           |0804a018|GLOBAL|NOTYPE  |00000000|        |.bss
+__data_start                          |0804a014|GLOBAL|NOTYPE  |00000000|        |.data
+__do_global_dtors_aux                 |080483f0|LOCAL |FUNC    |00000000|        |.text
+__do_global_dtors_aux_fini_array_entry|08049f0c|LOCAL |OBJECT  |00000000|        |.fini_array
+__dso_handle                          |08048550|GLOBAL|OBJECT  |00000000|        |.rodata
+__frame_dummy_init_array_entry        |08049f00|LOCAL |OBJECT  |00000000|        |.init_array
+__init_array_end                      |08049f0c|LOCAL |NOTYPE  |00000000|        |.init_array
+__init_array_start                    |08049f00|LOCAL |NOTYPE  |00000000|        |.init_array
+__libc_csu_fini                       |08048530|GLOBAL|FUNC    |00000002|        |.text
+__libc_csu_init                       |080484c0|GLOBAL|FUNC    |00000061|        |.text
+__x86.get_pc_thunk.bx                 |08048370|GLOBAL|FUNC    |00000004|        |.text
+_edata                                |0804a018|GLOBAL|NOTYPE  |00000000|        |.data
+_end                                  |0804a024|GLOBAL|NOTYPE  |00000000|        |.bss
+_fini                                 |08048534|GLOBAL|FUNC    |00000000|        |.fini
+_fp_hw                                |08048548|GLOBAL|OBJECT  |00000004|        |.rodata
+_init                                 |08048294|GLOBAL|FUNC    |00000000|        |.init
+_start                                |0804834c|GLOBAL|FUNC    |00000000|        |.text
+bar                                   |08048440|GLOBAL|FUNC    |00000012|bar.c:18|.text
+bar.c                                 |00000000|LOCAL |FILE    |00000000|        |ABS
+baz                                   |08048460|GLOBAL|FUNC    |0000005c|baz.c:18|.text
+baz.c                                 |00000000|LOCAL |FILE    |00000000|        |ABS
+bi                                    |0804a01c|LOCAL |OBJECT  |00000004| bar.c:3|.bss
+bj                                    |0804a020|LOCAL |OBJECT  |00000004| baz.c:3|.bss
+completed.5757                        |0804a018|LOCAL |OBJECT  |00000001|        |.bss
+crtstuff.c                            |00000000|LOCAL |FILE    |00000000|        |ABS
+crtstuff.c                            |00000000|LOCAL |FILE    |00000000|        |ABS
+data_start                            |0804a014|WEAK  |NOTYPE  |00000000|        |.data
+deregister_tm_clones                  |08048380|LOCAL |FUNC    |00000000|        |.text
+foo.c                                 |00000000|LOCAL |FILE    |00000000|        |ABS
+frame_dummy                           |08048410|LOCAL |FUNC    |00000000|        |.text
+main                                  |080482f0|GLOBAL|FUNC    |00000034|foo.c:15|.text
+nobar                                 |08048330|GLOBAL|FUNC    |0000000b|bar.c:12|.text
+nobaz                                 |08048340|GLOBAL|FUNC    |0000000b|baz.c:12|.text
+register_tm_clones                    |080483b0|LOCAL |FUNC    |00000000|        |.text
+EOF
+
+# Not every CU need be covered by .debug_aranges.  Functions which are
+# not are found in the names of all CUs.
+#
+# foo.c:
+# int Bar (void);
+#
+# static int
+# foo (void)
+# {
+#   return 1;
+# }
+#
+# void
+# _start (void)
+# {
+#   foo ();
+#   Bar ();
+#   for (;;);
+# }
+#
+# bar.c:
+# static int
+# Nobar (void)
+# {
+#   return 2;
+# }
+#
+# int
+# Bar (void)
+# {
+#   return Nobar ();
+# }
+#
+# gcc -g -O0 -gdwarf-4 -c foo.c bar.c
+# objcopy --remove-section .debug_aranges bar.o
+# gcc -g -nostdlib -static -Wl,--build-id=none \
+#   -o testfile-nm-aranges foo.o bar.o
+# objcopy --strip-symbol=foo.c --strip-symbol=bar.c testfile-nm-aranges
+testfiles testfile-nm-aranges
+
+testrun_compare ${abs_top_builddir}/src/nm -f sysv --defined-only testfile-nm-aranges <<\EOF
+
+
+Symbols from testfile-nm-aranges:
+
+Name        Value            Class  Type     Size                 Line Section
+
+Nobar      |000000000040101b|LOCAL |FUNC    |000000000000000b| bar.c:2|.text
+__bss_start|0000000000403000|GLOBAL|NOTYPE  |0000000000000000|        |.eh_frame
+_edata     |0000000000403000|GLOBAL|NOTYPE  |0000000000000000|        |.eh_frame
+_end       |0000000000403000|GLOBAL|NOTYPE  |0000000000000000|        |.eh_frame
+_start     |000000000040100b|GLOBAL|FUNC    |0000000000000010|foo.c:10|.text
+foo        |0000000000401000|LOCAL |FUNC    |000000000000000b| foo.c:4|.text
+EOF
+
+exit 0
@@ -34,3 +34,16 @@ for what_arg in --debug-syms --defined-only --dynamic --extern-only; do
     done
   done
 done
+
+# Without sorting the symbols are printed a batch at a time.  All of
+# them must be there, also for files with many symbols.
+tempfiles nosort.out sorted.out
+for format_arg in --format=bsd --format=posix; do
+  for self_file in $ET_EXEC ${abs_top_builddir}/libdw/libdw.so; do
+    testrun ${abs_top_builddir}/src/nm $format_arg -C --no-sort $self_file \
+      | sort > nosort.out
+    testrun ${abs_top_builddir}/src/nm $format_arg --jobs=3 -C $self_file \
+      | sort > sorted.out
+    cmp nosort.out sorted.out
+  done
+done
@@ -0,0 +1,43 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Printing the units in several processes must give the same output
+# as printing them one after the other.
+testfiles testfile testfile-debug-types testfile-zgabi32 testfile36.debug
+tempfiles readelf.serial.out readelf.serial.err
+tempfiles readelf.jobs.out readelf.jobs.err
+
+for file in testfile testfile-debug-types testfile-zgabi32 testfile36.debug; do
+  testrun ${abs_top_builddir}/src/readelf -w $file \
+    > readelf.serial.out 2> readelf.serial.err
+  for jobs in 2 3 8; do
+    testrun ${abs_top_builddir}/src/readelf -w --jobs=$jobs $file \
+      > readelf.jobs.out 2> readelf.jobs.err
+    cmp readelf.serial.out readelf.jobs.out || exit 1
+    cmp readelf.serial.err readelf.jobs.err || exit 1
+  done
+done
+
+# Only the list pointers noticed in .debug_info are needed here.
+testrun ${abs_top_builddir}/src/readelf --debug-dump=loc testfile-debug-types \
+  > readelf.serial.out
+testrun ${abs_top_builddir}/src/readelf --debug-dump=loc --jobs=2 \
+  testfile-debug-types > readelf.jobs.out
+cmp readelf.serial.out readelf.jobs.out || exit 1
+
+exit 0
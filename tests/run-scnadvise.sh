@@ -0,0 +1,33 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Advice must not change the section data, mmapped or read.  Mapped
+# data must be in memory after ELF_ADV_POPULATE.
+testfiles testfile testfile10 backtrace.x86_64.exec
+
+# Skipped when all the data was in memory before ELF_ADV_POPULATE.
+tempfiles scnadvise.out
+testrun ${abs_builddir}/scnadvise testfile testfile10 \
+	backtrace.x86_64.exec > scnadvise.out
+diff -u scnadvise.out - <<\EOF
+testfile: 34 sections
+testfile10: 32 sections
+backtrace.x86_64.exec: 32 sections
+EOF
+
+exit 0
@@ -0,0 +1,29 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Both with and without the hash table, section groups have several
+# sections with the same name.
+testfiles testfile testfile10 testfile58
+
+testrun_compare ${abs_builddir}/scnbyname testfile testfile10 testfile58 <<\EOF
+testfile: 34 names
+testfile10: 32 names
+testfile58: 30 names
+EOF
+
+exit 0
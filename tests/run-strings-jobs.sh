@@ -0,0 +1,58 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# A file large enough to be split into several pieces, 1M which is
+# shared out among the jobs.
+testfiles testfile testfile10 testfile-zgnu64
+tempfiles strings-jobs.tmp strings-jobs.tmp2 strings-jobs.out strings-jobs.jobs
+
+for f in testfile testfile10 testfile-zgnu64; do
+  cat $f $f $f $f >> strings-jobs.tmp
+done
+while test $(wc -c < strings-jobs.tmp) -lt 1048576; do
+  cat strings-jobs.tmp strings-jobs.tmp > strings-jobs.tmp2
+  mv strings-jobs.tmp2 strings-jobs.tmp
+done
+head -c 1048576 strings-jobs.tmp > strings-jobs.tmp2
+mv strings-jobs.tmp2 strings-jobs.tmp
+
+# Strings crossing where the pieces would end for 2 and 5 jobs, at 512k
+# and at a fifth of the file.
+for end in 524288 209715; do
+  printf '\000a string across the end of a piece\000' |
+    dd of=strings-jobs.tmp bs=1 seek=$(($end - 20)) conv=notrunc 2> /dev/null
+done
+
+for opts in "-a" "-a -n 2 -td" "-a -n 7 -el -tx" "-a -eb" "-a -eL -to"; do
+  testrun ${abs_top_builddir}/src/strings $opts strings-jobs.tmp \
+    > strings-jobs.out
+  for jobs in 2 5; do
+    testrun ${abs_top_builddir}/src/strings --jobs=$jobs $opts \
+      strings-jobs.tmp > strings-jobs.jobs
+    cmp strings-jobs.out strings-jobs.jobs
+  done
+done
+
+for jobs in 2 5; do
+  testrun ${abs_top_builddir}/src/strings --jobs=$jobs -a -td \
+    strings-jobs.tmp > strings-jobs.jobs
+  grep -q '^ *209696 a string across the end of a piece$' strings-jobs.jobs
+  grep -q '^ *524269 a string across the end of a piece$' strings-jobs.jobs
+done
+
+exit 0
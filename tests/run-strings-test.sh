@@ -467,4 +467,23 @@ testfile9:    3e20 Discard symbols from object files.
 testfile9:    3e43 [FILE...]
 EOF
 
+# Read through a pipe the input is looked at in chunks of 64k.  Strings
+# crossing into the next chunk are printed in one piece, and those which
+# are too short are not prepended to the next string.
+tempfiles strings-chunk strings-chunk.out
+{
+  dd if=/dev/zero bs=65528 count=1 2> /dev/null
+  printf 'hello\000world\000'
+  dd if=/dev/zero bs=65530 count=1 2> /dev/null
+  printf 'abc\000later\000'
+} > strings-chunk
+
+cat strings-chunk | testrun ${abs_top_builddir}/src/strings \
+  > strings-chunk.out || exit 1
+diff -u - strings-chunk.out <<\EOF || exit 1
+hello
+world
+later
+EOF
+
 exit 0
@@ -0,0 +1,73 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Writing the debug file in its own thread must not change either file.
+testfiles testfile testfile-debug-rel.o hello_x86_64.ko
+
+tempfiles out.stripped1 out.debug1 out.stripped2 out.debug2
+tempfiles readelf.out1 readelf.out2
+
+for file in testfile testfile-debug-rel.o hello_x86_64.ko; do
+  for opt in "" --reloc-debug-sections; do
+    testrun ${abs_top_builddir}/src/strip $opt -o out.stripped1 \
+	-f out.debug1 $file
+    # The debuglink section names the debug file.
+    mv out.debug1 out.debug2
+    testrun ${abs_top_builddir}/src/strip --jobs=2 $opt -o out.stripped2 \
+	-f out.debug1 $file
+    cmp out.stripped1 out.stripped2
+    cmp out.debug1 out.debug2
+  done
+done
+
+# The debug sections are compressed as elfcompress would.
+testrun ${abs_top_builddir}/src/strip --reloc-debug-sections \
+	-o out.stripped1 -f out.debug1 hello_x86_64.ko
+testrun ${abs_top_builddir}/src/elfcompress -q -t zlib out.debug1
+testrun ${abs_top_builddir}/src/readelf -w out.debug1 > readelf.out1
+testrun ${abs_top_builddir}/src/strip --jobs=2 --compress-debug-sections \
+	--reloc-debug-sections -o out.stripped2 -f out.debug1 hello_x86_64.ko
+testrun ${abs_top_builddir}/src/readelf -w out.debug1 > readelf.out2
+cmp readelf.out1 readelf.out2
+testrun ${abs_top_builddir}/src/readelf -S out.debug1 \
+	| grep -q '\.debug_info .* C '
+
+# The umask applies to the new files just like without --jobs.
+chmod 755 testfile
+rm -f out.stripped1 out.debug1 out.stripped2 out.debug2
+(umask 027
+ testrun ${abs_top_builddir}/src/strip -o out.stripped1 -f out.debug1 testfile
+ mv out.debug1 out.debug2
+ testrun ${abs_top_builddir}/src/strip --jobs=2 -o out.stripped2 \
+	-f out.debug1 testfile)
+for file in out.stripped1 out.debug1 out.stripped2 out.debug2; do
+  test "$(stat -c %a $file)" = 750
+done
+
+# The checksum of the debug file is only known when it is written.  If
+# it cannot be written the output file is left alone.
+tempfiles out.stripped3
+echo old > out.stripped3
+mkdir out.debugdir
+testrun ${abs_top_builddir}/src/strip --jobs=2 -o out.stripped3 \
+	-f out.debugdir testfile 2> /dev/null && exit 1
+rmdir out.debugdir
+test "$(cat out.stripped3)" = old
+test "$(echo out.stripped3.*)" = "out.stripped3.*"
+
+exit 0
@@ -0,0 +1,78 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Files and archive members handled in several processes must give the
+# same output as handled one after the other.
+testfiles testfile testfile2 testfile8 testfile11 testfile-debug-types
+tempfiles jobs.a serial.out serial.err jobs.out jobs.err
+
+testrun ${abs_top_builddir}/src/ar -rc jobs.a testfile testfile2 testfile8 \
+  testfile11
+
+check_jobs ()
+{
+  serial=0
+  testrun "$@" jobs.a testfile-debug-types nonexistent testfile11 jobs.a \
+    > serial.out 2> serial.err || serial=$?
+  for jobs in 2 3 8; do
+    status=0
+    testrun "$@" --jobs=$jobs jobs.a testfile-debug-types nonexistent \
+      testfile11 jobs.a > jobs.out 2> jobs.err || status=$?
+    test $serial -eq $status || exit 1
+    cmp serial.out jobs.out || exit 1
+    cmp serial.err jobs.err || exit 1
+  done
+}
+
+check_jobs ${abs_top_builddir}/src/nm
+check_jobs ${abs_top_builddir}/src/nm -s
+check_jobs ${abs_top_builddir}/src/size
+check_jobs ${abs_top_builddir}/src/size -A
+check_jobs ${abs_top_builddir}/src/size -t
+check_jobs ${abs_top_builddir}/src/readelf -a -w
+check_jobs ${abs_top_builddir}/src/readelf -c
+check_jobs ${abs_top_builddir}/src/elflint --gnu-ld
+check_jobs ${abs_top_builddir}/src/elflint -q --strict
+
+# readelf stops at a symbol table with a bad sh_link, what was printed
+# before must not get lost.  Also with output and errors going to the
+# same file, then their order must be kept.
+tempfiles badlink
+cp testfile badlink
+printf '\377\377\000\000' | dd of=badlink bs=1 seek=18876 conv=notrunc \
+  2>/dev/null
+for merge in false true; do
+  status=0
+  if $merge; then
+    testrun ${abs_top_builddir}/src/readelf -s testfile2 badlink testfile \
+      > serial.out 2>&1 || status=$?
+    testrun ${abs_top_builddir}/src/readelf --jobs=2 -s testfile2 badlink \
+      testfile > jobs.out 2>&1 || status=$((status + $?))
+  else
+    testrun ${abs_top_builddir}/src/readelf -s testfile2 badlink testfile \
+      > serial.out 2> serial.err || status=$?
+    testrun ${abs_top_builddir}/src/readelf --jobs=2 -s testfile2 badlink \
+      testfile > jobs.out 2> jobs.err || status=$((status + $?))
+    cmp serial.err jobs.err || exit 1
+  fi
+  test $status -eq 2 || exit 1
+  cmp serial.out jobs.out || exit 1
+  grep -q _IO_stdin_used jobs.out || exit 1
+done
+
+exit 0
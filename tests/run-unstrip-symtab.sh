@@ -0,0 +1,51 @@
+#! /bin/sh
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+# Symbols in both the stripped file and the debug file are merged
+# into one, section symbols come first in section order.
+testfiles testfile-debug-rel.o
+
+tempfiles out.stripped out.debug out.unstripped
+
+testrun ${abs_top_builddir}/src/strip -g -o out.stripped -f out.debug \
+	testfile-debug-rel.o
+testrun ${abs_top_builddir}/src/unstrip -o out.unstripped out.stripped \
+	out.debug
+
+testrun_compare ${abs_top_builddir}/src/readelf -s out.unstripped <<\EOF
+
+Symbol table [18] '.symtab' contains 15 entries:
+ 14 local symbols  String table: [19] '.strtab'
+  Num:            Value   Size Type    Bind   Vis          Ndx Name
+    0: 0000000000000000      0 NOTYPE  LOCAL  DEFAULT    UNDEF 
+    1: 0000000000000000      0 SECTION LOCAL  DEFAULT        1 
+    2: 0000000000000000      0 SECTION LOCAL  DEFAULT        2 
+    3: 0000000000000000      0 SECTION LOCAL  DEFAULT        3 
+    4: 0000000000000000      0 SECTION LOCAL  DEFAULT        4 
+    5: 0000000000000000      0 SECTION LOCAL  DEFAULT        6 
+    6: 0000000000000000      0 SECTION LOCAL  DEFAULT        7 
+    7: 0000000000000000      0 SECTION LOCAL  DEFAULT        8 
+    8: 0000000000000000      0 SECTION LOCAL  DEFAULT       10 
+    9: 0000000000000000      0 SECTION LOCAL  DEFAULT       12 
+   10: 0000000000000000      0 SECTION LOCAL  DEFAULT       13 
+   11: 0000000000000000      0 SECTION LOCAL  DEFAULT       14 
+   12: 0000000000000000      0 SECTION LOCAL  DEFAULT       15 
+   13: 0000000000000000      0 FILE    LOCAL  DEFAULT      ABS testfile-zdebug-rel.c
+   14: 0000000000000000     24 FUNC    GLOBAL DEFAULT        1 main
+EOF
+
+exit 0
@@ -0,0 +1,208 @@
+/* Test program for elf_scnadvise.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+
+
+static const int advices[] =
+  {
+    ELF_ADV_RANDOM, ELF_ADV_SEQUENTIAL, ELF_ADV_WILLNEED,
+    ELF_ADV_POPULATE, ELF_ADV_HUGEPAGE, ELF_ADV_NORMAL
+  };
+#define nadvices (sizeof advices / sizeof advices[0])
+
+
+/* Return whether all pages of the LEN bytes at START are in memory if
+   ALL, or whether any of them is.  */
+static bool
+resident (void *start, size_t len, bool all)
+{
+  uintptr_t pagesize = sysconf (_SC_PAGESIZE);
+  uintptr_t page = (uintptr_t) start & ~(pagesize - 1);
+  uintptr_t end = (uintptr_t) start + len;
+  for (; page < end; page += pagesize)
+    {
+      unsigned char vec;
+      if (mincore ((void *) page, pagesize, &vec) != 0)
+	error (EXIT_FAILURE, errno, "mincore");
+      if ((vec & 1) != all)
+	return ! all;
+    }
+  return all;
+}
+
+
+/* Check that ELF_ADV_POPULATE brings the data of the sections of FNAME
+   into memory.  Only sections of which nothing is in memory before can
+   tell, returns the number of those.  */
+static size_t
+check_populate (const char *fname)
+{
+  int fd = open (fname, O_RDONLY);
+  if (fd == -1)
+    error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+
+  /* Drop the file from memory.  It was likely just written, it must
+     be clean to be dropped.  */
+  (void) fdatasync (fd);
+  (void) posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+
+  /* Map the file ourselves, so the kernel can be told not to read
+     ahead before the ELF headers are looked at.  */
+  struct stat st;
+  if (fstat (fd, &st) != 0)
+    error (EXIT_FAILURE, errno, "cannot stat '%s'", fname);
+  void *map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    error (EXIT_FAILURE, errno, "cannot mmap '%s'", fname);
+  (void) madvise (map, st.st_size, MADV_RANDOM);
+
+  Elf *elf = elf_memory (map, st.st_size);
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "elf_memory '%s': %s", fname, elf_errmsg (-1));
+
+  size_t checked = 0;
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      Elf_Data *data = elf_rawdata (scn, NULL);
+      if (data == NULL || data->d_buf == NULL || data->d_size == 0
+	  || resident (data->d_buf, data->d_size, false))
+	continue;
+
+      if (elf_scnadvise (scn, ELF_ADV_POPULATE) != 0)
+	error (EXIT_FAILURE, 0, "elf_scnadvise: %s", elf_errmsg (-1));
+      if (! resident (data->d_buf, data->d_size, true))
+	error (EXIT_FAILURE, 0, "section %zd not in memory",
+	       elf_ndxscn (scn));
+      ++checked;
+    }
+
+  elf_end (elf);
+  munmap (map, st.st_size);
+  close (fd);
+
+  return checked;
+}
+
+
+/* Give all advices for all sections of FNAME opened with CMD, then
+   compare the section data with that of REF if not NULL.  Returns the
+   number of sections.  */
+static size_t
+check (const char *fname, Elf_Cmd cmd, Elf *ref)
+{
+  int fd = open (fname, O_RDONLY);
+  if (fd == -1)
+    error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+
+  Elf *elf = elf_begin (fd, cmd, NULL);
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin '%s': %s", fname, elf_errmsg (-1));
+
+  size_t nscns = 0;
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      ++nscns;
+      for (size_t i = 0; i < nadvices; ++i)
+	if (elf_scnadvise (scn, advices[i]) != 0)
+	  error (EXIT_FAILURE, 0, "elf_scnadvise %zd, %d: %s",
+		 elf_ndxscn (scn), advices[i], elf_errmsg (-1));
+
+      if (elf_scnadvise (scn, -1) != -1
+	  || elf_scnadvise (scn, ELF_ADV_HUGEPAGE + 1) != -1)
+	error (EXIT_FAILURE, 0, "invalid advice accepted");
+
+      if (ref != NULL)
+	{
+	  Elf_Data *data = elf_rawdata (scn, NULL);
+	  Elf_Data *refdata = elf_rawdata (elf_getscn (ref, elf_ndxscn (scn)),
+					   NULL);
+	  if (data == NULL || refdata == NULL)
+	    error (EXIT_FAILURE, 0, "elf_rawdata: %s", elf_errmsg (-1));
+	  if (data->d_size != refdata->d_size
+	      || (data->d_buf != NULL
+		  && memcmp (data->d_buf, refdata->d_buf, data->d_size) != 0))
+	    error (EXIT_FAILURE, 0, "section %zd data differs",
+		   elf_ndxscn (scn));
+	}
+    }
+
+  elf_end (elf);
+  close (fd);
+
+  return nscns;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  elf_version (EV_CURRENT);
+
+  if (elf_scnadvise (NULL, ELF_ADV_NORMAL) != -1)
+    error (EXIT_FAILURE, 0, "elf_scnadvise NULL");
+
+  /* How many sections can be checked depends on what the system
+     keeps in memory.  */
+  size_t populated = 0;
+  for (int i = 1; i < argc; ++i)
+    {
+      populated += check_populate (argv[i]);
+
+      int fd = open (argv[i], O_RDONLY);
+      if (fd == -1)
+	error (EXIT_FAILURE, errno, "cannot open '%s'", argv[i]);
+      Elf *ref = elf_begin (fd, ELF_C_READ, NULL);
+      if (ref == NULL)
+	error (EXIT_FAILURE, 0, "elf_begin '%s': %s", argv[i],
+	       elf_errmsg (-1));
+
+      size_t n = check (argv[i], ELF_C_READ_MMAP, ref);
+      if (check (argv[i], ELF_C_READ, ref) != n)
+	error (EXIT_FAILURE, 0, "different number of sections");
+      printf ("%s: %zd sections\n", argv[i], n);
+
+      elf_end (ref);
+      close (fd);
+    }
+
+  /* Skip if ELF_ADV_POPULATE couldn't be checked at all.  */
+  if (populated == 0)
+    {
+      puts ("no section data to populate");
+      return 77;
+    }
+
+  return 0;
+}
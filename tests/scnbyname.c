@@ -0,0 +1,158 @@
+/* Test looking up sections by name.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+
+
+static const char *
+scn_name (Elf *elf, Elf_Scn *scn)
+{
+  size_t shstrndx;
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+  if (elf_getshdrstrndx (elf, &shstrndx) != 0 || shdr == NULL)
+    error (EXIT_FAILURE, 0, "cannot get section name: %s", elf_errmsg (-1));
+  return elf_strptr (elf, shstrndx, shdr->sh_name);
+}
+
+
+/* Check that looking up each section by name gives the same as
+   walking all sections.  Returns the number of different names.  */
+static size_t
+check_names (Elf *elf)
+{
+  size_t nnames = 0;
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      const char *name = scn_name (elf, scn);
+      if (name == NULL)
+	continue;
+
+      Elf_Scn *first = NULL;
+      while ((first = elf_nextscn (elf, first)) != NULL)
+	if (strcmp (scn_name (elf, first) ?: "", name) == 0)
+	  break;
+      if (elf_getscnbyname (elf, name) != first)
+	error (EXIT_FAILURE, 0, "section %zd '%s': first is not %zd",
+	       elf_ndxscn (scn), name, elf_ndxscn (first));
+      if (first == scn)
+	++nnames;
+
+      Elf_Scn *next = scn;
+      while ((next = elf_nextscn (elf, next)) != NULL)
+	if (strcmp (scn_name (elf, next) ?: "", name) == 0)
+	  break;
+      if (elf_nextscnbyname (elf, scn, name) != next)
+	error (EXIT_FAILURE, 0, "section %zd '%s': next is not %zd",
+	       elf_ndxscn (scn), name, next != NULL ? elf_ndxscn (next) : 0);
+    }
+
+  if (elf_getscnbyname (elf, ".no such section") != NULL)
+    error (EXIT_FAILURE, 0, "found section which does not exist");
+
+  return nnames;
+}
+
+
+/* Give the first section the name of the last one and check that
+   the lookup notices.  */
+static void
+check_rename (Elf *elf)
+{
+  size_t shnum;
+  if (elf_getshdrnum (elf, &shnum) != 0 || shnum < 3)
+    error (EXIT_FAILURE, 0, "not enough sections");
+
+  Elf_Scn *last = elf_getscn (elf, shnum - 1);
+  const char *name = scn_name (elf, last);
+  if (elf_getscnbyname (elf, name) != last)
+    error (EXIT_FAILURE, 0, "last section not found by name");
+
+  GElf_Shdr lastshdr_mem;
+  GElf_Shdr *lastshdr = gelf_getshdr (last, &lastshdr_mem);
+  Elf_Scn *scn = elf_getscn (elf, 1);
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+  if (lastshdr == NULL || shdr == NULL)
+    error (EXIT_FAILURE, 0, "gelf_getshdr: %s", elf_errmsg (-1));
+  shdr->sh_name = lastshdr->sh_name;
+  if (gelf_update_shdr (scn, shdr) == 0)
+    error (EXIT_FAILURE, 0, "gelf_update_shdr: %s", elf_errmsg (-1));
+
+  if (elf_getscnbyname (elf, name) != scn
+      || elf_nextscnbyname (elf, scn, name) != last
+      || elf_nextscnbyname (elf, last, name) != NULL)
+    error (EXIT_FAILURE, 0, "renamed section not found by name");
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  static const Elf_Cmd cmds[] =
+    { ELF_C_READ_MMAP, ELF_C_READ, ELF_C_RDWR };
+
+  elf_version (EV_CURRENT);
+
+  if (elf_getscnbyname (NULL, ".text") != NULL)
+    error (EXIT_FAILURE, 0, "elf_getscnbyname NULL");
+
+  for (int i = 1; i < argc; ++i)
+    {
+      int fd = open (argv[i], O_RDWR);
+      if (fd == -1)
+	error (EXIT_FAILURE, errno, "cannot open '%s'", argv[i]);
+
+      size_t nnames = 0;
+      for (size_t c = 0; c < sizeof cmds / sizeof cmds[0]; ++c)
+	{
+	  Elf *elf = elf_begin (fd, cmds[c], NULL);
+	  if (elf == NULL)
+	    error (EXIT_FAILURE, 0, "elf_begin '%s': %s", argv[i],
+		   elf_errmsg (-1));
+	  size_t n = check_names (elf);
+	  if (c > 0 && n != nnames)
+	    error (EXIT_FAILURE, 0, "different number of names");
+	  nnames = n;
+	  elf_end (elf);
+	}
+
+      Elf *elf = elf_begin (fd, ELF_C_READ_MMAP_PRIVATE, NULL);
+      if (elf == NULL)
+	error (EXIT_FAILURE, 0, "elf_begin '%s': %s", argv[i],
+	       elf_errmsg (-1));
+      check_rename (elf);
+      elf_end (elf);
+
+      printf ("%s: %zd names\n", argv[i], nnames);
+      close (fd);
+    }
+
+  return 0;
+}